@@ -18,21 +18,59 @@
 
 #include "pico/cyw43_arch.h"            // Biblioteca para usar o módulo de conectividade para Raspberry Pi Pico W.
 #include <string.h>                     // Biblioteca padrão para funções de manipulação de strings.
+#include <strings.h>                    // Biblioteca padrão para comparação de strings sem diferenciar maiúsculas.
+#include <stddef.h>                     // Biblioteca padrão para `offsetof`.
 
 #include "lwip/pbuf.h"                  // Biblioteca para gerenciamento de buffer de pacotes no LWIP.
 #include "lwip/tcp.h"                   // Biblioteca de funções TCP.
 
 #include "dhcpserver.h"                 // Biblioteca para funcionalidade de servidor DHCP.
 #include "dnsserver.h"                  // Biblioteca para funcionalidade de servidor DNS.
+#include "web_assets.h"                 // Páginas do portal (geradas de web/ por tools/embed_assets.py).
+#include "crypto/sha1.h"                // SHA-1 e base64 para o aceite do WebSocket.
+#include "log_ring.h"                    // Registro binário de mensagens (`LOG_DEBUG`, `LOG_INFO`, ...).
 
 // ----------------------------------- Defines ----------------------------------
 
 #define TCP_PORT 80                     // Número da porta TCP para o servidor HTTP.
-#define DEBUG_printf printf             // Macro para impressão de depuração.
-#define POLL_TIME_S 5                   // Tempo de polling em segundos para operações do servidor.
+#define AP_IP_STRING "192.168.4.1"      // Endereço do gateway do modo AP (deve coincidir com o configurado em main.c).
+#define POLL_TIME_S 1                   // Tempo de polling em segundos para operações do servidor.
+#define TCP_IDLE_TIMEOUT_S 5            // Tempo (s) sem dados recebidos ou confirmados antes de fechar a conexão.
+#define TCP_MAX_CONNECTIONS 4           // Quantidade de conexões simultâneas atendidas (slots estáticos).
+#define TCP_SERVER_BACKLOG 8            // Conexões aguardando o accept na fila do socket de escuta.
+#define TCP_REQUEST_BUF_SIZE 1024       // Tamanho do buffer de requisição de cada conexão.
+#define TCP_MAX_REQUESTS 16             // Requisições atendidas por conexão persistente antes de fechá-la.
+#define TCP_MAX_SUBSCRIBERS 2           // Conexões de `/events` simultâneas (as demais ficam livres para o portal).
+#define LIVE_JSON_SIZE 160              // Tamanho do buffer da amostra ao vivo em JSON.
+#define LIVE_EVENT_SIZE (LIVE_JSON_SIZE + 32) // Tamanho do buffer do evento SSE (`id:` e `data:` + JSON).
+#define AP_STRINGIFY_(x) #x             // Converte o argumento em string literal.
+#define AP_STRINGIFY(x) AP_STRINGIFY_(x) // Converte o valor de uma macro em string literal.
 #define HTTP_GET "GET"                  // String do método HTTP GET.
 #define HTTP_POST "POST"                // String do método HTTP POST.
-#define CONFIG "/config"                // Caminho da URL para a página de configuração.
+#define POST_PATH "/post"               // Caminho da URL que recebe o formulário de configuração.
+#define API_TELEMETRY "/api/telemetry"  // Caminho da URL da última amostra de telemetria em JSON.
+#define EVENTS_PATH "/events"           // Caminho da URL do fluxo de amostras (Server-Sent Events).
+#define REMOTE_PATH "/remote"          // Caminho da URL da página de controle remoto do menu.
+#define WS_PATH "/ws"                   // Caminho da URL do WebSocket de controle remoto e espelho do display.
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11" // GUID concatenado à chave do cliente (RFC 6455).
+#define WS_KEY_SIZE 24                  // Comprimento de `Sec-WebSocket-Key` (16 bytes em base64).
+#define WS_ACCEPT_SIZE 28               // Comprimento de `Sec-WebSocket-Accept` (SHA-1 em base64).
+#define WS_FRAME_SIZE (128 * 64 / 8)    // Tamanho do framebuffer do SSD1306 espelhado.
+#define WS_FRAME_INTERVAL_MS 100        // Intervalo mínimo entre dois quadros do espelho (até 10 quadros/s).
+#define WS_DELTA_MAX_GAP 3              // Bytes iguais tolerados dentro de um trecho alterado (evita trechos curtos).
+#define WS_INPUT_QUEUE_SIZE 8           // Comandos remotos aguardando o laço principal (potência de 2).
+#define WS_HEADER_MAX 4                 // Maior cabeçalho de quadro enviado (payload de até 65535 bytes).
+#define WS_OPCODE_TEXT 0x1              // Quadro de texto (comandos do cliente).
+#define WS_OPCODE_BINARY 0x2            // Quadro binário (espelho do display).
+#define WS_OPCODE_CLOSE 0x8             // Quadro de fechamento.
+#define WS_OPCODE_PING 0x9              // Quadro de ping (mantém a conexão ativa).
+#define WS_MSG_KEYFRAME 0x00            // Mensagem com o framebuffer completo.
+#define WS_MSG_DELTA 0x01               // Mensagem com os trechos alterados (offset de 16 bits, tamanho, bytes).
+#define WIFI_SSID_MAX_LEN 32            // Comprimento máximo do SSID (802.11).
+#define WIFI_PASSWORD_MIN_LEN 8         // Comprimento mínimo da frase-senha WPA2.
+#define WIFI_PASSWORD_MAX_LEN 64        // Comprimento máximo da senha WPA2 (frase de 63 ou chave de 64 dígitos hexadecimais).
+#define HTTP_MODE_AP 0x01               // Rota disponível no modo AP (portal de configuração).
+#define HTTP_MODE_STA 0x02              // Rota disponível no modo STA (conectado à rede local).
 
 /* Definições de Teste usando o LED Onboard do Raspberry Pi Pico */
 #define LED_TEST_BODY "<html><body><h1>Olá do Pico W.</h1><p>Led está %s</p><p><a href=\"?led=%d\">Ligar led %s</a></body></html>"
@@ -45,69 +83,236 @@
 /**
  * @brief Modelo de cabeçalhos de resposta HTTP.
  *
- * Esta definição contém uma string de cabeçalhos de resposta HTTP pré-formatada, incluindo código de status e comprimento do conteúdo.
- * É dinamicamente populada com o código de status (`%d`) e comprimento do conteúdo (`%d`) antes de ser enviada ao cliente.
+ * Esta definição contém uma string de cabeçalhos de resposta HTTP pré-formatada, incluindo tipo e comprimento do conteúdo.
+ * É populada uma única vez, na abertura do servidor, com o tipo (`%s`), o comprimento (`%lu`), a codificação (`%s`)
+ * e a ETag (`%s`) de cada página. `Cache-Control: no-cache` faz o navegador revalidar a página com `If-None-Match`.
+ *
+ * @note Os cabeçalhos das respostas estáticas não têm a linha `Connection` nem a linha em branco
+ *       final: elas são enviadas depois, de `HTTP_CONNECTION_KEEP_ALIVE` ou `HTTP_CONNECTION_CLOSE`.
+ */
+#define HTTP_RESPONSE_HEADERS "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %lu\r\n%sVary: Accept-Encoding\r\nETag: %s\r\nCache-Control: no-cache\r\n"
+
+/**
+ * @brief Resposta HTTP para página não modificada.
+ *
+ * Enviada quando a ETag informada pelo cliente em `If-None-Match` é igual à da página.
  */
-#define HTTP_RESPONSE_HEADERS "HTTP/1.1 %d OK\nContent-Length: %d\nContent-Type: text/html; charset=utf-8\nConnection: close\n\n"
+#define HTTP_RESPONSE_NOT_MODIFIED "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nCache-Control: no-cache\r\n"
 
 /**
  * @brief Resposta HTTP para redirecionamento.
  *
- * Esta definição contém uma string de resposta HTTP pré-formatada para redirecionamento.
- * É dinamicamente populada com a URL de destino (`%s`) antes de ser enviada ao cliente.
+ * Resposta completa, montada em tempo de compilação com o endereço do gateway, usada para
+ * caminhos desconhecidos e para as sondagens de portal cativo do Android e do Windows.
+ * `Cache-Control: no-store` impede que o sistema guarde o resultado da sondagem.
  */
-#define HTTP_RESPONSE_REDIRECT "HTTP/1.1 302 Redirect\nLocation: http://%s" CONFIG "\n\n"
+#define HTTP_RESPONSE_REDIRECT "HTTP/1.1 302 Found\r\nLocation: http://" AP_IP_STRING CONFIG "\r\nContent-Length: 0\r\nCache-Control: no-store\r\n"
 
 /**
- * @brief Modelo de corpo HTML para a página de configuração Wi-Fi.
+ * @brief Corpo da resposta às sondagens de portal cativo da Apple.
  *
- * Esta definição contém uma string de corpo HTML pré-formatada para a página de configuração Wi-Fi.
- * Inclui um formulário para inserir SSID e senha, estilizado com CSS inline.
+ * O iOS e o macOS só consideram a rede livre se o corpo contiver "Success"; uma página que
+ * redireciona para a configuração abre o assistente de portal cativo já na página certa.
+ */
+#define HTTP_APPLE_PROBE_BODY "<HTML><HEAD><meta http-equiv=\"refresh\" content=\"0;url=http://" AP_IP_STRING CONFIG "\"></HEAD></HTML>"
+#define HTTP_APPLE_PROBE_BODY_LEN "95"  // Comprimento de `HTTP_APPLE_PROBE_BODY` (conferido em tempo de compilação).
+
+/**
+ * @brief Cabeçalhos da resposta às sondagens de portal cativo da Apple.
+ */
+#define HTTP_RESPONSE_APPLE_PROBE "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " HTTP_APPLE_PROBE_BODY_LEN \
+                                  "\r\nCache-Control: no-store\r\n"
+
+/**
+ * @brief Final dos cabeçalhos de uma resposta em conexão persistente.
  */
-#define WIFI_CONFIG_BODY "<html><body style=\"display:flex;justify-content:center;align-items:center;height:100vh;background-color:#e3f2fd;\">\n\
-<div style=\"text-align:center;max-width:400px;padding:20px;border-radius:10px;background-color:white;box-shadow:0 4px 8px rgba(0,0,0,0.2);\">\n\
-<h1 style=\"color:#1976d2;\">Wi-Fi Configuration</h1>\n\
-<p style=\"color:#444;\">Enter your Wi-Fi credentials below:</p>\n\
-<form method=\"POST\" action=\"/post\">\n\
-<label for=\"ssid\" style=\"font-weight:bold;\">SSID:</label><br>\n\
-<input type=\"text\" id=\"ssid\" name=\"ssid\" required style=\"width:100%;padding:10px;margin:10px 0;border:1px solid #ccc;border-radius:5px;\"><br>\n\
-<label for=\"password\" style=\"font-weight:bold;\">PASSWORD:</label><br>\n\
-<input type=\"password\" id=\"password\" name=\"password\" required style=\"width:100%;padding:10px;margin:10px 0;border:1px solid #ccc;border-radius:5px;\"><br>\n\
-<button type=\"submit\" style=\"width:100%;padding:10px;background-color:#1976d2;color:white;border:none;border-radius:5px;font-size:16px;\">Salvar</button>\n\
-</form>\n\
-</div></body></html>"
+#define HTTP_CONNECTION_KEEP_ALIVE "Connection: keep-alive\r\nKeep-Alive: timeout=" AP_STRINGIFY(TCP_IDLE_TIMEOUT_S) \
+                                   ", max=" AP_STRINGIFY(TCP_MAX_REQUESTS) "\r\n\r\n"
 
 /**
- * @brief Modelo de página HTML para configuração bem-sucedida.
+ * @brief Final dos cabeçalhos de uma resposta seguida do fechamento da conexão.
+ */
+#define HTTP_CONNECTION_CLOSE "Connection: close\r\n\r\n"
+
+/**
+ * @brief Modelo de cabeçalhos da amostra ao vivo em JSON.
  *
- * Esta definição contém uma string de página HTML pré-formatada para exibir uma mensagem de sucesso
- * quando a configuração é salva com sucesso. Nesta página, há um botão para 
- * retornar à página de configuração.
+ * Formatado uma vez por amostra com o comprimento (`%d`) do JSON, em `tcp_server_publish`.
  */
-#define SUCCESS_PAGE "<html><body style=\"display:flex;justify-content:center;align-items:center;height:100vh;background-color:#e3f2fd;\">\n\
-<div style=\"text-align:center;max-width:400px;padding:20px;border-radius:10px;background-color:white;box-shadow:0 4px 8px rgba(0,0,0,0.2);\">\n\
-<h1 style=\"color:#1976d2;\">Configuração salva com sucesso!</h1>\n\
-<a href=\"/config\" style=\"display:inline-block;margin-top:20px;padding:10px 20px;background-color:#1976d2;color:white;text-decoration:none;border-radius:5px;font-size:16px;\">Voltar para Configuração</a>\n\
-</div></body></html>"
+#define HTTP_RESPONSE_JSON_HEADERS "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\nCache-Control: no-store\r\nAccess-Control-Allow-Origin: *\r\n"
 
 /**
- * @brief Modelo de página HTML para configuração falhada.
+ * @brief Cabeçalhos e início do fluxo de eventos de `/events`.
  *
- * Esta definição contém uma string de página HTML pré-formatada para exibir uma mensagem de erro
- * quando há uma falha ao salvar a configuração. Nesta página, há um botão para 
- * retornar à página de configuração.
+ * Sem `Content-Length`: cada amostra é enviada como um evento (`id:` e `data:`) enquanto a
+ * conexão estiver aberta. `retry` define o intervalo de reconexão do `EventSource`.
  */
-#define FAILURE_PAGE "<html><body style=\"display:flex;justify-content:center;align-items:center;height:100vh;background-color:#e3f2fd;\">\n\
-<div style=\"text-align:center;max-width:400px;padding:20px;border-radius:10px;background-color:white;box-shadow:0 4px 8px rgba(0,0,0,0.2);\">\n\
-<h1 style=\"color:#1976d2;\">Error saving configuration</h1>\n\
-<p style=\"color:#444;\">Por favor, tente novamente.</p>\n\
-<a href=\"/config\" style=\"display:inline-block;margin-top:20px;padding:10px 20px;background-color:#1976d2;color:white;text-decoration:none;border-radius:5px;font-size:16px;\">Back to Configuration</a>\n\
-</div></body></html>"
+#define HTTP_RESPONSE_EVENT_STREAM "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-store\r\nAccess-Control-Allow-Origin: *\r\n"
+#define HTTP_EVENT_STREAM_START "retry: 3000\n\n"
+#define HTTP_EVENT_HEARTBEAT ":\n\n"    // Comentário SSE enviado a assinantes ociosos.
+
+/**
+ * @brief Cabeçalhos da resposta ao pedido de upgrade para WebSocket.
+ *
+ * Seguidos do aceite calculado para a conexão (`WS_ACCEPT_SIZE` bytes) e da linha em branco final.
+ */
+#define HTTP_RESPONSE_WS_UPGRADE "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: "
+#define HTTP_WS_UPGRADE_END "\r\n\r\n"
+
+#define HTTP_RESPONSE_BAD_REQUEST "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n"
+#define HTTP_RESPONSE_NO_CONTENT "HTTP/1.1 204 No Content\r\nCache-Control: no-store\r\n"
+#define HTTP_RESPONSE_NOT_FOUND "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+#define HTTP_RESPONSE_UNAVAILABLE "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 5\r\nContent-Length: 0\r\n"
+
+#define STATIC_PAGE_HEADER_SIZE 224     // Tamanho do buffer para os cabeçalhos pré-formatados de cada página.
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura para armazenar uma resposta estática.
+ *
+ * O corpo fica na flash (dado constante) e é enviado sem cópia; os cabeçalhos, com o
+ * `Content-Length` já calculado, são formatados uma única vez em `tcp_server_pages_init`.
+ * Respostas sem cabeçalhos (`header_len` igual a 0) são eventos de um fluxo já iniciado.
+ */
+typedef struct STATIC_PAGE_T_ {
+    const void *body;             // Corpo da resposta (na flash), ou NULL para respostas sem corpo.
+    int body_len;                 // Comprimento do corpo.
+    char header[STATIC_PAGE_HEADER_SIZE]; // Cabeçalhos pré-formatados da resposta.
+    int header_len;               // Comprimento dos cabeçalhos.
+    bool copy;                    // Conteúdo reescrito a cada amostra: enviado com `TCP_WRITE_FLAG_COPY`.
+} STATIC_PAGE_T;
+
+/**
+ * @brief Estrutura para armazenar a última amostra de telemetria, já serializada.
+ *
+ * A amostra é formatada uma única vez e as mesmas respostas são enviadas para todos os
+ * clientes de `/api/telemetry` e para todos os assinantes de `/events`.
+ */
+typedef struct LIVE_FEED_T_ {
+    STATIC_PAGE_T json;           // Resposta de `/api/telemetry` (cabeçalhos + JSON).
+    STATIC_PAGE_T event;          // Evento SSE da amostra (sem cabeçalhos).
+    char json_body[LIVE_JSON_SIZE];   // Amostra em JSON.
+    char event_body[LIVE_EVENT_SIZE]; // Amostra no formato de evento SSE.
+    uint32_t seq;                 // Número da amostra (campo `id:` do evento).
+    uint32_t delivered;           // Eventos entregues aos assinantes.
+    uint32_t skipped;             // Eventos descartados porque o assinante ainda enviava o anterior.
+} LIVE_FEED_T;
+
+/**
+ * @brief Estrutura para armazenar o último quadro espelhado do display.
+ *
+ * Cada quadro é montado uma única vez, já com o cabeçalho do quadro WebSocket, e a mesma
+ * mensagem é enviada para todos os clientes de `/ws`: o quadro completo para quem acabou de
+ * conectar ou perdeu um quadro, e só os trechos alterados para os demais.
+ */
+typedef struct WS_MIRROR_T_ {
+    uint8_t last[WS_FRAME_SIZE];  // Último framebuffer enviado.
+    uint8_t key_msg[WS_HEADER_MAX + 1 + WS_FRAME_SIZE];   // Quadro completo (cabeçalho + tipo + framebuffer).
+    uint8_t delta_msg[WS_HEADER_MAX + 1 + WS_FRAME_SIZE]; // Trechos alterados (cabeçalho + tipo + trechos).
+    STATIC_PAGE_T key;            // Mensagem do quadro completo (sem cabeçalhos HTTP).
+    STATIC_PAGE_T delta;          // Mensagem dos trechos alterados (sem cabeçalhos HTTP).
+    bool valid;                   // `last` contém um quadro já enviado.
+    uint32_t last_ms;             // Instante do último quadro enviado.
+    uint32_t keyframes;           // Quadros completos enviados.
+    uint32_t deltas;              // Quadros de trechos alterados enviados.
+    uint32_t skipped;             // Quadros perdidos porque o cliente ainda enviava o anterior.
+    volatile uint8_t clients;     // Clientes de `/ws` conectados (lido sem trava pelo laço principal).
+} WS_MIRROR_T;
+
+/**
+ * @brief Comandos remotos recebidos pelo WebSocket.
+ */
+typedef enum {
+    WS_INPUT_UP = 1,              // Move o cursor para cima.
+    WS_INPUT_DOWN,                // Move o cursor para baixo.
+    WS_INPUT_ENTER                // Equivale ao botão B.
+} WS_INPUT_T;
+
+/**
+ * @brief Fila circular dos comandos remotos.
+ *
+ * Preenchida pelo callback de recebimento do lwIP e esvaziada pelo laço principal (um produtor
+ * e um consumidor), então os índices só são escritos por um dos lados e nenhuma trava é necessária.
+ */
+typedef struct WS_INPUT_QUEUE_T_ {
+    uint8_t events[WS_INPUT_QUEUE_SIZE]; // Comandos pendentes (`WS_INPUT_T`).
+    volatile uint8_t head;        // Próxima posição a escrever (escrita só pelo lwIP).
+    volatile uint8_t tail;        // Próxima posição a ler (escrita só pelo laço principal).
+    uint32_t dropped;             // Comandos descartados com a fila cheia.
+} WS_INPUT_QUEUE_T;
+
+/**
+ * @brief Estrutura para armazenar as respostas possíveis de uma página do portal.
+ */
+typedef struct WEB_PAGE_T_ {
+    const WEB_ASSET_T *asset;     // Arquivo embutido com o conteúdo da página.
+    STATIC_PAGE_T plain;          // Resposta 200 sem compressão.
+    STATIC_PAGE_T gzip;           // Resposta 200 com `Content-Encoding: gzip`.
+    STATIC_PAGE_T not_modified;   // Resposta 304 para a ETag atual.
+} WEB_PAGE_T;
 
 // ---------------------------------- Variáveis ---------------------------------
 
-char ssid[32] = {0};              // Array para armazenar o SSID da rede Wi-Fi.
-char password[64] = {0};          // Array para armazenar a senha da rede Wi-Fi. Aumentado para aceitar senhas mais longas.
+WEB_PAGE_T config_page = { &web_asset_config_html };      // Página de configuração Wi-Fi.
+WEB_PAGE_T success_page = { &web_asset_success_html };    // Página de configuração salva.
+WEB_PAGE_T failure_page = { &web_asset_failure_html };    // Página de falha ao salvar.
+WEB_PAGE_T remote_page = { &web_asset_remote_html };      // Página de controle remoto do menu.
+
+static const char apple_probe_body[] = HTTP_APPLE_PROBE_BODY; // Corpo da resposta às sondagens da Apple.
+_Static_assert(sizeof(apple_probe_body) - 1 == 95, "HTTP_APPLE_PROBE_BODY_LEN desatualizado");
+
+// Respostas constantes, montadas em tempo de compilação e gravadas na flash (enviadas sem formatação nem cópia)
+static const STATIC_PAGE_T redirect_page = {              // Redirecionamento para a configuração.
+    NULL, 0, HTTP_RESPONSE_REDIRECT, sizeof(HTTP_RESPONSE_REDIRECT) - 1
+};
+static const STATIC_PAGE_T apple_probe_page = {           // Resposta às sondagens da Apple.
+    apple_probe_body, sizeof(apple_probe_body) - 1, HTTP_RESPONSE_APPLE_PROBE, sizeof(HTTP_RESPONSE_APPLE_PROBE) - 1
+};
+
+static const char event_stream_start[] = HTTP_EVENT_STREAM_START; // Início do fluxo de eventos.
+static const char event_heartbeat[] = HTTP_EVENT_HEARTBEAT;       // Evento vazio para manter o fluxo ativo.
+static const STATIC_PAGE_T event_stream_page = {          // Cabeçalhos de `/events`.
+    event_stream_start, sizeof(event_stream_start) - 1, HTTP_RESPONSE_EVENT_STREAM, sizeof(HTTP_RESPONSE_EVENT_STREAM) - 1
+};
+static const STATIC_PAGE_T event_heartbeat_page = {       // Evento vazio (sem cabeçalhos).
+    event_heartbeat, sizeof(event_heartbeat) - 1, "", 0
+};
+static const STATIC_PAGE_T no_content_page = {            // Ainda não há amostra.
+    NULL, 0, HTTP_RESPONSE_NO_CONTENT, sizeof(HTTP_RESPONSE_NO_CONTENT) - 1
+};
+static const STATIC_PAGE_T not_found_page = {             // Caminho desconhecido no modo STA.
+    NULL, 0, HTTP_RESPONSE_NOT_FOUND, sizeof(HTTP_RESPONSE_NOT_FOUND) - 1
+};
+static const STATIC_PAGE_T unavailable_page = {           // Limite de assinantes atingido.
+    NULL, 0, HTTP_RESPONSE_UNAVAILABLE, sizeof(HTTP_RESPONSE_UNAVAILABLE) - 1
+};
+static const STATIC_PAGE_T bad_request_page = {           // Pedido de upgrade sem os cabeçalhos do WebSocket.
+    NULL, 0, HTTP_RESPONSE_BAD_REQUEST, sizeof(HTTP_RESPONSE_BAD_REQUEST) - 1
+};
+
+// Quadros de controle do WebSocket (sem máscara, sem payload), enviados sem cabeçalhos HTTP
+static const uint8_t ws_ping_frame[] = { 0x80 | WS_OPCODE_PING, 0x00 };   // Mantém a conexão ativa.
+static const uint8_t ws_close_frame[] = { 0x80 | WS_OPCODE_CLOSE, 0x00 }; // Resposta ao fechamento do cliente.
+static const STATIC_PAGE_T ws_ping_page = { ws_ping_frame, sizeof(ws_ping_frame), "", 0 };
+static const STATIC_PAGE_T ws_close_page = { ws_close_frame, sizeof(ws_close_frame), "", 0 };
+
+// Partes fixas da resposta de upgrade (o aceite, entre elas, é calculado por conexão)
+static const char ws_upgrade_headers[] = HTTP_RESPONSE_WS_UPGRADE;
+static const char ws_upgrade_end[] = HTTP_WS_UPGRADE_END;
+static const STATIC_PAGE_T ws_upgrade_page = { NULL, 0, HTTP_RESPONSE_WS_UPGRADE, sizeof(HTTP_RESPONSE_WS_UPGRADE) - 1 };
+
+LIVE_FEED_T live_feed = {0};      // Última amostra de telemetria serializada.
+WS_MIRROR_T ws_mirror = {0};      // Último quadro do display espelhado para os clientes de `/ws`.
+WS_INPUT_QUEUE_T ws_input = {0};  // Comandos remotos aguardando o laço principal.
+u8_t http_server_mode = HTTP_MODE_AP; // Modo atual do servidor (seleciona as rotas disponíveis).
+
+// Finais dos cabeçalhos, enviados entre os cabeçalhos estáticos e o corpo
+static const char http_connection_keep_alive[] = HTTP_CONNECTION_KEEP_ALIVE; // Mantém a conexão aberta.
+static const char http_connection_close[] = HTTP_CONNECTION_CLOSE;           // Fecha a conexão após a resposta.
+
+char ssid[WIFI_SSID_MAX_LEN + 1] = {0};         // Array para armazenar o SSID da rede Wi-Fi.
+char password[WIFI_PASSWORD_MAX_LEN + 1] = {0}; // Array para armazenar a senha da rede Wi-Fi.
 int id_pw_collected = 0;          // Flag para indicar se o SSID e a senha foram coletados (1) ou não (0).
 int aux_connection = 1;           // Variável auxiliar para indicar se o modo AP já foi desativado (0) ou não (1).
 
@@ -124,64 +329,155 @@ typedef struct TCP_SERVER_T_ {
     ip_addr_t gw;                 // Endereço IP do gateway.
 } TCP_SERVER_T;
 
+TCP_SERVER_T sta_server = {0};    // Estado do servidor HTTP no modo STA (telemetria ao vivo na rede local).
+
+/**
+ * @brief Estrutura para armazenar uma parte de uma resposta em envio.
+ */
+typedef struct TCP_RESPONSE_PART_T_ {
+    const char *data;             // Dados constantes da parte (enviados sem cópia).
+    int len;                      // Comprimento da parte.
+} TCP_RESPONSE_PART_T;
+
 /**
  * @brief Estrutura para armazenar o estado da conexão TCP.
  *
  * Esta estrutura armazena o estado de uma conexão TCP, incluindo o PCB da conexão,
- * comprimento dos dados enviados, cabeçalhos, resultado, comprimento dos cabeçalhos,
- * comprimento do resultado e endereço IP do gateway.
+ * a requisição recebida, a resposta estática em envio e o progresso do envio.
+ * Nenhum buffer de corpo é necessário: as páginas são enviadas diretamente da flash.
+ * Em conexões persistentes, requisições enviadas em pipeline aguardam em `headers`
+ * até que a resposta anterior tenha sido toda entregue ao lwIP.
  */
 typedef struct TCP_CONNECT_STATE_T_ {
     struct tcp_pcb *pcb;          // Ponteiro para o bloco de controle de protocolo TCP da conexão.
+    struct TCP_CONNECT_STATE_T_ *next_free; // Próximo slot livre (válido apenas enquanto o slot está livre).
     int sent_len;                 // Comprimento dos dados enviados.
-    char headers[1024];           // Buffer para armazenar os cabeçalhos HTTP.
-    char result[1024];            // Buffer para armazenar o resultado HTTP.
-    int header_len;               // Comprimento dos cabeçalhos HTTP.
-    int result_len;               // Comprimento do resultado HTTP.
+    const STATIC_PAGE_T *page;    // Resposta em envio (cabeçalhos e corpo estáticos), ou NULL se não houver.
+    TCP_RESPONSE_PART_T parts[3]; // Partes da resposta: cabeçalhos, linha `Connection` e corpo.
+    int response_len;             // Comprimento total da resposta.
+    int queued_len;               // Bytes da resposta já entregues ao lwIP com `tcp_write`.
+    int retired_len;              // Bytes de respostas anteriores do pipeline ainda não confirmados.
+    int request_len;              // Bytes recebidos e acumulados em `headers` (podem incluir requisições seguintes).
+    int scanned_len;              // Bytes da requisição atual já procurados pelo fim dos cabeçalhos.
+    int body_offset;              // Início do corpo em `headers` (0 enquanto os cabeçalhos não terminaram).
+    int content_length;           // Valor do cabeçalho Content-Length (0 se ausente).
+    bool keep_alive;              // A conexão continua aberta após a resposta atual.
+    bool subscriber;              // Assinante de `/events`: recebe cada nova amostra até fechar a conexão.
+    bool websocket;               // Conexão de `/ws` já aceita: os dados recebidos são quadros WebSocket.
+    bool ws_keyframe;             // O próximo quadro do espelho enviado deve ser completo.
+    char ws_accept[WS_ACCEPT_SIZE]; // Valor de `Sec-WebSocket-Accept` da conexão.
+    u16_t requests_served;        // Requisições já atendidas na conexão.
     ip_addr_t *gw;                // Ponteiro para o endereço IP do gateway.
+    uint32_t last_activity_ms;    // Instante do último dado recebido ou confirmado.
+    u8_t priority;                // Prioridade da conexão (TCP_PRIO_MIN para sondagens, TCP_PRIO_MAX para o portal).
+    char headers[TCP_REQUEST_BUF_SIZE]; // Buffer para armazenar a requisição HTTP recebida (último campo: não é zerado na alocação).
 } TCP_CONNECT_STATE_T;
 
+/**
+ * @brief Estrutura para armazenar o conjunto fixo de slots de conexão.
+ *
+ * Os slots são reservados estaticamente e encadeados em uma lista de livres, então
+ * alocar e liberar uma conexão é O(1) e não usa o heap compartilhado com o lwIP.
+ */
+typedef struct TCP_CONNECT_POOL_T_ {
+    TCP_CONNECT_STATE_T slots[TCP_MAX_CONNECTIONS]; // Slots de conexão.
+    TCP_CONNECT_STATE_T *free_list; // Primeiro slot livre.
+    bool initialized;             // Flag para indicar se a lista de livres foi montada.
+    uint8_t in_use;               // Quantidade de slots em uso.
+    uint8_t high_water;           // Maior quantidade de slots em uso desde o boot.
+    uint32_t accepted;            // Quantidade de conexões aceitas desde o boot.
+    uint32_t rejected;            // Quantidade de conexões recusadas por falta de slot desde o boot.
+} TCP_CONNECT_POOL_T;
+
+TCP_CONNECT_POOL_T tcp_connect_pool = {0}; // Slots de conexão do servidor HTTP.
 
-// ---------------------------------- Funções ---------------------------------
+/**
+ * @brief Estrutura para armazenar a requisição HTTP já separada em partes.
+ *
+ * Todas as strings apontam para o buffer de requisição da conexão (análise sem cópia).
+ */
+typedef struct HTTP_REQUEST_T_ {
+    const char *method;           // Método da requisição (por exemplo, "GET").
+    const char *path;             // Caminho, sem a query string.
+    const char *params;           // Query string (após o '?'), ou NULL se ausente.
+    const char *version;          // Versão do protocolo (terminada por "\r\n", não por NULL).
+    const char *headers;          // Início da requisição, para consulta dos cabeçalhos.
+    int headers_len;              // Comprimento da parte de cabeçalhos.
+    char *body;                   // Corpo da requisição, terminado com NULL.
+    int body_len;                 // Comprimento do corpo.
+} HTTP_REQUEST_T;
+
+/**
+ * @brief Política de cache de uma rota.
+ */
+typedef enum {
+    HTTP_CACHE_NONE,              // Sempre envia a página completa.
+    HTTP_CACHE_REVALIDATE         // Responde 304 quando a ETag do cliente coincide.
+} HTTP_CACHE_POLICY_T;
 
-// --------------------------- Função para Processar Payload POST ---------------------------
+struct HTTP_ROUTE_T_;
 
 /**
- * @brief Processa o payload da requisição POST para extrair SSID e senha.
- *
- * Esta função recebe um payload codificado em URL de uma requisição HTTP POST,
- * decodifica-o, extrai os parâmetros SSID e senha, e os armazena
- * em variáveis globais para uso posterior.
- *
- * @param request A requisição HTTP completa (não usada nesta função, mas mantida para extensibilidade).
- * @param payload O corpo da requisição POST codificado em URL contendo SSID e senha.
- * 
- * @return 0 se o SSID e a senha forem extraídos com sucesso, -1 caso contrário.
- *
- * @note A função garante a terminação correta das strings para evitar estouro de buffer.
- *       Ela também lida com a codificação URL, substituindo sequências "%XX" por seus equivalentes ASCII
- *       e convertendo símbolos "+" em espaços.
+ * @brief Função que trata uma rota.
  */
-int process_post_payload(const char *request, char *payload) {
-    if (!payload) return -1;            // Proteção contra ponteiro nulo
+typedef err_t (*HTTP_ROUTE_HANDLER_T)(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb,
+                                      HTTP_REQUEST_T *request, const struct HTTP_ROUTE_T_ *route);
 
-    // Garante que o payload esteja corretamente terminado com NULL
-    size_t payload_len = strlen(payload);
-    if (payload_len == 0) return -1;    // Verificação de payload vazio
+/**
+ * @brief Estrutura para armazenar uma entrada da tabela de rotas.
+ */
+typedef struct HTTP_ROUTE_T_ {
+    const char *path;             // Caminho exato da rota.
+    const char *method;           // Método aceito pela rota.
+    HTTP_ROUTE_HANDLER_T handler; // Função que trata a rota.
+    HTTP_CACHE_POLICY_T cache;    // Política de cache da resposta.
+    u8_t priority;                // Prioridade da conexão enquanto atende a rota.
+    u8_t modes;                   // Modos em que a rota está disponível (`HTTP_MODE_AP`, `HTTP_MODE_STA`).
+} HTTP_ROUTE_T;
+
+/**
+ * @brief Resposta enviada quando não há slot livre para a conexão.
+ */
+static const char HTTP_RESPONSE_BUSY[] = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+
+// ---------------------------------- Funções ---------------------------------
 
-    // Buffer para payload decodificado para evitar estouro de buffer
-    char decoded_payload[1024] = {0}; 
+// --------------------------- Funções para Processar Payload POST ---------------------------
 
-    // Lógica de decodificação URL: Converte "%XX" para ASCII e substitui "+" por espaço
-    char *src = payload;
-    char *dest = decoded_payload;
-    char hex[3] = {0};                  // Armazenamento temporário para conversão hexadecimal
+/**
+ * @brief Converte um dígito hexadecimal em seu valor.
+ *
+ * @return int O valor (0 a 15), ou -1 se o caractere não for um dígito hexadecimal.
+ */
+static int form_hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
-    while (*src && (dest - decoded_payload) < sizeof(decoded_payload) - 1) {
-        if (*src == '%' && isxdigit((unsigned char)src[1]) && isxdigit((unsigned char)src[2])) {
-            hex[0] = src[1];
-            hex[1] = src[2];
-            *dest++ = (char)strtol(hex, NULL, 16);
+/**
+ * @brief Decodifica no próprio buffer um campo do formulário, até o seu delimitador.
+ *
+ * @param field Início do campo (chave ou valor) no corpo da requisição.
+ * @param stop Delimitador que encerra o campo além de '&' ('=' para chaves, '&' para valores).
+ * @param len Ponteiro para armazenar o comprimento do campo decodificado.
+ * @param next Ponteiro para armazenar o início do campo seguinte (válido se o retorno não for '\0').
+ * @return char O delimitador encontrado ('=', '&' ou '\0' no fim do corpo).
+ *
+ * Sequências "%XX" são convertidas no byte correspondente e '+' em espaço. O resultado nunca
+ * é maior que o original, então ele é escrito sobre o próprio campo e terminado com NULL.
+ * Como o corpo é dividido antes da decodificação, um "%26" (&) ou "%3D" (=) decodificado
+ * faz parte do valor e não separa campos.
+ */
+static char form_decode_field(char *field, char stop, int *len, char **next) {
+    char *src = field;
+    char *dest = field;
+    while (*src && *src != '&' && *src != stop) {
+        int high, low;
+        if (*src == '%' && (high = form_hex_value(src[1])) >= 0 && (low = form_hex_value(src[2])) >= 0) {
+            *dest++ = (char)(high << 4 | low);
             src += 3;                   // Pula "%XX"
         } else if (*src == '+') {
             *dest++ = ' ';              // Converte '+' para espaço
@@ -190,47 +486,135 @@ int process_post_payload(const char *request, char *payload) {
             *dest++ = *src++;           // Copia caracteres normais
         }
     }
-    *dest = '\0';                       // Garante que a string esteja terminada com NULL
+    char delimiter = *src;
+    *next = src + 1;
+    *dest = '\0';                       // Pode sobrescrever o delimitador, já guardado
+    *len = dest - field;
+    return delimiter;
+}
 
-    // Buffers temporários para extração de SSID e senha
-    char id[32] = {0};                  // SSID
-    char pw[64] = {0};                  // Senha
+/**
+ * @brief Processa o payload da requisição POST para extrair SSID e senha.
+ *
+ * Esta função recebe um payload codificado em URL de uma requisição HTTP POST,
+ * extrai os parâmetros SSID e senha, e os armazena em variáveis globais para uso posterior.
+ *
+ * @param request A requisição HTTP completa (não usada nesta função, mas mantida para extensibilidade).
+ * @param payload O corpo da requisição POST codificado em URL contendo SSID e senha (alterado pela função).
+ * 
+ * @return 0 se o SSID e a senha forem extraídos com sucesso, -1 caso contrário.
+ *
+ * ### Comportamento:
+ * - Percorre o corpo uma única vez: separa cada par "chave=valor" em '&' e '=' e só então
+ *   decodifica a chave e o valor, no próprio buffer (sem buffer intermediário).
+ * - Aceita os campos em qualquer ordem; campos desconhecidos são ignorados e, se um campo se
+ *   repetir, vale o último.
+ * - Exige SSID de 1 a `WIFI_SSID_MAX_LEN` bytes e senha WPA2 de `WIFI_PASSWORD_MIN_LEN` a
+ *   `WIFI_PASSWORD_MAX_LEN` caracteres, sem bytes nulos; caso contrário as variáveis globais
+ *   não são alteradas.
+ */
+int process_post_payload(const char *request, char *payload) {
+    if (!payload) return -1;            // Proteção contra ponteiro nulo
 
-    // Extrai SSID
-    char *ssid_start = strstr(decoded_payload, "ssid=");
-    if (ssid_start) {
-        ssid_start += strlen("ssid=");
-        char *ssid_end = strchr(ssid_start, '&');
-        size_t ssid_len = ssid_end ? (size_t)(ssid_end - ssid_start) : strlen(ssid_start);
-        if (ssid_len < sizeof(id)) {
-            strncpy(id, ssid_start, ssid_len);
-            id[ssid_len] = '\0';
+    const char *id = NULL, *pw = NULL;
+    int id_len = 0, pw_len = 0;
+
+    char *field = payload;
+    char delimiter;
+    do {
+        // Separa e decodifica a chave e, se houver '=', o valor
+        char *key = field, *value = NULL;
+        int key_len, value_len = 0;
+        delimiter = form_decode_field(key, '=', &key_len, &field);
+        if (delimiter == '=') {
+            value = field;
+            delimiter = form_decode_field(value, '&', &value_len, &field);
         }
-    }
-
-    // Extrai senha
-    char *password_start = strstr(decoded_payload, "password=");
-    if (password_start) {
-        password_start += strlen("password=");
-        char *password_end = strchr(password_start, '&');// Encontra próximo parâmetro
-        size_t password_len = password_end ? (size_t)(password_end - password_start) : strlen(password_start);
-
-        if (password_len < sizeof(pw)) {
-            strncpy(pw, password_start, password_len);
-            pw[password_len] = '\0';                   // Garante que a string esteja terminada com NULL
+        if (!value) continue;
+
+        if (key_len == 4 && memcmp(key, "ssid", 4) == 0) {
+            id = value;
+            id_len = value_len;
+        } else if (key_len == 8 && memcmp(key, "password", 8) == 0) {
+            pw = value;
+            pw_len = value_len;
         }
-    }
+    } while (delimiter);
+
+    // Valida os limites do 802.11 (SSID) e do WPA2 (frase-senha) e rejeita bytes nulos decodificados de "%00"
+    if (!id || id_len < 1 || id_len > WIFI_SSID_MAX_LEN || (int)strlen(id) != id_len) return -1;
+    if (!pw || pw_len < WIFI_PASSWORD_MIN_LEN || pw_len > WIFI_PASSWORD_MAX_LEN || (int)strlen(pw) != pw_len) return -1;
 
     // Logs de depuração para credenciais extraídas
-    DEBUG_printf("SSID Extraído: %s\n", id);
-    DEBUG_printf("SENHA Extraída: %s\n", pw);
+    LOG_INFO_S("SSID Extraído: %s", id);
+    LOG_DEBUG_S("SENHA Extraída: %s", pw);
 
     // Armazena valores extraídos em variáveis globais
-    strncpy(ssid, id, sizeof(ssid) - 1);
-    strncpy(password, pw, sizeof(password) - 1);
+    memcpy(ssid, id, id_len + 1);
+    memcpy(password, pw, pw_len + 1);
+    return 0;
+}
+
+
+// --------------------------- Funções de Alocação dos Slots de Conexão ---------------------------
 
-    // Retorna sucesso apenas se SSID e senha foram extraídos com sucesso
-    return (strlen(id) > 0 && strlen(pw) > 0) ? 0 : -1;
+/**
+ * @brief Monta a lista de slots livres.
+ *
+ * Chamada na abertura do servidor; só monta a lista uma vez por boot para não perder
+ * slots de conexões ainda abertas.
+ */
+static void tcp_connect_pool_init(void) {
+    TCP_CONNECT_POOL_T *pool = &tcp_connect_pool;
+    if (pool->initialized) return;
+
+    pool->free_list = NULL;
+    for (int i = TCP_MAX_CONNECTIONS - 1; i >= 0; i--) {
+        pool->slots[i].next_free = pool->free_list;
+        pool->free_list = &pool->slots[i];
+    }
+    pool->initialized = true;
+}
+
+/**
+ * @brief Retira um slot da lista de livres.
+ *
+ * @return TCP_CONNECT_STATE_T* O slot zerado, ou NULL se todos estiverem em uso.
+ *
+ * ### Comportamento:
+ * - Zera apenas os campos de controle; o buffer de requisição é preenchido conforme os dados chegam.
+ * - Atualiza o número de slots em uso e o pico desde o boot.
+ */
+static TCP_CONNECT_STATE_T *tcp_connect_alloc(void) {
+    TCP_CONNECT_POOL_T *pool = &tcp_connect_pool;
+    TCP_CONNECT_STATE_T *con_state = pool->free_list;
+    if (!con_state) return NULL;
+    pool->free_list = con_state->next_free;
+
+    memset(con_state, 0, offsetof(TCP_CONNECT_STATE_T, headers));
+    con_state->headers[0] = '\0';
+
+    pool->accepted++;
+    if (++pool->in_use > pool->high_water) {
+        pool->high_water = pool->in_use;
+        LOG_INFO("connection slots high-water: %u/%u", pool->high_water, TCP_MAX_CONNECTIONS);
+    }
+    return con_state;
+}
+
+/**
+ * @brief Devolve um slot à lista de livres (descontando o cliente de `/ws`, se for um).
+ */
+static void tcp_connect_free(TCP_CONNECT_STATE_T *con_state) {
+    TCP_CONNECT_POOL_T *pool = &tcp_connect_pool;
+    if (con_state->websocket) {
+        con_state->websocket = false;
+        ws_mirror.clients--;
+    }
+    con_state->pcb = NULL;
+    con_state->next_free = pool->free_list;
+    pool->free_list = con_state;
+    pool->in_use--;
 }
 
 
@@ -252,7 +636,7 @@ int process_post_payload(const char *request, char *payload) {
  * - Limpa os callbacks TCP para o PCB do cliente.
  * - Tenta fechar a conexão TCP.
  * - Se a operação de fechamento falhar, aborta a conexão.
- * - Libera a estrutura de estado da conexão, se existir.
+ * - Devolve o slot da conexão à lista de livres, se existir.
  */
 static err_t tcp_close_client_connection(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *client_pcb, err_t close_err) {
     if (client_pcb) {
@@ -270,20 +654,61 @@ static err_t tcp_close_client_connection(TCP_CONNECT_STATE_T *con_state, struct
         err_t err = tcp_close(client_pcb);
         if (err != ERR_OK) {
             // Se o fechamento falhar, aborta a conexão
-            DEBUG_printf("close failed %d, calling abort\n", err);
+            LOG_WARN("close failed %d, calling abort", err);
             tcp_abort(client_pcb);
             close_err = ERR_ABRT;
         }
 
-        // Libera a estrutura de estado da conexão, se existir
+        // Devolve o slot da conexão, se existir
         if (con_state) {
-            free(con_state);
+            tcp_connect_free(con_state);
         }
     }
     return close_err;
 }
 
 
+// --------------------------- Funções de Prioridade das Conexões ---------------------------
+
+/**
+ * @brief Define a prioridade de uma conexão.
+ *
+ * A prioridade é usada pelo lwIP para escolher qual PCB descartar quando faltam PCBs,
+ * e pelo servidor para escolher qual conexão liberar quando todos os slots estão em uso.
+ */
+static void tcp_server_set_priority(TCP_CONNECT_STATE_T *con_state, u8_t priority) {
+    con_state->priority = priority;
+    tcp_setprio(con_state->pcb, priority);
+}
+
+/**
+ * @brief Libera o slot da conexão de menor prioridade para atender uma nova conexão.
+ *
+ * @return true se um slot foi liberado, false se nenhuma conexão pode ser descartada.
+ *
+ * ### Comportamento:
+ * - Apenas conexões de sondagem e conexões persistentes ociosas (prioridade abaixo de
+ *   `TCP_PRIO_NORMAL`) são descartadas; conexões ainda sem requisição e as que estão
+ *   respondendo ao portal (`/config`, `/post`) são preservadas.
+ * - Entre as candidatas, descarta a que está há mais tempo sem atividade.
+ */
+static bool tcp_connect_evict(void) {
+    TCP_CONNECT_STATE_T *victim = NULL;
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        TCP_CONNECT_STATE_T *con_state = &tcp_connect_pool.slots[i];
+        if (!con_state->pcb || con_state->priority >= TCP_PRIO_NORMAL) continue;
+        if (!victim || (int32_t)(con_state->last_activity_ms - victim->last_activity_ms) < 0) {
+            victim = con_state;
+        }
+    }
+    if (!victim) return false;
+
+    LOG_DEBUG("evicting probe connection");
+    tcp_close_client_connection(victim, victim->pcb, ERR_OK);
+    return true;
+}
+
+
 // --------------------------- Função para Fechar o Servidor TCP ---------------------------
 
 /**
@@ -298,10 +723,18 @@ static err_t tcp_close_client_connection(TCP_CONNECT_STATE_T *con_state, struct
  * - Limpa o argumento TCP para o PCB do servidor.
  * - Fecha a conexão TCP para o PCB do servidor.
  * - Define o ponteiro do PCB do servidor como NULL.
+ * - Fecha as conexões de clientes ainda abertas (persistentes ou assinantes de `/events`).
  *
  * @note O PCB do servidor é definido como NULL após fechar a conexão.
  */
 static void tcp_server_close(TCP_SERVER_T *state) {
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        TCP_CONNECT_STATE_T *con_state = &tcp_connect_pool.slots[i];
+        if (con_state->pcb) {
+            tcp_close_client_connection(con_state, con_state->pcb, ERR_OK);
+        }
+    }
+
     if (state->server_pcb) {
         // Limpa o argumento TCP para o PCB do servidor
         tcp_arg(state->server_pcb, NULL);
@@ -314,8 +747,106 @@ static void tcp_server_close(TCP_SERVER_T *state) {
     }
 }
 
+// --------------------------- Função para Enviar a Resposta ---------------------------
+
+/**
+ * @brief Entrega ao lwIP a parte da resposta que couber no buffer de envio.
+ *
+ * @param con_state Ponteiro para a estrutura de estado da conexão TCP.
+ * @param pcb Ponteiro para o bloco de controle de protocolo TCP.
+ * @return err_t Retorna ERR_OK em caso de sucesso, ou o erro de `tcp_write`.
+ *
+ * ### Comportamento:
+ * - Envia as partes da resposta (cabeçalhos, linha `Connection` e corpo) sem
+ *   `TCP_WRITE_FLAG_COPY`: o lwIP referencia diretamente os dados estáticos.
+ * - Limita cada escrita a `tcp_sndbuf` e para quando a fila de segmentos está cheia.
+ * - O restante é enviado a partir de `tcp_server_sent`, à medida que os dados são confirmados.
+ * - Respostas reescritas a cada amostra (`copy`) são copiadas pelo lwIP, e de uma só vez,
+ *   para que uma nova amostra não altere uma resposta já iniciada.
+ */
+static err_t tcp_server_send(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb) {
+    bool copy = con_state->page->copy;
+    if (copy && tcp_sndbuf(pcb) < con_state->response_len - con_state->queued_len) {
+        return ERR_OK;                  // Aguarda espaço para a resposta inteira
+    }
+
+    while (con_state->queued_len < con_state->response_len) {
+        // Localiza a parte da resposta que contém o próximo byte a enviar
+        const TCP_RESPONSE_PART_T *part = con_state->parts;
+        int offset = con_state->queued_len;
+        while (offset >= part->len) {
+            offset -= part->len;
+            part++;
+        }
+        int remaining = part->len - offset;
+
+        u16_t space = tcp_sndbuf(pcb);
+        if (space == 0 || tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN) break;
+        u16_t chunk = remaining < space ? remaining : space;
+
+        u8_t flags = (con_state->queued_len + chunk < con_state->response_len) ? TCP_WRITE_FLAG_MORE : 0;
+        if (copy) flags |= TCP_WRITE_FLAG_COPY;
+        err_t err = tcp_write(pcb, part->data + offset, chunk, flags);
+        if (err == ERR_MEM) break;      // Tenta novamente quando houver confirmação
+        if (err != ERR_OK) return err;
+        con_state->queued_len += chunk;
+    }
+    return ERR_OK;
+}
+
+
+// --------------------------- Função para Iniciar a Resposta ---------------------------
+
+/**
+ * @brief Começa a entregar ao lwIP as partes da resposta já preenchidas em `con_state->parts`.
+ *
+ * @param page A resposta em envio (define se o conteúdo é copiado pelo lwIP).
+ */
+static err_t tcp_server_start_response(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb, const STATIC_PAGE_T *page) {
+    con_state->page = page;
+    con_state->response_len = con_state->parts[0].len + con_state->parts[1].len + con_state->parts[2].len;
+    con_state->sent_len = 0;
+    con_state->queued_len = 0;
+
+    err_t err = tcp_server_send(con_state, pcb);
+    if (err != ERR_OK) {
+        LOG_WARN("failed to write response %d", err);
+        return tcp_close_client_connection(con_state, pcb, err);
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief Inicia o envio de uma página estática para o cliente.
+ *
+ * @param con_state Ponteiro para a estrutura de estado da conexão TCP.
+ * @param pcb Ponteiro para o bloco de controle de protocolo TCP.
+ * @param page A página a ser enviada.
+ * @return err_t Retorna ERR_OK em caso de sucesso, ou o resultado do fechamento da conexão em caso de falha.
+ *
+ * Os cabeçalhos estáticos são completados com `HTTP_CONNECTION_KEEP_ALIVE` ou
+ * `HTTP_CONNECTION_CLOSE`, conforme `con_state->keep_alive`. Eventos de um fluxo já
+ * iniciado (sem cabeçalhos) são enviados sem essa linha.
+ */
+static err_t tcp_server_respond(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb, const STATIC_PAGE_T *page) {
+    con_state->parts[0] = (TCP_RESPONSE_PART_T){ page->header, page->header_len };
+    if (!page->header_len) {
+        con_state->parts[1] = (TCP_RESPONSE_PART_T){ NULL, 0 };
+    } else if (con_state->keep_alive) {
+        con_state->parts[1] = (TCP_RESPONSE_PART_T){ http_connection_keep_alive, sizeof(http_connection_keep_alive) - 1 };
+    } else {
+        con_state->parts[1] = (TCP_RESPONSE_PART_T){ http_connection_close, sizeof(http_connection_close) - 1 };
+    }
+    con_state->parts[2] = (TCP_RESPONSE_PART_T){ (const char *)page->body, page->body_len };
+    return tcp_server_start_response(con_state, pcb, page);
+}
+
+
 // --------------------------- Função de Callback para Envio do Servidor TCP ---------------------------
 
+static err_t tcp_server_process_request(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb);
+static err_t tcp_server_pipeline(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb);
+
 /**
  * @brief Função de callback para quando os dados são enviados com sucesso pelo servidor TCP.
  *
@@ -325,87 +856,962 @@ static void tcp_server_close(TCP_SERVER_T *state) {
  * @return err_t Retorna ERR_OK em caso de sucesso, ou um código de erro apropriado em caso de falha.
  *
  * Esta função é chamada quando os dados são enviados com sucesso pelo servidor TCP.
- * Ela atualiza o comprimento enviado no estado da conexão e verifica se todos os dados foram enviados.
- * Se todos os dados foram enviados, ela fecha a conexão do cliente.
+ * Ela atualiza o comprimento enviado no estado da conexão, envia a parte restante da
+ * resposta e verifica se todos os dados foram enviados.
  *
  * ### Comportamento:
  * - Atualiza o comprimento enviado no estado da conexão.
- * - Verifica se o comprimento total enviado é maior ou igual à soma dos comprimentos do cabeçalho e do resultado.
- * - Se todos os dados foram enviados, ela fecha a conexão do cliente.
+ * - Desconta primeiro os bytes ainda não confirmados de respostas anteriores do pipeline.
+ * - Entrega ao lwIP a parte da resposta que ainda não coube no buffer de envio e, se ela
+ *   terminou de ser entregue, passa à próxima requisição do pipeline (`tcp_server_pipeline`).
+ * - Quando toda a resposta foi confirmada, fecha a conexão ou, se ela for persistente,
+ *   passa a atender a próxima requisição (que pode já estar no buffer, enviada em pipeline).
+ *   Assinantes de `/events` ficam aguardando a próxima amostra e clientes de `/ws`, o próximo quadro.
  *
  * @note O estado da conexão e o PCB são usados para gerenciar a conexão TCP.
  */
 static err_t tcp_server_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
-    DEBUG_printf("tcp_server_sent %u\n", len);
+    LOG_DEBUG("tcp_server_sent %u", len);
     
-    // Atualiza o comprimento enviado no estado da conexão
-    con_state->sent_len += len;
+    // Atualiza o comprimento enviado no estado da conexão (as respostas anteriores do pipeline são confirmadas antes)
+    int retired = len < con_state->retired_len ? len : con_state->retired_len;
+    con_state->retired_len -= retired;
+    con_state->sent_len += len - retired;
+    con_state->last_activity_ms = to_ms_since_boot(get_absolute_time());
     
     // Verifica se todos os dados foram enviados
-    if (con_state->sent_len >= con_state->header_len + con_state->result_len) {
-        DEBUG_printf("all done\n");
-        // Fecha a conexão do cliente
-        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    if (con_state->sent_len >= con_state->response_len) {
+        // Assinante de `/events` ou cliente de `/ws`: aguarda a próxima amostra ou o próximo quadro
+        if (con_state->subscriber || con_state->websocket) {
+            con_state->page = NULL;
+            return ERR_OK;
+        }
+        if (!con_state->keep_alive) {
+            LOG_DEBUG("all done");
+            // Fecha a conexão do cliente
+            return tcp_close_client_connection(con_state, pcb, ERR_OK);
+        }
+
+        // Conexão persistente ociosa: pode ser descartada se faltarem slots
+        con_state->page = NULL;
+        tcp_server_set_priority(con_state, TCP_PRIO_MIN);
+        return tcp_server_process_request(con_state, pcb);
     }
-    return ERR_OK;
+
+    // Envia a parte restante da resposta
+    err_t err = tcp_server_send(con_state, pcb);
+    if (err != ERR_OK) {
+        return tcp_close_client_connection(con_state, pcb, err);
+    }
+    return tcp_server_pipeline(con_state, pcb);
+}
+
+
+// --------------------------- Função para Preparar as Páginas Estáticas ---------------------------
+
+/**
+ * @brief Formata uma única vez os cabeçalhos das páginas do portal.
+ *
+ * Os corpos são constantes, então o `Content-Length` é conhecido na abertura do servidor
+ * e nenhuma formatação é necessária por requisição. Cada página tem três respostas
+ * prontas: sem compressão, com gzip e 304 (não modificada).
+ */
+static void tcp_server_pages_init(void) {
+    WEB_PAGE_T *pages[] = { &config_page, &success_page, &failure_page, &remote_page };
+    for (size_t i = 0; i < sizeof(pages) / sizeof(pages[0]); i++) {
+        WEB_PAGE_T *page = pages[i];
+        const WEB_ASSET_T *asset = page->asset;
+
+        page->plain.body = asset->data;
+        page->plain.body_len = asset->len;
+        page->plain.header_len = snprintf(page->plain.header, sizeof(page->plain.header), HTTP_RESPONSE_HEADERS,
+                                          asset->content_type, (unsigned long)asset->len, "", asset->etag);
+
+        page->gzip.body = asset->gzip_data;
+        page->gzip.body_len = asset->gzip_len;
+        page->gzip.header_len = snprintf(page->gzip.header, sizeof(page->gzip.header), HTTP_RESPONSE_HEADERS,
+                                         asset->content_type, (unsigned long)asset->gzip_len,
+                                         "Content-Encoding: gzip\r\n", asset->etag);
+
+        page->not_modified.header_len = snprintf(page->not_modified.header, sizeof(page->not_modified.header),
+                                                 HTTP_RESPONSE_NOT_MODIFIED, asset->etag);
+    }
+}
+
+
+// --------------------------- Funções para Consultar os Cabeçalhos da Requisição ---------------------------
+
+/**
+ * @brief Procura um cabeçalho da requisição (sem diferenciar maiúsculas e minúsculas).
+ *
+ * @param headers Início da requisição.
+ * @param headers_len Comprimento da parte de cabeçalhos da requisição.
+ * @param name Nome do cabeçalho, sem o ':'.
+ * @param value_len Ponteiro para armazenar o comprimento do valor encontrado.
+ * @return const char* Início do valor (sem espaços iniciais), ou NULL se o cabeçalho não existir.
+ *
+ * @note A busca é limitada a `headers_len` e não depende de terminador NULL, então a linha
+ *       da requisição pode ter sido dividida em partes antes da consulta.
+ */
+static const char *tcp_server_find_header(const char *headers, int headers_len, const char *name, int *value_len) {
+    int name_len = strlen(name);
+    const char *end = headers + headers_len;
+    const char *line = headers;
+
+    while (line < end) {
+        const char *eol = line;
+        while (eol + 1 < end && !(eol[0] == '\r' && eol[1] == '\n')) eol++;
+        if (eol + 1 >= end) eol = end;
+
+        if (eol - line > name_len && line[name_len] == ':' && strncasecmp(line, name, name_len) == 0) {
+            const char *value = line + name_len + 1;
+            while (value < eol && *value == ' ') value++;
+            *value_len = eol - value;
+            return value;
+        }
+        line = eol + 2;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Verifica se o valor de um cabeçalho contém um determinado texto (sem diferenciar maiúsculas e minúsculas).
+ */
+static bool tcp_server_value_contains(const char *value, int value_len, const char *token) {
+    int token_len = strlen(token);
+    if (!value) return false;
+    for (int i = 0; i + token_len <= value_len; i++) {
+        if (strncasecmp(value + i, token, token_len) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Escolhe a resposta de uma página de acordo com os cabeçalhos da requisição.
+ *
+ * @param page A página solicitada.
+ * @param request A requisição recebida.
+ * @param cache A política de cache da rota.
+ * @return const STATIC_PAGE_T* 304 se a rota permitir e a ETag coincidir, gzip se aceito,
+ *         ou a página sem compressão.
+ */
+static const STATIC_PAGE_T *tcp_server_select_page(const WEB_PAGE_T *page, const HTTP_REQUEST_T *request,
+                                                   HTTP_CACHE_POLICY_T cache) {
+    int len;
+    const char *value = tcp_server_find_header(request->headers, request->headers_len, "If-None-Match", &len);
+    if (cache == HTTP_CACHE_REVALIDATE && tcp_server_value_contains(value, len, page->asset->etag)) {
+        return &page->not_modified;
+    }
+
+    value = tcp_server_find_header(request->headers, request->headers_len, "Accept-Encoding", &len);
+    if (tcp_server_value_contains(value, len, "gzip")) return &page->gzip;
+    return &page->plain;
 }
 
 
-// --------------------------- Função de Conteúdo do Servidor de Teste ---------------------------
+// --------------------------- Função para Acumular a Requisição HTTP ---------------------------
 
 /**
- * @brief Gera o conteúdo do servidor com base na requisição e nos parâmetros.
+ * @brief Verifica se a requisição no início do buffer já está completa.
  *
- * @param request A string da requisição HTTP.
- * @param params A string de parâmetros da requisição HTTP.
- * @param result O buffer para armazenar o resultado gerado.
- * @param max_result_len O comprimento máximo do buffer de resultado.
- * @return int O comprimento do resultado gerado.
+ * @param con_state Ponteiro para a estrutura de estado da conexão TCP.
+ * @return int 1 se a requisição está completa, 0 se ainda faltam dados, -1 se ela não cabe no buffer.
  *
- * Esta função gera o conteúdo do servidor com base na requisição e nos parâmetros fornecidos.
- * Ela verifica o estado do LED e o atualiza se necessário, depois gera o conteúdo HTML apropriado
- * para ser enviado de volta ao cliente.
+ * Navegadores de iOS e de notebooks costumam enviar os cabeçalhos e o corpo do POST em
+ * segmentos TCP separados, e o próprio marcador "\r\n\r\n" pode ser dividido entre eles.
+ * Por isso a requisição é acumulada em `headers` ao longo de várias chamadas de `tcp_recv`.
+ *
+ * ### Comportamento:
+ * - Procura o fim dos cabeçalhos a partir dos 3 últimos bytes já procurados, para encontrar
+ *   o marcador mesmo quando ele chega dividido.
+ * - Ao encontrar o fim dos cabeçalhos, lê o `Content-Length` (sem diferenciar maiúsculas).
+ * - Considera a requisição completa quando todo o corpo declarado foi recebido; bytes
+ *   além do corpo pertencem à próxima requisição (pipeline) e permanecem no buffer.
+ */
+static int tcp_server_assemble_request(TCP_CONNECT_STATE_T *con_state) {
+    if (!con_state->body_offset) {
+        int scan_from = con_state->scanned_len > 3 ? con_state->scanned_len - 3 : 0;
+        con_state->scanned_len = con_state->request_len;
+
+        char *end = strstr(con_state->headers + scan_from, "\r\n\r\n");
+        if (!end) {
+            return con_state->request_len < (int)sizeof(con_state->headers) - 1 ? 0 : -1;
+        }
+        con_state->body_offset = end + 4 - con_state->headers;
+
+        // Procura o Content-Length nas linhas de cabeçalho
+        int value_len;
+        const char *value = tcp_server_find_header(con_state->headers, end - con_state->headers, "Content-Length", &value_len);
+        if (value) con_state->content_length = atoi(value);
+
+        if (con_state->content_length < 0) con_state->content_length = 0;
+        if (con_state->body_offset + con_state->content_length > (int)sizeof(con_state->headers) - 1) return -1;
+    }
+
+    return con_state->request_len >= con_state->body_offset + con_state->content_length;
+}
+
+/**
+ * @brief Decide se a conexão continua aberta após a resposta.
+ *
+ * @return true para HTTP/1.1 sem `Connection: close`, ou HTTP/1.0 com `Connection: keep-alive`,
+ *         enquanto a conexão não atingir `TCP_MAX_REQUESTS` requisições.
+ */
+static bool tcp_server_keep_alive(const TCP_CONNECT_STATE_T *con_state, const HTTP_REQUEST_T *request) {
+    if (con_state->requests_served >= TCP_MAX_REQUESTS) return false;
+
+    int len;
+    const char *value = tcp_server_find_header(request->headers, request->headers_len, "Connection", &len);
+    if (tcp_server_value_contains(value, len, "close")) return false;
+    if (strncmp(request->version, "HTTP/1.1", 8) == 0) return true;
+    return tcp_server_value_contains(value, len, "keep-alive");
+}
+
+
+// --------------------------- Sondagens de Portal Cativo ---------------------------
+
+/**
+ * @brief Estrutura para armazenar uma sondagem de portal cativo conhecida.
+ */
+typedef struct CAPTIVE_PROBE_T_ {
+    const char *request_line;     // Início da linha de requisição ("GET <caminho> ").
+    u8_t len;                     // Comprimento de `request_line`.
+    const STATIC_PAGE_T *response; // Resposta constante enviada ao sistema.
+} CAPTIVE_PROBE_T;
+
+#define CAPTIVE_PROBE(path, response) { HTTP_GET " " path " ", sizeof(HTTP_GET " " path " ") - 1, response }
+
+/**
+ * @brief Caminhos consultados pelos sistemas logo após a conexão ao AP.
+ *
+ * Android e Windows abrem o portal com um redirecionamento; Apple precisa de uma página sem "Success".
+ */
+static const CAPTIVE_PROBE_T captive_probes[] = {
+    CAPTIVE_PROBE("/generate_204", &redirect_page),                 // Android / Chrome OS
+    CAPTIVE_PROBE("/gen_204", &redirect_page),                      // Android
+    CAPTIVE_PROBE("/hotspot-detect.html", &apple_probe_page),       // iOS / macOS
+    CAPTIVE_PROBE("/library/test/success.html", &apple_probe_page), // iOS (versões antigas)
+    CAPTIVE_PROBE("/connecttest.txt", &redirect_page),              // Windows 10/11
+    CAPTIVE_PROBE("/ncsi.txt", &redirect_page),                     // Windows 7/8
+    CAPTIVE_PROBE("/redirect", &redirect_page),                     // Windows
+    CAPTIVE_PROBE("/canonical.html", &redirect_page),               // Firefox
+    CAPTIVE_PROBE("/success.txt", &redirect_page),                  // Firefox
+};
+
+/**
+ * @brief Reconhece uma sondagem de portal cativo pelos primeiros bytes da requisição.
+ *
+ * @param request Início da requisição.
+ * @param len Comprimento da linha de requisição.
+ * @return const STATIC_PAGE_T* A resposta da sondagem, ou NULL se a requisição não for uma sondagem.
+ *
+ * @note A comparação é feita logo que a linha de requisição chega, antes de receber os
+ *       cabeçalhos, separar a linha e buscar a rota, então as sondagens não passam pelo
+ *       caminho normal.
+ */
+static const STATIC_PAGE_T *tcp_server_match_probe(const char *request, int len) {
+    for (size_t i = 0; i < sizeof(captive_probes) / sizeof(captive_probes[0]); i++) {
+        const CAPTIVE_PROBE_T *probe = &captive_probes[i];
+        if (len >= probe->len && memcmp(request, probe->request_line, probe->len) == 0) {
+            return probe->response;
+        }
+    }
+    return NULL;
+}
+
+
+// --------------------------- Funções de Tratamento das Rotas ---------------------------
+
+/**
+ * @brief Trata `GET /config`: aplica o parâmetro do LED e envia a página de configuração.
  *
  * ### Comportamento:
- * - Verifica se a requisição corresponde ao caminho CONFIG.
  * - Recupera o estado atual do LED.
  * - Se os parâmetros forem fornecidos, atualiza o estado do LED com base nos parâmetros.
- * - Gera o conteúdo HTML com base no estado do LED.
+ * - Envia a página de configuração (gzip ou 304, conforme os cabeçalhos).
+ */
+static err_t tcp_route_config(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb,
+                              HTTP_REQUEST_T *request, const HTTP_ROUTE_T *route) {
+    // Obtém o estado do LED
+    bool value;
+    cyw43_gpio_get(&cyw43_state, LED_GPIO, &value);
+    int led_state = value;
+
+    // Verifica se o usuário mudou o estado
+    if (request->params) {
+        int led_param = sscanf(request->params, LED_PARAM, &led_state);
+        if (led_param == 1) {
+            // Liga ou desliga o LED
+            cyw43_gpio_set(&cyw43_state, 0, led_state != 0);
+        }
+    }
+    return tcp_server_respond(con_state, pcb, tcp_server_select_page(&config_page, request, route->cache));
+}
+
+/**
+ * @brief Trata `POST /post`: extrai o SSID e a senha do formulário.
  *
- * @note O resultado gerado é armazenado no parâmetro `result`.
+ * ### Comportamento:
+ * - Processa o corpo do formulário, já completo no buffer da conexão.
+ * - Em caso de sucesso, marca `id_pw_collected` e envia a página de sucesso.
+ * - Caso contrário, envia a página de falha.
  */
-static int test_server_content(const char *request, const char *params, char *result, size_t max_result_len) {
-    int len = 0;
-    if (strncmp(request, CONFIG, sizeof(CONFIG) - 1) == 0) {
-        // Obtém o estado do LED
-        bool value;
-        cyw43_gpio_get(&cyw43_state, LED_GPIO, &value);
-        int led_state = value;
-
-        // Verifica se o usuário mudou o estado
-        if (params) {
-            int led_param = sscanf(params, LED_PARAM, &led_state);
-            if (led_param == 1) {
-                if (led_state) {
-                    // Liga o LED
-                    cyw43_gpio_set(&cyw43_state, 0, true);
-                } else {
-                    // Desliga o LED
-                    cyw43_gpio_set(&cyw43_state, 0, false);
-                }
+static err_t tcp_route_post(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb,
+                            HTTP_REQUEST_T *request, const HTTP_ROUTE_T *route) {
+    if (process_post_payload(request->path, request->body) >= 0) {
+        // Resposta de sucesso com página (o servidor será encerrado em seguida)
+        id_pw_collected = 1;
+        con_state->keep_alive = false;
+        return tcp_server_respond(con_state, pcb, tcp_server_select_page(&success_page, request, route->cache));
+    }
+    // Resposta de falha com página
+    return tcp_server_respond(con_state, pcb, tcp_server_select_page(&failure_page, request, route->cache));
+}
+
+
+/**
+ * @brief Trata `GET /api/telemetry`: envia a última amostra em JSON.
+ *
+ * Responde 204 enquanto nenhuma amostra foi publicada.
+ */
+static err_t tcp_route_telemetry(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb,
+                                 HTTP_REQUEST_T *request, const HTTP_ROUTE_T *route) {
+    if (!live_feed.seq) {
+        return tcp_server_respond(con_state, pcb, &no_content_page);
+    }
+    return tcp_server_respond(con_state, pcb, &live_feed.json);
+}
+
+/**
+ * @brief Trata `GET /remote`: envia a página de controle remoto do menu.
+ */
+static err_t tcp_route_remote(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb,
+                              HTTP_REQUEST_T *request, const HTTP_ROUTE_T *route) {
+    return tcp_server_respond(con_state, pcb, tcp_server_select_page(&remote_page, request, route->cache));
+}
+
+/**
+ * @brief Conta as conexões de longa duração (assinantes de `/events` e clientes de `/ws`).
+ *
+ * As duas rotas dividem o limite `TCP_MAX_SUBSCRIBERS`, para que sempre sobrem slots
+ * para o portal e para as requisições comuns.
+ */
+static int tcp_server_count_subscribers(void) {
+    int subscribers = 0;
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        TCP_CONNECT_STATE_T *con_state = &tcp_connect_pool.slots[i];
+        if (con_state->pcb && (con_state->subscriber || con_state->websocket)) subscribers++;
+    }
+    return subscribers;
+}
+
+/**
+ * @brief Trata `GET /events`: inscreve a conexão no fluxo de amostras (Server-Sent Events).
+ *
+ * ### Comportamento:
+ * - Responde 503 se já houver `TCP_MAX_SUBSCRIBERS` assinantes (somados aos clientes de `/ws`).
+ * - Envia os cabeçalhos do fluxo e marca a conexão como assinante; cada nova amostra é
+ *   enviada por `tcp_server_publish`.
+ * - O fluxo não tem `Content-Length` e termina com o fechamento da conexão; requisições
+ *   seguintes na mesma conexão são ignoradas.
+ */
+static err_t tcp_route_events(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb,
+                              HTTP_REQUEST_T *request, const HTTP_ROUTE_T *route) {
+    int subscribers = tcp_server_count_subscribers();
+    if (subscribers >= TCP_MAX_SUBSCRIBERS) {
+        con_state->keep_alive = false;
+        return tcp_server_respond(con_state, pcb, &unavailable_page);
+    }
+
+    LOG_INFO("events subscriber %d", subscribers + 1);
+    con_state->keep_alive = false;      // O fluxo termina com o fechamento da conexão
+    con_state->subscriber = true;
+    return tcp_server_respond(con_state, pcb, &event_stream_page);
+}
+
+
+/**
+ * @brief Trata `GET /ws`: aceita o upgrade para WebSocket (RFC 6455).
+ *
+ * ### Comportamento:
+ * - Responde 400 se faltar `Upgrade: websocket` ou a chave `Sec-WebSocket-Key`.
+ * - Responde 503 se o limite de conexões de longa duração já foi atingido.
+ * - Calcula o aceite (SHA-1 da chave com `WS_GUID`, em base64) e envia a resposta 101 em
+ *   três partes: cabeçalhos constantes, aceite da conexão e linha em branco final.
+ * - A partir daí os dados recebidos são quadros (`tcp_server_ws_receive`) e o primeiro
+ *   quadro do espelho enviado à conexão é completo.
+ */
+static err_t tcp_route_ws(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb,
+                          HTTP_REQUEST_T *request, const HTTP_ROUTE_T *route) {
+    int upgrade_len, key_len;
+    const char *upgrade = tcp_server_find_header(request->headers, request->headers_len, "Upgrade", &upgrade_len);
+    const char *key = tcp_server_find_header(request->headers, request->headers_len, "Sec-WebSocket-Key", &key_len);
+    con_state->keep_alive = false;
+    if (!tcp_server_value_contains(upgrade, upgrade_len, "websocket") || !key) {
+        return tcp_server_respond(con_state, pcb, &bad_request_page);
+    }
+    while (key_len > 0 && key[key_len - 1] == ' ') key_len--;
+    if (key_len != WS_KEY_SIZE) {
+        return tcp_server_respond(con_state, pcb, &bad_request_page);
+    }
+    if (tcp_server_count_subscribers() >= TCP_MAX_SUBSCRIBERS) {
+        return tcp_server_respond(con_state, pcb, &unavailable_page);
+    }
+
+    // Sec-WebSocket-Accept = base64(SHA-1(chave + GUID))
+    SHA1_CTX_T sha;
+    uint8_t digest[SHA1_DIGEST_SIZE];
+    char accept[WS_ACCEPT_SIZE + 1];
+    sha1_init(&sha);
+    sha1_update(&sha, (const uint8_t *)key, key_len);
+    sha1_update(&sha, (const uint8_t *)WS_GUID, sizeof(WS_GUID) - 1);
+    sha1_final(&sha, digest);
+    base64_encode(digest, sizeof(digest), accept);
+    memcpy(con_state->ws_accept, accept, WS_ACCEPT_SIZE);
+
+    LOG_INFO("websocket client %d", tcp_server_count_subscribers() + 1);
+    con_state->websocket = true;
+    con_state->ws_keyframe = true;
+    ws_mirror.clients++;
+    con_state->parts[0] = (TCP_RESPONSE_PART_T){ ws_upgrade_headers, sizeof(ws_upgrade_headers) - 1 };
+    con_state->parts[1] = (TCP_RESPONSE_PART_T){ con_state->ws_accept, WS_ACCEPT_SIZE };
+    con_state->parts[2] = (TCP_RESPONSE_PART_T){ ws_upgrade_end, sizeof(ws_upgrade_end) - 1 };
+    return tcp_server_start_response(con_state, pcb, &ws_upgrade_page);
+}
+
+
+// --------------------------- Funções do WebSocket ---------------------------
+
+/**
+ * @brief Enfileira um comando remoto para o laço principal.
+ *
+ * @note Chamada pelo lwIP; com a fila cheia o comando é descartado.
+ */
+static void ws_input_push(uint8_t event) {
+    WS_INPUT_QUEUE_T *queue = &ws_input;
+    uint8_t head = queue->head;
+    if ((uint8_t)(head - queue->tail) >= WS_INPUT_QUEUE_SIZE) {
+        queue->dropped++;
+        return;
+    }
+    queue->events[head % WS_INPUT_QUEUE_SIZE] = event;
+    queue->head = head + 1;             // Publica o comando só depois de escrevê-lo
+}
+
+/**
+ * @brief Retira o próximo comando remoto da fila.
+ *
+ * @param event Ponteiro para armazenar o comando (`WS_INPUT_T`).
+ * @return true se havia um comando, false se a fila estava vazia.
+ *
+ * @note Chamada pelo laço principal (menu).
+ */
+bool ws_input_pop(uint8_t *event) {
+    WS_INPUT_QUEUE_T *queue = &ws_input;
+    uint8_t tail = queue->tail;
+    if (tail == queue->head) return false;
+    *event = queue->events[tail % WS_INPUT_QUEUE_SIZE];
+    queue->tail = tail + 1;
+    return true;
+}
+
+/**
+ * @brief Interpreta os quadros WebSocket acumulados no buffer da conexão.
+ *
+ * @param con_state Ponteiro para a estrutura de estado da conexão TCP.
+ * @param pcb Ponteiro para o bloco de controle de protocolo TCP.
+ * @return err_t Retorna ERR_OK em caso de sucesso, ou o resultado do fechamento da conexão.
+ *
+ * ### Comportamento:
+ * - Aceita apenas quadros completos (FIN), mascarados e com até 125 bytes, que é tudo o que a
+ *   página `/remote` envia; qualquer outro quadro fecha a conexão.
+ * - Quadros de texto "up", "down" e "enter" são enfileirados para o laço principal.
+ * - Um quadro de fechamento é respondido com outro quadro de fechamento, e a conexão é encerrada.
+ * - Quadros incompletos permanecem no buffer até o restante chegar.
+ */
+static err_t tcp_server_ws_receive(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb) {
+    uint8_t *buf = (uint8_t *)con_state->headers;
+    int used = 0;
+
+    while (con_state->request_len - used >= 2) {
+        uint8_t *frame = buf + used;
+        int opcode = frame[0] & 0x0F;
+        int len = frame[1] & 0x7F;
+        if (!(frame[0] & 0x80) || !(frame[1] & 0x80) || len > 125) {
+            LOG_WARN("unsupported websocket frame");
+            return tcp_close_client_connection(con_state, pcb, ERR_OK);
+        }
+        if (con_state->request_len - used < 6 + len) break;   // Quadro incompleto
+
+        // Remove a máscara do payload
+        const uint8_t *mask = frame + 2;
+        char *payload = (char *)frame + 6;
+        for (int i = 0; i < len; i++) payload[i] ^= mask[i & 3];
+        used += 6 + len;
+
+        if (opcode == WS_OPCODE_CLOSE) {
+            LOG_DEBUG("websocket closed by client");
+            if (con_state->page) {
+                return tcp_close_client_connection(con_state, pcb, ERR_OK);
             }
+            con_state->websocket = false;   // Fecha a conexão quando o quadro for confirmado
+            ws_mirror.clients--;
+            con_state->keep_alive = false;
+            con_state->request_len = 0;
+            return tcp_server_respond(con_state, pcb, &ws_close_page);
         }
-        // Gera o resultado
-        if (led_state) {
-            len = snprintf(result, max_result_len, WIFI_CONFIG_BODY, "ON", 0, "OFF");
-        } else {
-            len = snprintf(result, max_result_len, WIFI_CONFIG_BODY, "OFF", 1, "ON");
+        if (opcode == WS_OPCODE_TEXT) {
+            if (len == 2 && memcmp(payload, "up", 2) == 0) ws_input_push(WS_INPUT_UP);
+            else if (len == 4 && memcmp(payload, "down", 4) == 0) ws_input_push(WS_INPUT_DOWN);
+            else if (len == 5 && memcmp(payload, "enter", 5) == 0) ws_input_push(WS_INPUT_ENTER);
+        }
+        // Pongs e demais quadros de controle são ignorados
+    }
+
+    con_state->request_len -= used;
+    memmove(buf, buf + used, con_state->request_len);
+    return ERR_OK;
+}
+
+/**
+ * @brief Completa uma mensagem do espelho com o cabeçalho do quadro WebSocket binário.
+ *
+ * @param page A resposta que aponta para a mensagem.
+ * @param msg O buffer da mensagem; o payload começa em `msg + WS_HEADER_MAX`.
+ * @param payload_len Comprimento do payload.
+ *
+ * O cabeçalho (2 ou 4 bytes) é escrito logo antes do payload, que então não precisa ser movido.
+ */
+static void ws_mirror_finish(STATIC_PAGE_T *page, uint8_t *msg, int payload_len) {
+    uint8_t *payload = msg + WS_HEADER_MAX;
+    uint8_t *header;
+    if (payload_len < 126) {
+        header = payload - 2;
+        header[1] = payload_len;
+    } else {
+        header = payload - 4;
+        header[1] = 126;
+        header[2] = payload_len >> 8;
+        header[3] = payload_len & 0xFF;
+    }
+    header[0] = 0x80 | WS_OPCODE_BINARY;
+
+    page->body = header;
+    page->body_len = payload + payload_len - header;
+    page->header_len = 0;
+    page->copy = true;
+}
+
+/**
+ * @brief Monta os trechos alterados entre o último quadro enviado e o atual.
+ *
+ * @param frame O framebuffer atual.
+ * @param out Buffer de saída.
+ * @param max Tamanho do buffer de saída.
+ * @return int Comprimento dos trechos, ou -1 se eles não couberem (o quadro completo é menor).
+ *
+ * Cada trecho é `[offset alto][offset baixo][tamanho][bytes]`. Trechos separados por até
+ * `WS_DELTA_MAX_GAP` bytes iguais são unidos, pois cada trecho custa 3 bytes de cabeçalho.
+ */
+static int ws_mirror_delta(const uint8_t *frame, uint8_t *out, int max) {
+    const uint8_t *last = ws_mirror.last;
+    int len = 0;
+    int i = 0;
+
+    while (i < WS_FRAME_SIZE) {
+        if (last[i] == frame[i]) {
+            i++;
+            continue;
+        }
+        int start = i, end = i;
+        for (int j = i + 1; j < WS_FRAME_SIZE && j - start < 255; j++) {
+            if (last[j] != frame[j]) end = j;
+            else if (j - end > WS_DELTA_MAX_GAP) break;
         }
+        int run = end - start + 1;
+        if (len + 3 + run > max) return -1;
+
+        out[len++] = start >> 8;
+        out[len++] = start & 0xFF;
+        out[len++] = run;
+        memcpy(out + len, frame + start, run);
+        len += run;
+        i = end + 1;
     }
     return len;
 }
 
+/**
+ * @brief Espelha o display para os clientes de `/ws`.
+ *
+ * @param frame O framebuffer do SSD1306 (`WS_FRAME_SIZE` bytes, no formato do controlador).
+ *
+ * ### Comportamento:
+ * - Não faz nada sem clientes (contador `clients`, sem travar o lwIP), antes de
+ *   `WS_FRAME_INTERVAL_MS` desde o último quadro ou se o display não mudou (a menos que
+ *   algum cliente precise do quadro completo).
+ * - Monta uma única vez o quadro completo e/ou os trechos alterados; os trechos são usados
+ *   apenas quando menores que o quadro completo.
+ * - Clientes novos ou que perderam um quadro recebem o quadro completo; os demais, os trechos.
+ * - Clientes ainda enviando o quadro anterior perdem este (contador `skipped`) e recebem o
+ *   próximo completo.
+ *
+ * @note Chamada do laço principal: as chamadas ao lwIP são protegidas com `cyw43_arch_lwip_begin`.
+ */
+void tcp_server_mirror_display(const uint8_t *frame) {
+    WS_MIRROR_T *mirror = &ws_mirror;
+    if (!mirror->clients) return;       // Sem clientes de `/ws`: nem trava o lwIP
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (mirror->valid && now - mirror->last_ms < WS_FRAME_INTERVAL_MS) return;
+
+    cyw43_arch_lwip_begin();
+
+    int clients = 0;
+    bool need_key = false;
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        TCP_CONNECT_STATE_T *con_state = &tcp_connect_pool.slots[i];
+        if (!con_state->pcb || !con_state->websocket) continue;
+        // Quadro anterior ainda não entregue ao lwIP (copiado de uma só vez): é descartado,
+        // pois o buffer será reescrito, e o cliente passa a precisar do quadro completo
+        if ((con_state->page == &mirror->key || con_state->page == &mirror->delta) &&
+            con_state->queued_len == 0) {
+            con_state->page = NULL;
+            con_state->ws_keyframe = true;
+        }
+        clients++;
+        need_key |= con_state->ws_keyframe;
+    }
+
+    bool changed = !mirror->valid || memcmp(frame, mirror->last, WS_FRAME_SIZE) != 0;
+    if (!clients || (!changed && !need_key)) {
+        cyw43_arch_lwip_end();
+        return;
+    }
+    mirror->last_ms = now;
+
+    // Trechos alterados, se o quadro anterior foi enviado e eles forem menores que o quadro completo
+    bool delta = false;
+    if (changed && mirror->valid) {
+        uint8_t *payload = mirror->delta_msg + WS_HEADER_MAX;
+        payload[0] = WS_MSG_DELTA;
+        int len = ws_mirror_delta(frame, payload + 1, WS_FRAME_SIZE - 1);
+        if (len >= 0) {
+            ws_mirror_finish(&mirror->delta, mirror->delta_msg, 1 + len);
+            delta = true;
+        }
+    }
+    if (need_key || !delta) {
+        uint8_t *payload = mirror->key_msg + WS_HEADER_MAX;
+        payload[0] = WS_MSG_KEYFRAME;
+        memcpy(payload + 1, frame, WS_FRAME_SIZE);
+        ws_mirror_finish(&mirror->key, mirror->key_msg, 1 + WS_FRAME_SIZE);
+    }
+    memcpy(mirror->last, frame, WS_FRAME_SIZE);
+    mirror->valid = true;
+
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        TCP_CONNECT_STATE_T *con_state = &tcp_connect_pool.slots[i];
+        struct tcp_pcb *pcb = con_state->pcb;
+        if (!pcb || !con_state->websocket) continue;
+        if (!changed && !con_state->ws_keyframe) continue;
+        if (con_state->page) {
+            con_state->ws_keyframe = true;
+            mirror->skipped++;
+            continue;
+        }
+
+        const STATIC_PAGE_T *page = (con_state->ws_keyframe || !delta) ? &mirror->key : &mirror->delta;
+        if (page == &mirror->key) mirror->keyframes++;
+        else mirror->deltas++;
+        con_state->ws_keyframe = false;
+        if (tcp_server_respond(con_state, pcb, page) == ERR_OK && con_state->pcb == pcb) {
+            tcp_output(pcb);
+        }
+    }
+    cyw43_arch_lwip_end();
+}
+
+
+// --------------------------- Função para Publicar uma Amostra ---------------------------
+
+/**
+ * @brief Publica uma nova amostra para os clientes da rede local.
+ *
+ * @param json A amostra já serializada em JSON.
+ * @param len Comprimento do JSON.
+ *
+ * ### Comportamento:
+ * - Guarda o JSON e formata, uma única vez, os cabeçalhos de `/api/telemetry` e o evento SSE.
+ * - Envia o mesmo evento a todos os assinantes de `/events` que já terminaram de enviar o
+ *   anterior; assinantes ainda ocupados perdem esta amostra (contador `skipped`).
+ * - Fecha as conexões que ainda não entregaram ao lwIP toda a resposta da amostra anterior
+ *   (raro: as respostas são copiadas de uma só vez), pois o buffer é reescrito.
+ *
+ * @note Chamada do laço principal: as chamadas ao lwIP são protegidas com `cyw43_arch_lwip_begin`.
+ */
+void tcp_server_publish(const char *json, int len) {
+    LIVE_FEED_T *feed = &live_feed;
+    if (len <= 0 || len >= LIVE_JSON_SIZE) return;
+
+    cyw43_arch_lwip_begin();
+
+    // Respostas da amostra anterior ainda não entregues por inteiro ao lwIP seriam corrompidas
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        TCP_CONNECT_STATE_T *con_state = &tcp_connect_pool.slots[i];
+        if (con_state->pcb && (con_state->page == &feed->json || con_state->page == &feed->event) &&
+            con_state->queued_len < con_state->response_len) {
+            tcp_close_client_connection(con_state, con_state->pcb, ERR_OK);
+        }
+    }
+
+    feed->seq++;
+    memcpy(feed->json_body, json, len);
+    feed->json.body = feed->json_body;
+    feed->json.body_len = len;
+    feed->json.header_len = snprintf(feed->json.header, sizeof(feed->json.header), HTTP_RESPONSE_JSON_HEADERS, len);
+    feed->json.copy = true;
+
+    feed->event.body = feed->event_body;
+    feed->event.body_len = snprintf(feed->event_body, sizeof(feed->event_body), "id: %lu\ndata: %.*s\n\n",
+                                    (unsigned long)feed->seq, len, json);
+    feed->event.header_len = 0;
+    feed->event.copy = true;
+
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        TCP_CONNECT_STATE_T *con_state = &tcp_connect_pool.slots[i];
+        struct tcp_pcb *pcb = con_state->pcb;
+        if (!pcb || !con_state->subscriber) continue;
+        if (con_state->page) {
+            feed->skipped++;
+            continue;
+        }
+        if (tcp_server_respond(con_state, pcb, &feed->event) == ERR_OK && con_state->pcb == pcb) {
+            tcp_output(pcb);
+            feed->delivered++;
+        }
+    }
+    cyw43_arch_lwip_end();
+}
+
+
+// --------------------------- Tabela de Rotas ---------------------------
+
+/**
+ * @brief Tabela de rotas do servidor HTTP do modo AP.
+ *
+ * @note A tabela deve permanecer ordenada por caminho e, em seguida, por método
+ *       (ordem de `strcmp`), pois a busca é binária. A ordem é conferida na abertura
+ *       do servidor por `tcp_server_routes_check`.
+ */
+static const HTTP_ROUTE_T http_routes[] = {
+    { API_TELEMETRY, HTTP_GET,  tcp_route_telemetry, HTTP_CACHE_NONE,       TCP_PRIO_NORMAL, HTTP_MODE_AP | HTTP_MODE_STA },
+    { CONFIG,        HTTP_GET,  tcp_route_config,    HTTP_CACHE_REVALIDATE, TCP_PRIO_MAX,    HTTP_MODE_AP },
+    { EVENTS_PATH,   HTTP_GET,  tcp_route_events,    HTTP_CACHE_NONE,       TCP_PRIO_NORMAL, HTTP_MODE_AP | HTTP_MODE_STA },
+    { POST_PATH,     HTTP_POST, tcp_route_post,      HTTP_CACHE_NONE,       TCP_PRIO_MAX,    HTTP_MODE_AP },
+    { REMOTE_PATH,   HTTP_GET,  tcp_route_remote,    HTTP_CACHE_REVALIDATE, TCP_PRIO_NORMAL, HTTP_MODE_AP | HTTP_MODE_STA },
+    { WS_PATH,       HTTP_GET,  tcp_route_ws,        HTTP_CACHE_NONE,       TCP_PRIO_NORMAL, HTTP_MODE_AP | HTTP_MODE_STA },
+};
+
+#define HTTP_ROUTE_COUNT (sizeof(http_routes) / sizeof(http_routes[0]))
+
+
+// --------------------------- Funções de Busca das Rotas ---------------------------
+
+/**
+ * @brief Compara uma requisição com uma rota (caminho e, em seguida, método).
+ */
+static int tcp_server_route_compare(const char *method, const char *path, const HTTP_ROUTE_T *route) {
+    int cmp = strcmp(path, route->path);
+    return cmp ? cmp : strcmp(method, route->method);
+}
+
+/**
+ * @brief Busca a rota de uma requisição por busca binária na tabela ordenada.
+ *
+ * @return const HTTP_ROUTE_T* A rota encontrada, ou NULL se não houver rota para o caminho e o método
+ *         no modo atual do servidor.
+ */
+static const HTTP_ROUTE_T *tcp_server_find_route(const char *method, const char *path) {
+    int low = 0, high = HTTP_ROUTE_COUNT - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = tcp_server_route_compare(method, path, &http_routes[mid]);
+        if (cmp == 0) return (http_routes[mid].modes & http_server_mode) ? &http_routes[mid] : NULL;
+        if (cmp < 0) high = mid - 1;
+        else low = mid + 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Confere se a tabela de rotas está ordenada.
+ */
+static void tcp_server_routes_check(void) {
+    for (size_t i = 1; i < HTTP_ROUTE_COUNT; i++) {
+        if (tcp_server_route_compare(http_routes[i].method, http_routes[i].path, &http_routes[i - 1]) <= 0) {
+            printf("route table out of order at %s %s\n", http_routes[i].method, http_routes[i].path); // Antes do assert: o registro binário não seria enviado
+            assert(false);
+        }
+    }
+}
+
+/**
+ * @brief Separa a linha de requisição em método, caminho e parâmetros, no próprio buffer.
+ *
+ * @param line Início da requisição (terminada com NULL).
+ * @param request Estrutura a ser preenchida.
+ * @return true se a linha tem o formato "MÉTODO CAMINHO[?PARÂMETROS] VERSÃO", false caso contrário.
+ */
+static bool tcp_server_parse_request_line(char *line, HTTP_REQUEST_T *request) {
+    char *space = strchr(line, ' ');
+    if (!space) return false;
+    *space = '\0';
+    request->method = line;
+
+    char *path = space + 1;
+    char *end = path + strcspn(path, " \r\n");
+    if (*end != ' ') return false;
+    *end = '\0';
+
+    char *query = strchr(path, '?');
+    if (query) *query++ = '\0';
+    request->path = path;
+    request->params = query;
+    request->version = end + 1;
+    return true;
+}
+
+
+// --------------------------- Função para Atender a Requisição ---------------------------
+
+/**
+ * @brief Atende a requisição no início do buffer, se ela estiver completa.
+ *
+ * @param con_state Ponteiro para a estrutura de estado da conexão TCP.
+ * @param pcb Ponteiro para o bloco de controle de protocolo TCP.
+ * @return err_t Retorna ERR_OK em caso de sucesso, ou o resultado do fechamento da conexão em caso de falha.
+ *
+ * ### Comportamento:
+ * - No modo AP, responde às sondagens de portal cativo assim que a linha de requisição
+ *   estiver completa, sem esperar os cabeçalhos, e fecha a conexão após a resposta; até lá
+ *   ela tem a prioridade mínima e pode ceder o slot a outro cliente.
+ * - Aguarda novos dados enquanto a requisição estiver incompleta.
+ * - Separa a linha de requisição, decide se a conexão é persistente e busca a rota na
+ *   tabela `http_routes`.
+ * - Chama a função da rota; caminhos desconhecidos são redirecionados para a configuração
+ *   no modo AP e recebem 404 no modo STA.
+ * - Descarta a requisição atendida e move os bytes seguintes (pipeline) para o início do
+ *   buffer; eles são atendidos quando a resposta atual terminar.
+ *
+ * @note Só é chamada sem resposta em andamento, então as respostas saem na ordem das requisições.
+ */
+static err_t tcp_server_process_request(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb) {
+    // Sondagens de portal cativo recebem uma resposta constante assim que a linha de requisição chega
+    if (http_server_mode == HTTP_MODE_AP) {
+        const char *eol = memchr(con_state->headers, '\n', con_state->request_len);
+        const STATIC_PAGE_T *probe = eol ? tcp_server_match_probe(con_state->headers, eol - con_state->headers) : NULL;
+        if (probe) {
+            LOG_DEBUG("Captive portal probe");
+            // O restante da requisição é descartado: a conexão fecha após a resposta
+            con_state->request_len = 0;
+            con_state->headers[0] = '\0';
+            con_state->scanned_len = 0;
+            con_state->body_offset = 0;
+            con_state->content_length = 0;
+            con_state->keep_alive = false;
+            tcp_server_set_priority(con_state, TCP_PRIO_MIN);
+            return tcp_server_respond(con_state, pcb, probe);
+        }
+    }
+
+    int complete = tcp_server_assemble_request(con_state);
+    if (complete < 0) {
+        LOG_WARN("Request too large %d", con_state->request_len);
+        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    }
+    if (complete == 0) {
+        return ERR_OK;
+    }
+
+    int content_length = con_state->content_length;
+    int headers_len = con_state->body_offset;
+    int consumed = headers_len + content_length;
+    char *body = con_state->headers + headers_len;
+    char next = con_state->headers[consumed];  // Primeiro byte da próxima requisição, se houver
+    LOG_DEBUG("Request complete: %d bytes (body %d)", consumed, content_length);
+
+    // Separa a linha de requisição em método, caminho e parâmetros
+    HTTP_REQUEST_T request;
+    if (!tcp_server_parse_request_line(con_state->headers, &request)) {
+        LOG_WARN("Malformed request line");
+        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    }
+    request.headers = con_state->headers;
+    request.headers_len = headers_len;
+    request.body = body;
+    request.body_len = content_length;
+    body[content_length] = '\0';
+    LOG_DEBUG_S("Request: %s %s?%s", request.method, request.path, request.params);
+
+    con_state->requests_served++;
+    con_state->keep_alive = tcp_server_keep_alive(con_state, &request);
+
+    // Busca a rota; caminhos desconhecidos são redirecionados para o portal (modo AP) ou recebem 404 (modo STA)
+    err_t err;
+    const HTTP_ROUTE_T *route = tcp_server_find_route(request.method, request.path);
+    if (!route && http_server_mode == HTTP_MODE_STA) {
+        err = tcp_server_respond(con_state, pcb, &not_found_page);
+    } else if (!route) {
+        LOG_DEBUG("Sending redirect %s", redirect_page.header);
+        tcp_server_set_priority(con_state, TCP_PRIO_MIN);
+        err = tcp_server_respond(con_state, pcb, &redirect_page);
+    } else {
+        tcp_server_set_priority(con_state, route->priority);
+        err = route->handler(con_state, pcb, &request, route);
+    }
+    if (con_state->pcb != pcb) {
+        return err;                     // A conexão foi fechada
+    }
+
+    // Descarta a requisição atendida e traz a próxima para o início do buffer
+    con_state->headers[consumed] = next;
+    con_state->request_len -= consumed;
+    memmove(con_state->headers, con_state->headers + consumed, con_state->request_len + 1);
+    con_state->scanned_len = 0;
+    con_state->body_offset = 0;
+    con_state->content_length = 0;
+    return err;
+}
+
+/**
+ * @brief Atende as próximas requisições do pipeline sem esperar a confirmação da resposta atual.
+ *
+ * @param con_state Ponteiro para a estrutura de estado da conexão TCP.
+ * @param pcb Ponteiro para o bloco de controle de protocolo TCP.
+ * @return err_t Retorna ERR_OK em caso de sucesso, ou o resultado do fechamento da conexão em caso de falha.
+ *
+ * ### Comportamento:
+ * - Quando a resposta atual já foi toda entregue ao lwIP e a próxima requisição já está
+ *   completa no buffer, a resposta atual é encerrada: os bytes ainda não confirmados passam
+ *   para `retired_len` e a próxima resposta sai logo em seguida, na mesma janela.
+ * - Sem uma requisição completa à espera, nada muda: a resposta atual só termina quando for
+ *   confirmada, e até lá mantém a prioridade da sua rota.
+ * - Não se aplica a respostas que fecham a conexão, nem a assinantes de `/events` e clientes de `/ws`.
+ */
+static err_t tcp_server_pipeline(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb) {
+    while (con_state->page && con_state->keep_alive && !con_state->subscriber && !con_state->websocket &&
+           con_state->queued_len == con_state->response_len && tcp_server_assemble_request(con_state) != 0) {
+        con_state->retired_len += con_state->response_len - con_state->sent_len;
+        con_state->page = NULL;
+        err_t err = tcp_server_process_request(con_state, pcb);
+        if (err != ERR_OK || con_state->pcb != pcb) return err;
+    }
+    return ERR_OK;
+}
+
+
 // --------------------------- Função de Callback para Recebimento do Servidor TCP ---------------------------
 
 /**
@@ -417,149 +1823,65 @@ static int test_server_content(const char *request, const char *params, char *re
  * @param err Código de erro indicando o status da operação de recebimento.
  * @return err_t Retorna ERR_OK em caso de sucesso, ou um código de erro apropriado em caso de falha.
  *
- * Esta função é chamada quando dados são recebidos do cliente TCP. Ela processa
- * os dados recebidos, lida com requisições HTTP GET e POST, e gera a resposta apropriada
- * para ser enviada de volta ao cliente.
+ * Esta função é chamada quando dados são recebidos do cliente TCP. Ela acumula
+ * os dados recebidos e atende as requisições completas.
  *
  * ### Comportamento:
  * - Verifica se a conexão está fechada.
  * - Asserta a validade do estado da conexão e do PCB.
- * - Copia a requisição recebida para o buffer.
- * - Lida com requisições HTTP GET e POST.
- * - Gera o conteúdo de resposta apropriado.
- * - Envia os cabeçalhos e o corpo da resposta para o cliente.
- * - Libera o buffer de pacotes e retorna o código de erro apropriado.
+ * - Acumula os dados recebidos no buffer e libera o pbuf. Se o buffer estiver cheio
+ *   enquanto uma resposta é enviada, recusa o pbuf (`ERR_MEM`) para o lwIP entregá-lo depois.
+ * - Sem resposta em andamento, atende a requisição com `tcp_server_process_request`; com uma
+ *   resposta já toda entregue ao lwIP, passa à próxima requisição do pipeline.
+ * - Em conexões de `/ws`, interpreta os quadros recebidos com `tcp_server_ws_receive`.
  *
  * @note O estado da conexão e o PCB são usados para gerenciar a conexão TCP.
  */
 err_t tcp_server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
     if (!p) {
-        DEBUG_printf("connection closed\n");
+        LOG_DEBUG("connection closed");
         return tcp_close_client_connection(con_state, pcb, ERR_OK);
     }
     assert(con_state && con_state->pcb == pcb);
     if (p->tot_len > 0) {
-        DEBUG_printf("tcp_server_recv %d err %d\n", p->tot_len, err);
-#if 0
-        for (struct pbuf *q = p; q != NULL; q = q->next) {
-            DEBUG_printf("in: %.*s\n", q->len, q->payload);
-        }
-#endif
-        // Copia a requisição para o buffer
-        pbuf_copy_partial(p, con_state->headers, p->tot_len > sizeof(con_state->headers) - 1 ? sizeof(con_state->headers) - 1 : p->tot_len, 0);
-
-        // Lida com requisição GET
-        if (strncmp(HTTP_GET, con_state->headers, sizeof(HTTP_GET) - 1) == 0) {
-            char *request = con_state->headers + sizeof(HTTP_GET); // + espaço
-            char *params = strchr(request, '?');
-            if (params) {
-                if (*params) {
-                    char *space = strchr(request, ' ');
-                    *params++ = 0;
-                    if (space) {
-                        *space = 0;
-                    }
-                } else {
-                    params = NULL;
-                }
-            }
-            
-            // Gera conteúdo
-            con_state->result_len = test_server_content(request, params, con_state->result, sizeof(con_state->result));
-            DEBUG_printf("Request: %s?%s\n", request, params);
-            DEBUG_printf("Result: %d\n", con_state->result_len);
-
-            // Verifica se havia espaço suficiente no buffer
-            if (con_state->result_len > sizeof(con_state->result) - 1) {
-                DEBUG_printf("Too much result data %d\n", con_state->result_len);
-                return tcp_close_client_connection(con_state, pcb, ERR_CLSD);
-            }
-
-            // Gera página web
-            if (con_state->result_len > 0) {
-                con_state->header_len = snprintf(con_state->headers, sizeof(con_state->headers), HTTP_RESPONSE_HEADERS,
-                    200, con_state->result_len);
-                if (con_state->header_len > sizeof(con_state->headers) - 1) {
-                    DEBUG_printf("Too much header data %d\n", con_state->header_len);
-                    return tcp_close_client_connection(con_state, pcb, ERR_CLSD);
-                }
-            } else {
-                // Envia redirecionamento
-                con_state->header_len = snprintf(con_state->headers, sizeof(con_state->headers), HTTP_RESPONSE_REDIRECT,
-                    ipaddr_ntoa(con_state->gw));
-                DEBUG_printf("Sending redirect %s", con_state->headers);
-            }
-
-            // Envia os cabeçalhos para o cliente
-            con_state->sent_len = 0;
-            err_t err = tcp_write(pcb, con_state->headers, con_state->header_len, 0);
-            if (err != ERR_OK) {
-                DEBUG_printf("failed to write header data %d\n", err);
-                return tcp_close_client_connection(con_state, pcb, err);
-            }
-
-            // Envia o corpo para o cliente
-            if (con_state->result_len) {
-                err = tcp_write(pcb, con_state->result, con_state->result_len, 0);
-                if (err != ERR_OK) {
-                    DEBUG_printf("failed to write result data %d\n", err);
-                    return tcp_close_client_connection(con_state, pcb, err);
-                }
-            }
+        LOG_DEBUG("tcp_server_recv %d err %d", p->tot_len, err);
+        con_state->last_activity_ms = to_ms_since_boot(get_absolute_time());
+        // Assinantes de `/events` não enviam novas requisições: os dados são descartados
+        if (con_state->subscriber) {
+            tcp_recved(pcb, p->tot_len);
+            pbuf_free(p);
+            return ERR_OK;
         }
 
-        if (strncmp(HTTP_POST, con_state->headers, sizeof(HTTP_POST) - 1) == 0) {
-            char *request = con_state->headers + sizeof(HTTP_POST); // + espaço
-            char *space = strchr(request, ' ');
-            if (space) {
-                *space = 0;     // Termina a string no final do caminho
-            }
-
-            // Verifica se o marcador foi encontrado
-            char *payload = strstr(con_state->headers, "\r\n\r\n");
-            if (p->payload) {
-                p->payload += 4; // Avança 4 caracteres de "\r\n\r\n" para alcançar o corpo
-
-                // Garante que o payload seja uma string terminada em NULL
-                ((char *)p->payload)[p->len - 4] = '\0';
-
-                // Processa os dados recebidos no payload
-                int process_result = process_post_payload(request, p->payload);
-                if (process_result >= 0) {
-                    // Resposta de sucesso com página
-                    id_pw_collected = 1;
-                    snprintf(con_state->result, sizeof(con_state->result), SUCCESS_PAGE);
-                } else {
-                    // Resposta de falha com página
-                    snprintf(con_state->result, sizeof(con_state->result), FAILURE_PAGE);
-                }
-            } else {
-                // Resposta de falha com página
-                snprintf(con_state->result, sizeof(con_state->result), FAILURE_PAGE);
-            }
-
-            // Atualiza cabeçalhos para servir o HTML
-            con_state->header_len = snprintf(con_state->headers, sizeof(con_state->headers),
-                HTTP_RESPONSE_HEADERS, 200, strlen(con_state->result));
-
-            // Envia os cabeçalhos para o cliente
-            con_state->sent_len = 0;
-            err_t err = tcp_write(pcb, con_state->headers, con_state->header_len, 0);
-            if (err != ERR_OK) {
-                DEBUG_printf("Failed to send POST headers: %d\n", err);
-                return tcp_close_client_connection(con_state, pcb, err);
+        // Acumula os dados no buffer
+        int room = sizeof(con_state->headers) - 1 - con_state->request_len;
+        if (p->tot_len > room) {
+            if (con_state->page && !con_state->websocket) {
+                return ERR_MEM;         // Pipeline cheio: o lwIP entrega o pbuf de novo mais tarde
             }
+            LOG_WARN("Request too large %d", con_state->request_len + p->tot_len);
+            tcp_recved(pcb, p->tot_len);
+            pbuf_free(p);
+            return tcp_close_client_connection(con_state, pcb, ERR_OK);
+        }
+        pbuf_copy_partial(p, con_state->headers + con_state->request_len, p->tot_len, 0);
+        con_state->request_len += p->tot_len;
+        con_state->headers[con_state->request_len] = '\0';
+        tcp_recved(pcb, p->tot_len);
+        pbuf_free(p);
 
-            // Envia o corpo da resposta para o cliente
-            err = tcp_write(pcb, con_state->result, strlen(con_state->result), 0);
-            if (err != ERR_OK) {
-                DEBUG_printf("Failed to send body data: %d\n", err);
-                return tcp_close_client_connection(con_state, pcb, err);
-            }
+        // Clientes de `/ws` enviam quadros WebSocket, tratados mesmo durante o envio de um quadro
+        if (con_state->websocket) {
+            return tcp_server_ws_receive(con_state, pcb);
         }
 
-        tcp_recved(pcb, p->tot_len);
+        // Requisições em pipeline aguardam até que a resposta atual seja toda entregue ao lwIP
+        if (!con_state->page) {
+            err_t process_err = tcp_server_process_request(con_state, pcb);
+            if (process_err != ERR_OK || con_state->pcb != pcb) return process_err;
+        }
+        return tcp_server_pipeline(con_state, pcb);
     }
     pbuf_free(p);
     return ERR_OK;
@@ -569,26 +1891,51 @@ err_t tcp_server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 // --------------------------- Função de Polling do Servidor ---------------------------
 
 /**
- * @brief Faz polling no servidor TCP por atividade e lida com a desconexão do cliente.
+ * @brief Faz polling no servidor TCP por atividade e fecha conexões ociosas.
  *
  * @param arg Ponteiro para o argumento passado para a função de polling, tipicamente o estado da conexão.
  * @param pcb Ponteiro para o bloco de controle de protocolo TCP do cliente.
  * @return err_t Retorna ERR_OK em caso de sucesso, ou um código de erro apropriado em caso de falha.
  *
- * Esta função é chamada periodicamente para fazer polling no servidor TCP por atividade.
- * Se um cliente estiver conectado, ela lida com a desconexão do cliente.
+ * Esta função é chamada a cada `POLL_TIME_S` segundos para cada conexão.
  *
  * ### Comportamento:
- * - Converte o argumento para a estrutura de estado da conexão.
- * - Registra a chamada da função de polling para fins de depuração.
- * - Chama a função para fechar a conexão do cliente.
+ * - Fecha a conexão se ela estiver há `TCP_IDLE_TIMEOUT_S` segundos sem receber dados nem
+ *   ter dados confirmados; conexões ativas (por exemplo, enviando uma página) são mantidas.
+ *   É também o tempo máximo de espera pela próxima requisição em uma conexão persistente.
+ * - Assinantes de `/events` sem amostras nesse intervalo recebem um evento vazio, e clientes
+ *   de `/ws` sem quadros recebem um ping; eles só são fechados se nem isso for confirmado.
+ * - Tenta novamente entregar ao lwIP a parte da resposta que não coube no buffer de envio.
  *
  * @note Esta função é tipicamente registrada como um callback para o evento de polling do servidor TCP.
  */
 static err_t tcp_server_poll(void *arg, struct tcp_pcb *pcb) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
-    DEBUG_printf("tcp_server_poll_fn\n");
-    return tcp_close_client_connection(con_state, pcb, ERR_OK); // Apenas desconecta o cliente?
+    uint32_t idle_ms = to_ms_since_boot(get_absolute_time()) - con_state->last_activity_ms;
+
+    // Assinantes de `/events` e clientes de `/ws` ociosos recebem um evento vazio ou um ping em vez de serem fechados
+    if (idle_ms >= TCP_IDLE_TIMEOUT_S * 1000 && con_state->subscriber && !con_state->page) {
+        con_state->last_activity_ms += idle_ms;
+        return tcp_server_respond(con_state, pcb, &event_heartbeat_page);
+    }
+    if (idle_ms >= TCP_IDLE_TIMEOUT_S * 1000 && con_state->websocket && !con_state->page) {
+        con_state->last_activity_ms += idle_ms;
+        return tcp_server_respond(con_state, pcb, &ws_ping_page);
+    }
+
+    if (idle_ms >= TCP_IDLE_TIMEOUT_S * 1000) {
+        LOG_DEBUG("tcp_server_poll_fn: idle for %lu ms", (unsigned long)idle_ms);
+        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    }
+
+    if (con_state->page && con_state->queued_len < con_state->response_len) {
+        err_t err = tcp_server_send(con_state, pcb);
+        if (err != ERR_OK) {
+            return tcp_close_client_connection(con_state, pcb, err);
+        }
+        return tcp_server_pipeline(con_state, pcb);
+    }
+    return ERR_OK;
 }
 
 
@@ -600,24 +1947,26 @@ static err_t tcp_server_poll(void *arg, struct tcp_pcb *pcb) {
  * @param arg Ponteiro para o argumento passado para a função de erro, tipicamente o estado da conexão.
  * @param err O código de erro indicando o tipo de erro.
  *
- * Esta função é chamada quando ocorre um erro no servidor TCP.
- * Ela lida com o erro fechando a conexão do cliente se o erro não for ERR_ABRT.
+ * Esta função é chamada quando ocorre um erro no servidor TCP (conexão resetada ou
+ * abortada pelo lwIP). Nesse ponto o PCB já foi liberado pela pilha, então ele não pode
+ * mais ser fechado.
  *
  * ### Comportamento:
  * - Converte o argumento para a estrutura de estado da conexão.
  * - Registra o erro para fins de depuração.
- * - Chama a função para fechar a conexão do cliente se o erro não for ERR_ABRT.
+ * - Devolve o slot da conexão à lista de livres.
  *
  * @note Esta função é tipicamente registrada como um callback para o evento de erro do servidor TCP.
  */
 static void tcp_server_err(void *arg, err_t err) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
-    if (err != ERR_ABRT) {
-        // Registra o erro para fins de depuração
-        DEBUG_printf("tcp_client_err_fn %d\n", err);
 
-        // Fecha a conexão do cliente
-        tcp_close_client_connection(con_state, con_state->pcb, err);
+    // Registra o erro para fins de depuração
+    LOG_DEBUG("tcp_client_err_fn %d", err);
+
+    // O PCB já foi liberado pelo lwIP: apenas devolve o slot da conexão
+    if (con_state) {
+        tcp_connect_free(con_state);
     }
 }
 
@@ -638,7 +1987,8 @@ static void tcp_server_err(void *arg, err_t err) {
  * ### Comportamento:
  * - Verifica se há erros na operação de aceitação.
  * - Registra o status da conexão para fins de depuração.
- * - Aloca memória para a estrutura de estado da conexão.
+ * - Reserva um slot de conexão; sem slot livre, descarta a sondagem mais ociosa ou, se não
+ *   houver nenhuma, responde 503 e encerra a conexão.
  * - Configura o estado da conexão e registra os callbacks necessários.
  *
  * @note Esta função é tipicamente registrada como um callback para o evento de aceitação do servidor TCP.
@@ -646,19 +1996,32 @@ static void tcp_server_err(void *arg, err_t err) {
 static err_t tcp_server_accept(void *arg, struct tcp_pcb *client_pcb, err_t err) {
     TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
     if (err != ERR_OK || client_pcb == NULL) {
-        DEBUG_printf("failure in accept\n");
+        LOG_WARN("failure in accept");
         return ERR_VAL;
     }
-    DEBUG_printf("client connected\n");
+    LOG_DEBUG("client connected");
 
-    // Cria o estado para a conexão
-    TCP_CONNECT_STATE_T *con_state = calloc(1, sizeof(TCP_CONNECT_STATE_T));
+    // Reserva um slot para a conexão (descartando uma sondagem, se necessário)
+    TCP_CONNECT_STATE_T *con_state = tcp_connect_alloc();
+    if (!con_state && tcp_connect_evict()) {
+        con_state = tcp_connect_alloc();
+    }
     if (!con_state) {
-        DEBUG_printf("failed to allocate connect state\n");
-        return ERR_MEM;
+        // Sem slot livre: responde 503 (enviado da flash, sem estado) e encerra a conexão
+        tcp_connect_pool.rejected++;
+        LOG_WARN("no free connection slot (%lu rejected)", (unsigned long)tcp_connect_pool.rejected);
+        tcp_arg(client_pcb, NULL);
+        tcp_write(client_pcb, HTTP_RESPONSE_BUSY, sizeof(HTTP_RESPONSE_BUSY) - 1, 0);
+        if (tcp_close(client_pcb) != ERR_OK) {
+            tcp_abort(client_pcb);
+            return ERR_ABRT;
+        }
+        return ERR_OK;
     }
     con_state->pcb = client_pcb; // para verificação
     con_state->gw = &state->gw;
+    con_state->last_activity_ms = to_ms_since_boot(get_absolute_time());
+    tcp_server_set_priority(con_state, TCP_PRIO_NORMAL);
 
     // Configura a conexão com o cliente
     tcp_arg(client_pcb, con_state);
@@ -684,36 +2047,40 @@ static err_t tcp_server_accept(void *arg, struct tcp_pcb *client_pcb, err_t err)
  * ### Comportamento:
  * - Cria um novo bloco de controle de protocolo TCP (PCB).
  * - Associa o PCB à porta especificada.
- * - Começa a escutar por conexões de clientes com um backlog de 1.
+ * - Começa a escutar por conexões de clientes com um backlog de `TCP_SERVER_BACKLOG`.
  * - Registra os callbacks necessários para aceitar conexões de clientes.
  *
  * @note Esta função é tipicamente chamada para iniciar o servidor TCP.
  */
 static bool tcp_server_open(void *arg) {
     TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
-    DEBUG_printf("starting server on port %u\n", TCP_PORT);
+    LOG_INFO("starting server on port %u", TCP_PORT);
 
     struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
     if (!pcb) {
-        DEBUG_printf("failed to create pcb\n");
+        LOG_ERROR("failed to create pcb");
         return false;
     }
 
     err_t err = tcp_bind(pcb, IP_ANY_TYPE, TCP_PORT);
     if (err) {
-        DEBUG_printf("failed to bind to port %d\n", err);
+        LOG_ERROR("failed to bind to port %d", err);
         return false;
     }
 
-    state->server_pcb = tcp_listen_with_backlog(pcb, 1);
+    state->server_pcb = tcp_listen_with_backlog(pcb, TCP_SERVER_BACKLOG);
     if (!state->server_pcb) {
-        DEBUG_printf("failed to listen\n");
+        LOG_ERROR("failed to listen");
         if (pcb) {
             tcp_close(pcb);
         }
         return false;
     }
 
+    tcp_server_pages_init();
+    tcp_server_routes_check();
+    tcp_connect_pool_init();
+
     tcp_arg(state->server_pcb, state);
     tcp_accept(state->server_pcb, tcp_server_accept);
 
@@ -0,0 +1,280 @@
+/******************************************************************************
+ * @file    sha1.h
+ * @brief   Arquivo contendo a implementação do SHA-1, do HMAC-SHA1, do
+ *          PBKDF2-HMAC-SHA1 e da codificação Base64.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    Usado no handshake do WebSocket (`Sec-WebSocket-Accept`) e na derivação
+ *          da chave WPA2 (PMK) a partir da senha e do SSID. O SHA-1 não deve ser
+ *          usado para proteger dados novos: aqui ele só cumpre os protocolos.
+ ******************************************************************************/
+
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <stdint.h>                     // Tipos inteiros de tamanho fixo.
+#include <string.h>                     // Biblioteca padrão para `memcpy` e `memset`.
+
+// ----------------------------------- Defines ----------------------------------
+
+#define SHA1_BLOCK_SIZE 64              // Tamanho do bloco processado pelo SHA-1 (bytes).
+#define SHA1_DIGEST_SIZE 20             // Tamanho do resumo SHA-1 (bytes).
+#define WPA2_PMK_SIZE 32                // Tamanho da chave WPA2 derivada da senha (bytes).
+#define WPA2_PMK_ITERATIONS 4096        // Iterações do PBKDF2 definidas pelo IEEE 802.11i.
+#define SHA1_ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n)))) // Rotação à esquerda de 32 bits.
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura para armazenar o estado de um cálculo SHA-1 incremental.
+ */
+typedef struct SHA1_CTX_T_ {
+    uint32_t state[5];            // Resumo parcial (H0..H4).
+    uint64_t length;              // Total de bytes processados.
+    uint8_t block[SHA1_BLOCK_SIZE]; // Bloco em preenchimento.
+    uint8_t block_len;            // Bytes já presentes em `block`.
+} SHA1_CTX_T;
+
+/**
+ * @brief Estrutura para armazenar o estado de um cálculo HMAC-SHA1.
+ *
+ * Os estados interno e externo já absorveram a chave (blocos `ipad` e `opad`), então
+ * cálculos repetidos com a mesma chave partem de uma cópia destes estados.
+ */
+typedef struct HMAC_SHA1_CTX_T_ {
+    SHA1_CTX_T inner;             // SHA-1 de (chave XOR ipad || mensagem).
+    SHA1_CTX_T outer;             // SHA-1 de (chave XOR opad), completado com o resumo interno.
+} HMAC_SHA1_CTX_T;
+
+// ---------------------------------- Funções ---------------------------------
+
+// --------------------------- Função para Processar um Bloco ---------------------------
+
+/**
+ * @brief Processa um bloco de 64 bytes, atualizando o resumo parcial.
+ */
+static void sha1_transform(SHA1_CTX_T *ctx, const uint8_t *block) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+               (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+    }
+
+    uint32_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3], e = ctx->state[4];
+    for (int i = 0; i < 80; i++) {
+        // A expansão da mensagem usa uma janela circular de 16 palavras
+        if (i >= 16) {
+            uint32_t t = w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15];
+            w[i & 15] = SHA1_ROL(t, 1);
+        }
+
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+        uint32_t temp = SHA1_ROL(a, 5) + f + e + k + w[i & 15];
+        e = d;
+        d = c;
+        c = SHA1_ROL(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+}
+
+
+// --------------------------- Funções do Cálculo Incremental ---------------------------
+
+/**
+ * @brief Inicia um cálculo SHA-1.
+ */
+void sha1_init(SHA1_CTX_T *ctx) {
+    static const uint32_t initial[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+    ctx->block_len = 0;
+}
+
+/**
+ * @brief Acrescenta dados ao cálculo SHA-1.
+ */
+void sha1_update(SHA1_CTX_T *ctx, const void *data, size_t len) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    ctx->length += len;
+
+    while (len > 0) {
+        size_t chunk = SHA1_BLOCK_SIZE - ctx->block_len;
+        if (chunk > len) chunk = len;
+        memcpy(ctx->block + ctx->block_len, bytes, chunk);
+        ctx->block_len += chunk;
+        bytes += chunk;
+        len -= chunk;
+
+        if (ctx->block_len == SHA1_BLOCK_SIZE) {
+            sha1_transform(ctx, ctx->block);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+/**
+ * @brief Finaliza o cálculo SHA-1 (preenchimento e comprimento) e grava o resumo.
+ *
+ * @param ctx Estado do cálculo.
+ * @param digest Buffer de `SHA1_DIGEST_SIZE` bytes para o resumo.
+ */
+void sha1_final(SHA1_CTX_T *ctx, uint8_t *digest) {
+    uint64_t bits = ctx->length * 8;
+
+    ctx->block[ctx->block_len++] = 0x80;
+    if (ctx->block_len > SHA1_BLOCK_SIZE - 8) {
+        memset(ctx->block + ctx->block_len, 0, SHA1_BLOCK_SIZE - ctx->block_len);
+        sha1_transform(ctx, ctx->block);
+        ctx->block_len = 0;
+    }
+    memset(ctx->block + ctx->block_len, 0, SHA1_BLOCK_SIZE - 8 - ctx->block_len);
+    for (int i = 0; i < 8; i++) {
+        ctx->block[SHA1_BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+    sha1_transform(ctx, ctx->block);
+
+    for (int i = 0; i < SHA1_DIGEST_SIZE; i++) {
+        digest[i] = (uint8_t)(ctx->state[i / 4] >> (24 - 8 * (i % 4)));
+    }
+}
+
+
+// --------------------------- Funções do HMAC-SHA1 ---------------------------
+
+/**
+ * @brief Inicia um cálculo HMAC-SHA1 (RFC 2104) com a chave informada.
+ */
+void hmac_sha1_init(HMAC_SHA1_CTX_T *ctx, const void *key, size_t key_len) {
+    uint8_t pad[SHA1_BLOCK_SIZE] = {0};
+
+    // Chaves maiores que um bloco são substituídas pelo seu resumo
+    if (key_len > SHA1_BLOCK_SIZE) {
+        sha1_init(&ctx->inner);
+        sha1_update(&ctx->inner, key, key_len);
+        sha1_final(&ctx->inner, pad);
+    } else {
+        memcpy(pad, key, key_len);
+    }
+
+    for (int i = 0; i < SHA1_BLOCK_SIZE; i++) pad[i] ^= 0x36;
+    sha1_init(&ctx->inner);
+    sha1_update(&ctx->inner, pad, SHA1_BLOCK_SIZE);
+
+    for (int i = 0; i < SHA1_BLOCK_SIZE; i++) pad[i] ^= 0x36 ^ 0x5C;
+    sha1_init(&ctx->outer);
+    sha1_update(&ctx->outer, pad, SHA1_BLOCK_SIZE);
+}
+
+/**
+ * @brief Acrescenta dados ao cálculo HMAC-SHA1.
+ */
+void hmac_sha1_update(HMAC_SHA1_CTX_T *ctx, const void *data, size_t len) {
+    sha1_update(&ctx->inner, data, len);
+}
+
+/**
+ * @brief Finaliza o cálculo HMAC-SHA1 e grava o resultado (`SHA1_DIGEST_SIZE` bytes).
+ */
+void hmac_sha1_final(HMAC_SHA1_CTX_T *ctx, uint8_t *digest) {
+    uint8_t inner[SHA1_DIGEST_SIZE];
+    sha1_final(&ctx->inner, inner);
+    sha1_update(&ctx->outer, inner, sizeof(inner));
+    sha1_final(&ctx->outer, digest);
+}
+
+
+// --------------------------- Função de Derivação PBKDF2 ---------------------------
+
+/**
+ * @brief Deriva uma chave com PBKDF2-HMAC-SHA1 (RFC 8018).
+ *
+ * @param password Senha.
+ * @param password_len Comprimento da senha.
+ * @param salt Sal (no WPA2, o SSID).
+ * @param salt_len Comprimento do sal.
+ * @param iterations Quantidade de iterações (no WPA2, `WPA2_PMK_ITERATIONS`).
+ * @param out Buffer para a chave derivada.
+ * @param out_len Comprimento da chave derivada (no WPA2, `WPA2_PMK_SIZE`).
+ *
+ * O estado do HMAC com a senha é calculado uma única vez e copiado a cada iteração,
+ * então cada iteração custa apenas dois blocos SHA-1.
+ *
+ * @note Com os parâmetros do WPA2 são 8192 iterações do HMAC: a derivação leva um tempo
+ *       perceptível no RP2040 e deve ser feita só quando a senha ou o SSID mudam.
+ */
+void pbkdf2_sha1(const void *password, size_t password_len, const void *salt, size_t salt_len,
+                 uint32_t iterations, uint8_t *out, size_t out_len) {
+    HMAC_SHA1_CTX_T keyed, ctx;
+    hmac_sha1_init(&keyed, password, password_len);
+
+    for (uint32_t block = 1; out_len > 0; block++) {
+        uint8_t u[SHA1_DIGEST_SIZE], t[SHA1_DIGEST_SIZE];
+        uint8_t index[4] = { block >> 24, block >> 16, block >> 8, block };
+
+        // U1 = HMAC(senha, sal || índice do bloco)
+        ctx = keyed;
+        hmac_sha1_update(&ctx, salt, salt_len);
+        hmac_sha1_update(&ctx, index, sizeof(index));
+        hmac_sha1_final(&ctx, u);
+        memcpy(t, u, sizeof(t));
+
+        // Ui = HMAC(senha, Ui-1); T = U1 XOR U2 XOR ... XOR Un
+        for (uint32_t i = 1; i < iterations; i++) {
+            ctx = keyed;
+            hmac_sha1_update(&ctx, u, sizeof(u));
+            hmac_sha1_final(&ctx, u);
+            for (int j = 0; j < SHA1_DIGEST_SIZE; j++) t[j] ^= u[j];
+        }
+
+        size_t chunk = out_len < SHA1_DIGEST_SIZE ? out_len : SHA1_DIGEST_SIZE;
+        memcpy(out, t, chunk);
+        out += chunk;
+        out_len -= chunk;
+    }
+}
+
+
+// --------------------------- Função de Codificação Base64 ---------------------------
+
+/**
+ * @brief Codifica dados em Base64 (com preenchimento `=`).
+ *
+ * @param data Dados a codificar.
+ * @param len Comprimento dos dados.
+ * @param out Buffer de saída com pelo menos `4 * ((len + 2) / 3) + 1` bytes.
+ * @return int Comprimento do texto gerado (sem o terminador NULL).
+ */
+int base64_encode(const uint8_t *data, size_t len, char *out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    int n = 0;
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t triple = (uint32_t)data[i] << 16;
+        if (i + 1 < len) triple |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) triple |= data[i + 2];
+
+        out[n++] = alphabet[(triple >> 18) & 0x3F];
+        out[n++] = alphabet[(triple >> 12) & 0x3F];
+        out[n++] = (i + 1 < len) ? alphabet[(triple >> 6) & 0x3F] : '=';
+        out[n++] = (i + 2 < len) ? alphabet[triple & 0x3F] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+#endif /*SHA1_H*/
@@ -27,6 +27,13 @@
 #define ADC_LOWER_THRESHOLD 850  	// Limite inferior do ADC para decrementar a frequência
 #define STEP 20              		// Incremento ou decremento por iteração
 #define TEMPERATURE_UNITS 'C'       // Unidade para medição de temperatura.
+#define WIFI_JOIN_TIMEOUT_MS 10000  // Tempo máximo da conexão ao Wi-Fi com varredura completa.
+#define WIFI_FAST_JOIN_TIMEOUT_MS 5000 // Tempo máximo da conexão direta (BSSID, canal e PMK em cache).
+#define WIFI_BACKOFF_BASE_MS 1000   // Espera antes da primeira tentativa de reconexão ao Wi-Fi.
+#define WIFI_BACKOFF_MAX_MS 60000   // Espera máxima entre as tentativas de reconexão ao Wi-Fi.
+#ifndef CYW43_IOCTL_GET_CHANNEL
+#define CYW43_IOCTL_GET_CHANNEL 0x3a // Comando WLC_GET_CHANNEL no formato de `cyw43_ioctl`.
+#endif
 
 /*------------------------------------- VARIÁVEIS ---------------------------------------*/
 
@@ -35,12 +42,16 @@ float frequency = MIN_FREQUENCY;        // Frequência inicial do buzzer
 int Limit_Buzzer = 0;                   // Limite do buzzer
 uint8_t x_distance;                     // Distância no eixo X da barra de progresso
 int start_wifi = 0;                     // Flag para indicar se o Wi-Fi está conectado
+volatile bool wifi_radio_on = false;    // CYW43 inicializado (entre `cyw43_arch_init` e `cyw43_arch_deinit`)
+bool wifi_link_ok = false;              // Conexão Wi-Fi ativa (mantida pelo supervisor da conexão)
 float temperature;                      // Variável para armazenar a temperatura
 int percentual = 0;                     // Variável para armazenar o percentual da barra de progresso
 char *ap_name = "PICO_W_AP";            // Nome da rede Wi-Fi no modo AP
 char *ap_pw = "raspberry";              // Senha da rede Wi-Fi no modo AP
-volatile bool timer_expired = false;    // Flag para indicar que o timer expirou
 int inicialized = 0;                    // Flag para indicar se o sistema foi inicializado
+uint32_t wifi_connected_ms = 0;         // Instante (ms desde o boot) da conexão ao Wi-Fi, ou 0 se não conectado
+uint32_t wifi_join_ms = 0;              // Duração da última conexão ao Wi-Fi (ms)
+bool wifi_fast_join = false;            // A última conexão foi direta (BSSID, canal e PMK em cache)
 
 /*--------------------------------------- FUNÇÕES ----------------------------------------*/
 
@@ -223,51 +234,63 @@ void ftoa(float n, char* res, int afterpoint)
         // é necessário para lidar com casos como 233.007 
         fpart = fpart * pow(10, afterpoint); 
  
-        intToStr((int)fpart, res + i + 1, afterpoint); 
-    } 
+        intToStr((int)fpart, res + i + 1, afterpoint);
+    }
 }
 
 
-// --------------------------- Função de Callback do Timer ---------------------------
+// --------------------------- Funções de Conversão em Ponto Fixo ---------------------------
 
 /**
- * @brief Função de callback para o timer.
- *
- * @param rt Ponteiro para a estrutura do timer repetitivo.
- * @return bool Retorna true para continuar chamando o callback.
+ * @brief Converte um número de ponto flutuante para ponto fixo com arredondamento.
  *
- * Esta função é chamada quando o timer expira. Ela define a flag `timer_expired` como true
- * para indicar que o timer expirou.
- *
- * ### Comportamento:
- * - Define a flag `timer_expired` como true.
- * - Retorna true para continuar chamando o callback.
+ * @param value O número de ponto flutuante a ser convertido.
+ * @param decimals Número de casas decimais (0 a 6).
+ * @return int32_t O valor escalado por 10^decimals.
  *
- * @note A função depende da variável externa `timer_expired`.
+ * @note Latitude e longitude com 6 casas decimais cabem em 32 bits (|valor| < 2147).
  */
-bool timer_callback(repeating_timer_t *rt) {
-    timer_expired = true;
-    return true; // Retorna true para continuar chamando o callback
+int32_t float_to_fixed(float value, int decimals) {
+    static const float scale[] = { 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f };
+    float scaled = value * scale[decimals];
+    return (int32_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
 }
 
-// --------------------------- Função para Iniciar o Timer ---------------------------
 
 /**
- * @brief Inicia um timer repetitivo.
+ * @brief Converte um valor em ponto fixo para uma string decimal.
  *
- * Esta função cria e inicia um timer repetitivo que chama a função de callback `timer_callback`
- * a cada 2000 milissegundos.
+ * @param value O valor escalado por 10^decimals.
+ * @param decimals Número de casas decimais.
+ * @param out A string resultante (no mínimo 13 bytes).
+ * @return int O comprimento da string resultante.
  *
- * ### Comportamento:
- * - Cria um timer repetitivo.
- * - Inicia o timer com um intervalo de 2000 milissegundos.
- * - Associa a função de callback `timer_callback` ao timer.
+ * Esta função substitui o `printf("%.Nf")` nos caminhos de envio de dados, evitando
+ * aritmética de ponto flutuante e a formatação de float da newlib.
  *
- * @note A função depende da função `add_repeating_timer_ms` para criar e iniciar o timer.
+ * ### Comportamento:
+ * - Gera os dígitos em ordem inversa, com pelo menos `decimals + 1` dígitos.
+ * - Adiciona o sinal negativo, se necessário.
+ * - Insere o ponto decimal antes das `decimals` últimas posições.
  */
-void start_timer() {
-    static repeating_timer_t timer;
-    add_repeating_timer_ms(2000, timer_callback, NULL, &timer); // Timer de 2 segundos
+int fixed_to_str(int32_t value, int decimals, char *out) {
+    char digits[12];
+    int n = 0;
+    uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+
+    do {
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude || n <= decimals);
+
+    int len = 0;
+    if (value < 0) out[len++] = '-';
+    while (n > 0) {
+        out[len++] = digits[--n];
+        if (n == decimals && n > 0) out[len++] = '.';
+    }
+    out[len] = '\0';
+    return len;
 }
 
 
@@ -0,0 +1,311 @@
+/******************************************************************************
+ * @file    display_core1.h
+ * @brief   Arquivo contendo o envio dos quadros do display SSD1306 pelo núcleo 1.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    O núcleo 0 continua desenhando no buffer do driver; `ssd1306_UpdateScreen`
+ *          apenas copia o quadro para um de dois buffers compartilhados e avisa o
+ *          núcleo 1 (`__sev`), que o escreve pelo I2C (~25 ms por quadro completo
+ *          a 400 kHz). Só as páginas (8 linhas) que mudaram são escritas. Se um
+ *          quadro novo chega antes do anterior ser enviado, o anterior é descartado.
+ *
+ * @note    Comandos ao painel (contraste, ligar/desligar) também passam pelo núcleo 1
+ *          (`display_core1_set_contrast`, `display_core1_set_on`), para não disputar o
+ *          I2C com a escrita de um quadro.
+ *
+ * @note    A FIFO entre os núcleos não é usada para os quadros: ela pertence ao
+ *          `multicore_lockout`, que o `flash_safe_execute` (fila de telemetria e
+ *          credenciais na flash) usa para pausar o núcleo 1 durante as gravações.
+ ******************************************************************************/
+
+#ifndef DISPLAY_CORE1_H
+#define DISPLAY_CORE1_H
+
+#include <string.h>
+#include "pico/stdlib.h"                // Biblioteca padrão para Raspberry Pi Pico.
+#include "pico/multicore.h"             // Inicialização do núcleo 1 e `multicore_lockout`.
+#include "hardware/sync.h"              // Spin locks e `__sev`/`__wfe`.
+#include "ssd1306/ssd1306.h"            // Arquivo contendo funções para o display SSD1306.
+
+// ----------------------------------- Defines ----------------------------------
+
+#define DISPLAY_CORE1_RENDER 1          // 1 = envia os quadros do display pelo núcleo 1, 0 = pelo núcleo 0 (síncrono).
+#define DISPLAY_CORE1_PAGES (SSD1306_HEIGHT / 8) // Páginas do display (8 linhas cada).
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estados de um buffer de quadro compartilhado.
+ */
+typedef enum {
+    DISPLAY_SLOT_FREE,            // Livre para o núcleo 0.
+    DISPLAY_SLOT_WRITING,         // Núcleo 0 copiando o quadro.
+    DISPLAY_SLOT_READY,           // Quadro completo aguardando o núcleo 1.
+    DISPLAY_SLOT_FLUSHING         // Núcleo 1 escrevendo o quadro no display.
+} DISPLAY_SLOT_STATE_T;
+
+/**
+ * @brief Estrutura para armazenar os contadores do envio pelo núcleo 1.
+ *
+ * Os contadores só crescem (e voltam a zero ao transbordar); o relatório mostra a diferença
+ * desde o relatório anterior.
+ */
+typedef struct DISPLAY_CORE1_STATS_T_ {
+    uint32_t contended[2];        // Vezes que cada núcleo encontrou o spin lock ocupado.
+    uint32_t posted;              // Quadros entregues pelo núcleo 0.
+    uint32_t replaced;            // Quadros descartados por um mais novo antes de serem enviados.
+    uint32_t flushed;             // Quadros escritos pelo núcleo 1.
+    uint32_t pages_written;       // Páginas escritas no display.
+    uint32_t pages_skipped;       // Páginas iguais às do display, não escritas.
+    uint32_t flush_us;            // Tempo total do núcleo 1 escrevendo quadros.
+    uint32_t post_us;             // Tempo total do núcleo 0 entregando quadros.
+} DISPLAY_CORE1_STATS_T;
+
+/**
+ * @brief Estrutura para armazenar os buffers compartilhados e o estado do envio pelo núcleo 1.
+ */
+typedef struct DISPLAY_CORE1_T_ {
+    uint8_t frames[2][SSD1306_BUFFER_SIZE];     // Buffers de quadro compartilhados.
+    volatile uint8_t state[2];                  // Estado de cada buffer (`DISPLAY_SLOT_STATE_T`).
+    uint8_t shown[SSD1306_BUFFER_SIZE];         // Último quadro escrito no display (uso exclusivo do núcleo 1).
+    spin_lock_t *lock;                          // Protege `state`.
+    volatile bool running;                      // Núcleo 1 inicializado e aguardando quadros.
+    volatile int16_t contrast_cmd;              // Contraste a aplicar pelo núcleo 1 (-1 = nenhum).
+    volatile int8_t on_cmd;                     // Ligar (1) ou desligar (0) o painel pelo núcleo 1 (-1 = nenhum).
+    volatile DISPLAY_CORE1_STATS_T stats;       // Contadores acumulados.
+    volatile uint32_t flush_max_us;             // Maior tempo de escrita de um quadro desde o último relatório.
+    volatile uint32_t post_max_us;              // Maior tempo de entrega de um quadro desde o último relatório.
+} DISPLAY_CORE1_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+DISPLAY_CORE1_T display_core1 = { .contrast_cmd = -1, .on_cmd = -1 }; // Estado do envio dos quadros pelo núcleo 1.
+
+// --------------------------- Funções do Spin Lock ---------------------------
+
+static uint32_t display_core1_lock(void) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (!spin_try_lock_unsafe(display_core1.lock)) {
+        display_core1.stats.contended[get_core_num()]++;
+        spin_lock_unsafe_blocking(display_core1.lock);
+    }
+    return irq_state;
+}
+
+static void display_core1_unlock(uint32_t irq_state) {
+    spin_unlock_unsafe(display_core1.lock);
+    restore_interrupts(irq_state);
+}
+
+// --------------------------- Função de Entrega do Quadro (Núcleo 0) ---------------------------
+
+/**
+ * @brief Copia o quadro para um buffer compartilhado e avisa o núcleo 1.
+ *
+ * Registrada como destino dos quadros do driver (`ssd1306_SetFrameSink`); nunca aguarda
+ * o I2C. Com um buffer sendo escrito pelo núcleo 1, o outro está sempre livre ou com um
+ * quadro ainda não enviado, que é substituído.
+ */
+static void display_core1_post(const uint8_t *buffer) {
+    uint64_t start = time_us_64();
+
+    uint32_t irq_state = display_core1_lock();
+    int slot = -1;
+    for (int i = 0; i < 2; i++) {
+        if (display_core1.state[i] == DISPLAY_SLOT_READY) {
+            slot = i;
+            display_core1.stats.replaced++;
+        }
+    }
+    if (slot < 0) {
+        slot = display_core1.state[0] == DISPLAY_SLOT_FREE ? 0 : 1;
+    }
+    display_core1.state[slot] = DISPLAY_SLOT_WRITING;
+    display_core1_unlock(irq_state);
+
+    memcpy(display_core1.frames[slot], buffer, SSD1306_BUFFER_SIZE);
+
+    irq_state = display_core1_lock();
+    display_core1.state[slot] = DISPLAY_SLOT_READY;
+    display_core1_unlock(irq_state);
+    __sev();    // Acorda o núcleo 1
+
+    uint32_t elapsed = (uint32_t)(time_us_64() - start);
+    display_core1.stats.posted++;
+    display_core1.stats.post_us += elapsed;
+    if (elapsed > display_core1.post_max_us) display_core1.post_max_us = elapsed;
+}
+
+// --------------------------- Função Principal do Núcleo 1 ---------------------------
+
+/**
+ * @brief Laço do núcleo 1: aguarda quadros prontos e escreve no display as páginas que mudaram.
+ */
+static void display_core1_main(void) {
+    multicore_lockout_victim_init();    // Permite ao núcleo 0 pausar este núcleo durante gravações na flash
+    bool full = true;                   // O primeiro quadro é escrito por inteiro
+    display_core1.running = true;
+
+    while (true) {
+        uint32_t irq_state = display_core1_lock();
+        int slot = -1;
+        for (int i = 0; i < 2; i++) {
+            if (display_core1.state[i] == DISPLAY_SLOT_READY) slot = i;
+        }
+        if (slot >= 0) display_core1.state[slot] = DISPLAY_SLOT_FLUSHING;
+        int16_t contrast = display_core1.contrast_cmd;
+        int8_t on = display_core1.on_cmd;
+        display_core1_unlock(irq_state);
+
+        // Os comandos ao painel vão antes do quadro; o pedido só é limpo depois de aplicado
+        if (contrast >= 0) ssd1306_SetContrast((uint8_t)contrast);
+        if (on >= 0) ssd1306_SetDisplayOn((uint8_t)on);
+        if (contrast >= 0 || on >= 0) {
+            irq_state = display_core1_lock();
+            if (display_core1.contrast_cmd == contrast) display_core1.contrast_cmd = -1;
+            if (display_core1.on_cmd == on) display_core1.on_cmd = -1;
+            display_core1_unlock(irq_state);
+        }
+
+        if (slot < 0) {
+            if (contrast < 0 && on < 0) __wfe();    // Dorme até o próximo `__sev` do núcleo 0
+            continue;
+        }
+
+        uint64_t start = time_us_64();
+        const uint8_t *frame = display_core1.frames[slot];
+        for (int page = 0; page < DISPLAY_CORE1_PAGES; page++) {
+            const uint8_t *data = frame + page * SSD1306_WIDTH;
+            uint8_t *shown = display_core1.shown + page * SSD1306_WIDTH;
+            if (!full && memcmp(data, shown, SSD1306_WIDTH) == 0) {
+                display_core1.stats.pages_skipped++;
+                continue;
+            }
+            ssd1306_WritePage(page, data);
+            memcpy(shown, data, SSD1306_WIDTH);
+            display_core1.stats.pages_written++;
+        }
+        full = false;
+
+        irq_state = display_core1_lock();
+        display_core1.state[slot] = DISPLAY_SLOT_FREE;
+        display_core1_unlock(irq_state);
+
+        uint32_t elapsed = (uint32_t)(time_us_64() - start);
+        display_core1.stats.flushed++;
+        display_core1.stats.flush_us += elapsed;
+        if (elapsed > display_core1.flush_max_us) display_core1.flush_max_us = elapsed;
+    }
+}
+
+// --------------------------- Funções de Comando do Painel (Núcleo 0) ---------------------------
+
+/**
+ * @brief Pede ao núcleo 1 um novo contraste do painel (ou o aplica direto, sem o núcleo 1).
+ *
+ * Um pedido ainda não aplicado é substituído pelo novo.
+ */
+void display_core1_set_contrast(uint8_t value) {
+    if (!display_core1.running) {
+        ssd1306_SetContrast(value);
+        return;
+    }
+    uint32_t irq_state = display_core1_lock();
+    display_core1.contrast_cmd = value;
+    display_core1_unlock(irq_state);
+    __sev();    // Acorda o núcleo 1
+}
+
+/**
+ * @brief Pede ao núcleo 1 para ligar ou desligar o painel (ou o faz direto, sem o núcleo 1).
+ */
+void display_core1_set_on(bool on) {
+    if (!display_core1.running) {
+        ssd1306_SetDisplayOn(on);
+        return;
+    }
+    uint32_t irq_state = display_core1_lock();
+    display_core1.on_cmd = on;
+    display_core1_unlock(irq_state);
+    __sev();    // Acorda o núcleo 1
+}
+
+/**
+ * @brief Verifica se o núcleo 1 não tem quadros nem comandos pendentes (I2C livre).
+ *
+ * Com o núcleo 0 sem entregar quadros, o resultado permanece válido, o que permite
+ * reconfigurar os relógios sem interromper uma transferência I2C.
+ */
+bool display_core1_idle(void) {
+    if (!display_core1.running) return true;
+    uint32_t irq_state = display_core1_lock();
+    bool idle = display_core1.state[0] == DISPLAY_SLOT_FREE && display_core1.state[1] == DISPLAY_SLOT_FREE &&
+                display_core1.contrast_cmd < 0 && display_core1.on_cmd < 0;
+    display_core1_unlock(irq_state);
+    return idle;
+}
+
+// --------------------------- Função de Inicialização ---------------------------
+
+/**
+ * @brief Inicia o núcleo 1 e passa a enviar os quadros do display por ele.
+ *
+ * Deve ser chamada após `ssd1306_Init` e antes de qualquer gravação na flash. Aguarda o
+ * núcleo 1 habilitar o `multicore_lockout`, exigido pelo `flash_safe_execute` com os dois
+ * núcleos ativos. Com `DISPLAY_CORE1_RENDER` = 0, não faz nada.
+ */
+void display_core1_start(void) {
+#if DISPLAY_CORE1_RENDER
+    display_core1.lock = spin_lock_init(spin_lock_claim_unused(true));
+    multicore_launch_core1(display_core1_main);
+    while (!display_core1.running) {
+        tight_loop_contents();
+    }
+    ssd1306_SetFrameSink(display_core1_post);
+#endif
+}
+
+// --------------------------- Função de Relatório ---------------------------
+
+/**
+ * @brief Imprime no console os contadores do envio pelo núcleo 1 desde o último relatório.
+ *
+ * Quadros entregues, substituídos e escritos (quadros/s), páginas escritas e puladas,
+ * tempo médio e máximo de escrita (núcleo 1) e de entrega (núcleo 0), e disputas do spin lock.
+ *
+ * @param arg Não utilizado (assinatura de tarefa, para ser registrada com `sched_task_add`).
+ */
+void display_core1_report(void *arg) {
+    static DISPLAY_CORE1_STATS_T last;  // Contadores no relatório anterior
+    static uint64_t last_us;
+    if (!display_core1.running) return;
+
+    uint64_t now = time_us_64();
+    uint32_t window_ms = (uint32_t)((now - last_us) / 1000);
+    DISPLAY_CORE1_STATS_T stats = display_core1.stats;
+    uint32_t posted = stats.posted - last.posted;
+    uint32_t flushed = stats.flushed - last.flushed;
+
+    printf("Display (núcleo 1): %lu quadros entregues, %lu substituídos, %lu escritos (%lu.%lu/s)\n",
+           (unsigned long)posted, (unsigned long)(stats.replaced - last.replaced), (unsigned long)flushed,
+           (unsigned long)(window_ms ? flushed * 1000 / window_ms : 0),
+           (unsigned long)(window_ms ? flushed * 10000 / window_ms % 10 : 0));
+    printf("  páginas: %lu escritas, %lu iguais; escrita: med %lu us, max %lu us; entrega: med %lu us, max %lu us\n",
+           (unsigned long)(stats.pages_written - last.pages_written),
+           (unsigned long)(stats.pages_skipped - last.pages_skipped),
+           (unsigned long)(flushed ? (stats.flush_us - last.flush_us) / flushed : 0), (unsigned long)display_core1.flush_max_us,
+           (unsigned long)(posted ? (stats.post_us - last.post_us) / posted : 0), (unsigned long)display_core1.post_max_us);
+    printf("  spin lock ocupado: núcleo 0 %lu, núcleo 1 %lu\n",
+           (unsigned long)(stats.contended[0] - last.contended[0]),
+           (unsigned long)(stats.contended[1] - last.contended[1]));
+
+    last = stats;
+    last_us = now;
+    display_core1.flush_max_us = 0;
+    display_core1.post_max_us = 0;
+}
+
+#endif /*DISPLAY_CORE1_H*/
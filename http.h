@@ -20,6 +20,223 @@
 #include "lwip/dns.h"             // Biblioteca de Funções DNS
 #include <time.h>                 // Biblioteca para manipulação de tempo
 #include "defines_functions.h"    // Arquivo contendo definições e funções para o projeto.
+#include "http_response.h"        // Arquivo contendo o analisador incremental de respostas HTTP.
+#include "log_ring.h"             // Registro binário de mensagens (`LOG_INFO`, `LOG_WARN`, ...).
+
+
+
+// ----------------------------------- Defines ----------------------------------
+
+#define THINGSPEAK_HOST "api.thingspeak.com"    // Host da API do ThingSpeak.
+#define THINGSPEAK_CHANNEL_ID "2838403"         // Identificador do canal no ThingSpeak.
+#define THINGSPEAK_API_KEY "JWR3PN07O0NANG46"   // Chave de escrita do canal no ThingSpeak.
+
+#define HTTP_CLIENT_MAX_SEGMENTS 6              // Quantidade máxima de trechos (fixos ou dinâmicos) de uma requisição.
+#define HTTP_CLIENT_BUF_SIZE 1280               // Tamanho do buffer para os trechos dinâmicos da requisição.
+#define HTTP_BACKOFF_MIN_MS 15000               // Espera após a primeira falha (intervalo mínimo do ThingSpeak).
+#define HTTP_BACKOFF_MAX_MS 240000              // Espera máxima entre envios após falhas seguidas.
+#define HTTP_CLIENT_TIMEOUT_MS 20000            // Tempo máximo de uma requisição, do envio até o fim da resposta.
+#define HTTP_CLIENT_POLL_INTERVAL 2             // Intervalo do `tcp_poll` do cliente (em ciclos de 500 ms do lwIP).
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura para armazenar um trecho da requisição HTTP.
+ *
+ * Um trecho aponta para um modelo constante (na flash) ou para uma parte do buffer
+ * da conexão; em ambos os casos é enviado sem cópia.
+ */
+typedef struct HTTP_SEGMENT_T_ {
+    const char *data;             // Início do trecho.
+    u16_t len;                    // Comprimento do trecho.
+} HTTP_SEGMENT_T;
+
+/**
+ * @brief Estrutura para armazenar o estado da conexão do cliente HTTP.
+ *
+ * Os trechos dinâmicos (valores das amostras, `Content-Length`) são formatados em `buf`,
+ * que pertence à conexão e só é reutilizado quando a requisição anterior termina.
+ */
+typedef struct HTTP_CLIENT_T_ {
+    struct tcp_pcb *pcb;          // PCB da conexão em andamento.
+    HTTP_SEGMENT_T segments[HTTP_CLIENT_MAX_SEGMENTS]; // Trechos da requisição, na ordem de envio.
+    uint8_t segment_count;        // Quantidade de trechos da requisição.
+    u16_t buf_len;                // Quantidade de bytes usados em `buf`.
+    char buf[HTTP_CLIENT_BUF_SIZE]; // Buffer para os trechos dinâmicos.
+    HTTP_RESPONSE_T response;     // Analisador da resposta da requisição em andamento.
+    uint32_t backoff_ms;          // Espera atual entre envios (cresce a cada falha seguida, zera com sucesso).
+    uint32_t hold_until_ms;       // Instante a partir do qual um novo envio é permitido.
+    uint32_t rate_limited;        // Quantidade de respostas recusadas por limite de taxa.
+    uint32_t failures;            // Quantidade de requisições que falharam (inclusive por limite de taxa).
+    uint32_t deadline_ms;         // Instante em que a requisição em andamento é abortada sem resposta.
+    uint32_t timeouts;            // Quantidade de requisições abortadas por tempo esgotado.
+} HTTP_CLIENT_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+volatile bool http_request_pending = false;    // Flag para indicar que há uma requisição HTTP em andamento.
+volatile bool http_request_ok = false;         // Flag para indicar que a última requisição foi respondida com sucesso (200).
+HTTP_CLIENT_T http_client;                     // Estado da conexão do cliente HTTP (uma requisição por vez).
+
+/* Trechos fixos da requisição GET de uma amostra. */
+static const char HTTP_GET_PREFIX[] = "GET /update?api_key=" THINGSPEAK_API_KEY "&field1=";
+static const char HTTP_GET_SUFFIX[] = " HTTP/1.1\r\n"
+                                      "Host: " THINGSPEAK_HOST "\r\n"
+                                      "Connection: close\r\n\r\n";
+
+
+// --------------------------- Funções para Montar a Requisição HTTP ---------------------------
+
+/**
+ * @brief Verifica se um novo envio é permitido.
+ *
+ * @return true se não há requisição em andamento e a espera imposta pelo limite de
+ *         taxa já passou, false caso contrário.
+ */
+bool http_client_ready(void) {
+    if (http_request_pending) return false;
+    return (int32_t)(to_ms_since_boot(get_absolute_time()) - http_client.hold_until_ms) >= 0;
+}
+
+/**
+ * @brief Descarta a requisição anterior e prepara o cliente para montar uma nova.
+ *
+ * @return HTTP_CLIENT_T* O cliente HTTP, ou NULL se o envio ainda não é permitido.
+ */
+HTTP_CLIENT_T *http_client_reset(void) {
+    if (!http_client_ready()) return NULL;
+    http_client.segment_count = 0;
+    http_client.buf_len = 0;
+    return &http_client;
+}
+
+/**
+ * @brief Adiciona um trecho à requisição.
+ *
+ * @param client Ponteiro para o cliente HTTP.
+ * @param data Início do trecho (precisa permanecer válido até o fim da requisição).
+ * @param len Comprimento do trecho.
+ * @return true se o trecho foi adicionado, false se a tabela de trechos está cheia.
+ */
+bool http_add_segment(HTTP_CLIENT_T *client, const char *data, u16_t len) {
+    if (client->segment_count == HTTP_CLIENT_MAX_SEGMENTS) return false;
+    client->segments[client->segment_count].data = data;
+    client->segments[client->segment_count].len = len;
+    client->segment_count++;
+    return true;
+}
+
+/**
+ * @brief Copia uma string para o buffer da conexão.
+ *
+ * @return true se houve espaço no buffer, false caso contrário.
+ */
+bool http_buf_append(HTTP_CLIENT_T *client, const char *str, u16_t len) {
+    if (client->buf_len + len > HTTP_CLIENT_BUF_SIZE) return false;
+    memcpy(client->buf + client->buf_len, str, len);
+    client->buf_len += len;
+    return true;
+}
+
+/**
+ * @brief Formata um valor em ponto fixo diretamente no buffer da conexão.
+ *
+ * @return true se houve espaço no buffer, false caso contrário.
+ */
+bool http_buf_append_fixed(HTTP_CLIENT_T *client, int32_t value, int decimals) {
+    char digits[16];
+    return http_buf_append(client, digits, fixed_to_str(value, decimals, digits));
+}
+
+/**
+ * @brief Formata um inteiro sem sinal diretamente no buffer da conexão.
+ *
+ * @return true se houve espaço no buffer, false caso contrário.
+ */
+bool http_buf_append_uint(HTTP_CLIENT_T *client, uint32_t value) {
+    return http_buf_append_fixed(client, (int32_t)value, 0);
+}
+
+
+// --------------------------- Função para Desassociar o PCB do Cliente ---------------------------
+
+/**
+ * @brief Remove os callbacks do cliente de um PCB que está sendo fechado ou abortado.
+ *
+ * Um PCB fechado continua na pilha até o fim do encerramento do TCP; sem os callbacks,
+ * ele não interfere na próxima requisição (que reutiliza `http_client`).
+ */
+static void http_client_detach(struct tcp_pcb *tpcb) {
+    tcp_arg(tpcb, NULL);
+    tcp_recv(tpcb, NULL);
+    tcp_err(tpcb, NULL);
+    tcp_poll(tpcb, NULL, 0);
+}
+
+
+// --------------------------- Funções de Conclusão da Requisição HTTP ---------------------------
+
+/**
+ * @brief Encerra a requisição em andamento como falha e adia o próximo envio.
+ *
+ * @param client Ponteiro para o cliente HTTP.
+ * @param retry_after_ms Espera mínima pedida pelo servidor (`Retry-After`), ou 0.
+ *
+ * Usada em todas as falhas: erro ou tempo esgotado da conexão, falha do DNS, resposta
+ * diferente de 2xx e limite de taxa. Sem ela, uma falha de transporte com amostras
+ * pendentes na flash faria uma nova conexão a cada rodada do serviço de rede.
+ *
+ * ### Comportamento:
+ * - Dobra a espera entre envios (de `HTTP_BACKOFF_MIN_MS` até `HTTP_BACKOFF_MAX_MS`),
+ *   respeitando `retry_after_ms` quando maior.
+ * - Limpa `http_request_ok` e libera a flag `http_request_pending`.
+ */
+static void http_client_fail(HTTP_CLIENT_T *client, uint32_t retry_after_ms) {
+    client->failures++;
+    client->backoff_ms = client->backoff_ms ? client->backoff_ms * 2 : HTTP_BACKOFF_MIN_MS;
+    if (client->backoff_ms > HTTP_BACKOFF_MAX_MS) client->backoff_ms = HTTP_BACKOFF_MAX_MS;
+    if (retry_after_ms > client->backoff_ms) client->backoff_ms = retry_after_ms;
+    client->hold_until_ms = to_ms_since_boot(get_absolute_time()) + client->backoff_ms;
+    LOG_WARN("Falha no envio HTTP: próximo envio em %lu ms", (uint32_t)client->backoff_ms);
+
+    client->pcb = NULL;
+    http_request_ok = false;
+    http_request_pending = false;
+}
+
+/**
+ * @brief Avalia a resposta recebida e encerra a requisição em andamento.
+ *
+ * @param client Ponteiro para o cliente HTTP.
+ *
+ * ### Comportamento:
+ * - Com sucesso, marca `http_request_ok` e volta ao intervalo normal (sem espera).
+ * - Com limite de taxa ou qualquer outra resposta, encerra como falha
+ *   (`http_client_fail`), respeitando o `Retry-After` quando presente.
+ * - Libera a flag `http_request_pending`.
+ */
+static void http_client_complete(HTTP_CLIENT_T *client) {
+    HTTP_RESPONSE_T *response = &client->response;
+    uint32_t entry_id = 0;
+
+    if (http_response_entry_id(response, &entry_id)) {
+        LOG_INFO("Resposta HTTP %u: entrada %lu", response->status, entry_id);
+    } else {
+        LOG_INFO("Resposta HTTP %u (%lu bytes de corpo)", response->status, (uint32_t)response->body_len);
+    }
+
+    if (!http_response_ok(response)) {
+        if (http_response_rate_limited(response)) client->rate_limited++;
+        http_client_fail(client, response->retry_after_s * 1000);
+        return;
+    }
+
+    client->backoff_ms = 0;
+    client->hold_until_ms = to_ms_since_boot(get_absolute_time());
+    client->pcb = NULL;
+    http_request_ok = true;
+    http_request_pending = false;
+}
 
 
 // --------------------------- Função de Callback para Processar Respostas HTTP ---------------------------
@@ -27,36 +244,137 @@
 /**
  * @brief Função de callback para processar respostas HTTP.
  *
- * @param arg Ponteiro para o argumento passado para o callback.
+ * @param arg Ponteiro para o cliente HTTP.
  * @param tpcb Ponteiro para o bloco de controle de protocolo TCP.
  * @param p Ponteiro para o buffer de pacotes contendo os dados recebidos.
  * @param err Código de erro indicando o status da operação de recebimento.
- * @return err_t Retorna ERR_OK em caso de sucesso, ou um código de erro apropriado em caso de falha.
+ * @return err_t Retorna ERR_OK em caso de sucesso, ou ERR_ABRT se a conexão foi abortada.
  *
- * Esta função é chamada quando uma resposta HTTP é recebida do servidor.
- * Ela processa a resposta, imprime o conteúdo e libera o buffer recebido.
+ * Esta função é chamada quando uma parte da resposta HTTP é recebida do servidor.
  *
  * ### Comportamento:
- * - Verifica se a conexão foi fechada pelo servidor.
- * - Processa a resposta HTTP e imprime o conteúdo.
- * - Libera o buffer recebido.
- *
- * @note O estado da conexão e o PCB são usados para gerenciar a conexão TCP.
+ * - Passa cada pbuf da cadeia ao analisador incremental, sem copiar os dados.
+ * - Informa ao lwIP os bytes consumidos com `tcp_recved`, reabrindo a janela de recepção.
+ * - Quando a resposta termina (ou é inválida), fecha a conexão sem esperar o servidor.
+ * - Se o servidor fechar a conexão antes, conclui a resposta com o que foi recebido.
  */
 static err_t http_client_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    HTTP_CLIENT_T *client = (HTTP_CLIENT_T *)arg;
+
     if (p == NULL) {
         // Conexão fechada pelo servidor
+        http_client_detach(tpcb);
         tcp_close(tpcb);
+        http_response_finish(&client->response);
+        http_client_complete(client);
         return ERR_OK;
     }
 
-    // Processa a resposta HTTP
-    char *response = (char *)p->payload;
-    printf("Resposta HTTP:\n%s\n", response);
-
-    // Libera o buffer recebido
+    for (struct pbuf *q = p; q != NULL; q = q->next) {
+        if (http_response_feed(&client->response, (const char *)q->payload, q->len) < q->len) break;
+    }
+    tcp_recved(tpcb, p->tot_len);
     pbuf_free(p);
 
+    HTTP_RESPONSE_STATE_T state = client->response.state;
+    if (state != HTTP_RESPONSE_DONE && state != HTTP_RESPONSE_ERROR) return ERR_OK;
+
+    // Resposta completa: encerra a conexão
+    http_client_detach(tpcb);
+    err_t close_err = tcp_close(tpcb);
+    http_client_complete(client);
+    if (close_err != ERR_OK) {
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+
+// --------------------------- Função de Callback para Erros da Conexão HTTP ---------------------------
+
+/**
+ * @brief Função de callback para erros na conexão HTTP.
+ *
+ * @param arg Ponteiro para o argumento passado para o callback.
+ * @param err Código de erro reportado pelo lwIP.
+ *
+ * Esta função é chamada pelo lwIP quando a conexão é abortada ou resetada.
+ * O PCB já foi liberado pela pilha nesse ponto, então a requisição é apenas
+ * encerrada como falha.
+ */
+static void http_client_err(void *arg, err_t err) {
+    HTTP_CLIENT_T *client = (HTTP_CLIENT_T *)arg;
+    LOG_WARN("Erro na conexão HTTP: %d", err);
+    http_client_fail(client, 0);
+}
+
+
+// --------------------------- Função de Callback do Tempo Limite da Requisição ---------------------------
+
+/**
+ * @brief Função de callback periódica da conexão HTTP (`tcp_poll`).
+ *
+ * @param arg Ponteiro para o cliente HTTP.
+ * @param tpcb Ponteiro para o bloco de controle de protocolo TCP.
+ * @return err_t ERR_OK, ou ERR_ABRT se a conexão foi abortada.
+ *
+ * Chamada pelo lwIP a cada `HTTP_CLIENT_POLL_INTERVAL` ciclos, inclusive durante a
+ * conexão. Um servidor que aceita a conexão e nunca responde manteria
+ * `http_request_pending` ativa para sempre e pararia o envio da telemetria.
+ *
+ * ### Comportamento:
+ * - Antes de `deadline_ms`, não faz nada.
+ * - Depois, aborta a conexão e encerra a requisição como falha (`http_client_fail`),
+ *   para que o lote seja tratado por `telemetry_complete`.
+ */
+static err_t http_client_poll(void *arg, struct tcp_pcb *tpcb) {
+    HTTP_CLIENT_T *client = (HTTP_CLIENT_T *)arg;
+    if ((int32_t)(to_ms_since_boot(get_absolute_time()) - client->deadline_ms) < 0) return ERR_OK;
+
+    LOG_WARN("Requisição HTTP sem resposta em %u ms: conexão abortada", HTTP_CLIENT_TIMEOUT_MS);
+    client->timeouts++;
+    http_client_detach(tpcb);
+    tcp_abort(tpcb);
+    http_client_fail(client, 0);
+    return ERR_ABRT;
+}
+
+
+// --------------------------- Função de Callback da Conexão Estabelecida ---------------------------
+
+/**
+ * @brief Função de callback chamada quando a conexão com o servidor é estabelecida.
+ *
+ * @param arg Ponteiro para o cliente HTTP.
+ * @param tpcb Ponteiro para o bloco de controle de protocolo TCP.
+ * @param err Código de erro (sempre ERR_OK no lwIP atual).
+ * @return err_t ERR_OK, ou ERR_ABRT se a conexão foi abortada.
+ *
+ * ### Comportamento:
+ * - Enfileira cada trecho com `tcp_write` sem a flag `TCP_WRITE_FLAG_COPY`: o lwIP
+ *   referencia diretamente a flash e o buffer da conexão.
+ * - Marca todos os trechos, exceto o último, com `TCP_WRITE_FLAG_MORE`.
+ * - Força o envio com `tcp_output`.
+ *
+ * @note O buffer só pode ser reutilizado quando o servidor fechar a conexão, momento em
+ *       que todos os dados já foram confirmados.
+ */
+static err_t http_client_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
+    HTTP_CLIENT_T *client = (HTTP_CLIENT_T *)arg;
+
+    for (uint8_t i = 0; i < client->segment_count; i++) {
+        u8_t flags = (i + 1 < client->segment_count) ? TCP_WRITE_FLAG_MORE : 0;
+        err_t write_err = tcp_write(tpcb, client->segments[i].data, client->segments[i].len, flags);
+        if (write_err != ERR_OK) {
+            LOG_ERROR("Erro ao enviar a solicitação HTTP: %d", write_err);
+            http_client_detach(tpcb);
+            tcp_abort(tpcb);
+            http_client_fail(client, 0);
+            return ERR_ABRT;
+        }
+    }
+    tcp_output(tpcb);
     return ERR_OK;
 }
 
@@ -68,7 +386,7 @@ static err_t http_client_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *
  *
  * @param name O nome do domínio que foi resolvido.
  * @param ipaddr Ponteiro para o endereço IP resolvido.
- * @param callback_arg Argumento passado para o callback.
+ * @param callback_arg Ponteiro para o cliente HTTP.
  *
  * Esta função é chamada quando uma resposta DNS é recebida.
  * Ela processa a resposta, imprime o endereço IP resolvido e tenta conectar ao servidor.
@@ -77,118 +395,126 @@ static err_t http_client_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *
  * - Verifica se o endereço IP foi resolvido com sucesso.
  * - Imprime o endereço IP resolvido.
  * - Tenta conectar ao servidor usando o endereço IP resolvido.
- * - Associa o callback de recepção e envia a solicitação HTTP.
+ * - Associa os callbacks de recepção, de erro, de tempo limite e de conexão; a
+ *   solicitação é enviada em `http_client_connected`.
  *
  * @note O estado da conexão e o PCB são usados para gerenciar a conexão TCP.
  */
 static void handle_dns_response(const char *name, const ip_addr_t *ipaddr, void *callback_arg) {
+    HTTP_CLIENT_T *client = (HTTP_CLIENT_T *)callback_arg;
+
     if (ipaddr == NULL) {
-        printf("Erro ao resolver o nome de domínio: %s\n", name);
+        LOG_WARN_S("Erro ao resolver o nome de domínio: %s", name);
+        http_client_fail(client, 0);
         return;
     }
 
-    printf("Nome de domínio resolvido: %s -> %s\n", name, ipaddr_ntoa(ipaddr));
+    const ip4_addr_t *ip4 = ip_2_ip4(ipaddr);
+    LOG_INFO("Nome de domínio resolvido: " THINGSPEAK_HOST " -> %u.%u.%u.%u", ip4_addr1(ip4), ip4_addr2(ip4), ip4_addr3(ip4), ip4_addr4(ip4));
 
     // Conecte ao servidor usando o endereço IP resolvido
     struct tcp_pcb *pcb = tcp_new();
     if (!pcb) {
-        printf("Erro ao criar PCB\n");
+        LOG_ERROR("Erro ao criar PCB");
+        http_client_fail(client, 0);
         return;
     }
+    client->pcb = pcb;
 
-    if (tcp_connect(pcb, ipaddr, 80, NULL) != ERR_OK) {
-        printf("Erro ao conectar ao servidor\n");
-        return;
-    }
-
-    // Associa o callback de recepção
+    // Associa o cliente e os callbacks de recepção e de erro
+    tcp_arg(pcb, client);
     tcp_recv(pcb, http_client_callback);
+    tcp_err(pcb, http_client_err);
+    tcp_poll(pcb, http_client_poll, HTTP_CLIENT_POLL_INTERVAL);
 
-    // Cria e envia a solicitação HTTP
-    const char *data = (const char *)callback_arg;
-    tcp_write(pcb, data, strlen(data), TCP_WRITE_FLAG_COPY);
+    if (tcp_connect(pcb, ipaddr, 80, http_client_connected) != ERR_OK) {
+        LOG_ERROR("Erro ao conectar ao servidor");
+        http_client_detach(pcb);
+        tcp_abort(pcb);
+        http_client_fail(client, 0);
+    }
 }
 
 
 // --------------------------- Função para Iniciar uma Solicitação HTTP ---------------------------
 
 /**
- * @brief Inicia uma solicitação HTTP.
- *
- * @param data Ponteiro para os dados da solicitação HTTP.
- * @param len Comprimento dos dados da solicitação HTTP.
+ * @brief Inicia a solicitação HTTP montada em `http_client`.
  *
- * Esta função inicia uma solicitação HTTP criando um PCB, resolvendo o nome de domínio
- * e conectando ao servidor. Ela também associa o callback de recepção e envia a solicitação HTTP.
+ * Esta função inicia uma solicitação HTTP resolvendo o nome de domínio do ThingSpeak.
+ * A conexão é feita em `handle_dns_response`, seja imediatamente (endereço em cache)
+ * ou quando a resolução do DNS terminar, e os trechos são enviados quando a conexão
+ * for estabelecida.
  *
  * ### Comportamento:
- * - Cria um novo PCB.
+ * - Marca a flag `http_request_pending` como ativa e limpa `http_request_ok`.
+ * - Define o prazo da requisição (`HTTP_CLIENT_TIMEOUT_MS`), verificado por `http_client_poll`
+ *   a partir da conexão; a resolução do DNS tem o seu próprio limite de tentativas no lwIP
+ *   e sempre termina chamando `handle_dns_response`.
  * - Resolve o nome de domínio usando DNS.
  * - Conecta ao servidor usando o endereço IP resolvido.
- * - Associa o callback de recepção.
- * - Cria e envia a solicitação HTTP.
+ * - Envia os trechos da requisição sem cópia.
  *
- * @note O estado da conexão e o PCB são usados para gerenciar a conexão TCP.
+ * @note A requisição deve ter sido montada após `http_client_reset`.
  */
-void star_http_request(const void *data, u16_t len) {
-    struct tcp_pcb *pcb = tcp_new();
-    if (!pcb) {
-        printf("Erro ao criar PCB\n");
-        //return;
-    }
+void http_client_send(void) {
+    HTTP_CLIENT_T *client = &http_client;
+    http_request_pending = true;
+    http_request_ok = false;
+    http_response_init(&client->response);
+    client->deadline_ms = to_ms_since_boot(get_absolute_time()) + HTTP_CLIENT_TIMEOUT_MS;
 
     ip_addr_t server_ip;
-    err_t err = dns_gethostbyname("api.thingspeak.com", &server_ip, handle_dns_response, (void *)data);
+    err_t err = dns_gethostbyname(THINGSPEAK_HOST, &server_ip, handle_dns_response, client);
     if (err == ERR_OK) {
         // O endereço IP foi resolvido imediatamente
-        handle_dns_response("api.thingspeak.com", &server_ip, (void *)data);
+        handle_dns_response(THINGSPEAK_HOST, &server_ip, client);
     } else if (err == ERR_INPROGRESS) {
         // A resolução do DNS está em andamento, o callback será chamado quando terminar
-        printf("Resolução do DNS em andamento...\n");
+        LOG_DEBUG("Resolução do DNS em andamento...");
     } else {
-        printf("Erro ao iniciar a resolução do DNS\n");
-        return;
-    }
-
-    if (tcp_connect(pcb, &server_ip, 80, NULL) != ERR_OK) {
-        printf("Erro ao conectar ao servidor\n");
-        //return;
+        LOG_ERROR("Erro ao iniciar a resolução do DNS");
+        http_client_fail(client, 0);
     }
-
-    // Associa o callback de recepção
-    tcp_recv(pcb, http_client_callback);
-
-    // Cria e envia a solicitação HTTP
-    tcp_write(pcb, data, len, TCP_WRITE_FLAG_COPY);
 }
 
 
-// --------------------------- Função para Criar a Solicitação HTTP POST com Dados JSON ---------------------------
+// --------------------------- Função para Criar a Solicitação HTTP GET ---------------------------
 
 /**
- * @brief Cria a solicitação HTTP POST com dados JSON.
+ * @brief Cria e envia a solicitação HTTP GET de uma amostra.
  *
  * @param temperatura A temperatura a ser enviada na solicitação HTTP.
  *
- * Esta função cria uma solicitação HTTP POST com dados JSON, incluindo a temperatura,
- * latitude e longitude geradas aleatoriamente. Ela então inicia a solicitação HTTP.
+ * Esta função cria uma solicitação HTTP GET com a temperatura, a latitude e a longitude
+ * geradas aleatoriamente. Ela então inicia a solicitação HTTP.
  *
  * ### Comportamento:
  * - Gera coordenadas aleatórias para latitude e longitude.
- * - Formata a solicitação HTTP com os dados fornecidos.
- * - Inicia a solicitação HTTP chamando `star_http_request`.
+ * - Formata apenas os valores, em ponto fixo, no buffer da conexão.
+ * - Monta a requisição com os trechos fixos `HTTP_GET_PREFIX` e `HTTP_GET_SUFFIX`.
+ * - Inicia a solicitação HTTP chamando `http_client_send`.
  *
  * @note A função depende da função `generate_random_coordinates` para gerar coordenadas aleatórias.
+ * @note Se houver uma requisição em andamento ou o servidor tiver imposto uma espera,
+ *       a amostra é descartada.
  */
 void build_http_request(float temperatura) {
-    char http_request[256]; // Buffer para a requisição HTTP
+    HTTP_CLIENT_T *client = http_client_reset();
+    if (!client) return;
 
     generate_random_coordinates(&lat, &lon);
-    snprintf(http_request, sizeof(http_request),
-             "GET /update?api_key=JWR3PN07O0NANG46&field1=%.2f&field2=%.6f&field3=%.6f HTTP/1.1\r\n"
-             "Host: api.thingspeak.com\r\n"
-             "Connection: close\r\n\r\n", temperatura, lat, lon);
-    star_http_request(http_request, strlen(http_request));
+
+    http_buf_append_fixed(client, float_to_fixed(temperatura, 2), 2);
+    http_buf_append(client, "&field2=", 8);
+    http_buf_append_fixed(client, float_to_fixed(lat, 6), 6);
+    http_buf_append(client, "&field3=", 8);
+    http_buf_append_fixed(client, float_to_fixed(lon, 6), 6);
+
+    http_add_segment(client, HTTP_GET_PREFIX, sizeof(HTTP_GET_PREFIX) - 1);
+    http_add_segment(client, client->buf, client->buf_len);
+    http_add_segment(client, HTTP_GET_SUFFIX, sizeof(HTTP_GET_SUFFIX) - 1);
+    http_client_send();
 }
 
 
@@ -216,7 +542,7 @@ void shutdown_tcp_server(TCP_SERVER_T *server_state) {
         tcp_server_close(server_state);
         free(server_state);
     }
-    DEBUG_printf("Servidor TCP fechado e porta 80 liberada.\n");
+    LOG_INFO("Servidor TCP fechado e porta 80 liberada.");
 }
 
 #endif /*HTTP_H*/
\ No newline at end of file
@@ -0,0 +1,345 @@
+/******************************************************************************
+ * @file    http_response.h
+ * @brief   Arquivo contendo o analisador incremental de respostas HTTP/1.1
+ *          usado pelo cliente de envio de telemetria.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    O analisador recebe os dados em pedaços de qualquer tamanho (cada
+ *          pbuf da cadeia, sem cópia), reconhece a linha de status, os
+ *          cabeçalhos `Content-Length`, `Transfer-Encoding: chunked` e
+ *          `Retry-After`, e guarda apenas o início do corpo, suficiente para
+ *          o número da entrada (ou "0") retornado pelo ThingSpeak.
+ ******************************************************************************/
+
+#ifndef HTTP_RESPONSE_H
+#define HTTP_RESPONSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// ----------------------------------- Defines ----------------------------------
+
+#define HTTP_RESPONSE_LINE_SIZE 64      // Tamanho máximo guardado de cada linha (linhas maiores são truncadas).
+#define HTTP_RESPONSE_BODY_SIZE 24      // Quantidade de bytes guardados do início do corpo.
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estados do analisador de respostas HTTP.
+ */
+typedef enum {
+    HTTP_RESPONSE_STATUS_LINE,    // Aguardando a linha de status.
+    HTTP_RESPONSE_HEADER,         // Lendo os cabeçalhos.
+    HTTP_RESPONSE_BODY,           // Lendo o corpo (por Content-Length ou até o fechamento).
+    HTTP_RESPONSE_CHUNK_SIZE,     // Lendo a linha com o tamanho do chunk.
+    HTTP_RESPONSE_CHUNK_DATA,     // Lendo os dados do chunk.
+    HTTP_RESPONSE_CHUNK_END,      // Aguardando o CRLF ao fim dos dados do chunk.
+    HTTP_RESPONSE_TRAILER,        // Lendo os cabeçalhos finais após o último chunk.
+    HTTP_RESPONSE_DONE,           // Resposta completa.
+    HTTP_RESPONSE_ERROR           // Resposta malformada.
+} HTTP_RESPONSE_STATE_T;
+
+/**
+ * @brief Estrutura para armazenar o estado do analisador e o resultado da resposta.
+ */
+typedef struct HTTP_RESPONSE_T_ {
+    HTTP_RESPONSE_STATE_T state;  // Estado atual do analisador.
+    uint16_t status;              // Código de status da resposta.
+    bool chunked;                 // Flag para indicar `Transfer-Encoding: chunked`.
+    int32_t content_length;       // Valor do `Content-Length`, ou -1 se ausente.
+    uint32_t retry_after_s;       // Valor do `Retry-After` em segundos, ou 0 se ausente.
+    uint32_t remaining;           // Bytes restantes do corpo (ou do chunk atual).
+    uint32_t body_len;            // Total de bytes do corpo recebidos.
+    char line[HTTP_RESPONSE_LINE_SIZE]; // Linha em leitura (status, cabeçalho ou tamanho do chunk).
+    uint8_t line_len;             // Comprimento da linha em leitura.
+    char body[HTTP_RESPONSE_BODY_SIZE]; // Início do corpo.
+    uint8_t body_stored;          // Quantidade de bytes guardados em `body`.
+} HTTP_RESPONSE_T;
+
+
+// --------------------------- Função para Reiniciar o Analisador ---------------------------
+
+/**
+ * @brief Prepara o analisador para uma nova resposta.
+ */
+void http_response_init(HTTP_RESPONSE_T *response) {
+    memset(response, 0, sizeof(*response));
+    response->state = HTTP_RESPONSE_STATUS_LINE;
+    response->content_length = -1;
+}
+
+
+// --------------------------- Funções Auxiliares de Conversão ---------------------------
+
+/**
+ * @brief Compara o nome de um cabeçalho (sem diferenciar maiúsculas e minúsculas).
+ *
+ * @param line A linha do cabeçalho.
+ * @param name_len Comprimento do nome do cabeçalho na linha (até o ':').
+ * @param name O nome esperado, em minúsculas.
+ */
+static bool http_response_header_is(const char *line, uint8_t name_len, const char *name) {
+    if (name_len != strlen(name)) return false;
+    for (uint8_t i = 0; i < name_len; i++) {
+        char c = line[i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c != name[i]) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Converte um número decimal sem sinal (até 9 dígitos).
+ *
+ * @return O valor convertido, ou -1 se o texto não for um número válido.
+ */
+static int32_t http_response_parse_uint(const char *str, uint8_t len) {
+    while (len && *str == ' ') { str++; len--; }
+    while (len && str[len - 1] == ' ') len--;
+    if (len == 0 || len > 9) return -1;
+
+    int32_t value = 0;
+    for (uint8_t i = 0; i < len; i++) {
+        if (str[i] < '0' || str[i] > '9') return -1;
+        value = value * 10 + (str[i] - '0');
+    }
+    return value;
+}
+
+
+// --------------------------- Função de Processamento de uma Linha ---------------------------
+
+/**
+ * @brief Trata uma linha completa (sem o CRLF) de acordo com o estado atual.
+ *
+ * ### Comportamento:
+ * - Linha de status: valida o prefixo `HTTP/1.` e extrai o código de três dígitos.
+ * - Cabeçalhos: registra `Content-Length`, `Transfer-Encoding` e `Retry-After`; a linha
+ *   vazia define o enquadramento do corpo (chunked, tamanho fixo ou até o fechamento).
+ * - Respostas 1xx são descartadas e 204/304 não têm corpo.
+ * - Tamanho do chunk: interpreta o valor hexadecimal (ignorando extensões após ';').
+ */
+static void http_response_line(HTTP_RESPONSE_T *response) {
+    const char *line = response->line;
+    uint8_t len = response->line_len;
+
+    switch (response->state) {
+    case HTTP_RESPONSE_STATUS_LINE:
+        if (len < 12 || strncmp(line, "HTTP/1.", 7) != 0 || line[8] != ' ') {
+            response->state = HTTP_RESPONSE_ERROR;
+            return;
+        }
+        response->status = 0;
+        for (int i = 9; i < 12; i++) {
+            if (line[i] < '0' || line[i] > '9') {
+                response->state = HTTP_RESPONSE_ERROR;
+                return;
+            }
+            response->status = response->status * 10 + (line[i] - '0');
+        }
+        response->state = HTTP_RESPONSE_HEADER;
+        break;
+
+    case HTTP_RESPONSE_HEADER:
+        if (len == 0) {
+            // Fim dos cabeçalhos
+            if (response->status >= 100 && response->status < 200) {
+                response->chunked = false;
+                response->content_length = -1;
+                response->state = HTTP_RESPONSE_STATUS_LINE;
+            } else if (response->status == 204 || response->status == 304) {
+                response->state = HTTP_RESPONSE_DONE;
+            } else if (response->chunked) {
+                response->state = HTTP_RESPONSE_CHUNK_SIZE;
+            } else if (response->content_length >= 0) {
+                response->remaining = response->content_length;
+                response->state = response->remaining ? HTTP_RESPONSE_BODY : HTTP_RESPONSE_DONE;
+            } else {
+                response->remaining = UINT32_MAX;
+                response->state = HTTP_RESPONSE_BODY;
+            }
+            return;
+        }
+
+        const char *colon = memchr(line, ':', len);
+        if (!colon) return;
+        uint8_t name_len = colon - line;
+        const char *value = colon + 1;
+        uint8_t value_len = len - name_len - 1;
+
+        if (http_response_header_is(line, name_len, "content-length")) {
+            response->content_length = http_response_parse_uint(value, value_len);
+            if (response->content_length < 0) response->state = HTTP_RESPONSE_ERROR;
+        } else if (http_response_header_is(line, name_len, "transfer-encoding")) {
+            for (uint8_t i = 0; i + 7 <= value_len; i++) {
+                if (strncmp(value + i, "chunked", 7) == 0) response->chunked = true;
+            }
+        } else if (http_response_header_is(line, name_len, "retry-after")) {
+            int32_t seconds = http_response_parse_uint(value, value_len);
+            if (seconds > 0) response->retry_after_s = seconds;
+        }
+        break;
+
+    case HTTP_RESPONSE_CHUNK_SIZE: {
+        uint32_t size = 0;
+        uint8_t digits = 0;
+        for (uint8_t i = 0; i < len && line[i] != ';' && line[i] != ' '; i++) {
+            char c = line[i];
+            int nibble = (c >= '0' && c <= '9') ? c - '0'
+                       : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                       : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+            if (nibble < 0 || ++digits > 7) {
+                response->state = HTTP_RESPONSE_ERROR;
+                return;
+            }
+            size = (size << 4) | nibble;
+        }
+        if (digits == 0) {
+            response->state = HTTP_RESPONSE_ERROR;
+        } else if (size == 0) {
+            response->state = HTTP_RESPONSE_TRAILER;
+        } else {
+            response->remaining = size;
+            response->state = HTTP_RESPONSE_CHUNK_DATA;
+        }
+        break;
+    }
+
+    case HTTP_RESPONSE_CHUNK_END:
+        response->state = (len == 0) ? HTTP_RESPONSE_CHUNK_SIZE : HTTP_RESPONSE_ERROR;
+        break;
+
+    case HTTP_RESPONSE_TRAILER:
+        if (len == 0) response->state = HTTP_RESPONSE_DONE;
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+// --------------------------- Função para Processar um Trecho da Resposta ---------------------------
+
+/**
+ * @brief Processa um trecho da resposta, de qualquer tamanho.
+ *
+ * @param response Ponteiro para o estado do analisador.
+ * @param data Início do trecho (por exemplo, o `payload` de um pbuf da cadeia).
+ * @param len Comprimento do trecho.
+ * @return uint16_t A quantidade de bytes consumidos (menor que `len` se a resposta
+ *         terminou ou é inválida).
+ *
+ * ### Comportamento:
+ * - Linhas de status, cabeçalhos e tamanhos de chunk são acumulados em `line` até o '\n'.
+ * - Os bytes do corpo são contados em blocos, guardando apenas os primeiros
+ *   `HTTP_RESPONSE_BODY_SIZE` bytes.
+ */
+uint16_t http_response_feed(HTTP_RESPONSE_T *response, const char *data, uint16_t len) {
+    uint16_t i = 0;
+
+    while (i < len) {
+        HTTP_RESPONSE_STATE_T state = response->state;
+        if (state == HTTP_RESPONSE_DONE || state == HTTP_RESPONSE_ERROR) break;
+
+        if (state == HTTP_RESPONSE_BODY || state == HTTP_RESPONSE_CHUNK_DATA) {
+            uint32_t n = len - i;
+            if (n > response->remaining) n = response->remaining;
+
+            uint32_t room = HTTP_RESPONSE_BODY_SIZE - response->body_stored;
+            if (room) {
+                uint32_t copy = n < room ? n : room;
+                memcpy(response->body + response->body_stored, data + i, copy);
+                response->body_stored += copy;
+            }
+            response->body_len += n;
+            i += n;
+
+            // Corpo até o fechamento da conexão: `remaining` nunca chega a zero
+            if (response->remaining != UINT32_MAX) response->remaining -= n;
+            if (response->remaining == 0) {
+                response->state = (state == HTTP_RESPONSE_BODY) ? HTTP_RESPONSE_DONE : HTTP_RESPONSE_CHUNK_END;
+            }
+            continue;
+        }
+
+        char c = data[i++];
+        if (c == '\n') {
+            if (response->line_len && response->line[response->line_len - 1] == '\r') response->line_len--;
+            http_response_line(response);
+            response->line_len = 0;
+        } else if (response->line_len < HTTP_RESPONSE_LINE_SIZE) {
+            response->line[response->line_len++] = c;
+        }
+    }
+    return i;
+}
+
+
+// --------------------------- Função de Fim da Conexão ---------------------------
+
+/**
+ * @brief Informa ao analisador que o servidor fechou a conexão.
+ *
+ * Um corpo sem `Content-Length` nem chunked termina no fechamento; em qualquer outro
+ * estado intermediário a resposta está truncada.
+ */
+void http_response_finish(HTTP_RESPONSE_T *response) {
+    if (response->state == HTTP_RESPONSE_BODY && response->remaining == UINT32_MAX) {
+        response->state = HTTP_RESPONSE_DONE;
+    } else if (response->state != HTTP_RESPONSE_DONE) {
+        response->state = HTTP_RESPONSE_ERROR;
+    }
+}
+
+
+// --------------------------- Funções de Consulta do Resultado ---------------------------
+
+/**
+ * @brief Obtém o número da entrada criada, quando o corpo é um número decimal.
+ *
+ * @param response Ponteiro para a resposta completa.
+ * @param entry_id Ponteiro para armazenar o número da entrada.
+ * @return true se o corpo é apenas um número, false caso contrário.
+ */
+bool http_response_entry_id(const HTTP_RESPONSE_T *response, uint32_t *entry_id) {
+    uint8_t len = response->body_stored;
+    while (len && (response->body[len - 1] == '\r' || response->body[len - 1] == '\n' || response->body[len - 1] == ' ')) len--;
+    if (response->body_len != response->body_stored) return false;
+
+    int32_t value = http_response_parse_uint(response->body, len);
+    if (value < 0) return false;
+    *entry_id = value;
+    return true;
+}
+
+/**
+ * @brief Verifica se o servidor recusou a atualização por limite de taxa.
+ *
+ * O ThingSpeak responde 429 no bulk update e "0" (com status 200) no update simples.
+ */
+bool http_response_rate_limited(const HTTP_RESPONSE_T *response) {
+    uint32_t entry_id;
+    if (response->status == 429) return true;
+    return response->state == HTTP_RESPONSE_DONE && http_response_entry_id(response, &entry_id) && entry_id == 0;
+}
+
+/**
+ * @brief Verifica se a resposta confirma o recebimento dos dados.
+ *
+ * @return true se a resposta está completa, tem status 2xx, não indica limite de taxa
+ *         e o corpo JSON (bulk update) não é `{"success":false}`.
+ */
+bool http_response_ok(const HTTP_RESPONSE_T *response) {
+    static const char failure[] = "{\"success\":false";
+    if (response->state != HTTP_RESPONSE_DONE) return false;
+    if (response->status < 200 || response->status > 299) return false;
+    if (http_response_rate_limited(response)) return false;
+    return !(response->body_stored >= sizeof(failure) - 1 && strncmp(response->body, failure, sizeof(failure) - 1) == 0);
+}
+
+#endif /*HTTP_RESPONSE_H*/
@@ -0,0 +1,46 @@
+/******************************************************************************
+ * @file    live_telemetry.h
+ * @brief   Arquivo contendo a publicação das amostras de telemetria para os
+ *          clientes da rede local (`/api/telemetry` e `/events`).
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    Cada amostra é serializada uma única vez; o servidor HTTP envia o
+ *          mesmo buffer para todos os clientes, qualquer que seja o número deles.
+ ******************************************************************************/
+
+#ifndef LIVE_TELEMETRY_H
+#define LIVE_TELEMETRY_H
+
+#include "ap_mode/ap_mode_utility.h"    // Servidor HTTP (rotas `/api/telemetry` e `/events`).
+#include "defines_functions.h"          // Arquivo contendo `float_to_fixed` e `fixed_to_str`.
+
+// --------------------------- Função para Publicar uma Amostra ---------------------------
+
+/**
+ * @brief Serializa uma amostra em JSON e a publica no servidor HTTP.
+ *
+ * @param temperature A temperatura lida.
+ * @param lat A latitude associada à amostra.
+ * @param lon A longitude associada à amostra.
+ *
+ * Formato: `{"seq":N,"t":ms,"temperature":T,"unit":"C","lat":LAT,"lon":LON}`, com os
+ * números formatados em ponto fixo (mesma precisão do envio via MQTT).
+ */
+void live_telemetry_publish(float temperature, float lat, float lon) {
+    char json[LIVE_JSON_SIZE];
+    int len = snprintf(json, sizeof(json), "{\"seq\":%lu,\"t\":%lu,\"temperature\":",
+                       (unsigned long)(live_feed.seq + 1), (unsigned long)to_ms_since_boot(get_absolute_time()));
+    len += fixed_to_str(float_to_fixed(temperature, 2), 2, json + len);
+    len += sprintf(json + len, ",\"unit\":\"%c\",\"lat\":", TEMPERATURE_UNITS);
+    len += fixed_to_str(float_to_fixed(lat, 6), 6, json + len);
+    memcpy(json + len, ",\"lon\":", 7); len += 7;
+    len += fixed_to_str(float_to_fixed(lon, 6), 6, json + len);
+    json[len++] = '}';
+
+    tcp_server_publish(json, len);
+}
+
+#endif /*LIVE_TELEMETRY_H*/
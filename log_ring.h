@@ -0,0 +1,286 @@
+/******************************************************************************
+ * @file    log_ring.h
+ * @brief   Arquivo contendo o registro binário de mensagens: buffers circulares
+ *          por núcleo, escrita sem formatação e sem bloqueio a partir de qualquer
+ *          contexto, e envio ao console por uma tarefa de baixa prioridade.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    Cada registro guarda o instante (`time_us_32`), o endereço da string de
+ *          formato (que fica na flash e serve de identificador), o nível, o núcleo
+ *          e até `LOG_MAX_ARGS` argumentos de 32 bits. Nada é formatado no
+ *          dispositivo: a tarefa `log_drain` envia cada registro em hexadecimal,
+ *          em uma linha `#L...`, e `tools/log_decode.py` o formata no computador a
+ *          partir do ELF do firmware. As demais linhas do console passam inalteradas.
+ *
+ * @note    Os níveis acima de `LOG_LEVEL` são eliminados na compilação (as macros
+ *          viram `((void)0)`), junto com as suas strings de formato.
+ ******************************************************************************/
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "pico/stdlib.h"                // Biblioteca padrão para Raspberry Pi Pico (`time_us_32`, `puts_raw`).
+#include "hardware/sync.h"              // Interrupções e barreira de memória `__dmb`.
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"             // `stdio_usb_connected`.
+#endif
+
+// ----------------------------------- Defines ----------------------------------
+
+#define LOG_LEVEL_NONE 0                // Nenhum registro.
+#define LOG_LEVEL_ERROR 1               // Falhas que impedem uma operação.
+#define LOG_LEVEL_WARN 2                // Situações anormais recuperadas (recursos esgotados, entradas inválidas).
+#define LOG_LEVEL_INFO 3                // Eventos de ciclo de vida (servidor iniciado, cliente inscrito).
+#define LOG_LEVEL_DEBUG 4               // Rastreamento dos caminhos quentes (recepção, envio, conexões).
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO        // Níveis compilados (pode ser definido com -DLOG_LEVEL=...).
+#endif
+
+#define LOG_RING_SIZE 64                // Registros no buffer de cada núcleo.
+#define LOG_MAX_ARGS 6                  // Argumentos de 32 bits por registro.
+#define LOG_DRAIN_BATCH 16              // Registros enviados por execução da tarefa de envio.
+#define LOG_FLAG_TEXT 0x01              // Os argumentos são strings copiadas (separadas por NUL), não palavras.
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura para armazenar um registro (enviado byte a byte, little-endian).
+ */
+typedef struct LOG_RECORD_T_ {
+    uint32_t timestamp_us;        // Instante do registro (`time_us_32`).
+    uint32_t fmt;                 // Endereço da string de formato na flash.
+    uint8_t level;                // Nível (`LOG_LEVEL_*`).
+    uint8_t core;                 // Núcleo que registrou.
+    uint8_t size;                 // Argumentos: palavras usadas ou, com `LOG_FLAG_TEXT`, bytes de texto.
+    uint8_t flags;                // `LOG_FLAG_*`.
+    union {
+        uint32_t args[LOG_MAX_ARGS];            // Argumentos inteiros ou ponteiros.
+        char text[LOG_MAX_ARGS * 4];            // Strings copiadas, terminadas em NUL.
+    };
+} LOG_RECORD_T;
+
+/**
+ * @brief Estrutura para armazenar o buffer circular de registros de um núcleo.
+ *
+ * Só o núcleo dono escreve `head` (com as interrupções desabilitadas, então tarefas e
+ * interrupções do mesmo núcleo não se misturam); só a tarefa de envio escreve `tail`.
+ */
+typedef struct LOG_RING_T_ {
+    LOG_RECORD_T records[LOG_RING_SIZE]; // Registros aguardando envio.
+    volatile uint32_t head;       // Próxima posição a escrever.
+    volatile uint32_t tail;       // Próxima posição a enviar.
+    volatile uint32_t dropped;    // Registros descartados com o buffer cheio.
+} LOG_RING_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+LOG_RING_T log_rings[2] = {0};          // Buffers de registros de cada núcleo.
+
+// --------------------------- Macros de Registro ---------------------------
+
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+
+/*
+ * LOG_<NIVEL>(fmt, ...)   argumentos inteiros ou ponteiros de 32 bits (um `%s` com ponteiro
+ *                         para a flash é resolvido pelo decodificador a partir do ELF).
+ * LOG_<NIVEL>_S(fmt, ...) apenas strings em RAM, copiadas para o registro (truncadas em
+ *                         `LOG_MAX_ARGS * 4` bytes no total).
+ */
+#define LOG_WRITE(level, fmt, ...) log_write(level, fmt, LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+#define LOG_WRITE_S(level, fmt, ...) log_write_text(level, fmt, LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) LOG_WRITE(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_ERROR_S(fmt, ...) LOG_WRITE_S(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) ((void)0)
+#define LOG_ERROR_S(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) LOG_WRITE(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_WARN_S(fmt, ...) LOG_WRITE_S(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) ((void)0)
+#define LOG_WARN_S(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) LOG_WRITE(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_INFO_S(fmt, ...) LOG_WRITE_S(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) ((void)0)
+#define LOG_INFO_S(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) LOG_WRITE(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG_S(fmt, ...) LOG_WRITE_S(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) ((void)0)
+#define LOG_DEBUG_S(fmt, ...) ((void)0)
+#endif
+
+// --------------------------- Funções de Reserva e Publicação ---------------------------
+
+/**
+ * @brief Reserva o próximo registro do buffer do núcleo atual, com as interrupções desabilitadas.
+ *
+ * @return O registro reservado, ou NULL com o buffer cheio (o registro é descartado e
+ *         as interrupções já foram restauradas).
+ */
+static LOG_RECORD_T *log_reserve(uint8_t level, const char *fmt, uint32_t *irq_state) {
+    uint core = get_core_num();
+    LOG_RING_T *ring = &log_rings[core];
+
+    *irq_state = save_and_disable_interrupts();
+    if (ring->head - ring->tail == LOG_RING_SIZE) {
+        ring->dropped++;
+        restore_interrupts(*irq_state);
+        return NULL;
+    }
+
+    LOG_RECORD_T *record = &ring->records[ring->head % LOG_RING_SIZE];
+    record->timestamp_us = time_us_32();
+    record->fmt = (uint32_t)(uintptr_t)fmt;
+    record->level = level;
+    record->core = core;
+    return record;
+}
+
+static void log_commit(uint32_t irq_state) {
+    LOG_RING_T *ring = &log_rings[get_core_num()];
+    __dmb();                            // O registro fica visível antes do novo `head`
+    ring->head++;
+    restore_interrupts(irq_state);
+}
+
+// --------------------------- Funções de Escrita ---------------------------
+
+/**
+ * @brief Grava um registro com argumentos inteiros (use as macros `LOG_<NIVEL>`).
+ *
+ * @param level Nível do registro.
+ * @param fmt String de formato (literal, na flash).
+ * @param nargs Quantidade de argumentos (até `LOG_MAX_ARGS`; os excedentes são ignorados).
+ *
+ * @note Não formata, não aloca e não bloqueia; pode ser chamada de interrupções e de
+ *       callbacks do lwIP. Os argumentos devem ter 32 bits (inteiros até `long`, ponteiros).
+ */
+void log_write(uint8_t level, const char *fmt, int nargs, ...) {
+    uint32_t irq_state;
+    LOG_RECORD_T *record = log_reserve(level, fmt, &irq_state);
+    if (!record) return;
+
+    if (nargs > LOG_MAX_ARGS) nargs = LOG_MAX_ARGS;
+    va_list ap;
+    va_start(ap, nargs);
+    for (int i = 0; i < nargs; i++) {
+        record->args[i] = va_arg(ap, uint32_t);
+    }
+    va_end(ap);
+    record->size = nargs;
+    record->flags = 0;
+
+    log_commit(irq_state);
+}
+
+/**
+ * @brief Grava um registro copiando strings em RAM (use as macros `LOG_<NIVEL>_S`).
+ *
+ * As strings são copiadas uma após a outra, cada uma terminada em NUL, até ocupar
+ * `LOG_MAX_ARGS * 4` bytes; a última que não couber é truncada.
+ */
+void log_write_text(uint8_t level, const char *fmt, int nargs, ...) {
+    uint32_t irq_state;
+    LOG_RECORD_T *record = log_reserve(level, fmt, &irq_state);
+    if (!record) return;
+
+    int len = 0;
+    va_list ap;
+    va_start(ap, nargs);
+    for (int i = 0; i < nargs && len < (int)sizeof(record->text); i++) {
+        const char *str = va_arg(ap, const char *);
+        int room = (int)sizeof(record->text) - len - 1;
+        int n = str ? (int)strnlen(str, room) : 0;
+        if (n) memcpy(record->text + len, str, n);
+        len += n;
+        record->text[len++] = '\0';
+    }
+    va_end(ap);
+    record->size = len;
+    record->flags = LOG_FLAG_TEXT;
+
+    log_commit(irq_state);
+}
+
+// --------------------------- Função de Envio ---------------------------
+
+static char *log_hex(char *out, const uint8_t *data, int len) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < len; i++) {
+        *out++ = digits[data[i] >> 4];
+        *out++ = digits[data[i] & 0x0f];
+    }
+    return out;
+}
+
+/**
+ * @brief Envia ao console os registros pendentes dos dois núcleos, em hexadecimal.
+ *
+ * Esta função é executada pelo escalonador em prioridade baixa; envia no máximo
+ * `LOG_DRAIN_BATCH` registros por execução, do núcleo 0 e depois do núcleo 1.
+ *
+ * ### Comportamento:
+ * - Sem computador conectado ao USB, não envia nada: os registros esperam no buffer
+ *   (com o buffer cheio, os novos são descartados e contados).
+ * - Cada registro vira uma linha `#L` seguida dos bytes usados do registro.
+ * - Registros descartados são informados em uma linha de texto.
+ *
+ * @param arg Não utilizado (assinatura de tarefa, para ser registrada com `sched_task_add`).
+ */
+void log_drain(void *arg) {
+    static uint32_t reported[2];        // Descartes já informados de cada núcleo
+#if LIB_PICO_STDIO_USB
+    if (!stdio_usb_connected()) return;
+#endif
+
+    char line[3 + 2 * sizeof(LOG_RECORD_T)];
+    int budget = LOG_DRAIN_BATCH;
+    for (int core = 0; core < 2; core++) {
+        LOG_RING_T *ring = &log_rings[core];
+
+        uint32_t dropped = ring->dropped;
+        if (dropped != reported[core]) {
+            printf("Log: %lu registros descartados (núcleo %d)\n", (unsigned long)(dropped - reported[core]), core);
+            reported[core] = dropped;
+        }
+
+        while (budget > 0 && ring->tail != ring->head) {
+            __dmb();                    // Lê o registro somente depois de ver o novo `head`
+            const LOG_RECORD_T *record = &ring->records[ring->tail % LOG_RING_SIZE];
+            int size = offsetof(LOG_RECORD_T, args) + ((record->flags & LOG_FLAG_TEXT) ? record->size : record->size * 4);
+
+            char *out = line;
+            *out++ = '#';
+            *out++ = 'L';
+            out = log_hex(out, (const uint8_t *)record, size);
+            *out = '\0';
+
+            ring->tail++;
+            puts_raw(line);
+            budget--;
+        }
+    }
+}
+
+#endif /*LOG_RING_H*/
@@ -21,6 +21,8 @@
 #define MEM_ALIGNMENT               4
 #define MEM_SIZE                    4000
 #define MEMP_NUM_TCP_SEG            64 // Modified from 32 to 64
+#define MEMP_NUM_TCP_PCB            10 // Added: conexões simultâneas do servidor do modo AP e clientes HTTP/MQTT
+#define TCP_LISTEN_BACKLOG          1  // Added: habilita o backlog de tcp_listen_with_backlog
 #define MEMP_NUM_SYS_TIMEOUT        16 // Added
 #define MEMP_NUM_ARP_QUEUE          10
 #define PBUF_POOL_SIZE              32 // Modified from 24 to 32
@@ -48,7 +50,7 @@
 #define LWIP_UDP                    1
 #define LWIP_DNS                    1
 #define LWIP_TCP_KEEPALIVE          1
-#define LWIP_NETIF_TX_SINGLE_PBUF   1
+#define LWIP_NETIF_TX_SINGLE_PBUF   0 // Com 1 o lwIP copia todo tcp_write (ignora o envio sem cópia)
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
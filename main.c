@@ -5,15 +5,126 @@
 
 /*
     Alguns pontos importantes a serem destacados:
-    1 - Nessa etapa do projeto, apenas dispositivos Android conseguem enviar a senha para o Raspberry Pi Pico W, em iOS e notebooks não foi possível devido a diferentes requisições HTTP geradas
+    1 - A requisição HTTP é acumulada até o fim do corpo (Content-Length), então o envio da senha funciona também em iOS e notebooks, que dividem os cabeçalhos e o corpo do POST em segmentos TCP diferentes
     2 - Link do ThingSpeak: https://thingspeak.mathworks.com/channels/2838403
     3 - Link do vídeo de demonstração: https://youtube.com/shorts/M_ZbwZbM4-g?si=VA5z2ySlKUF2r0dz
     4 - A aplicação iniciará com o AP Mode habilitado e apenas entrará no Menu principal quando alguém clicar no botão de enviar e for retornado Sucesso no envio das credenciais
     5 - A navegação dentro do menu é dada pelo joystick e botão B (ENTER).
     4 - Se o ssid ou senha do wifi for escrito incorretamente, só será visível quando já no menu, o usuário clicar em <System Setup> e imprimir o erro e necessidade de reiniciar a placa para enviar novamente
+    6 - Após a primeira conexão bem sucedida, as credenciais ficam gravadas na flash (storage/credential_store.h): nos boots seguintes o dispositivo conecta direto e só inicia o modo AP se a conexão falhar
+    7 - O laço principal é um escalonador cooperativo (scheduler.h): entrada, renderização, amostragem, envio e rede são tarefas com período e prioridade próprios, e o console imprime periodicamente o tempo gasto por cada uma
+    8 - A amostragem não chama o lwIP: posta a amostra na caixa de mensagens do serviço de rede (net_service.h), que a publica com o lwIP travado e mede a latência da leitura do ADC até o segmento TCP
+    9 - Sem uso por 30 s o display escurece; por 2 min o painel desliga, o rádio entra em economia e o relógio cai para 48 MHz (power_idle.h). Qualquer botão, o joystick ou um comando remoto acorda o display
+    10 - As mensagens de depuração do servidor HTTP são registros binários (log_ring.h), enviados ao console pela tarefa de baixa prioridade e decodificados no computador com tools/log_decode.py
 */
 
 
+static TCP_SERVER_T *state;             // Estado do servidor TCP do modo AP
+static dhcp_server_t dhcp_server;       // Servidor DHCP do modo AP
+static dns_server_t dns_server;         // Servidor DNS do modo AP
+
+/*------------------------------ Tarefas do laço principal ------------------------------*/
+
+// Encerra o modo AP após receber as credenciais (trabalho adiado, agendado pela tarefa da tela)
+static void ap_mode_stop(void *arg) {
+
+    // Finaliza os serviços de rede relacionados ao servidor TCP
+    dns_server_deinit(&dns_server);
+    dhcp_server_deinit(&dhcp_server);
+
+    shutdown_tcp_server(state);     // Encerra o servidor TCP
+
+    cyw43_arch_disable_ap_mode();   // Desabilita o modo AP
+    wifi_radio_on = false;          // Nenhuma tarefa usa o CYW43 até o próximo `cyw43_arch_init`
+    cyw43_arch_deinit();            // Libera recursos do Wi-Fi
+    sleep_ms(500);
+
+    ssd1306_SetCursor(40, 54);
+    ssd1306_WriteString("RECEIVED", Font_6x8, White);
+    ssd1306_UpdateScreen();
+    sleep_ms(2000);
+
+    aux_connection = 0;
+    wifi_link.valid = false;        // Cache da conexão pertence às credenciais anteriores
+}
+
+// Joystick, botão ENTER e comandos remotos (com o painel desligado, apenas acorda o display)
+static void task_input(void *arg) {
+    if (aux_connection != 0) return;
+
+    if (power.mode == POWER_MODE_SLEEP) {
+        if (menu_input_pending()) power_activity();
+        return;
+    }
+    menu_input();
+    if (current_screen && item_selected == 2) power_activity(); // O buzzer tocando mantém o modo ativo
+}
+
+// Renderiza o menu principal ou, no modo AP, a tela do AP até as credenciais chegarem
+static void task_render(void *arg) {
+    static bool ap_stop_pending = false;
+
+    if (aux_connection == 0) {
+        if (power.mode != POWER_MODE_SLEEP) menu();    // Renderiza o menu principal (nada com o painel desligado)
+        return;
+    }
+
+    menu_ap();          // Renderiza o menu do modo AP
+    if (id_pw_collected == 1 && !ap_stop_pending) {
+        ap_stop_pending = sched_defer(ap_mode_stop, NULL);
+    }
+}
+
+// Lê a temperatura interna e a posta para o serviço de rede (sem chamar o lwIP)
+static void task_sample(void *arg) {
+    if (!inicialized) return;
+
+    temperature = read_onboard_temperature(TEMPERATURE_UNITS);
+    uint64_t adc_us = time_us_64();     // Instante da leitura, para medir a latência até o TCP
+
+#if TELEMETRY_USE_BULK
+    generate_random_coordinates(&lat, &lon);
+#endif
+    net_post_sample(temperature, lat, lon, adc_us);
+}
+
+// Publica as amostras postadas, envia o lote quando devido e mantém a sessão MQTT (lwIP travado)
+static void task_uplink(void *arg) {
+    if (!inicialized) return;
+
+    net_service_poll();
+}
+
+// Supervisiona a conexão Wi-Fi e faz o polling do módulo CYW43 (apenas com o rádio inicializado)
+static void task_network(void *arg) {
+    if (!wifi_radio_on) return;
+
+    wifi_supervisor_poll();
+    cyw43_arch_poll();
+}
+
+// Escurece e desliga o display, ajusta o rádio e o relógio conforme a inatividade (após o modo AP)
+static void task_power(void *arg) {
+    if (aux_connection == 0) {
+        power_poll();
+    }
+}
+
+// Amostra RSSI, endereços e canal para a tela Network Info
+static void task_net_status(void *arg) {
+    net_status_poll();
+}
+
+// Espelha o display para os clientes de /ws (o servidor só existe com o rádio inicializado)
+static void task_mirror(void *arg) {
+    if (!wifi_radio_on) return;
+
+    tcp_server_mirror_display(ssd1306_GetBuffer());
+}
+
+/*---------------------------------------------------------------------------------------*/
+
+
 int main() {
 
     stdio_init_all();                   // Inicializa todas as funções de entrada e saída padrão
@@ -24,81 +135,104 @@ int main() {
     gpio_set_dir(BUTTON_B, GPIO_IN);    // Define o pino do botão B como entrada
     gpio_pull_up(BUTTON_B);             // Habilita o pull-up interno no pino do botão B
 
+    gpio_init(BUTTON_A);                // Inicializa o pino do botão A
+    gpio_set_dir(BUTTON_A, GPIO_IN);    // Define o pino do botão A como entrada
+    gpio_pull_up(BUTTON_A);             // Habilita o pull-up interno no pino do botão A
+
     adc_init();                         // Inicializa o ADC
+    power_init();                       // Política de energia: botões acordam o display por interrupção
 
 /*---------------------------------------------------------------------------------------*/
 
 
     ssd1306_Init();                     // Inicializa o display SSD1306
+    display_core1_start();              // Passa o envio dos quadros ao núcleo 1 (antes de gravar na flash)
+
+    flash_queue_init();                 // Recupera a fila de telemetria gravada na flash (antes do Wi-Fi)
     
 
+/*------------------------ Conectando com as credenciais gravadas ------------------------*/
+
+    // Com credenciais gravadas na flash e a rede ao alcance, o portal do modo AP é pulado
+    if (cred_store_load(ssid, sizeof(ssid), password, sizeof(password), &wifi_link)) {
+        ssd1306_Fill(Black);
+        ssd1306_SetCursor(25, 28);
+        ssd1306_WriteString("Conectando...", Font_6x8, White);
+        ssd1306_UpdateScreen();
+
+        if (wifi_connect_sta()) {
+            id_pw_collected = 1;
+            aux_connection = 0;         // Vai direto ao menu principal
+        } else {
+            printf("Credenciais gravadas falharam, iniciando o modo AP\n");
+        }
+    }
+
 /*------------------------- Inicializando Setup para AP_MODE ----------------------------*/
 
-    TCP_SERVER_T *state = calloc(1, sizeof(TCP_SERVER_T)); // Aloca memória para o estado do servidor TCP
+    state = calloc(1, sizeof(TCP_SERVER_T)); // Aloca memória para o estado do servidor TCP
     if (!state) {
-        DEBUG_printf("failed to allocate state\n");
+        printf("failed to allocate state\n");
         return 1;
     }
 
-    // Inicializa o Wi-Fi
-    if (cyw43_arch_init()) {
-        printf("Wi-Fi init failed");
-        return 1;
-    }
+    if (aux_connection) {
+        // Inicializa o Wi-Fi
+        if (cyw43_arch_init()) {
+            printf("Wi-Fi init failed");
+            return 1;
+        }
+        wifi_radio_on = true;
 
-    // Habilita o modo AP (Access Point)
-    cyw43_arch_enable_ap_mode(ap_name, ap_pw, CYW43_AUTH_WPA2_AES_PSK);
+        // Habilita o modo AP (Access Point)
+        cyw43_arch_enable_ap_mode(ap_name, ap_pw, CYW43_AUTH_WPA2_AES_PSK);
 
-    ip4_addr_t mask;
-    IP4_ADDR(ip_2_ip4(&state->gw), 192, 168, 4, 1); // Configura o endereço IP do gateway
-    IP4_ADDR(ip_2_ip4(&mask), 255, 255, 255, 0);    // Configura a máscara de sub-rede
+        ip4_addr_t mask;
+        IP4_ADDR(ip_2_ip4(&state->gw), 192, 168, 4, 1); // Configura o endereço IP do gateway
+        IP4_ADDR(ip_2_ip4(&mask), 255, 255, 255, 0);    // Configura a máscara de sub-rede
 
-    // Inicia o servidor DHCP
-    dhcp_server_t dhcp_server;
-    dhcp_server_init(&dhcp_server, &state->gw, &mask);
+        // Inicia o servidor DHCP
+        dhcp_server_init(&dhcp_server, &state->gw, &mask);
 
-    // Inicia o servidor DNS
-    dns_server_t dns_server;
-    dns_server_init(&dns_server, &state->gw);
+        // Inicia o servidor DNS
+        dns_server_init(&dns_server, &state->gw);
 
-    // Abre o servidor TCP
-    if (!tcp_server_open(state)) {
-        DEBUG_printf("failed to open server\n");
-        return 1;
+        // Abre o servidor TCP
+        if (!tcp_server_open(state)) {
+            printf("failed to open server\n");
+            return 1;
+        }
     }
 
 /*---------------------------------------------------------------------------------------*/
 
-    //aux_connection = 0;
+/*------------------------------ Registrando as tarefas ---------------------------------*/
+
+    sched_task_add("entrada", task_input, NULL, 20, SCHED_PRIORITY_HIGH);
+    sched_task_add("rede", task_network, NULL, 100, SCHED_PRIORITY_HIGH);
+    sched_task_add("amostra", task_sample, NULL, 2000, SCHED_PRIORITY_NORMAL);
+    sched_task_add("envio", task_uplink, NULL, 20, SCHED_PRIORITY_NORMAL);
+    sched_task_add("energia", task_power, NULL, 100, SCHED_PRIORITY_NORMAL);
+    sched_task_add("estado", task_net_status, NULL, NET_STATUS_PERIOD_MS, SCHED_PRIORITY_NORMAL);
+    sched_task_add("tela", task_render, NULL, 40, SCHED_PRIORITY_NORMAL);
+    sched_task_add("espelho", task_mirror, NULL, WS_FRAME_INTERVAL_MS / 2, SCHED_PRIORITY_LOW);
+    sched_task_add("registro", log_drain, NULL, 50, SCHED_PRIORITY_LOW);
+#if SCHED_REPORT_PERIOD_MS
+    sched_task_add("relatorio", sched_report, NULL, SCHED_REPORT_PERIOD_MS, SCHED_PRIORITY_LOW);
+#if DISPLAY_CORE1_RENDER
+    sched_task_add("nucleo1", display_core1_report, NULL, SCHED_REPORT_PERIOD_MS, SCHED_PRIORITY_LOW);
+#endif
+    sched_task_add("servico", net_service_report, NULL, SCHED_REPORT_PERIOD_MS, SCHED_PRIORITY_LOW);
+    sched_task_add("consumo", power_report, NULL, SCHED_REPORT_PERIOD_MS, SCHED_PRIORITY_LOW);
+#endif
+
+/*---------------------------------------------------------------------------------------*/
 
     while (1)
     {
-        if (aux_connection == 0){
-            menu();     // Renderiza o menu principal
-        }
-
-        else {
-            menu_ap();  // Renderiza o menu do modo AP
-
-            if (id_pw_collected == 1 && aux_connection == 1) {
-
-                // Finaliza os serviços de rede relacionados ao servidor TCP
-                dns_server_deinit(&dns_server);
-                dhcp_server_deinit(&dhcp_server);
-
-                shutdown_tcp_server(state);     // Encerra o servidor TCP
-
-                cyw43_arch_disable_ap_mode();   // Desabilita o modo AP
-                cyw43_arch_deinit();            // Libera recursos do Wi-Fi
-                sleep_ms(500);
-
-                ssd1306_SetCursor(40, 54);
-                ssd1306_WriteString("RECEIVED", Font_6x8, White);
-                ssd1306_UpdateScreen();
-                sleep_ms(2000);
-
-                aux_connection = 0;
-            }
+        // Executa a próxima tarefa pronta (ou o trabalho adiado); sem nada pronto, dorme até o próximo prazo
+        if (!sched_run()) {
+            sched_idle();
         }
     }
     
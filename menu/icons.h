@@ -35,6 +35,8 @@ int cursor = 0;                ///< Posição do cursor no menu para navegação
 int button_enter_clicked = 0;  ///< só executa ação quando o botão ENTER é clicado, e espera até outro clique
 int up_clicked = 0;            ///< só executa ação quando o botão é clicado, e espera até outro clique
 int down_clicked = 0;          ///< mesmo que acima
+int button_a_clicked = 0;      ///< só alterna o modo de envio (ou a visão da rede) quando o botão A é clicado, e espera até outro clique
+int net_info_graph = 0;        ///< Tela Network Info: 0 = endereços e estado, 1 = gráfico do RSSI
 
 
 // ---------------------- Variáveis de Ícones Bitmap -----------------------
@@ -30,7 +30,16 @@
 #include "icons.h"                              // Arquivo contendo ícones para o display SSD1306.
 #include "hardware/timer.h"                     // Biblioteca para operações com temporizadores.     
 #include "http.h"                               // Arquivo contendo funções para o protocolo HTTP.
+#include "telemetry.h"                          // Arquivo contendo funções para o envio de telemetria em lotes.
+#include "mqtt_uplink.h"                        // Arquivo contendo funções para o envio de telemetria via MQTT.
 #include "defines_functions.h"                  // Arquivo contendo definições e funções para o projeto.
+#include "live_telemetry.h"                     // Arquivo contendo a publicação das amostras na rede local.
+#include "storage/credential_store.h"           // Arquivo contendo as credenciais Wi-Fi gravadas na flash.
+#include "net_status.h"                         // Arquivo contendo a amostragem do estado da rede Wi-Fi.
+#include "scheduler.h"                          // Arquivo contendo o escalonador cooperativo do laço principal.
+#include "display_core1.h"                      // Arquivo contendo o envio dos quadros do display pelo núcleo 1.
+#include "net_service.h"                        // Arquivo contendo a caixa de mensagens do serviço de rede.
+#include "power_idle.h"                         // Arquivo contendo a política de energia por inatividade.
 #include "lwip/tcpip.h"                         // Certifique-se de incluir a biblioteca LWIP
 
 // ---------------------------- Função de Renderização da Tela Inicial ----------------------------
@@ -93,6 +102,376 @@ void home_screen(void) {
 }
 
 
+// ---------------------------- Funções de Conexão ao Wi-Fi ----------------------------
+
+CRED_STORE_LINK_T wifi_link = {0};  // Último ponto de acesso usado (BSSID, canal e PMK), gravado com as credenciais.
+
+/**
+ * @brief Estados do supervisor da conexão Wi-Fi.
+ */
+typedef enum {
+    WIFI_SUPERVISOR_UP,           // Conexão ativa; verifica o estado a cada chamada.
+    WIFI_SUPERVISOR_BACKOFF,      // Conexão perdida; aguardando o instante da próxima tentativa.
+    WIFI_SUPERVISOR_JOINING       // Tentativa de reconexão em andamento.
+} WIFI_SUPERVISOR_STATE_T;
+
+/**
+ * @brief Estrutura para armazenar o estado do supervisor da conexão Wi-Fi.
+ */
+typedef struct WIFI_SUPERVISOR_T_ {
+    WIFI_SUPERVISOR_STATE_T state;    // Estado atual.
+    uint32_t up_since_ms;             // Instante em que a conexão ficou ativa.
+    uint32_t lost_ms;                 // Instante em que a conexão foi perdida.
+    uint32_t next_attempt_ms;         // Instante da próxima tentativa de reconexão.
+    uint32_t attempt_start_ms;        // Instante em que a tentativa atual foi iniciada.
+    uint32_t attempts;                // Tentativas desde a perda da conexão.
+    uint32_t reconnects;              // Reconexões bem-sucedidas desde o boot.
+    bool attempt_cached;              // A tentativa atual é a conexão direta (cache).
+} WIFI_SUPERVISOR_T;
+
+WIFI_SUPERVISOR_T wifi_supervisor = {0};  // Estado do supervisor da conexão Wi-Fi.
+
+/**
+ * @brief Aguarda a conexão ficar ativa (associada e com endereço IP).
+ *
+ * @return true se a conexão ficou ativa dentro de `timeout_ms`, false em caso de falha ou tempo esgotado.
+ */
+static bool wifi_wait_link_up(uint32_t timeout_ms) {
+    uint32_t start = to_ms_since_boot(get_absolute_time());
+    while (to_ms_since_boot(get_absolute_time()) - start < timeout_ms) {
+        int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+        if (status == CYW43_LINK_UP) return true;
+        if (status < 0) return false;   // CYW43_LINK_FAIL, CYW43_LINK_NONET ou CYW43_LINK_BADAUTH
+        sleep_ms(10);
+    }
+    return false;
+}
+
+/**
+ * @brief Inicia a conexão à rede de `ssid` e `password` sem aguardar o resultado.
+ *
+ * @param cached true para conectar diretamente ao último ponto de acesso usado (`wifi_link`).
+ *
+ * @return 0 se a conexão foi iniciada, ou o código de erro do driver CYW43.
+ *
+ * Na conexão direta, a PMK é entregue ao firmware como 64 dígitos hexadecimais, que ele usa
+ * como a própria chave em vez de derivá-la da senha com o PBKDF2; o BSSID e o canal dispensam
+ * a varredura. O resultado é acompanhado por `cyw43_tcpip_link_status`.
+ */
+static int wifi_join_start(bool cached) {
+    if (!cached) {
+        return cyw43_arch_wifi_connect_async(ssid, password, CYW43_AUTH_WPA2_AES_PSK);
+    }
+
+    char key[2 * WPA2_PMK_SIZE + 1];
+    for (int i = 0; i < WPA2_PMK_SIZE; i++) {
+        snprintf(key + 2 * i, 3, "%02x", wifi_link.pmk[i]);
+    }
+
+    cyw43_arch_lwip_begin();
+    int err = cyw43_wifi_join(&cyw43_state, strlen(ssid), (const uint8_t *)ssid, 2 * WPA2_PMK_SIZE,
+                              (const uint8_t *)key, CYW43_AUTH_WPA2_AES_PSK, wifi_link.bssid, wifi_link.channel);
+    cyw43_arch_lwip_end();
+    return err;
+}
+
+/**
+ * @brief Abandona a conexão (ou a tentativa de conexão) em andamento.
+ */
+static void wifi_leave(void) {
+    cyw43_arch_lwip_begin();
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Atualiza o cache da conexão com o ponto de acesso atual.
+ *
+ * Lê o BSSID e o canal da conexão. Se o cache ainda não tem a PMK das credenciais atuais,
+ * calcula-a (PBKDF2 da senha com o SSID); senhas de 64 dígitos hexadecimais já são a própria chave.
+ */
+static void wifi_update_link_cache(void) {
+    uint8_t bssid[6];
+    uint32_t channel_info[3] = {0};     // Canal atual, canal alvo e canal de varredura.
+
+    cyw43_arch_lwip_begin();
+    int err = cyw43_wifi_get_bssid(&cyw43_state, bssid);
+    if (err == 0) {
+        err = cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(channel_info), (uint8_t *)channel_info, CYW43_ITF_STA);
+    }
+    cyw43_arch_lwip_end();
+    if (err != 0 || channel_info[0] < 1 || channel_info[0] > 165) {
+        wifi_link.valid = false;
+        return;
+    }
+
+    if (!wifi_link.valid) {
+        uint32_t start = to_ms_since_boot(get_absolute_time());
+        size_t password_len = strlen(password);
+        if (password_len == 2 * WPA2_PMK_SIZE) {
+            for (int i = 0; i < WPA2_PMK_SIZE; i++) {
+                wifi_link.pmk[i] = form_hex_value(password[2 * i]) << 4 | form_hex_value(password[2 * i + 1]);
+            }
+        } else {
+            pbkdf2_sha1(password, password_len, ssid, strlen(ssid), WPA2_PMK_ITERATIONS, wifi_link.pmk, WPA2_PMK_SIZE);
+        }
+        printf("PMK calculada em %lu ms\n", (unsigned long)(to_ms_since_boot(get_absolute_time()) - start));
+    }
+    memcpy(wifi_link.bssid, bssid, sizeof(bssid));
+    wifi_link.channel = channel_info[0];
+    wifi_link.valid = true;
+}
+
+/**
+ * @brief Conecta à rede de `ssid` e `password` com o Wi-Fi já inicializado no modo STA.
+ *
+ * @return true se conectado, false caso contrário.
+ *
+ * ### Comportamento:
+ * - Com o cache válido, tenta primeiro a conexão direta (`wifi_join_start(true)`); se o ponto de
+ *   acesso mudou de canal ou não responde, faz a conexão completa (varredura e PBKDF2).
+ * - Registra a duração da conexão (`wifi_join_ms`) e se ela foi direta (`wifi_fast_join`).
+ * - Atualiza o cache com o ponto de acesso conectado.
+ */
+bool wifi_join(void) {
+    uint32_t start = to_ms_since_boot(get_absolute_time());
+
+    wifi_fast_join = wifi_link.valid && wifi_join_start(true) == 0 && wifi_wait_link_up(WIFI_FAST_JOIN_TIMEOUT_MS);
+    if (!wifi_fast_join) {
+        if (wifi_link.valid) {
+            wifi_leave();
+            printf("Conexão direta falhou, usando varredura completa\n");
+        }
+        if (wifi_join_start(false) != 0 || !wifi_wait_link_up(WIFI_JOIN_TIMEOUT_MS)) {
+            printf("Erro: Falha ao conectar ao Wi-Fi.\n");
+            return false;
+        }
+    }
+
+    wifi_join_ms = to_ms_since_boot(get_absolute_time()) - start;
+    printf("Conectado a %s em %lu ms (%s)\n", ssid, (unsigned long)wifi_join_ms,
+           wifi_fast_join ? "direta: BSSID, canal e PMK em cache" : "varredura completa");
+    wifi_update_link_cache();
+    return true;
+}
+
+/**
+ * @brief Inicializa o Wi-Fi no modo STA e conecta à rede de `ssid` e `password`.
+ *
+ * @return true se conectado (ou se já estava conectado), false caso contrário.
+ *
+ * Usada no boot, com as credenciais gravadas na flash, e pela opção System Setup, com as
+ * credenciais recebidas pelo portal.
+ *
+ * ### Comportamento:
+ * - Em caso de falha, libera o Wi-Fi para que o modo AP possa ser iniciado em seguida.
+ * - Após conectar, registra o tempo desde o boot, grava as credenciais e o cache da conexão
+ *   na flash (apenas se mudaram) e mantém o servidor HTTP disponível na rede local.
+ */
+bool wifi_connect_sta(void) {
+    if (wifi_connected_ms) return true;
+
+    // Inicializa o Wi-Fi
+    if (cyw43_arch_init()) {
+        printf("Wi-Fi init failed\n");
+        return false;
+    }
+    wifi_radio_on = true;
+
+    printf("Habilitando modo STA...\n");
+
+    // Habilita o modo STA
+    cyw43_arch_enable_sta_mode();
+
+    // Conecta ao Wi-Fi
+    printf("Conectando ao Wi-Fi...\n");
+    if (!wifi_join()) {
+        wifi_radio_on = false;
+        cyw43_arch_deinit();
+        return false;
+    }
+
+    wifi_connected_ms = to_ms_since_boot(get_absolute_time());
+    printf("Conectado %lu ms desde o boot\n", (unsigned long)wifi_connected_ms);
+
+    wifi_link_ok = true;
+    wifi_supervisor.state = WIFI_SUPERVISOR_UP;
+    wifi_supervisor.up_since_ms = wifi_connected_ms;
+
+    // Próximos boots conectam direto, sem o portal do modo AP nem varredura
+    if (!cred_store_save(ssid, password, &wifi_link)) {
+        printf("Erro: Falha ao gravar as credenciais na flash.\n");
+    }
+
+    // Mantém o servidor HTTP disponível na rede local (telemetria ao vivo)
+    http_server_mode = HTTP_MODE_STA;
+    if (tcp_server_open(&sta_server)) {
+        printf("Telemetria ao vivo em http://%s" API_TELEMETRY " e " EVENTS_PATH "\n",
+               ip4addr_ntoa(netif_ip4_addr(&cyw43_state.netif[CYW43_ITF_STA])));
+    }
+    return true;
+}
+
+
+// ---------------------------- Funções de Supervisão do Wi-Fi ----------------------------
+
+/**
+ * @brief Agenda a próxima tentativa de reconexão com espera exponencial e aleatória.
+ *
+ * A espera dobra a cada tentativa (`WIFI_BACKOFF_BASE_MS` até `WIFI_BACKOFF_MAX_MS`) e é sorteada
+ * entre a metade e o valor cheio, para que vários dispositivos não tentem todos ao mesmo tempo
+ * quando o ponto de acesso voltar.
+ */
+static void wifi_supervisor_schedule(uint32_t now) {
+    uint32_t delay = WIFI_BACKOFF_MAX_MS;
+    if (wifi_supervisor.attempts < 16 && (WIFI_BACKOFF_BASE_MS << wifi_supervisor.attempts) < WIFI_BACKOFF_MAX_MS) {
+        delay = WIFI_BACKOFF_BASE_MS << wifi_supervisor.attempts;
+    }
+    delay = delay / 2 + (uint32_t)rand() % (delay / 2 + 1);
+
+    wifi_supervisor.state = WIFI_SUPERVISOR_BACKOFF;
+    wifi_supervisor.next_attempt_ms = now + delay;
+    printf("Nova tentativa de conexão em %lu ms\n", (unsigned long)delay);
+}
+
+/**
+ * @brief Acompanha a conexão Wi-Fi e reconecta quando ela cai.
+ *
+ * Esta função é executada periodicamente pelo escalonador; não faz nada antes da primeira
+ * conexão (`wifi_connect_sta`) e nunca bloqueia.
+ *
+ * ### Comportamento:
+ * - Conexão ativa: ao detectar a perda (`cyw43_tcpip_link_status`), zera `wifi_link_ok`, o que
+ *   pausa o envio da telemetria (as amostras seguem para a flash) e a sessão MQTT.
+ * - Reconexão: a primeira tentativa usa a conexão direta (cache); as seguintes, a varredura
+ *   completa, com espera exponencial e aleatória entre elas (`wifi_supervisor_schedule`).
+ * - Ao reconectar, conta a reconexão, atualiza o cache da conexão e o grava na flash se mudou.
+ */
+void wifi_supervisor_poll(void) {
+    if (!wifi_connected_ms) return;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+
+    switch (wifi_supervisor.state) {
+    case WIFI_SUPERVISOR_UP:
+        if (status == CYW43_LINK_UP) return;
+
+        wifi_link_ok = false;
+        wifi_supervisor.lost_ms = now;
+        wifi_supervisor.attempts = 0;
+        printf("Conexão Wi-Fi perdida (estado %d) após %lu s\n", status,
+               (unsigned long)((now - wifi_supervisor.up_since_ms) / 1000));
+        wifi_supervisor_schedule(now);
+        break;
+
+    case WIFI_SUPERVISOR_BACKOFF:
+        if ((int32_t)(now - wifi_supervisor.next_attempt_ms) < 0) return;
+
+        wifi_leave();
+        wifi_supervisor.attempt_cached = wifi_link.valid && wifi_supervisor.attempts == 0;
+        wifi_supervisor.attempt_start_ms = now;
+        wifi_supervisor.attempts++;
+        if (wifi_join_start(wifi_supervisor.attempt_cached) != 0) {
+            wifi_supervisor_schedule(now);
+            return;
+        }
+        wifi_supervisor.state = WIFI_SUPERVISOR_JOINING;
+        break;
+
+    case WIFI_SUPERVISOR_JOINING:
+        if (status == CYW43_LINK_UP) {
+            wifi_link_ok = true;
+            wifi_fast_join = wifi_supervisor.attempt_cached;
+            wifi_join_ms = now - wifi_supervisor.attempt_start_ms;
+            wifi_supervisor.state = WIFI_SUPERVISOR_UP;
+            wifi_supervisor.up_since_ms = now;
+            wifi_supervisor.reconnects++;
+            printf("Reconectado a %s em %lu ms (%s; tentativa %lu, %lu ms sem conexão)\n", ssid,
+                   (unsigned long)wifi_join_ms, wifi_fast_join ? "direta" : "varredura completa",
+                   (unsigned long)wifi_supervisor.attempts, (unsigned long)(now - wifi_supervisor.lost_ms));
+
+            wifi_update_link_cache();
+            cred_store_save(ssid, password, &wifi_link);    // Grava só se o ponto de acesso mudou
+            return;
+        }
+        if (status < 0 || now - wifi_supervisor.attempt_start_ms >=
+                (wifi_supervisor.attempt_cached ? WIFI_FAST_JOIN_TIMEOUT_MS : WIFI_JOIN_TIMEOUT_MS)) {
+            wifi_leave();
+            wifi_supervisor_schedule(now);
+        }
+        break;
+    }
+}
+
+
+// ---------------------------- Funções de Navegação do Menu ----------------------------
+
+/**
+ * @brief Move o cursor do menu um item para cima (`step` = -1) ou para baixo (`step` = 1).
+ *
+ * Chamada pelo joystick (`update_cursor`) e pelos comandos remotos recebidos via WebSocket,
+ * com a mesma rotação ao atingir o topo ou o fundo da lista.
+ */
+void menu_move_cursor(int step) {
+    power_activity();       // Adia o escurecimento do display
+
+    cursor += step;
+    if (cursor == -1)
+        cursor = 3;
+    if (cursor == 4)
+        cursor = 0;
+
+    item_selected += step;
+    if (item_selected < 0)
+        item_selected = NUM_ITEMS - 1;
+    if (item_selected >= NUM_ITEMS)
+        item_selected = 0;
+}
+
+/**
+ * @brief Executa a ação do botão ENTER: entra na opção selecionada ou volta à tela inicial.
+ *
+ * Chamada pelo botão B e pelos comandos remotos recebidos via WebSocket.
+ */
+void menu_press_enter(void) {
+    power_activity();       // Adia o escurecimento do display
+
+    // Desliga o buzzer
+    pwm_set_gpio_level(BUZZER_PIN, 0);  // Desativa o buzzer
+
+    // Se o item selecionado for diferente de "Buzzer PWM"
+    if(item_selected != 2){
+
+    // Se a tela atual for a tela inicial
+    if(current_screen)
+        menu_enter_sound(BUZZER_PIN);   // Toca o som de entrada
+    // Se a tela atual for a tela específica
+    else
+        menu_exit_sound(BUZZER_PIN);    // Toca o som de saída
+    }
+
+    // Alterna para o outro tipo de tela
+    current_screen = !current_screen;
+}
+
+/**
+ * @brief Aplica os comandos remotos (WebSocket `/ws`) recebidos desde a última chamada.
+ *
+ * Os comandos de cursor só têm efeito na tela inicial, como o joystick.
+ */
+void menu_poll_remote_input(void) {
+    uint8_t event;
+    while (ws_input_pop(&event)) {
+        if (event == WS_INPUT_ENTER) {
+            menu_press_enter();
+        } else if (current_screen == 0) {
+            menu_move_cursor(event == WS_INPUT_UP ? -1 : 1);
+        }
+    }
+}
+
+
 // ---------------------------- Função de Atualização da Posição do Cursor ----------------------------
 
 /**
@@ -129,12 +508,7 @@ void update_cursor(void){
     // Verifica o estado do joystick para cima
     if ((filtered_read > 3000) && up_clicked == 0) {
         up_clicked = 1; // Marca como pressionado
-        cursor--;
-        if (cursor == -1)
-            cursor = 3;
-        item_selected--;
-        if (item_selected < 0)
-            item_selected = NUM_ITEMS - 1;
+        menu_move_cursor(-1);
     }
     // Libera o botão para cima
     if (filtered_read <= 3000) {
@@ -144,12 +518,7 @@ void update_cursor(void){
     // Verifica o estado do joystick para baixo
     if ((filtered_read < 1100) && down_clicked == 0) {
         down_clicked = 1; // Marca como pressionado
-        cursor++;
-        if (cursor == 4)
-            cursor = 0;
-        item_selected++;
-        if (item_selected >= NUM_ITEMS)
-            item_selected = 0;
+        menu_move_cursor(1);
     }
     // Libera o botão para baixo
     if (filtered_read >= 1100) {
@@ -158,6 +527,105 @@ void update_cursor(void){
 }
 
 
+// ---------------------------- Função de Verificação da Entrada com o Display Desligado ----------------------------
+
+/**
+ * @brief Verifica se há alguma entrada do usuário sem agir sobre o menu.
+ *
+ * Usada com o painel desligado (modo de energia dormindo), no lugar de `menu_input`.
+ *
+ * @return true se o joystick está fora do centro, um botão está pressionado ou há
+ *         comandos remotos na fila, false caso contrário.
+ *
+ * @note Marca o joystick e os botões como já tratados: o toque que acorda o display não
+ *       move o cursor nem aciona o menu. Os comandos remotos continuam na fila.
+ */
+bool menu_input_pending(void) {
+    adc_select_input(0);
+    uint adc_y_raw = adc_read();
+
+    up_clicked = adc_y_raw > 3000;
+    down_clicked = adc_y_raw < 1100;
+    button_enter_clicked = !gpio_get(BUTTON_B);
+    button_a_clicked = !gpio_get(BUTTON_A);
+
+    return up_clicked || down_clicked || button_enter_clicked || button_a_clicked || ws_input.head != ws_input.tail;
+}
+
+
+// ---------------------------- Função de Leitura da Entrada do Menu ----------------------------
+
+/**
+ * @brief Lê o joystick, o botão ENTER e os comandos remotos e atualiza a navegação do menu.
+ *
+ * Separada da renderização (`menu`) para rodar em uma tarefa própria, com período menor.
+ *
+ * ### Comportamento:
+ * - Aplica os comandos recebidos via WebSocket.
+ * - Na tela inicial, move o cursor com o joystick.
+ * - Trata o clique do botão ENTER (entra na opção ou volta à tela inicial).
+ * - Calcula os itens anterior e próximo exibidos na tela inicial.
+ */
+void menu_input(void) {
+
+    menu_poll_remote_input();   // Aplica os comandos recebidos via WebSocket
+
+    // Se a tela atual for a tela inicial
+    if (current_screen == 0) {
+        update_cursor();        // Atualiza o cursor com o joystick
+    }
+
+    // Função que analisa o estado do botão ENTER
+    if (!(gpio_get(BUTTON_B)) && button_enter_clicked == 0) {
+
+        button_enter_clicked = 1;           // Marca o botão ENTER como pressionado
+        menu_press_enter();                 // Entra na opção ou volta à tela inicial
+    }
+
+    // Se o botão ENTER for liberado, a variável auxiliar retorna para baixo, dando chance de clicar novamente
+    if ((gpio_get(BUTTON_B)) && button_enter_clicked == 1) {
+        button_enter_clicked = 0;
+    }
+
+/*------------------------- Lógica para imprimir os itens corretos ----------------------------*/
+
+    item_sel_previous = item_selected - 1;  // O item anterior é o item selecionado menos 1
+
+    // Se o item anterior for menor que 0 = O item anterior estaria abaixo do primeiro = torná-lo o último
+    if (item_sel_previous < 0) {
+        item_sel_previous = NUM_ITEMS - 1;
+    } 
+    item_sel_next = item_selected + 1;      // O próximo item é o item selecionado mais 1
+
+    // Se o próximo item for maior ou igual ao número total de itens = O próximo item estaria após o último = torná-lo o primeiro
+    if (item_sel_next >= NUM_ITEMS) {
+        item_sel_next = 0;
+    }
+
+/*---------------------------------------------------------------------------------------*/
+}
+
+
+// ---------------------------- Funções de Formatação da Tela Network Info ----------------------------
+
+/**
+ * @brief Limita um RSSI ao que a tela Network Info exibe (-99 a 0 dBm).
+ *
+ * Abaixo de -99 dBm não há conexão utilizável; o limite garante que cada valor
+ * ocupe no máximo 3 colunas e que as linhas caibam nas 21 colunas do display.
+ */
+static inline int net_info_dbm(int32_t rssi) {
+    return rssi < -99 ? -99 : rssi > 0 ? 0 : (int)rssi;
+}
+
+/**
+ * @brief Limita um contador exibido na tela Network Info a 3 dígitos (satura em 999).
+ */
+static inline unsigned net_info_count(uint32_t value) {
+    return value > 999 ? 999 : (unsigned)value;
+}
+
+
 // ---------------------------- Função de Renderização do Menu ----------------------------
 
 /**
@@ -189,8 +657,6 @@ void menu(void) {
 
     // Se a tela atual for a tela inicial
     if (current_screen == 0) {
-
-        update_cursor();    // Atualiza o cursor com o joystick
         home_screen();      // Atualiza a Tela Inicial no Display OLED
     }
 
@@ -206,27 +672,30 @@ void menu(void) {
             // Exibe o cabeçalho
             cabecalho("CLOUD:", 45, 1);
 
-            char buffer_string[7];      // Buffer para armazenar valores formatados em string
+            char buffer_string[24];     // Buffer para armazenar valores formatados em string
             
             // Se o sistema estiver inicializado (Passado pela opção System Setup)
             if(inicialized){
 
-                // Se a interrupção do timer já foi ativa (a cada 2 segundos)
-                if(timer_expired){
-
-                    // Lê a temperatura interna do sistema
-                    temperature = read_onboard_temperature(TEMPERATURE_UNITS);
-
-                    // Passará a temperatura para a função que construirá a requisição HTTP
-                    build_http_request(temperature);
-                    timer_expired = false;      // Reseta a flag de interrupção do timer
+                // O botão A alterna o caminho de envio entre HTTP e MQTT
+                if (!(gpio_get(BUTTON_A)) && button_a_clicked == 0) {
+                    button_a_clicked = 1;
+                    uplink_mode = (uplink_mode == UPLINK_HTTP) ? UPLINK_MQTT : UPLINK_HTTP;
+                }
+                if ((gpio_get(BUTTON_A)) && button_a_clicked == 1) {
+                    button_a_clicked = 0;
                 }
 
+                // Exibe o caminho de envio no canto do cabeçalho
+                ssd1306_SetCursor(100, 3);
+                ssd1306_WriteString(uplink_mode == UPLINK_MQTT ? "MQTT" : "HTTP", Font_6x8, White);
+
                 // Exibe a temperatura no display
                 ssd1306_SetCursor(3, 24);
-                sprintf(buffer_string, "- Temp: %.2f %c", temperature, TEMPERATURE_UNITS);
+                int len = fixed_to_str(float_to_fixed(temperature, 2), 2, strcpy(buffer_string, "- Temp: ") + 8);
+                sprintf(buffer_string + 8 + len, " %c", TEMPERATURE_UNITS);
                 ssd1306_WriteString(buffer_string, Font_6x8, White);
-                sprintf(buffer_string, "- Latitude: %.4f", lat);
+                fixed_to_str(float_to_fixed(lat, 4), 4, strcpy(buffer_string, "- Latitude: ") + 12);
                 ssd1306_DrawRectangle(1, 34, 127, 34, White);   // Separador Horizontal
 
                 // Exibe a latitude no display
@@ -235,12 +704,10 @@ void menu(void) {
                 ssd1306_DrawRectangle(1, 48, 127, 48, White);   // Separador Horizontal
 
                 // Exibe a longitude no display
-                sprintf(buffer_string, "- Longitude: %.4f", lon);
+                fixed_to_str(float_to_fixed(lon, 4), 4, strcpy(buffer_string, "- Longitude: ") + 13);
                 ssd1306_SetCursor(3, 52);
                 ssd1306_WriteString(buffer_string, Font_6x8, White);
 
-                cyw43_arch_poll();      // Polling do módulo CYW43 (Manter conexão Wi-Fi ativa)
-
               // Se o sistema não estiver inicializado  
             } else {
 
@@ -333,30 +800,12 @@ void menu(void) {
                         ssd1306_WriteString("%", Font_7x10, 1);
                         ssd1306_UpdateScreen();                                                         // Atualiza o display devido ação bloqueante do Wi-Fi
 
-                        // Inicializa o Wi-Fi
-                        if (cyw43_arch_init()) {
-                            printf("Wi-Fi init failed\n");
-                            return;
-                        }
-
-                        printf("Habilitando modo STA...\n");
-
-                        // Habilita o modo STA
-                        cyw43_arch_enable_sta_mode();   
-
-                        // Tenta conectar ao Wi-Fi
-                        printf("Conectando ao Wi-Fi...\n");
-
-                        // Conecta ao Wi-Fi
-                        if (cyw43_arch_wifi_connect_timeout_ms(ssid, password, CYW43_AUTH_WPA2_AES_PSK, 10000)) {
-                            printf("Erro: Falha ao conectar ao Wi-Fi.\n");
+                        // Conecta ao Wi-Fi (imediato se já conectado no boot com as credenciais gravadas)
+                        if (!wifi_connect_sta()) {
                             break;  // Encerra o laço
                         }
 
-                        printf("Conectado a %s\n", ssid);
-                        
-                        start_wifi = 1;     // Marca a flag de conexão Wi-Fi como ativa
-                        start_timer();      // Inicializa o timer para a requisição HTTP
+                        start_wifi = 1;     // Marca a flag de conexão Wi-Fi como ativa (libera a amostragem e o envio)
                     }
                     
                     // Atualização do percentual quando nenhum dos blocos IF é ativo
@@ -447,37 +896,80 @@ void menu(void) {
             // Se o sistema estiver inicializado (Passado pela opção System Setup)
             if(inicialized){
 
-                ssd1306_DrawRectangle(32, 20, 32, 63, 1);	        // Separador Vertical
-
-                char buffer_string[7];                              // Buffer para armazenar valores formatados em string
-                uint8_t *ip_address = (uint8_t*)&(cyw43_state.netif[0].ip_addr.addr);
-                sprintf(buffer_string, "%d.%d.%d.%d", ip_address[0], ip_address[1], ip_address[2], ip_address[3]);
-                ssd1306_SetCursor(3, 23);
-                ssd1306_WriteString("IP", Font_6x8, 1);             // Exibe o texto "IP"
-                ssd1306_SetCursor(53, 23);
-                ssd1306_WriteString(buffer_string, Font_6x8, 1);    // Exibe o endereço IP
-
-                ssd1306_DrawRectangle(1, 34, 127, 34, 1);	        // Separador horizontal
-                int32_t rssi;                                       // Variável para armazenar o RSSI
-                cyw43_wifi_get_rssi(&cyw43_state, &rssi);           // Lê o RSSI do módulo CYW43
-                sprintf(buffer_string, "%d dBm", rssi);             // Formata o RSSI em string
-                ssd1306_SetCursor(3, 37);
-                ssd1306_WriteString("RSSI", Font_6x8, 1);           // Exibe o texto "RSSI"
-                ssd1306_SetCursor(81, 37);
-                ssd1306_WriteString(buffer_string, Font_6x8, 1);    // Exibe o valor do RSSI
-                ssd1306_DrawRectangle(1, 46, 127, 46, 1);	        // Separador horizontal
-
-                ssd1306_SetCursor(3, 50);
-                ssd1306_WriteString("WIFI", Font_6x8, 1);           // Exibe o texto "WIFI"
-
-                // Se o Wi-Fi estiver conectado
-                if(start_wifi){
-
-                    ssd1306_SetCursor(70, 50);
-                    ssd1306_WriteString("CONNECTED", Font_6x8, 1);  // Exibe o texto "CONNECTED"
+                // O botão A alterna entre os endereços e o gráfico do RSSI
+                if (!(gpio_get(BUTTON_A)) && button_a_clicked == 0) {
+                    button_a_clicked = 1;
+                    net_info_graph = !net_info_graph;
+                }
+                if ((gpio_get(BUTTON_A)) && button_a_clicked == 1) {
+                    button_a_clicked = 0;
+                }
+
+                // Os valores vêm da última amostra de `net_status_poll`, sem acessar o CYW43 a cada quadro
+                char buffer_string[22];                             // Uma linha de 21 colunas (valores limitados por `net_info_dbm` e `net_info_count`)
+
+                if (net_info_graph) {
+                    // RSSI atual, mínimo e médio do histórico
+                    snprintf(buffer_string, sizeof(buffer_string), "%ddBm min%d avg%d", net_info_dbm(net_status.rssi),
+                             net_info_dbm(net_status.rssi_min), net_info_dbm(net_status.rssi_avg));
+                    ssd1306_SetCursor(4, 22);
+                    ssd1306_WriteString(buffer_string, Font_6x8, 1);
+                    ssd1306_DrawRectangle(1, 31, 127, 31, 1);       // Separador horizontal
+
+                    // Gráfico do histórico (-90 dBm na base, -30 dBm no topo), amostra mais recente à direita
+                    uint8_t x_previous = 0, y_previous = 0;
+                    for (int i = 0; i < net_status.history_count; i++) {
+                        int rssi = net_status_history_at(i);
+                        rssi = rssi < -90 ? -90 : rssi > -30 ? -30 : rssi;
+                        uint8_t x = 126 - (net_status.history_count - 1 - i) * 4;
+                        uint8_t y = 61 - ((rssi + 90) * 27) / 60;
+                        if (i) ssd1306_Line(x_previous, y_previous, x, y, 1);
+                        else ssd1306_DrawPixel(x, y, 1);
+                        x_previous = x;
+                        y_previous = y;
+                    }
                 } else {
-                    ssd1306_SetCursor(52, 50);
-                    ssd1306_WriteString("DISCONNECTED", Font_6x8, 1);  // Exibe o texto "DISCONNECTED"
+                    ssd1306_DrawRectangle(32, 20, 32, 63, 1);       // Separador Vertical
+
+                    ssd1306_SetCursor(3, 22);
+                    ssd1306_WriteString("IP", Font_6x8, 1);         // Exibe o texto "IP"
+                    ssd1306_SetCursor(35, 22);
+                    ssd1306_WriteString(net_status.ip_str, Font_6x8, 1);        // Exibe o endereço IP
+                    ssd1306_DrawRectangle(1, 31, 127, 31, 1);       // Separador horizontal
+
+                    ssd1306_SetCursor(3, 33);
+                    ssd1306_WriteString("GW", Font_6x8, 1);         // Exibe o texto "GW"
+                    ssd1306_SetCursor(35, 33);
+                    ssd1306_WriteString(net_status.gateway_str, Font_6x8, 1);   // Exibe o endereço do gateway
+                    ssd1306_DrawRectangle(1, 42, 127, 42, 1);       // Separador horizontal
+
+                    snprintf(buffer_string, sizeof(buffer_string), "%ddBm CH%u",
+                             net_info_dbm(net_status.rssi), net_info_count(net_status.channel));
+                    ssd1306_SetCursor(3, 44);
+                    ssd1306_WriteString("RSSI", Font_6x8, 1);       // Exibe o texto "RSSI"
+                    ssd1306_SetCursor(125 - 6 * strlen(buffer_string), 44);
+                    ssd1306_WriteString(buffer_string, Font_6x8, 1);            // Exibe o RSSI e o canal
+                    ssd1306_DrawRectangle(1, 53, 127, 53, 1);       // Separador horizontal
+
+                    ssd1306_SetCursor(3, 55);
+                    ssd1306_WriteString("WIFI", Font_6x8, 1);       // Exibe o texto "WIFI"
+
+                    // Tempo de conexão (ou estado da reconexão) e número de reconexões desde o boot, saturados em 999
+                    uint32_t now = to_ms_since_boot(get_absolute_time());
+                    if (wifi_supervisor.state == WIFI_SUPERVISOR_UP) {
+                        uint32_t uptime_min = (now - wifi_supervisor.up_since_ms) / 60000;
+                        snprintf(buffer_string, sizeof(buffer_string), "UP %uh%02um R%u", net_info_count(uptime_min / 60),
+                                 (unsigned)(uptime_min % 60), net_info_count(wifi_supervisor.reconnects));
+                    } else if (wifi_supervisor.state == WIFI_SUPERVISOR_JOINING) {
+                        snprintf(buffer_string, sizeof(buffer_string), "JOIN R%u", net_info_count(wifi_supervisor.reconnects));
+                    } else {
+                        int32_t wait_ms = (int32_t)(wifi_supervisor.next_attempt_ms - now);
+                        snprintf(buffer_string, sizeof(buffer_string), "RETRY %us R%u",
+                                 net_info_count(wait_ms > 0 ? wait_ms / 1000 + 1 : 0),
+                                 net_info_count(wifi_supervisor.reconnects));
+                    }
+                    ssd1306_SetCursor(125 - 6 * strlen(buffer_string), 55);
+                    ssd1306_WriteString(buffer_string, Font_6x8, 1);  // Exibe o estado da conexão
                 }
             
             // Se o sistema não estiver inicializado
@@ -487,52 +979,6 @@ void menu(void) {
     }
     }
 
-    // Função que analisa o estado do botão ENTER
-    if (!(gpio_get(BUTTON_B)) && button_enter_clicked == 0) {
-
-        button_enter_clicked = 1;           // Marca o botão ENTER como pressionado
-
-        // Desliga o buzzer
-        pwm_set_gpio_level(BUZZER_PIN, 0);  // Desativa o buzzer
-
-        // Se o item selecionado for diferente de "Buzzer PWM"
-        if(item_selected != 2){
-        
-        // Se a tela atual for a tela inicial
-        if(current_screen)
-            menu_enter_sound(BUZZER_PIN);   // Toca o som de entrada
-        // Se a tela atual for a tela específica
-        else
-            menu_exit_sound(BUZZER_PIN);    // Toca o som de saída
-        }
-
-        // Alterna para o outro tipo de tela
-        current_screen = !current_screen;
-        
-    }
-
-    // Se o botão ENTER for liberado, a variável auxiliar retorna para baixo, dando chance de clicar novamente
-    if ((gpio_get(BUTTON_B)) && button_enter_clicked == 1) {
-        button_enter_clicked = 0;
-    }
-
-/*------------------------- Lógica para imprimir os itens corretos ----------------------------*/
-
-    item_sel_previous = item_selected - 1;  // O item anterior é o item selecionado menos 1
-
-    // Se o item anterior for menor que 0 = O item anterior estaria abaixo do primeiro = torná-lo o último
-    if (item_sel_previous < 0) {
-        item_sel_previous = NUM_ITEMS - 1;
-    } 
-    item_sel_next = item_selected + 1;      // O próximo item é o item selecionado mais 1
-
-    // Se o próximo item for maior ou igual ao número total de itens = O próximo item estaria após o último = torná-lo o primeiro
-    if (item_sel_next >= NUM_ITEMS) {
-        item_sel_next = 0;
-    }
-
-/*---------------------------------------------------------------------------------------*/
-
     ssd1306_UpdateScreen(); // Atualiza o display
 }
 
@@ -574,7 +1020,7 @@ void menu_ap (void){
     ssd1306_WriteString(ap_pw, Font_6x8, White);            // Exibe a senha da rede Wi-Fi
 
     ssd1306_SetCursor(4, 44);
-    ssd1306_WriteString("192.168.4.1", Font_6x8, White);    // Exibe o endereço IP do AP
+    ssd1306_WriteString(AP_IP_STRING, Font_6x8, White);     // Exibe o endereço IP do AP
     
     ssd1306_UpdateScreen();                                 // Atualiza o display
 }
@@ -0,0 +1,236 @@
+/******************************************************************************
+ * @file    mqtt_uplink.h
+ * @brief   Arquivo contendo definições e funções para o envio de telemetria
+ *          via MQTT (cliente MQTT do lwIP) no Raspberry Pi Pico W.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    Alternativa ao envio por HTTP: a conexão com o broker é mantida aberta
+ *          e cada amostra é publicada em poucas dezenas de bytes. Amostras que não
+ *          puderem ser publicadas seguem pelo caminho HTTP (lote + fila na flash).
+ ******************************************************************************/
+
+#ifndef MQTT_UPLINK_H
+#define MQTT_UPLINK_H
+
+#include "lwip/apps/mqtt.h"             // Biblioteca MQTT para lidar com o protocolo MQTT.
+#include "lwip/dns.h"                   // Biblioteca de Funções DNS
+#include "telemetry.h"                  // Arquivo contendo funções para o envio de telemetria em lotes.
+#include "log_ring.h"                   // Registro binário de mensagens (`LOG_INFO`, `LOG_WARN`, ...).
+
+// ----------------------------------- Defines ----------------------------------
+
+#define MQTT_BROKER_HOST "mqtt3.thingspeak.com" // Host do broker MQTT.
+#define MQTT_BROKER_PORT 1883           // Porta do broker MQTT (sem TLS).
+#define MQTT_CLIENT_ID ""               // Client ID do dispositivo MQTT cadastrado no ThingSpeak.
+#define MQTT_USERNAME ""                // Usuário do dispositivo MQTT cadastrado no ThingSpeak.
+#define MQTT_PASSWORD ""                // Senha do dispositivo MQTT cadastrado no ThingSpeak.
+#define MQTT_QOS 0                      // Nível de QoS das publicações (0 ou 1).
+#define MQTT_KEEP_ALIVE_S 30            // Keep-alive (s): com publicações a cada 2 s, só é usado se o envio parar.
+#define MQTT_RETRY_MS 5000              // Intervalo mínimo entre tentativas de conexão com o broker.
+
+/* Layout dos tópicos: 0 = um tópico com todos os campos, 1 = um tópico por campo. */
+#define MQTT_TOPIC_PER_FIELD 0
+#define MQTT_TOPIC "channels/" THINGSPEAK_CHANNEL_ID "/publish"                 // Tópico único.
+#define MQTT_TOPIC_FIELD "channels/" THINGSPEAK_CHANNEL_ID "/publish/fields/field%d" // Tópico por campo.
+
+#define UPLINK_HTTP 0                   // Telemetria enviada via HTTP (bulk update).
+#define UPLINK_MQTT 1                   // Telemetria publicada via MQTT.
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura para armazenar o estado do cliente MQTT.
+ */
+typedef struct MQTT_UPLINK_T_ {
+    mqtt_client_t *client;        // Cliente MQTT do lwIP (alocado uma única vez).
+    ip_addr_t broker_ip;          // Endereço IP do broker resolvido via DNS.
+    bool connecting;              // Flag para indicar que há uma conexão (ou resolução DNS) em andamento.
+    uint32_t last_attempt_ms;     // Instante da última tentativa de conexão.
+    uint32_t published;           // Quantidade de publicações confirmadas.
+    uint32_t failed;              // Quantidade de publicações que falharam.
+} MQTT_UPLINK_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+MQTT_UPLINK_T mqtt_uplink = {0};  // Estado do cliente MQTT.
+int uplink_mode = UPLINK_HTTP;    // Caminho de envio da telemetria selecionado no menu.
+
+
+// --------------------------- Função de Callback da Conexão MQTT ---------------------------
+
+/**
+ * @brief Função de callback chamada quando a conexão com o broker muda de estado.
+ *
+ * @param client Ponteiro para o cliente MQTT.
+ * @param arg Ponteiro para o estado do cliente (`MQTT_UPLINK_T`).
+ * @param status Estado da conexão reportado pelo lwIP.
+ */
+static void mqtt_uplink_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status) {
+    MQTT_UPLINK_T *state = (MQTT_UPLINK_T *)arg;
+    state->connecting = false;
+    if (status == MQTT_CONNECT_ACCEPTED) {
+        LOG_INFO("MQTT conectado a " MQTT_BROKER_HOST);
+    } else {
+        LOG_WARN("MQTT desconectado: %d", status);
+    }
+}
+
+
+// --------------------------- Função de Callback da Publicação MQTT ---------------------------
+
+/**
+ * @brief Função de callback chamada quando uma publicação termina.
+ *
+ * Com QoS 0 é chamada assim que a mensagem é enviada; com QoS 1, quando o PUBACK chega.
+ */
+static void mqtt_uplink_publish_cb(void *arg, err_t err) {
+    MQTT_UPLINK_T *state = (MQTT_UPLINK_T *)arg;
+    if (err == ERR_OK) {
+        state->published++;
+    } else {
+        state->failed++;
+    }
+}
+
+
+// --------------------------- Função para Conectar ao Broker ---------------------------
+
+/**
+ * @brief Inicia a conexão com o broker a partir do endereço já resolvido.
+ */
+static void mqtt_uplink_connect(MQTT_UPLINK_T *state) {
+    static const struct mqtt_connect_client_info_t client_info = {
+        .client_id = MQTT_CLIENT_ID,
+        .client_user = MQTT_USERNAME,
+        .client_pass = MQTT_PASSWORD,
+        .keep_alive = MQTT_KEEP_ALIVE_S,
+    };
+
+    err_t err = mqtt_client_connect(state->client, &state->broker_ip, MQTT_BROKER_PORT,
+                                    mqtt_uplink_connection_cb, state, &client_info);
+    if (err != ERR_OK) {
+        LOG_ERROR("Erro ao conectar ao broker MQTT: %d", err);
+        state->connecting = false;
+    }
+}
+
+
+// --------------------------- Função de Callback do DNS do Broker ---------------------------
+
+/**
+ * @brief Função de callback chamada quando o endereço do broker é resolvido.
+ */
+static void mqtt_uplink_dns_cb(const char *name, const ip_addr_t *ipaddr, void *arg) {
+    MQTT_UPLINK_T *state = (MQTT_UPLINK_T *)arg;
+    if (ipaddr == NULL) {
+        LOG_WARN_S("Erro ao resolver o nome de domínio: %s", name);
+        state->connecting = false;
+        return;
+    }
+    state->broker_ip = *ipaddr;
+    mqtt_uplink_connect(state);
+}
+
+
+// --------------------------- Função de Manutenção da Conexão MQTT ---------------------------
+
+/**
+ * @brief Mantém a sessão com o broker aberta enquanto o modo MQTT estiver selecionado.
+ *
+ * ### Comportamento:
+ * - Aloca o cliente MQTT na primeira chamada.
+ * - Sem conexão, tenta reconectar no máximo a cada `MQTT_RETRY_MS`, resolvendo o broker via DNS.
+ * - Com o modo HTTP selecionado, encerra a sessão aberta.
+ */
+void mqtt_uplink_poll(void) {
+    MQTT_UPLINK_T *state = &mqtt_uplink;
+
+    if (uplink_mode != UPLINK_MQTT) {
+        if (state->client && mqtt_client_is_connected(state->client)) {
+            mqtt_disconnect(state->client);
+        }
+        return;
+    }
+
+    if (!telemetry_link_up() || state->connecting) return;
+
+    if (!state->client) {
+        state->client = mqtt_client_new();
+        if (!state->client) {
+            LOG_ERROR("Erro ao alocar cliente MQTT");
+            return;
+        }
+    }
+    if (mqtt_client_is_connected(state->client)) return;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (state->last_attempt_ms && now - state->last_attempt_ms < MQTT_RETRY_MS) return;
+    state->last_attempt_ms = now;
+    state->connecting = true;
+
+    err_t err = dns_gethostbyname(MQTT_BROKER_HOST, &state->broker_ip, mqtt_uplink_dns_cb, state);
+    if (err == ERR_OK) {
+        mqtt_uplink_connect(state);
+    } else if (err != ERR_INPROGRESS) {
+        LOG_ERROR("Erro ao iniciar a resolução do DNS");
+        state->connecting = false;
+    }
+}
+
+
+// --------------------------- Função para Publicar uma Amostra ---------------------------
+
+/**
+ * @brief Publica uma amostra de telemetria no broker.
+ *
+ * @param temperature A temperatura lida.
+ * @param lat A latitude associada à amostra.
+ * @param lon A longitude associada à amostra.
+ * @return true se a publicação foi enfileirada no cliente MQTT, false caso contrário.
+ *
+ * ### Comportamento:
+ * - Com `MQTT_TOPIC_PER_FIELD` = 0, publica `field1=..&field2=..&field3=..` em `MQTT_TOPIC`.
+ * - Com `MQTT_TOPIC_PER_FIELD` = 1, publica cada valor em seu próprio tópico.
+ *
+ * @note O lwIP copia tópico e payload para o seu buffer de saída, então os buffers
+ *       locais podem ser descartados ao retornar.
+ */
+bool mqtt_uplink_publish(float temperature, float lat, float lon) {
+    MQTT_UPLINK_T *state = &mqtt_uplink;
+    if (!state->client || !mqtt_client_is_connected(state->client)) return false;
+
+    char payload[64];
+    err_t err;
+
+#if MQTT_TOPIC_PER_FIELD
+    char topic[64];
+    const int32_t values[3] = { float_to_fixed(temperature, 2), float_to_fixed(lat, 6), float_to_fixed(lon, 6) };
+    for (int field = 1; field <= 3; field++) {
+        snprintf(topic, sizeof(topic), MQTT_TOPIC_FIELD, field);
+        int len = fixed_to_str(values[field - 1], field == 1 ? 2 : 6, payload);
+        err = mqtt_publish(state->client, topic, payload, len, MQTT_QOS, 0, mqtt_uplink_publish_cb, state);
+        if (err != ERR_OK) break;
+    }
+#else
+    int len = 0;
+    memcpy(payload + len, "field1=", 7);  len += 7;
+    len += fixed_to_str(float_to_fixed(temperature, 2), 2, payload + len);
+    memcpy(payload + len, "&field2=", 8); len += 8;
+    len += fixed_to_str(float_to_fixed(lat, 6), 6, payload + len);
+    memcpy(payload + len, "&field3=", 8); len += 8;
+    len += fixed_to_str(float_to_fixed(lon, 6), 6, payload + len);
+    err = mqtt_publish(state->client, MQTT_TOPIC, payload, len, MQTT_QOS, 0, mqtt_uplink_publish_cb, state);
+#endif
+
+    if (err != ERR_OK) {
+        LOG_WARN("Erro ao publicar via MQTT: %d", err);
+        state->failed++;
+        return false;
+    }
+    return true;
+}
+
+#endif /*MQTT_UPLINK_H*/
@@ -0,0 +1,235 @@
+/******************************************************************************
+ * @file    net_service.h
+ * @brief   Arquivo contendo o serviço de rede: caixa de mensagens entre a
+ *          aplicação (amostragem e interface) e o lado que usa o CYW43/lwIP.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    A aplicação não chama o lwIP: a amostra é postada em uma caixa de
+ *          mensagens sem trava (um produtor, um consumidor) e o serviço de rede
+ *          a retira e a publica com o lwIP travado (`cyw43_arch_lwip_begin/end`),
+ *          junto com o envio do lote HTTP e a sessão MQTT. Os índices da caixa são
+ *          escritos cada um por um só lado, então ela também funciona entre núcleos.
+ *
+ * @note    Cada amostra leva o instante da leitura do ADC; o serviço mede o tempo
+ *          até o segmento TCP ser entregue ao lwIP (`tcp_output`) nos caminhos
+ *          diretos (MQTT e clientes da rede local). No caminho HTTP em lote a
+ *          espera é definida pelo próprio lote (`TELEMETRY_BATCH_MAX_AGE_MS`).
+ ******************************************************************************/
+
+#ifndef NET_SERVICE_H
+#define NET_SERVICE_H
+
+#include "pico/stdlib.h"                // Biblioteca padrão para Raspberry Pi Pico.
+#include "pico/cyw43_arch.h"            // `cyw43_arch_lwip_begin/end`.
+#include "hardware/sync.h"              // Barreira de memória `__dmb`.
+#include "telemetry.h"                  // Arquivo contendo funções para o envio de telemetria em lotes.
+#include "mqtt_uplink.h"                // Arquivo contendo funções para o envio de telemetria via MQTT.
+#include "live_telemetry.h"             // Arquivo contendo a publicação das amostras na rede local.
+
+// ----------------------------------- Defines ----------------------------------
+
+#define NET_MAILBOX_SIZE 8              // Mensagens na caixa (potência de 2).
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Tipos de mensagem aceitos pelo serviço de rede.
+ */
+typedef enum {
+    NET_MSG_SAMPLE                // Publica uma amostra (MQTT ou lote HTTP, e clientes da rede local).
+} NET_MSG_TYPE_T;
+
+/**
+ * @brief Estrutura para armazenar uma mensagem da caixa.
+ */
+typedef struct NET_MSG_T_ {
+    uint8_t type;                 // Tipo da mensagem (`NET_MSG_TYPE_T`).
+    float temperature;            // Temperatura lida.
+    float lat;                    // Latitude associada à amostra.
+    float lon;                    // Longitude associada à amostra.
+    uint64_t adc_us;              // Instante da leitura do ADC (`time_us_64`).
+} NET_MSG_T;
+
+/**
+ * @brief Caminhos de envio com latência medida.
+ */
+typedef enum {
+    NET_PATH_MQTT,                // Publicação no broker MQTT.
+    NET_PATH_LIVE,                // Evento SSE para os clientes de `/events`.
+    NET_PATH_COUNT
+} NET_PATH_T;
+
+/**
+ * @brief Estrutura para armazenar a latência (leitura do ADC até o segmento TCP) de um caminho.
+ */
+typedef struct NET_LATENCY_T_ {
+    uint32_t count;               // Amostras medidas desde o último relatório.
+    uint32_t sum_us;              // Soma das latências.
+    uint32_t min_us;              // Menor latência.
+    uint32_t max_us;              // Maior latência.
+} NET_LATENCY_T;
+
+/**
+ * @brief Estrutura para armazenar a caixa de mensagens e as medidas do serviço de rede.
+ */
+typedef struct NET_SERVICE_T_ {
+    NET_MSG_T mailbox[NET_MAILBOX_SIZE]; // Mensagens postadas pela aplicação.
+    volatile uint32_t head;       // Próxima posição a escrever (só a aplicação escreve).
+    volatile uint32_t tail;       // Próxima posição a ler (só o serviço de rede escreve).
+    volatile uint32_t posted;     // Mensagens postadas (só a aplicação escreve).
+    volatile uint32_t dropped;    // Mensagens descartadas com a caixa cheia (só a aplicação escreve).
+    uint32_t depth_max;           // Maior ocupação da caixa vista pelo serviço.
+    NET_LATENCY_T latency[NET_PATH_COUNT]; // Latência de cada caminho.
+} NET_SERVICE_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+NET_SERVICE_T net_service = {0};        // Caixa de mensagens e medidas do serviço de rede.
+
+// --------------------------- Função para Postar uma Amostra (Aplicação) ---------------------------
+
+/**
+ * @brief Posta uma amostra para o serviço de rede publicar.
+ *
+ * @param temperature A temperatura lida.
+ * @param lat A latitude associada à amostra.
+ * @param lon A longitude associada à amostra.
+ * @param adc_us Instante da leitura do ADC (`time_us_64`).
+ * @return true se a amostra foi postada, false se a caixa estava cheia (amostra descartada).
+ *
+ * @note Não chama o lwIP nem aguarda o serviço; apenas um produtor pode chamá-la.
+ */
+bool net_post_sample(float temperature, float lat, float lon, uint64_t adc_us) {
+    NET_SERVICE_T *service = &net_service;
+    uint32_t head = service->head;
+    if (head - service->tail == NET_MAILBOX_SIZE) {
+        service->dropped++;
+        return false;
+    }
+
+    NET_MSG_T *msg = &service->mailbox[head % NET_MAILBOX_SIZE];
+    msg->type = NET_MSG_SAMPLE;
+    msg->temperature = temperature;
+    msg->lat = lat;
+    msg->lon = lon;
+    msg->adc_us = adc_us;
+
+    __dmb();                            // A mensagem fica visível antes do novo `head`
+    service->head = head + 1;
+    service->posted++;
+    return true;
+}
+
+// --------------------------- Função de Registro da Latência ---------------------------
+
+static void net_service_record(NET_PATH_T path, uint64_t adc_us) {
+    NET_LATENCY_T *latency = &net_service.latency[path];
+    uint32_t elapsed = (uint32_t)(time_us_64() - adc_us);
+    if (latency->count == 0 || elapsed < latency->min_us) latency->min_us = elapsed;
+    if (elapsed > latency->max_us) latency->max_us = elapsed;
+    latency->sum_us += elapsed;
+    latency->count++;
+}
+
+// --------------------------- Função de Publicação de uma Amostra ---------------------------
+
+/**
+ * @brief Publica uma amostra retirada da caixa (chamada com o lwIP travado).
+ *
+ * ### Comportamento:
+ * - Em lote: publica via MQTT ou armazena no lote do ThingSpeak com o instante da leitura;
+ *   sem sessão MQTT, a amostra segue pelo caminho HTTP para não ser perdida.
+ * - Sem lote: monta a requisição HTTP GET, se houver conexão.
+ * - Envia a amostra aos clientes da rede local.
+ */
+static void net_service_publish(const NET_MSG_T *msg) {
+#if TELEMETRY_USE_BULK
+    if (uplink_mode == UPLINK_MQTT && mqtt_uplink_publish(msg->temperature, msg->lat, msg->lon)) {
+        net_service_record(NET_PATH_MQTT, msg->adc_us);
+    } else {
+        telemetry_push(msg->temperature, msg->lat, msg->lon, (uint32_t)(msg->adc_us / 1000));
+    }
+#else
+    if (telemetry_link_up()) {
+        build_http_request(msg->temperature);
+    }
+#endif
+
+    uint32_t delivered = live_feed.delivered;
+    live_telemetry_publish(msg->temperature, msg->lat, msg->lon);
+    if (live_feed.delivered != delivered) {
+        net_service_record(NET_PATH_LIVE, msg->adc_us);
+    }
+}
+
+// --------------------------- Função de Processamento do Serviço de Rede ---------------------------
+
+/**
+ * @brief Retira as mensagens da caixa e mantém o envio da telemetria.
+ *
+ * Esta função é executada pelo escalonador; é o único ponto, fora dos callbacks do
+ * lwIP, que publica dados na rede.
+ *
+ * ### Comportamento:
+ * - Trava o lwIP uma única vez para toda a rodada.
+ * - Publica cada amostra postada, da mais antiga à mais recente.
+ * - Envia o lote HTTP quando devido e mantém a sessão MQTT.
+ */
+void net_service_poll(void) {
+    NET_SERVICE_T *service = &net_service;
+
+    cyw43_arch_lwip_begin();
+
+    uint32_t depth = service->head - service->tail;
+    if (depth > service->depth_max) service->depth_max = depth;
+
+    while (service->tail != service->head) {
+        __dmb();                        // Lê a mensagem somente depois de ver o novo `head`
+        NET_MSG_T msg = service->mailbox[service->tail % NET_MAILBOX_SIZE];
+        service->tail++;
+        if (msg.type == NET_MSG_SAMPLE) net_service_publish(&msg);
+    }
+
+#if TELEMETRY_USE_BULK
+    telemetry_poll();
+#endif
+    mqtt_uplink_poll();
+
+    cyw43_arch_lwip_end();
+}
+
+// --------------------------- Função de Relatório ---------------------------
+
+/**
+ * @brief Imprime no console a caixa de mensagens e a latência de cada caminho desde o último relatório.
+ *
+ * @param arg Não utilizado (assinatura de tarefa, para ser registrada com `sched_task_add`).
+ */
+void net_service_report(void *arg) {
+    static const char *const names[NET_PATH_COUNT] = { "mqtt", "local" };
+    static uint32_t last_posted, last_dropped;  // Contadores no relatório anterior
+    NET_SERVICE_T *service = &net_service;
+    uint32_t posted = service->posted;
+    uint32_t dropped = service->dropped;
+
+    printf("Rede: %lu amostras postadas, %lu descartadas (caixa cheia), ocupação máx. %lu/%d\n",
+           (unsigned long)(posted - last_posted), (unsigned long)(dropped - last_dropped),
+           (unsigned long)service->depth_max, NET_MAILBOX_SIZE);
+    for (int path = 0; path < NET_PATH_COUNT; path++) {
+        NET_LATENCY_T *latency = &service->latency[path];
+        if (!latency->count) continue;
+        printf("  ADC -> TCP (%s): %lu amostras, min %lu us, med %lu us, max %lu us\n", names[path],
+               (unsigned long)latency->count, (unsigned long)latency->min_us,
+               (unsigned long)(latency->sum_us / latency->count), (unsigned long)latency->max_us);
+        *latency = (NET_LATENCY_T){0};
+    }
+
+    last_posted = posted;
+    last_dropped = dropped;
+    service->depth_max = 0;
+}
+
+#endif /*NET_SERVICE_H*/
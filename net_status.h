@@ -0,0 +1,124 @@
+/******************************************************************************
+ * @file    net_status.h
+ * @brief   Arquivo contendo a amostragem periódica do estado da rede Wi-Fi
+ *          (RSSI, IP, gateway, canal e estado da conexão).
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    A leitura do RSSI e do canal é um ioctl ao CYW43 pelo barramento SPI;
+ *          por isso o estado é lido a cada `NET_STATUS_PERIOD_MS` e as telas
+ *          usam apenas a cópia em `net_status`.
+ ******************************************************************************/
+
+#ifndef NET_STATUS_H
+#define NET_STATUS_H
+
+#include "pico/cyw43_arch.h"            // Biblioteca para usar o módulo de conectividade para raspberry pi pico w.
+#include "lwip/netif.h"                 // Endereços IP e gateway da interface.
+#include "defines_functions.h"          // Arquivo contendo `wifi_connected_ms` e `CYW43_IOCTL_GET_CHANNEL`.
+
+// ---------------------------------- Definições ----------------------------------
+
+#define NET_STATUS_PERIOD_MS 2000       // Intervalo entre as amostras do estado da rede.
+#define NET_STATUS_HISTORY 32           // Amostras de RSSI mantidas no histórico (gráfico da tela Network Info).
+
+// ---------------------------------- Estruturas ----------------------------------
+
+/**
+ * @brief Estrutura para armazenar a última amostra do estado da rede e o histórico do RSSI.
+ */
+typedef struct NET_STATUS_T_ {
+    uint32_t sampled_ms;                // Instante da última amostra (0 = nenhuma amostra).
+    int link;                           // Estado da conexão (`cyw43_tcpip_link_status`).
+    int32_t rssi;                       // Último RSSI lido (dBm).
+    uint32_t channel;                   // Canal do ponto de acesso.
+    uint32_t ip;                        // Endereço IP da interface STA.
+    uint32_t gateway;                   // Endereço do gateway.
+    char ip_str[16];                    // Endereço IP formatado (refeito apenas quando muda).
+    char gateway_str[16];               // Endereço do gateway formatado (refeito apenas quando muda).
+    int8_t history[NET_STATUS_HISTORY]; // Histórico do RSSI (buffer circular, dBm).
+    uint8_t history_head;               // Posição da próxima amostra no histórico.
+    uint8_t history_count;              // Amostras válidas no histórico.
+    int8_t rssi_min;                    // Menor RSSI do histórico.
+    int8_t rssi_avg;                    // Média do RSSI do histórico.
+} NET_STATUS_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+NET_STATUS_T net_status = {0};          // Estado da rede amostrado por `net_status_poll`.
+
+// --------------------------- Função de Acesso ao Histórico ---------------------------
+
+/**
+ * @brief Retorna a amostra `i` do histórico do RSSI, da mais antiga (0) à mais recente.
+ */
+static inline int8_t net_status_history_at(int i) {
+    int index = net_status.history_head - net_status.history_count + i;
+    if (index < 0) index += NET_STATUS_HISTORY;
+    return net_status.history[index];
+}
+
+// --------------------------- Função de Amostragem do Estado da Rede ---------------------------
+
+/**
+ * @brief Atualiza `net_status` com uma nova amostra do estado da rede.
+ *
+ * Esta função é executada pelo escalonador a cada `NET_STATUS_PERIOD_MS`; não faz nada
+ * antes da primeira conexão.
+ *
+ * ### Comportamento:
+ * - Lê o estado da conexão, o IP e o gateway (apenas memória) e formata os endereços
+ *   somente quando mudam.
+ * - Com a conexão ativa, lê o RSSI e o canal do CYW43 e acrescenta o RSSI ao histórico,
+ *   recalculando o mínimo e a média.
+ */
+void net_status_poll(void) {
+    if (!wifi_connected_ms) return;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    net_status.sampled_ms = now ? now : 1;
+
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+    net_status.link = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+
+    uint32_t ip = ip4_addr_get_u32(netif_ip4_addr(netif));
+    if (ip != net_status.ip || !net_status.ip_str[0]) {
+        net_status.ip = ip;
+        ip4addr_ntoa_r(netif_ip4_addr(netif), net_status.ip_str, sizeof(net_status.ip_str));
+    }
+    uint32_t gateway = ip4_addr_get_u32(netif_ip4_gw(netif));
+    if (gateway != net_status.gateway || !net_status.gateway_str[0]) {
+        net_status.gateway = gateway;
+        ip4addr_ntoa_r(netif_ip4_gw(netif), net_status.gateway_str, sizeof(net_status.gateway_str));
+    }
+
+    if (net_status.link != CYW43_LINK_UP) return;
+
+    int32_t rssi;
+    uint32_t channel_info[3] = {0};     // Canal atual, canal alvo e canal de varredura.
+    cyw43_arch_lwip_begin();
+    int err = cyw43_wifi_get_rssi(&cyw43_state, &rssi);
+    cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(channel_info), (uint8_t *)channel_info, CYW43_ITF_STA);
+    cyw43_arch_lwip_end();
+    if (channel_info[0]) net_status.channel = channel_info[0];
+    if (err != 0) return;
+
+    net_status.rssi = rssi;
+    net_status.history[net_status.history_head] = (int8_t)(rssi < -128 ? -128 : rssi > 0 ? 0 : rssi);
+    net_status.history_head = (net_status.history_head + 1) % NET_STATUS_HISTORY;
+    if (net_status.history_count < NET_STATUS_HISTORY) net_status.history_count++;
+
+    int32_t sum = 0;
+    int8_t min = 0;
+    for (int i = 0; i < net_status.history_count; i++) {
+        int8_t value = net_status_history_at(i);
+        sum += value;
+        if (i == 0 || value < min) min = value;
+    }
+    net_status.rssi_min = min;
+    net_status.rssi_avg = (int8_t)(sum / net_status.history_count);
+}
+
+#endif /*NET_STATUS_H*/
@@ -0,0 +1,262 @@
+/******************************************************************************
+ * @file    power_idle.h
+ * @brief   Arquivo contendo a política de economia de energia por inatividade:
+ *          escurecimento e desligamento do display, modo de economia do rádio,
+ *          redução do relógio do sistema e estimativa de consumo por modo.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    Sem entrada do usuário por `POWER_DIM_AFTER_MS`, o display é escurecido;
+ *          por `POWER_SLEEP_AFTER_MS`, o painel é desligado, o CYW43 passa ao modo
+ *          `CYW43_AGGRESSIVE_PM` entre os envios e o relógio do sistema cai para
+ *          `POWER_SLEEP_SYS_KHZ`. A amostragem e o envio continuam. Os botões acordam
+ *          o dispositivo por interrupção; o joystick e os comandos remotos, pela
+ *          tarefa de entrada. O toque que acorda não chega ao menu.
+ *
+ * @note    O consumo é uma estimativa: tempo em cada modo vezes a corrente típica
+ *          do modo (`POWER_CURRENT_*_MA`), que deve ser ajustada com medições na placa.
+ ******************************************************************************/
+
+#ifndef POWER_IDLE_H
+#define POWER_IDLE_H
+
+#include "pico/stdlib.h"                // Biblioteca padrão para Raspberry Pi Pico.
+#include "pico/cyw43_arch.h"            // Modo de economia do rádio (`cyw43_wifi_pm`).
+#include "hardware/clocks.h"            // Relógio do sistema (`set_sys_clock_khz`).
+#include "hardware/i2c.h"               // Reconfiguração da velocidade do I2C do display.
+#include "defines_functions.h"          // Arquivo contendo os botões, `start_wifi` e `wifi_link_ok`.
+#include "http.h"                       // Arquivo contendo `http_request_pending` (envio em andamento).
+#include "scheduler.h"                  // Arquivo contendo `sched_defer` (despertar pela interrupção).
+#include "display_core1.h"              // Arquivo contendo os comandos ao painel pelo núcleo 1.
+
+// ----------------------------------- Defines ----------------------------------
+
+#define POWER_IDLE_POLICY 1             // 1 = aplica a política de inatividade, 0 = sempre ativo.
+#define POWER_DIM_AFTER_MS 30000        // Inatividade até escurecer o display.
+#define POWER_SLEEP_AFTER_MS 120000     // Inatividade até desligar o painel e reduzir o relógio.
+#define POWER_CONTRAST_FULL 0xFF        // Contraste no modo ativo (o mesmo de `ssd1306_Init`).
+#define POWER_CONTRAST_DIM 0x08         // Contraste no modo escurecido.
+#define POWER_SLEEP_SYS_KHZ 48000       // Relógio do sistema dormindo (o USB e o ADC usam a PLL_USB).
+
+#define POWER_CURRENT_ACTIVE_MA 70      // Corrente típica estimada: display no máximo, rádio sem economia.
+#define POWER_CURRENT_DIM_MA 62         // Corrente típica estimada: display escurecido.
+#define POWER_CURRENT_SLEEP_MA 28       // Corrente típica estimada: painel desligado, rádio em economia, 48 MHz.
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Modos da política de energia.
+ */
+typedef enum {
+    POWER_MODE_ACTIVE,            // Uso normal.
+    POWER_MODE_DIM,               // Display escurecido.
+    POWER_MODE_SLEEP,             // Painel desligado, rádio em economia e relógio reduzido.
+    POWER_MODE_COUNT
+} POWER_MODE_T;
+
+/**
+ * @brief Estrutura para armazenar o estado da política de energia e o tempo em cada modo.
+ */
+typedef struct POWER_T_ {
+    POWER_MODE_T mode;                  // Modo atual.
+    volatile uint32_t activity_ms;      // Instante da última entrada do usuário.
+    volatile bool wake_pending;         // Despertar já agendado com `sched_defer`.
+    uint32_t active_khz;                // Relógio do sistema no modo ativo.
+    bool clock_low;                     // Relógio reduzido para `POWER_SLEEP_SYS_KHZ`.
+    uint32_t radio_pm;                  // Modo de economia aplicado ao CYW43 (0 = nenhum ainda).
+    uint32_t wakes;                     // Vezes que o dispositivo acordou do modo dormindo.
+    uint64_t mode_ms[POWER_MODE_COUNT]; // Tempo acumulado em cada modo desde o boot.
+    uint64_t accounted_us;              // Instante até o qual o tempo já foi contabilizado.
+} POWER_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+POWER_T power = {0};                    // Estado da política de energia.
+
+static const uint16_t power_current_ma[POWER_MODE_COUNT] = {
+    POWER_CURRENT_ACTIVE_MA, POWER_CURRENT_DIM_MA, POWER_CURRENT_SLEEP_MA
+};
+
+void power_poll(void);
+
+// --------------------------- Função de Registro de Atividade ---------------------------
+
+static void power_wake(void *arg) {
+    power_poll();
+}
+
+/**
+ * @brief Registra uma entrada do usuário e, fora do modo ativo, agenda o despertar.
+ *
+ * Pode ser chamada de interrupções (botões) e das tarefas (joystick, comandos remotos).
+ */
+void power_activity(void) {
+    power.activity_ms = to_ms_since_boot(get_absolute_time());
+    if (power.mode != POWER_MODE_ACTIVE && !power.wake_pending) {
+        power.wake_pending = sched_defer(power_wake, NULL);
+    }
+}
+
+static void power_gpio_irq(uint gpio, uint32_t events) {
+    power_activity();
+}
+
+// --------------------------- Função de Contabilização do Tempo ---------------------------
+
+static void power_account(void) {
+    uint64_t now = time_us_64();
+    power.mode_ms[power.mode] += (now - power.accounted_us) / 1000;
+    power.accounted_us = now - (now - power.accounted_us) % 1000;
+}
+
+// --------------------------- Função de Troca do Relógio ---------------------------
+
+/**
+ * @brief Troca o relógio do sistema e reajusta o I2C do display.
+ *
+ * @return true se o relógio foi trocado, false se o núcleo 1 ainda usa o I2C ou a
+ *         frequência não pode ser gerada.
+ *
+ * ### Comportamento:
+ * - Só troca com o núcleo 1 sem quadros nem comandos pendentes.
+ * - Segura o processamento do CYW43 em segundo plano durante a troca.
+ * - O `clk_peri` acompanha o `clk_sys`, então a velocidade do I2C é recalculada.
+ */
+static bool power_clock_set(uint32_t khz) {
+    if (!display_core1_idle()) return false;
+
+    if (start_wifi) cyw43_arch_lwip_begin();
+    bool ok = set_sys_clock_khz(khz, false);
+    if (start_wifi) cyw43_arch_lwip_end();
+
+    if (ok) i2c_set_baudrate(i2c1, SSD1306_I2C_CLK * 1000);
+    return ok;
+}
+
+// --------------------------- Função do Modo de Economia do Rádio ---------------------------
+
+/**
+ * @brief Aplica ao CYW43 o modo de economia do modo atual.
+ *
+ * Dormindo, usa `CYW43_AGGRESSIVE_PM` entre os envios e volta a `CYW43_DEFAULT_PM`
+ * enquanto um lote HTTP está em andamento, para que ele termine logo. Sem conexão,
+ * esquece o modo aplicado, que é refeito após a reconexão.
+ */
+static void power_radio_pm(void) {
+    if (!start_wifi || !wifi_link_ok) {
+        power.radio_pm = 0;
+        return;
+    }
+
+    uint32_t pm = (power.mode == POWER_MODE_SLEEP && !http_request_pending) ? CYW43_AGGRESSIVE_PM : CYW43_DEFAULT_PM;
+    if (pm == power.radio_pm) return;
+
+    cyw43_arch_lwip_begin();
+    int err = cyw43_wifi_pm(&cyw43_state, pm);
+    cyw43_arch_lwip_end();
+    if (err == 0) power.radio_pm = pm;
+}
+
+// --------------------------- Função de Troca de Modo ---------------------------
+
+static void power_set_mode(POWER_MODE_T mode) {
+    static const char *const names[POWER_MODE_COUNT] = { "ativo", "escurecido", "dormindo" };
+
+    power_account();
+    if (power.mode == POWER_MODE_SLEEP) {
+        if (power.clock_low && power_clock_set(power.active_khz)) power.clock_low = false;
+        display_core1_set_on(true);
+        power.wakes++;
+    }
+
+    if (mode == POWER_MODE_SLEEP) {
+        display_core1_set_on(false);
+    } else {
+        display_core1_set_contrast(mode == POWER_MODE_ACTIVE ? POWER_CONTRAST_FULL : POWER_CONTRAST_DIM);
+    }
+    power.mode = mode;
+    printf("Energia: modo %s\n", names[mode]);
+}
+
+// --------------------------- Função de Inicialização ---------------------------
+
+/**
+ * @brief Inicia a política de energia e habilita o despertar pelos botões.
+ *
+ * Deve ser chamada após a inicialização dos pinos dos botões.
+ */
+void power_init(void) {
+    power.active_khz = clock_get_hz(clk_sys) / 1000;
+    power.activity_ms = to_ms_since_boot(get_absolute_time());
+    power.accounted_us = time_us_64();
+
+#if POWER_IDLE_POLICY
+    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, true, power_gpio_irq);
+    gpio_set_irq_enabled(BUTTON_B, GPIO_IRQ_EDGE_FALL, true);
+#endif
+}
+
+// --------------------------- Função de Processamento da Política ---------------------------
+
+/**
+ * @brief Escolhe o modo de energia pela inatividade e aplica as trocas pendentes.
+ *
+ * Esta função é executada pelo escalonador e também como trabalho adiado, quando
+ * uma entrada do usuário acorda o dispositivo.
+ *
+ * ### Comportamento:
+ * - Ativo, escurecido ou dormindo conforme o tempo desde a última entrada.
+ * - Dormindo, reduz o relógio assim que o núcleo 1 termina de desligar o painel; fora
+ *   dele, restaura o relógio do modo ativo.
+ * - Ajusta o modo de economia do rádio.
+ */
+void power_poll(void) {
+    power.wake_pending = false;
+
+#if POWER_IDLE_POLICY
+    uint32_t idle_ms = to_ms_since_boot(get_absolute_time()) - power.activity_ms;
+    POWER_MODE_T mode = idle_ms >= POWER_SLEEP_AFTER_MS ? POWER_MODE_SLEEP :
+                        idle_ms >= POWER_DIM_AFTER_MS ? POWER_MODE_DIM : POWER_MODE_ACTIVE;
+    if (mode != power.mode) power_set_mode(mode);
+
+    // A troca do relógio espera o núcleo 1 liberar o I2C; se não der agora, tenta na próxima passagem
+    bool clock_low = power.mode == POWER_MODE_SLEEP;
+    if (clock_low != power.clock_low && power_clock_set(clock_low ? POWER_SLEEP_SYS_KHZ : power.active_khz)) {
+        power.clock_low = clock_low;
+    }
+#endif
+    power_radio_pm();
+}
+
+// --------------------------- Função de Relatório ---------------------------
+
+/**
+ * @brief Imprime no console o tempo em cada modo e o consumo estimado desde o boot.
+ *
+ * A corrente média e o consumo por dia servem para dimensionar a bateria.
+ *
+ * @param arg Não utilizado (assinatura de tarefa, para ser registrada com `sched_task_add`).
+ */
+void power_report(void *arg) {
+    power_account();
+
+    uint64_t total_ms = 0;
+    uint64_t charge = 0;                // mA·ms
+    for (int mode = 0; mode < POWER_MODE_COUNT; mode++) {
+        total_ms += power.mode_ms[mode];
+        charge += power.mode_ms[mode] * power_current_ma[mode];
+    }
+    if (!total_ms) return;
+
+    uint32_t avg_ma10 = (uint32_t)(charge * 10 / total_ms);     // Décimos de mA
+    printf("Energia: ativo %lu s, escurecido %lu s, dormindo %lu s, %lu despertares\n",
+           (unsigned long)(power.mode_ms[POWER_MODE_ACTIVE] / 1000), (unsigned long)(power.mode_ms[POWER_MODE_DIM] / 1000),
+           (unsigned long)(power.mode_ms[POWER_MODE_SLEEP] / 1000), (unsigned long)power.wakes);
+    printf("  consumo estimado: %lu.%03lu mAh, média %lu.%lu mA (~%lu mAh/dia)\n",
+           (unsigned long)(charge / 3600000), (unsigned long)(charge / 3600 % 1000),
+           (unsigned long)(avg_ma10 / 10), (unsigned long)(avg_ma10 % 10), (unsigned long)(avg_ma10 * 24 / 10));
+}
+
+#endif /*POWER_IDLE_H*/
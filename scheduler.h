@@ -0,0 +1,358 @@
+/******************************************************************************
+ * @file    scheduler.h
+ * @brief   Arquivo contendo o escalonador cooperativo do laço principal:
+ *          tarefas periódicas com prioridade, fila de trabalho adiado e
+ *          contabilização do tempo de execução de cada tarefa.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    As tarefas rodam até o fim (sem preempção), sempre no laço principal.
+ *          Os prazos ficam em um heap mínimo; a cada passagem, `sched_run`
+ *          executa uma única unidade de trabalho: a tarefa pronta de maior
+ *          prioridade (e prazo mais antigo) ou um item da fila de trabalho adiado.
+ ******************************************************************************/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdio.h>
+#include "pico/stdlib.h"                // Biblioteca padrão para Raspberry Pi Pico (`time_us_64`, interrupções).
+
+// ----------------------------------- Defines ----------------------------------
+
+#define SCHED_MAX_TASKS 16              // Quantidade máxima de tarefas registradas.
+#define SCHED_DEFER_SIZE 8              // Capacidade da fila de trabalho adiado.
+#define SCHED_REPORT_PERIOD_MS 30000    // Intervalo do relatório de tempo de execução no console (0 = desativado).
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Prioridades das tarefas (menor valor = executa primeiro).
+ *
+ * O trabalho adiado roda depois das tarefas de prioridade alta e antes das demais.
+ */
+typedef enum {
+    SCHED_PRIORITY_HIGH,          // Entrada do usuário e manutenção da rede.
+    SCHED_PRIORITY_NORMAL,        // Amostragem, envio e renderização.
+    SCHED_PRIORITY_LOW            // Espelhamento do display e diagnóstico.
+} SCHED_PRIORITY_T;
+
+typedef void (*sched_fn_t)(void *arg);
+
+/**
+ * @brief Estrutura para armazenar uma tarefa e as suas estatísticas.
+ */
+typedef struct SCHED_TASK_T_ {
+    const char *name;             // Nome exibido no relatório.
+    sched_fn_t fn;                // Função da tarefa.
+    void *arg;                    // Argumento passado à função.
+    uint32_t period_us;           // Período (0 = tarefa única, rearmada por `sched_task_start`).
+    SCHED_PRIORITY_T priority;    // Prioridade.
+    uint64_t next_us;             // Próximo prazo de execução.
+    bool queued;                  // Está no heap de prazos.
+    bool ready;                   // Prazo atingido, aguardando a vez de executar.
+    uint32_t runs;                // Execuções na janela do relatório.
+    uint32_t late;                // Períodos perdidos na janela do relatório.
+    uint64_t busy_us;             // Tempo de execução acumulado na janela do relatório.
+    uint32_t max_us;              // Maior tempo de execução na janela do relatório.
+    uint32_t max_delay_us;        // Maior atraso entre o prazo e o início da execução na janela.
+} SCHED_TASK_T;
+
+/**
+ * @brief Estrutura para armazenar um item da fila de trabalho adiado.
+ */
+typedef struct SCHED_WORK_T_ {
+    sched_fn_t fn;                // Função a executar.
+    void *arg;                    // Argumento passado à função.
+} SCHED_WORK_T;
+
+/**
+ * @brief Estrutura para armazenar o estado do escalonador.
+ */
+typedef struct SCHEDULER_T_ {
+    SCHED_TASK_T tasks[SCHED_MAX_TASKS];    // Tarefas registradas.
+    uint8_t task_count;                     // Quantidade de tarefas registradas.
+    uint8_t heap[SCHED_MAX_TASKS];          // Heap mínimo de índices de tarefas, ordenado por `next_us`.
+    uint8_t heap_count;                     // Quantidade de tarefas no heap.
+    SCHED_WORK_T work[SCHED_DEFER_SIZE];    // Fila circular de trabalho adiado.
+    volatile uint8_t work_head;             // Próximo item a executar.
+    volatile uint8_t work_count;            // Itens na fila.
+    uint32_t work_runs;                     // Itens executados na janela do relatório.
+    uint32_t work_dropped;                  // Itens descartados por fila cheia (desde o boot).
+    uint64_t work_busy_us;                  // Tempo de execução do trabalho adiado na janela.
+    uint64_t window_start_us;               // Início da janela do relatório.
+} SCHEDULER_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+SCHEDULER_T scheduler = {0};            // Estado do escalonador do laço principal.
+
+// --------------------------- Funções do Heap de Prazos ---------------------------
+
+static inline bool sched_heap_less(int a, int b) {
+    return scheduler.tasks[scheduler.heap[a]].next_us < scheduler.tasks[scheduler.heap[b]].next_us;
+}
+
+static inline void sched_heap_swap(int a, int b) {
+    uint8_t tmp = scheduler.heap[a];
+    scheduler.heap[a] = scheduler.heap[b];
+    scheduler.heap[b] = tmp;
+}
+
+static void sched_heap_sift_up(int i) {
+    while (i > 0 && sched_heap_less(i, (i - 1) / 2)) {
+        sched_heap_swap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void sched_heap_sift_down(int i) {
+    for (;;) {
+        int smallest = i, left = 2 * i + 1, right = 2 * i + 2;
+        if (left < scheduler.heap_count && sched_heap_less(left, smallest)) smallest = left;
+        if (right < scheduler.heap_count && sched_heap_less(right, smallest)) smallest = right;
+        if (smallest == i) return;
+        sched_heap_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+static void sched_heap_push(int id) {
+    scheduler.heap[scheduler.heap_count] = id;
+    sched_heap_sift_up(scheduler.heap_count++);
+    scheduler.tasks[id].queued = true;
+}
+
+static void sched_heap_remove(int pos) {
+    scheduler.tasks[scheduler.heap[pos]].queued = false;
+    scheduler.heap[pos] = scheduler.heap[--scheduler.heap_count];
+    if (pos < scheduler.heap_count) {
+        sched_heap_sift_up(pos);
+        sched_heap_sift_down(pos);
+    }
+}
+
+// --------------------------- Funções de Registro de Tarefas ---------------------------
+
+/**
+ * @brief (Re)arma uma tarefa para executar daqui a `delay_ms` milissegundos.
+ *
+ * Usada para as tarefas únicas (período 0) e para adiantar ou atrasar uma tarefa periódica.
+ */
+void sched_task_start(int id, uint32_t delay_ms) {
+    SCHED_TASK_T *task = &scheduler.tasks[id];
+    if (task->queued) {
+        for (int i = 0; i < scheduler.heap_count; i++) {
+            if (scheduler.heap[i] == id) {
+                sched_heap_remove(i);
+                break;
+            }
+        }
+    }
+    task->ready = false;
+    task->next_us = time_us_64() + (uint64_t)delay_ms * 1000;
+    sched_heap_push(id);
+}
+
+/**
+ * @brief Registra uma tarefa.
+ *
+ * @param name Nome exibido no relatório de tempo de execução.
+ * @param fn Função da tarefa (deve retornar rapidamente; nunca aguardar em laço).
+ * @param arg Argumento passado à função.
+ * @param period_ms Período em milissegundos; 0 registra uma tarefa única, armada por `sched_task_start`.
+ * @param priority Prioridade da tarefa.
+ *
+ * @return O identificador da tarefa, ou -1 se não houver espaço.
+ *
+ * Tarefas periódicas executam pela primeira vez na próxima passagem do laço.
+ */
+int sched_task_add(const char *name, sched_fn_t fn, void *arg, uint32_t period_ms, SCHED_PRIORITY_T priority) {
+    if (scheduler.task_count >= SCHED_MAX_TASKS) return -1;
+
+    int id = scheduler.task_count++;
+    SCHED_TASK_T *task = &scheduler.tasks[id];
+    task->name = name;
+    task->fn = fn;
+    task->arg = arg;
+    task->period_us = period_ms * 1000;
+    task->priority = priority;
+    if (!scheduler.window_start_us) scheduler.window_start_us = time_us_64();
+    if (period_ms) sched_task_start(id, 0);
+    return id;
+}
+
+// --------------------------- Função de Trabalho Adiado ---------------------------
+
+/**
+ * @brief Agenda `fn(arg)` para a próxima passagem do laço principal.
+ *
+ * Pode ser chamada de interrupções e de callbacks do lwIP para tirar deles o trabalho demorado.
+ *
+ * @return true se o item foi enfileirado, false se a fila estava cheia.
+ */
+bool sched_defer(sched_fn_t fn, void *arg) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    bool ok = scheduler.work_count < SCHED_DEFER_SIZE;
+    if (ok) {
+        SCHED_WORK_T *work = &scheduler.work[(scheduler.work_head + scheduler.work_count) % SCHED_DEFER_SIZE];
+        work->fn = fn;
+        work->arg = arg;
+        scheduler.work_count++;
+    } else {
+        scheduler.work_dropped++;
+    }
+    restore_interrupts(irq_state);
+    return ok;
+}
+
+// --------------------------- Função de Execução ---------------------------
+
+/**
+ * @brief Executa uma tarefa e atualiza as suas estatísticas e o seu próximo prazo.
+ *
+ * Uma tarefa periódica que perdeu um ou mais períodos não os executa em sequência:
+ * o próximo prazo passa a ser um período após o fim da execução, e a perda é contada em `late`.
+ */
+static void sched_run_task(int id, uint64_t now) {
+    SCHED_TASK_T *task = &scheduler.tasks[id];
+    task->ready = false;
+
+    uint32_t delay = (uint32_t)(now - task->next_us);
+    if (delay > task->max_delay_us) task->max_delay_us = delay;
+
+    task->fn(task->arg);
+
+    uint64_t end = time_us_64();
+    uint32_t elapsed = (uint32_t)(end - now);
+    task->runs++;
+    task->busy_us += elapsed;
+    if (elapsed > task->max_us) task->max_us = elapsed;
+
+    // A própria tarefa pode ter se rearmado com `sched_task_start`
+    if (task->period_us && !task->queued) {
+        task->next_us += task->period_us;
+        if (task->next_us <= end) {
+            task->late += (uint32_t)((end - task->next_us) / task->period_us) + 1;
+            task->next_us = end + task->period_us;
+        }
+        sched_heap_push(id);
+    }
+}
+
+/**
+ * @brief Executa uma passagem do escalonador.
+ *
+ * Esta função deve ser chamada continuamente no laço principal.
+ *
+ * ### Comportamento:
+ * - Move as tarefas com prazo vencido do heap para o estado pronto.
+ * - Executa uma única unidade de trabalho, nesta ordem: tarefa pronta de prioridade alta,
+ *   item da fila de trabalho adiado, tarefa pronta de prioridade normal ou baixa. Entre
+ *   tarefas de mesma prioridade, a de prazo mais antigo executa primeiro.
+ *
+ * @return true se alguma unidade de trabalho foi executada, false se o laço está ocioso.
+ */
+bool sched_run(void) {
+    uint64_t now = time_us_64();
+
+    while (scheduler.heap_count && scheduler.tasks[scheduler.heap[0]].next_us <= now) {
+        int id = scheduler.heap[0];
+        sched_heap_remove(0);
+        scheduler.tasks[id].ready = true;
+    }
+
+    int best = -1;
+    for (int i = 0; i < scheduler.task_count; i++) {
+        SCHED_TASK_T *task = &scheduler.tasks[i];
+        if (!task->ready) continue;
+        if (best < 0 || task->priority < scheduler.tasks[best].priority ||
+            (task->priority == scheduler.tasks[best].priority && task->next_us < scheduler.tasks[best].next_us)) {
+            best = i;
+        }
+    }
+
+    if (best >= 0 && scheduler.tasks[best].priority == SCHED_PRIORITY_HIGH) {
+        sched_run_task(best, now);
+        return true;
+    }
+
+    if (scheduler.work_count) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        SCHED_WORK_T work = scheduler.work[scheduler.work_head];
+        scheduler.work_head = (scheduler.work_head + 1) % SCHED_DEFER_SIZE;
+        scheduler.work_count--;
+        restore_interrupts(irq_state);
+
+        work.fn(work.arg);
+        scheduler.work_runs++;
+        scheduler.work_busy_us += time_us_64() - now;
+        return true;
+    }
+
+    if (best >= 0) {
+        sched_run_task(best, now);
+        return true;
+    }
+    return false;
+}
+
+// --------------------------- Função de Espera Ociosa ---------------------------
+
+/**
+ * @brief Dorme (`__wfe`) até o próximo prazo do heap ou até uma interrupção.
+ *
+ * Chamada quando `sched_run` retorna false. Qualquer interrupção (botões, CYW43, USB,
+ * `sched_defer` de uma interrupção) acorda o núcleo antes do prazo; o laço então
+ * reavalia as tarefas. O tempo dormindo aparece como ocioso no relatório.
+ */
+void sched_idle(void) {
+    if (scheduler.work_count || !scheduler.heap_count) return;
+
+    uint64_t next_us = scheduler.tasks[scheduler.heap[0]].next_us;
+    if (next_us > time_us_64()) {
+        best_effort_wfe_or_timeout(from_us_since_boot(next_us));
+    }
+}
+
+// --------------------------- Função de Relatório ---------------------------
+
+/**
+ * @brief Imprime no console o tempo de execução de cada tarefa desde o último relatório.
+ *
+ * Para cada tarefa: execuções, tempo médio e máximo, fração do tempo total (carga),
+ * maior atraso em relação ao prazo e períodos perdidos. O tempo que sobra é o laço ocioso.
+ * Zera as estatísticas da janela ao final.
+ *
+ * @param arg Não utilizado (assinatura de tarefa, para ser registrada com `sched_task_add`).
+ */
+void sched_report(void *arg) {
+    uint64_t now = time_us_64();
+    uint64_t window = now - scheduler.window_start_us;
+    if (!window) return;
+
+    uint64_t busy = scheduler.work_busy_us;
+    printf("Escalonador: janela de %lu ms\n", (unsigned long)(window / 1000));
+    printf("  %-10s %6s %8s %8s %6s %8s %5s\n", "tarefa", "exec", "med(us)", "max(us)", "carga", "atraso", "perd");
+    for (int i = 0; i < scheduler.task_count; i++) {
+        SCHED_TASK_T *task = &scheduler.tasks[i];
+        busy += task->busy_us;
+        printf("  %-10s %6lu %8lu %8lu %5lu%% %8lu %5lu\n", task->name, (unsigned long)task->runs,
+               (unsigned long)(task->runs ? task->busy_us / task->runs : 0), (unsigned long)task->max_us,
+               (unsigned long)(task->busy_us * 100 / window), (unsigned long)task->max_delay_us,
+               (unsigned long)task->late);
+        task->runs = task->late = task->max_us = task->max_delay_us = 0;
+        task->busy_us = 0;
+    }
+    printf("  adiado: %lu itens, %lu%%, %lu descartados; ocioso: %lu%%\n", (unsigned long)scheduler.work_runs,
+           (unsigned long)(scheduler.work_busy_us * 100 / window), (unsigned long)scheduler.work_dropped,
+           (unsigned long)(busy < window ? (window - busy) * 100 / window : 0));
+
+    scheduler.work_runs = 0;
+    scheduler.work_busy_us = 0;
+    scheduler.window_start_us = now;
+}
+
+#endif /*SCHEDULER_H*/
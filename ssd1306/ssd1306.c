@@ -56,6 +56,11 @@ SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len) {
     return ret;
 }
 
+/* Returns the Screenbuffer (read-only), e.g. to mirror the display remotely */
+const uint8_t* ssd1306_GetBuffer(void) {
+    return SSD1306_Buffer;
+}
+
 /* Initialize the oled screen */
 void ssd1306_Init(void) {
     // Reset OLED
@@ -172,8 +177,29 @@ void ssd1306_Fill(SSD1306_COLOR color) {
     memset(SSD1306_Buffer, (color == Black) ? 0x00 : 0xFF, sizeof(SSD1306_Buffer));
 }
 
+// Optional receiver of finished frames (e.g. a flush pipeline on the other core)
+static ssd1306_FrameSink_t SSD1306_FrameSink = NULL;
+
+void ssd1306_SetFrameSink(ssd1306_FrameSink_t sink) {
+    SSD1306_FrameSink = sink;
+}
+
+/* Write one page (8 rows, SSD1306_WIDTH bytes) of a frame to the screen */
+void ssd1306_WritePage(uint8_t page, const uint8_t* data) {
+    ssd1306_WriteCommand(0xB0 + page); // Set the current RAM page address.
+    ssd1306_WriteCommand(0x00 + SSD1306_X_OFFSET_LOWER);
+    ssd1306_WriteCommand(0x10 + SSD1306_X_OFFSET_UPPER);
+    ssd1306_WriteData((uint8_t*)data, SSD1306_WIDTH);
+}
+
 /* Write the screenbuffer with changed to the screen */
 void ssd1306_UpdateScreen(void) {
+    // With a frame sink the frame is handed over instead of written here
+    if (SSD1306_FrameSink) {
+        SSD1306_FrameSink(SSD1306_Buffer);
+        return;
+    }
+
     // Write data to each page of RAM. Number of pages
     // depends on the screen height:
     //
@@ -181,10 +207,7 @@ void ssd1306_UpdateScreen(void) {
     //  * 64px   ==  8 pages
     //  * 128px  ==  16 pages
     for(uint8_t i = 0; i < SSD1306_HEIGHT/8; i++) {
-        ssd1306_WriteCommand(0xB0 + i); // Set the current RAM page address.
-        ssd1306_WriteCommand(0x00 + SSD1306_X_OFFSET_LOWER);
-        ssd1306_WriteCommand(0x10 + SSD1306_X_OFFSET_UPPER);
-        ssd1306_WriteData(&SSD1306_Buffer[SSD1306_WIDTH*i],SSD1306_WIDTH);
+        ssd1306_WritePage(i, &SSD1306_Buffer[SSD1306_WIDTH*i]);
     }
 }
 
@@ -165,11 +165,25 @@ void ssd1306_SetDisplayOn(const uint8_t on);
  */
 uint8_t ssd1306_GetDisplayOn();
 
+/**
+ * @brief Receiver of finished frames, see ssd1306_SetFrameSink().
+ */
+typedef void (*ssd1306_FrameSink_t)(const uint8_t* buffer);
+
+/**
+ * @brief Hands every frame passed to ssd1306_UpdateScreen() to `sink` instead of writing it.
+ * @param[in] sink receiver of the screenbuffer, or NULL to write to the screen again.
+ * @note The sink must copy the buffer before returning; drawing continues on it right after.
+ */
+void ssd1306_SetFrameSink(ssd1306_FrameSink_t sink);
+
 // Low-level procedures
 void ssd1306_Reset(void);
 void ssd1306_WriteCommand(uint8_t byte);
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
+void ssd1306_WritePage(uint8_t page, const uint8_t* data);
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len);
+const uint8_t* ssd1306_GetBuffer(void);
 
 _END_STD_C
 
@@ -0,0 +1,269 @@
+/******************************************************************************
+ * @file    credential_store.h
+ * @brief   Arquivo contendo definições e funções para guardar as credenciais
+ *          Wi-Fi na memória flash do Raspberry Pi Pico W.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    As credenciais ocupam o setor imediatamente anterior à fila de
+ *          telemetria (`flash_queue.h`). O setor é um log de registros de uma
+ *          página: cada gravação usa a próxima página livre e o setor só é
+ *          apagado quando todas as páginas foram usadas. Cada registro tem
+ *          versão, número de sequência e CRC32; o SSID e a senha são
+ *          ofuscados com o identificador único da placa, para que não fiquem
+ *          legíveis em um dump da flash (não é criptografia). Junto com as
+ *          credenciais fica o último ponto de acesso usado (BSSID, canal e PMK),
+ *          para uma reconexão direta, sem varredura nem derivação da chave.
+ ******************************************************************************/
+
+#ifndef CREDENTIAL_STORE_H
+#define CREDENTIAL_STORE_H
+
+#include <string.h>                     // Biblioteca padrão para funções de manipulação de strings.
+#include "pico/stdlib.h"                // Biblioteca padrão para Raspberry Pi Pico.
+#include "pico/unique_id.h"             // Biblioteca para o identificador único da placa.
+#include "storage/flash_queue.h"        // CRC32 e acesso seguro à flash.
+#include "crypto/sha1.h"                // Tamanho da chave WPA2 (PMK).
+
+// ----------------------------------- Defines ----------------------------------
+
+#define CRED_STORE_OFFSET (FLASH_QUEUE_OFFSET - FLASH_SECTOR_SIZE) // Setor das credenciais (offset na flash).
+#define CRED_STORE_PAGES (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)       // Registros por setor (um por página).
+#define CRED_STORE_MAGIC 0x52435750     // Marcador de registro gravado ("PWCR").
+#define CRED_STORE_VERSION 2            // Versão do formato do registro.
+#define CRED_STORE_FLAG_OBFUSCATED 0x0001 // SSID, senha e PMK ofuscados com o identificador da placa.
+#define CRED_STORE_FLAG_LINK 0x0002     // BSSID, canal e PMK do último ponto de acesso gravados.
+#define CRED_STORE_SSID_SIZE 32         // Espaço do SSID no registro (802.11).
+#define CRED_STORE_PASSWORD_SIZE 64     // Espaço da senha no registro (WPA2).
+
+/* Acesso à flash. Podem ser redefinidos antes da inclusão para usar um emulador no host. */
+#ifndef CRED_STORE_READ_PTR
+#define CRED_STORE_READ_PTR(offset) ((const uint8_t *)(XIP_BASE + (offset)))
+#endif
+#ifndef CRED_STORE_ERASE
+#define CRED_STORE_ERASE(offset) flash_queue_safe_erase(offset)
+#endif
+#ifndef CRED_STORE_PROGRAM
+#define CRED_STORE_PROGRAM(offset, data) flash_queue_safe_program(offset, data)
+#endif
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura de um registro de credenciais na flash (gravado no início de uma página).
+ */
+typedef struct CRED_STORE_RECORD_T_ {
+    uint32_t magic;               // CRED_STORE_MAGIC quando o registro foi gravado.
+    uint16_t version;             // CRED_STORE_VERSION.
+    uint16_t flags;               // CRED_STORE_FLAG_OBFUSCATED, se aplicável.
+    uint32_t seq;                 // Número de sequência (o maior é o registro atual).
+    uint8_t ssid_len;             // Comprimento do SSID.
+    uint8_t password_len;         // Comprimento da senha.
+    uint16_t reserved;            // Reservado (0xFFFF).
+    uint8_t ssid[CRED_STORE_SSID_SIZE];         // SSID (ofuscado).
+    uint8_t password[CRED_STORE_PASSWORD_SIZE]; // Senha (ofuscada).
+    uint8_t bssid[6];             // BSSID do último ponto de acesso.
+    uint8_t channel;              // Canal do último ponto de acesso.
+    uint8_t reserved2;            // Reservado (0xFF).
+    uint8_t pmk[WPA2_PMK_SIZE];   // Chave WPA2 derivada da senha e do SSID (ofuscada).
+    uint32_t crc;                 // CRC32 dos campos de `magic` até `pmk`.
+} CRED_STORE_RECORD_T;
+
+_Static_assert(sizeof(CRED_STORE_RECORD_T) <= FLASH_PAGE_SIZE, "registro de credenciais deve caber em uma página");
+
+/**
+ * @brief Estrutura para armazenar o último ponto de acesso usado (cache da conexão).
+ */
+typedef struct CRED_STORE_LINK_T_ {
+    uint8_t bssid[6];             // BSSID do ponto de acesso.
+    uint8_t channel;              // Canal do ponto de acesso.
+    uint8_t pmk[WPA2_PMK_SIZE];   // Chave WPA2 (PBKDF2 da senha com o SSID).
+    bool valid;                   // O cache corresponde às credenciais atuais.
+} CRED_STORE_LINK_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+static int cred_store_current = -1;   // Página do registro atual, ou -1 se não houver (atualizada por `cred_store_load`).
+static uint32_t cred_store_seq = 0;   // Número de sequência do registro atual.
+
+
+// --------------------------- Funções Auxiliares ---------------------------
+
+/**
+ * @brief Retorna o ponteiro (via XIP) para o registro da página `page`.
+ */
+static inline const CRED_STORE_RECORD_T *cred_store_record(int page) {
+    return (const CRED_STORE_RECORD_T *)CRED_STORE_READ_PTR(CRED_STORE_OFFSET + (uint32_t)page * FLASH_PAGE_SIZE);
+}
+
+/**
+ * @brief Verifica se o registro foi gravado por inteiro e está no formato atual.
+ */
+static bool cred_store_record_valid(const CRED_STORE_RECORD_T *rec) {
+    // Registros de versões anteriores são ignorados (as credenciais são pedidas de novo pelo portal)
+    return rec->magic == CRED_STORE_MAGIC && rec->version == CRED_STORE_VERSION &&
+           rec->ssid_len >= 1 && rec->ssid_len <= CRED_STORE_SSID_SIZE &&
+           rec->password_len <= CRED_STORE_PASSWORD_SIZE &&
+           rec->crc == crc32_compute(rec, offsetof(CRED_STORE_RECORD_T, crc));
+}
+
+/**
+ * @brief Verifica se a página ainda está apagada (todos os bytes em 0xFF).
+ */
+static bool cred_store_page_blank(int page) {
+    const uint8_t *data = CRED_STORE_READ_PTR(CRED_STORE_OFFSET + (uint32_t)page * FLASH_PAGE_SIZE);
+    for (int i = 0; i < FLASH_PAGE_SIZE; i++) {
+        if (data[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Aplica (ou remove) a ofuscação do SSID e da senha.
+ *
+ * Cada byte é combinado por XOR com o identificador único da placa e com a sua posição,
+ * então a mesma operação ofusca e recupera os dados, e um registro copiado para outra
+ * placa não é lido corretamente.
+ */
+static void cred_store_obfuscate(uint8_t *data, size_t len, uint8_t salt) {
+    pico_unique_board_id_t id;
+    pico_get_unique_board_id(&id);
+    for (size_t i = 0; i < len; i++) {
+        data[i] ^= id.id[i % PICO_UNIQUE_BOARD_ID_SIZE_BYTES] ^ (uint8_t)(i * 31 + salt);
+    }
+}
+
+
+// --------------------------- Função para Ler as Credenciais ---------------------------
+
+/**
+ * @brief Lê as credenciais gravadas na flash.
+ *
+ * @param ssid Buffer para o SSID (terminado com NULL).
+ * @param ssid_size Tamanho do buffer do SSID.
+ * @param password Buffer para a senha (terminada com NULL).
+ * @param password_size Tamanho do buffer da senha.
+ * @param link Ponteiro para o cache da conexão (`valid` indica se ele foi gravado), ou NULL.
+ * @return true se havia um registro válido e ele cabe nos buffers, false caso contrário.
+ *
+ * ### Comportamento:
+ * - Percorre as páginas do setor e usa o registro válido de maior número de sequência.
+ * - Registros com CRC inválido (gravação interrompida) ou de outra versão são ignorados.
+ */
+bool cred_store_load(char *ssid, size_t ssid_size, char *password, size_t password_size, CRED_STORE_LINK_T *link) {
+    cred_store_current = -1;
+    for (int page = 0; page < CRED_STORE_PAGES; page++) {
+        const CRED_STORE_RECORD_T *rec = cred_store_record(page);
+        if (!cred_store_record_valid(rec)) continue;
+        if (cred_store_current < 0 || (int32_t)(rec->seq - cred_store_seq) > 0) {
+            cred_store_current = page;
+            cred_store_seq = rec->seq;
+        }
+    }
+    if (cred_store_current < 0) return false;
+
+    CRED_STORE_RECORD_T rec;
+    memcpy(&rec, cred_store_record(cred_store_current), sizeof(rec));
+    if (rec.ssid_len >= ssid_size || rec.password_len >= password_size) return false;
+
+    if (rec.flags & CRED_STORE_FLAG_OBFUSCATED) {
+        cred_store_obfuscate(rec.ssid, sizeof(rec.ssid), 0x00);
+        cred_store_obfuscate(rec.password, sizeof(rec.password), 0x80);
+        cred_store_obfuscate(rec.pmk, sizeof(rec.pmk), 0x40);
+    }
+    memcpy(ssid, rec.ssid, rec.ssid_len);
+    ssid[rec.ssid_len] = '\0';
+    memcpy(password, rec.password, rec.password_len);
+    password[rec.password_len] = '\0';
+
+    if (link) {
+        link->valid = (rec.flags & CRED_STORE_FLAG_LINK) != 0;
+        memcpy(link->bssid, rec.bssid, sizeof(link->bssid));
+        link->channel = rec.channel;
+        memcpy(link->pmk, rec.pmk, sizeof(link->pmk));
+    }
+    return true;
+}
+
+
+// --------------------------- Função para Gravar as Credenciais ---------------------------
+
+/**
+ * @brief Grava as credenciais na flash, se forem diferentes das já gravadas.
+ *
+ * @param ssid O SSID (1 a `CRED_STORE_SSID_SIZE` bytes).
+ * @param password A senha (até `CRED_STORE_PASSWORD_SIZE` bytes).
+ * @param link O cache da conexão a gravar junto, ou NULL (ou `valid` falso) se não houver.
+ * @return true se as credenciais estão gravadas (novas ou iguais às atuais), false em caso de erro.
+ *
+ * ### Comportamento:
+ * - Não grava nada se as credenciais e o cache forem iguais aos do registro atual.
+ * - Grava o novo registro na primeira página livre após o atual (páginas com gravação
+ *   interrompida são puladas); só apaga o setor quando não há página livre, distribuindo o
+ *   desgaste pelas `CRED_STORE_PAGES` páginas.
+ * - Enquanto há página livre, o registro anterior continua válido até o novo ser gravado,
+ *   então uma queda de energia durante a gravação não perde as credenciais.
+ *
+ * @note Deve ser chamada depois de `cred_store_load` (que localiza o registro atual).
+ */
+bool cred_store_save(const char *ssid, const char *password, const CRED_STORE_LINK_T *link) {
+    size_t ssid_len = strlen(ssid), password_len = strlen(password);
+    if (ssid_len < 1 || ssid_len > CRED_STORE_SSID_SIZE || password_len > CRED_STORE_PASSWORD_SIZE) return false;
+
+    bool has_link = link && link->valid;
+
+    // Credenciais e cache iguais aos atuais: evita desgastar a flash a cada conexão
+    char stored_ssid[CRED_STORE_SSID_SIZE + 1], stored_password[CRED_STORE_PASSWORD_SIZE + 1];
+    CRED_STORE_LINK_T stored_link;
+    if (cred_store_load(stored_ssid, sizeof(stored_ssid), stored_password, sizeof(stored_password), &stored_link) &&
+        strcmp(stored_ssid, ssid) == 0 && strcmp(stored_password, password) == 0 && stored_link.valid == has_link &&
+        (!has_link || (memcmp(stored_link.bssid, link->bssid, sizeof(link->bssid)) == 0 &&
+                       stored_link.channel == link->channel &&
+                       memcmp(stored_link.pmk, link->pmk, sizeof(link->pmk)) == 0))) {
+        return true;
+    }
+
+    // Monta a página do registro (bytes não usados em 0xFF, o valor da flash apagada)
+    static uint8_t page_buf[FLASH_PAGE_SIZE];
+    memset(page_buf, 0xFF, sizeof(page_buf));
+    CRED_STORE_RECORD_T *rec = (CRED_STORE_RECORD_T *)page_buf;
+    rec->magic = CRED_STORE_MAGIC;
+    rec->version = CRED_STORE_VERSION;
+    rec->flags = CRED_STORE_FLAG_OBFUSCATED | (has_link ? CRED_STORE_FLAG_LINK : 0);
+    rec->seq = cred_store_current < 0 ? 1 : cred_store_seq + 1;
+    rec->ssid_len = ssid_len;
+    rec->password_len = password_len;
+    memset(rec->ssid, 0, sizeof(rec->ssid));
+    memset(rec->password, 0, sizeof(rec->password));
+    memcpy(rec->ssid, ssid, ssid_len);
+    memcpy(rec->password, password, password_len);
+    cred_store_obfuscate(rec->ssid, sizeof(rec->ssid), 0x00);
+    cred_store_obfuscate(rec->password, sizeof(rec->password), 0x80);
+    if (has_link) {
+        memcpy(rec->bssid, link->bssid, sizeof(rec->bssid));
+        rec->channel = link->channel;
+        memcpy(rec->pmk, link->pmk, sizeof(rec->pmk));
+        cred_store_obfuscate(rec->pmk, sizeof(rec->pmk), 0x40);
+    }
+    rec->crc = crc32_compute(rec, offsetof(CRED_STORE_RECORD_T, crc));
+
+    // Próxima página livre após o registro atual (pulando gravações interrompidas); sem página livre, apaga o setor
+    int page = cred_store_current + 1;
+    while (page < CRED_STORE_PAGES && !cred_store_page_blank(page)) page++;
+    if (page == CRED_STORE_PAGES) {
+        if (!CRED_STORE_ERASE(CRED_STORE_OFFSET)) return false;
+        page = 0;
+    }
+
+    if (!CRED_STORE_PROGRAM(CRED_STORE_OFFSET + (uint32_t)page * FLASH_PAGE_SIZE, page_buf)) return false;
+    if (!cred_store_record_valid(cred_store_record(page))) return false;
+
+    cred_store_current = page;
+    cred_store_seq = rec->seq;
+    printf("Credenciais gravadas na flash (página %d, seq %lu)\n", page, (unsigned long)rec->seq);
+    return true;
+}
+
+#endif /*CREDENTIAL_STORE_H*/
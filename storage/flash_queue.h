@@ -0,0 +1,475 @@
+/******************************************************************************
+ * @file    flash_queue.h
+ * @brief   Arquivo contendo definições e funções para a fila persistente de
+ *          telemetria gravada na memória flash do Raspberry Pi Pico W.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    A fila é um log circular de registros de 32 bytes ocupando os últimos
+ *          `FLASH_QUEUE_SECTORS` setores da flash. Cada registro possui número de
+ *          sequência e CRC32, de forma que uma gravação interrompida (queda de
+ *          energia) é detectada e ignorada na próxima inicialização. Os setores são
+ *          apagados em ordem circular, distribuindo o desgaste por toda a região.
+ ******************************************************************************/
+
+#ifndef FLASH_QUEUE_H
+#define FLASH_QUEUE_H
+
+#include <string.h>                     // Biblioteca padrão para funções de manipulação de strings.
+#include <stddef.h>                     // Biblioteca padrão para a macro offsetof.
+#include "pico/stdlib.h"                // Biblioteca padrão para Raspberry Pi Pico.
+#include "pico/flash.h"                 // Biblioteca para execução segura de operações na flash.
+#include "hardware/flash.h"             // Biblioteca para apagar e gravar a memória flash.
+
+// ----------------------------------- Defines ----------------------------------
+
+#define FLASH_QUEUE_SECTORS 8           // Quantidade de setores de 4 KiB reservados para a fila.
+#define FLASH_QUEUE_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_QUEUE_SECTORS * FLASH_SECTOR_SIZE) // Início da região (offset na flash).
+#define FLASH_QUEUE_RECORD_SIZE 32      // Tamanho de cada registro em bytes.
+#define FLASH_QUEUE_RECORDS_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_QUEUE_RECORD_SIZE)
+#define FLASH_QUEUE_RECORDS_PER_PAGE (FLASH_PAGE_SIZE / FLASH_QUEUE_RECORD_SIZE)
+#define FLASH_QUEUE_CAPACITY (FLASH_QUEUE_SECTORS * FLASH_QUEUE_RECORDS_PER_SECTOR)
+#define FLASH_QUEUE_MAGIC 0xA5          // Marcador de registro gravado.
+#define FLASH_QUEUE_PENDING 0xFF        // Valor do campo `consumed` para registro ainda não enviado.
+#define FLASH_QUEUE_CONSUMED 0x00       // Valor do campo `consumed` para registro já enviado.
+
+#define FLASH_QUEUE_DROP_OLDEST 0       // Política: com a fila cheia, apaga o setor mais antigo.
+#define FLASH_QUEUE_DECIMATE 1          // Política: conforme a fila enche, aceita apenas 1 a cada N amostras.
+#define FLASH_QUEUE_POLICY FLASH_QUEUE_DROP_OLDEST // Política de contrapressão utilizada.
+
+/* Acesso à flash. Podem ser redefinidos antes da inclusão para usar um emulador no host. */
+#ifndef FLASH_QUEUE_READ_PTR
+#define FLASH_QUEUE_READ_PTR(offset) ((const uint8_t *)(XIP_BASE + (offset)))
+#endif
+#ifndef FLASH_QUEUE_ERASE
+#define FLASH_QUEUE_ERASE(offset) flash_queue_safe_erase(offset)
+#endif
+#ifndef FLASH_QUEUE_PROGRAM
+#define FLASH_QUEUE_PROGRAM(offset, data) flash_queue_safe_program(offset, data)
+#endif
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura de um registro da fila na flash (32 bytes).
+ *
+ * O campo `consumed` fica fora do CRC: ele é gravado de 0xFF para 0x00 depois que a
+ * amostra é entregue, aproveitando que a flash NOR só transiciona bits de 1 para 0
+ * sem necessidade de apagar o setor.
+ */
+typedef struct FLASH_QUEUE_RECORD_T_ {
+    uint8_t magic;                // FLASH_QUEUE_MAGIC quando o registro foi gravado.
+    uint8_t consumed;             // FLASH_QUEUE_PENDING ou FLASH_QUEUE_CONSUMED.
+    uint16_t reserved;            // Reservado (0xFFFF).
+    uint32_t seq;                 // Número de sequência monotônico.
+    uint32_t timestamp_ms;        // Instante da leitura em milissegundos desde o boot.
+    float temperature;            // Temperatura da amostra.
+    float lat;                    // Latitude da amostra.
+    float lon;                    // Longitude da amostra.
+    uint32_t reserved2;           // Reservado (0xFFFFFFFF).
+    uint32_t crc;                 // CRC32 dos campos de `seq` até `reserved2`.
+} FLASH_QUEUE_RECORD_T;
+
+_Static_assert(sizeof(FLASH_QUEUE_RECORD_T) == FLASH_QUEUE_RECORD_SIZE, "registro da fila deve ter 32 bytes");
+
+/**
+ * @brief Estrutura para armazenar o estado da fila em RAM.
+ *
+ * O estado é reconstruído em `flash_queue_init` a partir do conteúdo da flash.
+ */
+typedef struct FLASH_QUEUE_T_ {
+    uint16_t head;                // Índice do registro pendente mais antigo.
+    uint16_t tail;                // Índice do próximo registro a ser gravado.
+    uint16_t count;               // Quantidade de registros pendentes.
+    uint32_t next_seq;            // Próximo número de sequência.
+    uint32_t dropped;             // Amostras descartadas pela política de contrapressão.
+    uint32_t corrupted;           // Registros com CRC inválido encontrados na inicialização.
+    uint32_t decimate_counter;    // Contador usado pela política de decimação.
+    bool initialized;             // Flag para indicar se a fila foi inicializada.
+} FLASH_QUEUE_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+FLASH_QUEUE_T flash_queue = {0};  // Estado da fila persistente.
+
+
+// --------------------------- Função de Cálculo do CRC32 ---------------------------
+
+/**
+ * @brief Calcula o CRC32 (polinômio 0xEDB88320) de um bloco de dados.
+ *
+ * @param data Ponteiro para os dados.
+ * @param len Quantidade de bytes.
+ * @return uint32_t O CRC32 calculado.
+ */
+uint32_t crc32_compute(const void *data, size_t len) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (len--) {
+        crc ^= *bytes++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+
+// --------------------------- Funções de Acesso Seguro à Flash ---------------------------
+
+/**
+ * @brief Funções executadas com interrupções (e o outro núcleo) suspensos.
+ *
+ * `flash_safe_execute` garante que nenhum código rode a partir da flash (XIP)
+ * enquanto ela está sendo apagada ou gravada.
+ */
+static void flash_queue_do_erase(void *param) {
+    flash_range_erase((uint32_t)(uintptr_t)param, FLASH_SECTOR_SIZE);
+}
+
+typedef struct FLASH_QUEUE_PROGRAM_T_ {
+    uint32_t offset;              // Offset da página na flash.
+    const uint8_t *data;          // Conteúdo da página (FLASH_PAGE_SIZE bytes).
+} FLASH_QUEUE_PROGRAM_T;
+
+static void flash_queue_do_program(void *param) {
+    FLASH_QUEUE_PROGRAM_T *program = (FLASH_QUEUE_PROGRAM_T *)param;
+    flash_range_program(program->offset, program->data, FLASH_PAGE_SIZE);
+}
+
+static bool flash_queue_safe_erase(uint32_t offset) {
+    return flash_safe_execute(flash_queue_do_erase, (void *)(uintptr_t)offset, UINT32_MAX) == PICO_OK;
+}
+
+static bool flash_queue_safe_program(uint32_t offset, const uint8_t *data) {
+    FLASH_QUEUE_PROGRAM_T program = { .offset = offset, .data = data };
+    return flash_safe_execute(flash_queue_do_program, &program, UINT32_MAX) == PICO_OK;
+}
+
+
+// --------------------------- Funções Auxiliares de Registro ---------------------------
+
+/**
+ * @brief Retorna o ponteiro (via XIP) para o registro de índice `index`.
+ */
+static inline const FLASH_QUEUE_RECORD_T *flash_queue_record(uint16_t index) {
+    return (const FLASH_QUEUE_RECORD_T *)FLASH_QUEUE_READ_PTR(FLASH_QUEUE_OFFSET + (uint32_t)index * FLASH_QUEUE_RECORD_SIZE);
+}
+
+/**
+ * @brief Calcula o CRC de um registro (campos de `seq` até `reserved2`).
+ */
+static inline uint32_t flash_queue_record_crc(const FLASH_QUEUE_RECORD_T *rec) {
+    return crc32_compute(&rec->seq, offsetof(FLASH_QUEUE_RECORD_T, crc) - offsetof(FLASH_QUEUE_RECORD_T, seq));
+}
+
+/**
+ * @brief Verifica se o registro foi gravado por completo (marcador e CRC válidos).
+ */
+static inline bool flash_queue_record_valid(const FLASH_QUEUE_RECORD_T *rec) {
+    return rec->magic == FLASH_QUEUE_MAGIC && rec->crc == flash_queue_record_crc(rec);
+}
+
+/**
+ * @brief Verifica se o espaço do registro ainda está apagado (todos os bytes em 0xFF).
+ */
+static bool flash_queue_record_blank(const FLASH_QUEUE_RECORD_T *rec) {
+    const uint8_t *bytes = (const uint8_t *)rec;
+    for (int i = 0; i < FLASH_QUEUE_RECORD_SIZE; i++) {
+        if (bytes[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Grava bytes dentro de uma página sem apagá-la.
+ *
+ * @param index Índice do registro cuja página será gravada.
+ * @param offset_in_page Posição dos dados dentro da página.
+ * @param data Dados a serem gravados.
+ * @param len Quantidade de bytes.
+ *
+ * O restante da página é preenchido com 0xFF, que não altera bits já gravados.
+ */
+static bool flash_queue_program_bytes(uint16_t index, uint16_t offset_in_page, const void *data, uint16_t len) {
+    static uint8_t page[FLASH_PAGE_SIZE];
+    uint32_t page_offset = FLASH_QUEUE_OFFSET + ((uint32_t)index / FLASH_QUEUE_RECORDS_PER_PAGE) * FLASH_PAGE_SIZE;
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page + offset_in_page, data, len);
+    return FLASH_QUEUE_PROGRAM(page_offset, page);
+}
+
+
+// --------------------------- Função de Inicialização da Fila ---------------------------
+
+/**
+ * @brief Reconstrói o estado da fila a partir do conteúdo da flash.
+ *
+ * ### Comportamento:
+ * - Localiza o registro válido com o maior número de sequência; o próximo espaço em
+ *   branco após ele passa a ser o ponto de escrita (`tail`).
+ * - Percorre a região a partir do `tail` para encontrar o registro pendente mais antigo
+ *   (`head`) e contar os registros pendentes.
+ * - Registros com CRC inválido (gravação interrompida) são contabilizados e ignorados.
+ *
+ * @note Deve ser chamada antes de qualquer outra função da fila, de preferência antes
+ *       de iniciar o Wi-Fi.
+ */
+void flash_queue_init(void) {
+    FLASH_QUEUE_T *q = &flash_queue;
+    memset(q, 0, sizeof(*q));
+
+    bool found = false;
+    uint32_t max_seq = 0;
+    uint16_t last = 0;
+
+    for (uint16_t i = 0; i < FLASH_QUEUE_CAPACITY; i++) {
+        const FLASH_QUEUE_RECORD_T *rec = flash_queue_record(i);
+        if (flash_queue_record_valid(rec)) {
+            if (!found || (int32_t)(rec->seq - max_seq) > 0) {
+                max_seq = rec->seq;
+                last = i;
+                found = true;
+            }
+        } else if (!flash_queue_record_blank(rec)) {
+            q->corrupted++;
+        }
+    }
+
+    if (found) {
+        q->next_seq = max_seq + 1;
+        q->tail = (last + 1) % FLASH_QUEUE_CAPACITY;
+
+        // Pula espaços danificados por uma gravação interrompida dentro do mesmo setor
+        while (q->tail % FLASH_QUEUE_RECORDS_PER_SECTOR != 0 && !flash_queue_record_blank(flash_queue_record(q->tail))) {
+            q->tail = (q->tail + 1) % FLASH_QUEUE_CAPACITY;
+        }
+
+        // O registro pendente mais antigo é o primeiro encontrado a partir do ponto de escrita
+        bool head_found = false;
+        for (uint16_t n = 0; n < FLASH_QUEUE_CAPACITY; n++) {
+            uint16_t i = (q->tail + n) % FLASH_QUEUE_CAPACITY;
+            const FLASH_QUEUE_RECORD_T *rec = flash_queue_record(i);
+            if (flash_queue_record_valid(rec) && rec->consumed == FLASH_QUEUE_PENDING) {
+                if (!head_found) {
+                    q->head = i;
+                    head_found = true;
+                }
+                q->count++;
+            }
+        }
+        if (!head_found) {
+            q->head = q->tail;
+        }
+    }
+
+    q->initialized = true;
+    printf("Fila na flash: %u pendentes, %lu corrompidos\n", q->count, (unsigned long)q->corrupted);
+}
+
+
+// --------------------------- Função de Avanço do Head ---------------------------
+
+/**
+ * @brief Avança o `head` até o próximo registro pendente.
+ *
+ * @note Só deve ser chamada com `count > 0`; com a fila cheia, `head` e `tail` coincidem.
+ */
+static void flash_queue_advance_head(void) {
+    FLASH_QUEUE_T *q = &flash_queue;
+    for (uint16_t scanned = 0; scanned < FLASH_QUEUE_CAPACITY; scanned++) {
+        const FLASH_QUEUE_RECORD_T *rec = flash_queue_record(q->head);
+        if (flash_queue_record_valid(rec) && rec->consumed == FLASH_QUEUE_PENDING) return;
+        q->head = (q->head + 1) % FLASH_QUEUE_CAPACITY;
+    }
+    q->head = q->tail;
+}
+
+
+// --------------------------- Função de Preparação de Setor ---------------------------
+
+/**
+ * @brief Prepara o setor que começa no `tail` para receber novos registros.
+ *
+ * @return true se o setor está pronto para gravação, false se a amostra deve ser descartada.
+ *
+ * Se o setor ainda contém registros pendentes, a fila está cheia. Com a política
+ * `FLASH_QUEUE_DROP_OLDEST` esses registros são descartados e o setor é apagado;
+ * com `FLASH_QUEUE_DECIMATE` a nova amostra é descartada.
+ */
+static bool flash_queue_prepare_sector(void) {
+    FLASH_QUEUE_T *q = &flash_queue;
+    uint16_t first = q->tail;
+    uint16_t pending = 0;
+    bool blank = true;
+
+    for (uint16_t i = first; i < first + FLASH_QUEUE_RECORDS_PER_SECTOR; i++) {
+        const FLASH_QUEUE_RECORD_T *rec = flash_queue_record(i);
+        if (!flash_queue_record_blank(rec)) {
+            blank = false;
+            if (flash_queue_record_valid(rec) && rec->consumed == FLASH_QUEUE_PENDING) pending++;
+        }
+    }
+    if (blank) return true;
+
+    if (pending) {
+#if FLASH_QUEUE_POLICY == FLASH_QUEUE_DECIMATE
+        return false;
+#else
+        q->count -= pending;
+        q->dropped += pending;
+#endif
+    }
+
+    if (!FLASH_QUEUE_ERASE(FLASH_QUEUE_OFFSET + (uint32_t)first * FLASH_QUEUE_RECORD_SIZE)) return false;
+
+    // Se o head estava no setor apagado, ele passa para o próximo registro pendente
+    if (pending) {
+        q->head = (first + FLASH_QUEUE_RECORDS_PER_SECTOR) % FLASH_QUEUE_CAPACITY;
+        if (q->count == 0) q->head = q->tail;
+        else flash_queue_advance_head();
+    }
+    return true;
+}
+
+
+// --------------------------- Função para Gravar uma Amostra ---------------------------
+
+/**
+ * @brief Acrescenta uma amostra ao final da fila na flash.
+ *
+ * @param timestamp_ms Instante da leitura em milissegundos desde o boot.
+ * @param temperature Temperatura da amostra.
+ * @param lat Latitude da amostra.
+ * @param lon Longitude da amostra.
+ * @return true se a amostra foi gravada, false se foi descartada.
+ *
+ * ### Comportamento:
+ * - Com a política `FLASH_QUEUE_DECIMATE`, aceita 1 a cada 2 amostras acima de 50% de
+ *   ocupação e 1 a cada 4 acima de 75%.
+ * - Ao entrar em um novo setor, apaga-o aplicando a política de contrapressão.
+ * - Grava o registro completo (com CRC) em uma única operação de página.
+ */
+bool flash_queue_push(uint32_t timestamp_ms, float temperature, float lat, float lon) {
+    FLASH_QUEUE_T *q = &flash_queue;
+    if (!q->initialized) return false;
+
+#if FLASH_QUEUE_POLICY == FLASH_QUEUE_DECIMATE
+    uint32_t factor = 1;
+    if (q->count >= FLASH_QUEUE_CAPACITY * 3 / 4) factor = 4;
+    else if (q->count >= FLASH_QUEUE_CAPACITY / 2) factor = 2;
+    if ((q->decimate_counter++ % factor) != 0) {
+        q->dropped++;
+        return false;
+    }
+#endif
+
+    if (q->tail % FLASH_QUEUE_RECORDS_PER_SECTOR == 0 && !flash_queue_prepare_sector()) {
+        q->dropped++;
+        return false;
+    }
+
+    FLASH_QUEUE_RECORD_T rec;
+    memset(&rec, 0xFF, sizeof(rec));
+    rec.magic = FLASH_QUEUE_MAGIC;
+    rec.consumed = FLASH_QUEUE_PENDING;
+    rec.seq = q->next_seq;
+    rec.timestamp_ms = timestamp_ms;
+    rec.temperature = temperature;
+    rec.lat = lat;
+    rec.lon = lon;
+    rec.crc = flash_queue_record_crc(&rec);
+
+    uint16_t slot = q->tail;
+    bool ok = flash_queue_program_bytes(slot, (slot % FLASH_QUEUE_RECORDS_PER_PAGE) * FLASH_QUEUE_RECORD_SIZE,
+                                        &rec, sizeof(rec));
+
+    // O espaço é consumido mesmo em caso de falha, pois pode ter sido parcialmente gravado
+    q->tail = (q->tail + 1) % FLASH_QUEUE_CAPACITY;
+    q->next_seq++;
+    if (!ok || !flash_queue_record_valid(flash_queue_record(slot))) {
+        q->dropped++;
+        return false;
+    }
+
+    if (q->count == 0) q->head = slot;
+    q->count++;
+    return true;
+}
+
+
+// --------------------------- Função para Ler um Lote ---------------------------
+
+/**
+ * @brief Obtém os registros pendentes mais antigos, sem removê-los da fila.
+ *
+ * @param out Vetor que receberá ponteiros (via XIP) para os registros.
+ * @param max Quantidade máxima de registros.
+ * @return uint16_t A quantidade de registros retornados.
+ *
+ * @note Os ponteiros permanecem válidos até a próxima chamada de `flash_queue_push`.
+ */
+uint16_t flash_queue_peek(const FLASH_QUEUE_RECORD_T **out, uint16_t max) {
+    FLASH_QUEUE_T *q = &flash_queue;
+    uint16_t n = 0;
+    uint16_t i = q->head;
+
+    // Limita pela capacidade: com a fila cheia, `head` e `tail` coincidem
+    for (uint16_t scanned = 0; n < max && n < q->count && scanned < FLASH_QUEUE_CAPACITY; scanned++) {
+        const FLASH_QUEUE_RECORD_T *rec = flash_queue_record(i);
+        if (flash_queue_record_valid(rec) && rec->consumed == FLASH_QUEUE_PENDING) {
+            out[n++] = rec;
+        }
+        i = (i + 1) % FLASH_QUEUE_CAPACITY;
+    }
+    return n;
+}
+
+
+// --------------------------- Função para Remover um Lote ---------------------------
+
+/**
+ * @brief Marca como entregues os `n` registros pendentes mais antigos.
+ *
+ * @param n Quantidade de registros entregues.
+ *
+ * Os registros de uma mesma página são marcados com uma única operação de gravação.
+ */
+void flash_queue_consume(uint16_t n) {
+    FLASH_QUEUE_T *q = &flash_queue;
+    static uint8_t page[FLASH_PAGE_SIZE];
+    int32_t page_index = -1;
+
+    while (n > 0 && q->count > 0) {
+        uint16_t i = q->head;
+        int32_t this_page = i / FLASH_QUEUE_RECORDS_PER_PAGE;
+
+        // Ao mudar de página, grava as marcações acumuladas
+        if (this_page != page_index) {
+            if (page_index >= 0) {
+                FLASH_QUEUE_PROGRAM(FLASH_QUEUE_OFFSET + (uint32_t)page_index * FLASH_PAGE_SIZE, page);
+            }
+            memset(page, 0xFF, sizeof(page));
+            page_index = this_page;
+        }
+        page[(i % FLASH_QUEUE_RECORDS_PER_PAGE) * FLASH_QUEUE_RECORD_SIZE + offsetof(FLASH_QUEUE_RECORD_T, consumed)] = FLASH_QUEUE_CONSUMED;
+
+        q->count--;
+        n--;
+        q->head = (q->head + 1) % FLASH_QUEUE_CAPACITY;
+        if (q->count == 0) {
+            q->head = q->tail;
+        } else {
+            flash_queue_advance_head();
+        }
+    }
+
+    if (page_index >= 0) {
+        FLASH_QUEUE_PROGRAM(FLASH_QUEUE_OFFSET + (uint32_t)page_index * FLASH_PAGE_SIZE, page);
+    }
+}
+
+#endif /*FLASH_QUEUE_H*/
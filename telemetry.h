@@ -0,0 +1,379 @@
+/******************************************************************************
+ * @file    telemetry.h
+ * @brief   Arquivo contendo definições e funções para o envio de telemetria
+ *          em lotes para o ThingSpeak no Raspberry Pi Pico W.
+ *
+ * @authors Gabriel Domingos de Medeiros
+ * @date    Fevereiro 2025
+ * @version 1.0.0
+ *
+ * @note    As amostras (temperatura, latitude, longitude e instante da leitura)
+ *          são acumuladas em um buffer circular e enviadas em uma única
+ *          requisição POST para o endpoint `bulk_update.json` do ThingSpeak.
+ *          Sem conexão (ou se o envio falhar), as amostras são gravadas na fila
+ *          persistente da flash e reenviadas em lotes quando a conexão voltar.
+ ******************************************************************************/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "http.h"                       // Arquivo contendo funções para o protocolo HTTP.
+#include "storage/flash_queue.h"        // Arquivo contendo a fila persistente de telemetria na flash.
+
+// ----------------------------------- Defines ----------------------------------
+
+#define TELEMETRY_USE_BULK 1            // 1 = envia em lotes (bulk update), 0 = uma requisição GET por amostra.
+#define TELEMETRY_RING_SIZE 32          // Capacidade do buffer circular de amostras.
+#define TELEMETRY_BATCH_SIZE 15         // Quantidade de amostras que dispara o envio de um lote.
+#define TELEMETRY_BATCH_MAX_AGE_MS 30000 // Idade máxima (ms) da amostra mais antiga antes de forçar o envio.
+#define TELEMETRY_CL_RESERVE 16         // Espaço reservado no buffer da conexão para o `Content-Length`.
+#define TELEMETRY_ENTRY_MAX_LEN 86      // Maior entrada do lote em JSON (`delta_t` de 7 dígitos e três valores de 12 caracteres).
+
+// ---------------------------------- Estruturas --------------------------------
+
+/**
+ * @brief Estrutura para armazenar uma amostra de telemetria.
+ */
+typedef struct TELEMETRY_SAMPLE_T_ {
+    float temperature;            // Temperatura lida no sensor interno.
+    float lat;                    // Latitude associada à amostra.
+    float lon;                    // Longitude associada à amostra.
+    uint32_t timestamp_ms;        // Instante da leitura em milissegundos desde o boot.
+} TELEMETRY_SAMPLE_T;
+
+/**
+ * @brief Estrutura para armazenar o buffer circular de amostras.
+ *
+ * Quando o buffer está cheio, a amostra mais antiga é descartada e o contador
+ * `dropped` é incrementado.
+ */
+typedef struct TELEMETRY_RING_T_ {
+    TELEMETRY_SAMPLE_T samples[TELEMETRY_RING_SIZE]; // Amostras armazenadas.
+    uint16_t head;                // Índice da amostra mais antiga.
+    uint16_t count;               // Quantidade de amostras armazenadas.
+    uint32_t dropped;             // Quantidade de amostras descartadas por falta de espaço.
+} TELEMETRY_RING_T;
+
+/**
+ * @brief Origem do lote em envio.
+ */
+typedef enum {
+    TELEMETRY_SOURCE_RING,        // Amostras retiradas do buffer circular em RAM.
+    TELEMETRY_SOURCE_FLASH        // Amostras lidas da fila persistente na flash.
+} TELEMETRY_SOURCE_T;
+
+// ---------------------------------- Variáveis ---------------------------------
+
+TELEMETRY_RING_T telemetry_ring = {0};                  // Buffer circular de amostras.
+TELEMETRY_SAMPLE_T telemetry_inflight[TELEMETRY_BATCH_SIZE]; // Cópia do lote em envio (para reenvio em caso de falha).
+uint16_t telemetry_inflight_count = 0;                  // Quantidade de amostras do lote em envio.
+TELEMETRY_SOURCE_T telemetry_inflight_source;           // Origem do lote em envio.
+
+// Um lote cheio de valores extremos não cabe no buffer (o excedente segue no próximo lote), mas uma entrada sempre cabe
+_Static_assert(TELEMETRY_ENTRY_MAX_LEN + TELEMETRY_CL_RESERVE <= HTTP_CLIENT_BUF_SIZE, "uma entrada do lote deve caber no buffer da conexão");
+
+/* Trechos fixos da requisição de bulk update. */
+static const char TELEMETRY_POST_HEADER[] = "POST /channels/" THINGSPEAK_CHANNEL_ID "/bulk_update.json HTTP/1.1\r\n"
+                                            "Host: " THINGSPEAK_HOST "\r\n"
+                                            "Content-Type: application/json\r\n"
+                                            "Connection: close\r\n"
+                                            "Content-Length: ";
+static const char TELEMETRY_JSON_PREFIX[] = "{\"write_api_key\":\"" THINGSPEAK_API_KEY "\",\"updates\":[";
+static const char TELEMETRY_JSON_SUFFIX[] = "]}";
+
+
+// --------------------------- Função para Armazenar uma Amostra ---------------------------
+
+/**
+ * @brief Armazena uma amostra de telemetria no buffer circular.
+ *
+ * @param temperature A temperatura lida.
+ * @param lat A latitude associada à amostra.
+ * @param lon A longitude associada à amostra.
+ * @param timestamp_ms Instante da leitura em milissegundos desde o boot.
+ *
+ * ### Comportamento:
+ * - Descarta a amostra mais antiga se o buffer estiver cheio.
+ * - Registra a amostra com o instante da leitura, e não o da chegada ao buffer.
+ */
+void telemetry_push(float temperature, float lat, float lon, uint32_t timestamp_ms) {
+    TELEMETRY_RING_T *ring = &telemetry_ring;
+
+    // Buffer cheio: descarta a amostra mais antiga
+    if (ring->count == TELEMETRY_RING_SIZE) {
+        ring->head = (ring->head + 1) % TELEMETRY_RING_SIZE;
+        ring->count--;
+        ring->dropped++;
+    }
+
+    TELEMETRY_SAMPLE_T *sample = &ring->samples[(ring->head + ring->count) % TELEMETRY_RING_SIZE];
+    sample->temperature = temperature;
+    sample->lat = lat;
+    sample->lon = lon;
+    sample->timestamp_ms = timestamp_ms;
+    ring->count++;
+}
+
+
+// --------------------------- Função para Verificar se o Lote Deve ser Enviado ---------------------------
+
+/**
+ * @brief Verifica se o lote atual deve ser enviado.
+ *
+ * @return true se o buffer atingiu `TELEMETRY_BATCH_SIZE` amostras ou se a amostra mais
+ *         antiga ultrapassou `TELEMETRY_BATCH_MAX_AGE_MS`, false caso contrário.
+ */
+bool telemetry_flush_due(void) {
+    TELEMETRY_RING_T *ring = &telemetry_ring;
+    if (ring->count == 0) return false;
+    if (ring->count >= TELEMETRY_BATCH_SIZE) return true;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    return (now - ring->samples[ring->head].timestamp_ms) >= TELEMETRY_BATCH_MAX_AGE_MS;
+}
+
+
+// --------------------------- Função para Enviar o Lote ---------------------------
+
+/**
+ * @brief Monta e envia o lote em `telemetry_inflight` para o endpoint de bulk update do ThingSpeak.
+ *
+ * @return int O número de amostras enviadas no lote (as primeiras de `telemetry_inflight`),
+ *         ou -1 em caso de falha (nenhuma amostra fica em envio).
+ *
+ * ### Comportamento:
+ * - Serializa as amostras no formato JSON esperado pelo ThingSpeak, usando `delta_t`
+ *   (segundos desde a amostra anterior do lote) como carimbo de tempo.
+ * - Formata os valores em ponto fixo diretamente no buffer da conexão (`http_client`).
+ * - Amostras que não couberem no buffer ficam fora do lote em envio (`telemetry_inflight_count`
+ *   passa a ser o número enviado); quem chamou as mantém na origem para o próximo lote.
+ * - Formata o `Content-Length` depois do corpo, quando o seu tamanho já é conhecido.
+ * - Monta a requisição com os trechos fixos na flash e os trechos dinâmicos do buffer,
+ *   e a inicia chamando `http_client_send`.
+ */
+int telemetry_send_inflight(void) {
+    HTTP_CLIENT_T *client = http_client_reset();
+    if (!client) {
+        telemetry_inflight_count = 0;
+        return -1;
+    }
+
+    uint16_t sent = 0;
+    uint32_t previous_ms = telemetry_inflight[0].timestamp_ms;
+    while (sent < telemetry_inflight_count) {
+        TELEMETRY_SAMPLE_T *sample = &telemetry_inflight[sent];
+        u16_t entry_start = client->buf_len;
+
+        // Amostras gravadas antes de uma reinicialização podem ter carimbo menor que o anterior
+        int32_t elapsed_ms = (int32_t)(sample->timestamp_ms - previous_ms);
+        uint32_t delta_t = elapsed_ms > 0 ? ((uint32_t)elapsed_ms + 500) / 1000 : 0;
+
+        bool ok = (sent == 0 || http_buf_append(client, ",", 1))
+               && http_buf_append(client, "{\"delta_t\":", 11)
+               && http_buf_append_uint(client, delta_t)
+               && http_buf_append(client, ",\"field1\":", 10)
+               && http_buf_append_fixed(client, float_to_fixed(sample->temperature, 2), 2)
+               && http_buf_append(client, ",\"field2\":", 10)
+               && http_buf_append_fixed(client, float_to_fixed(sample->lat, 6), 6)
+               && http_buf_append(client, ",\"field3\":", 10)
+               && http_buf_append_fixed(client, float_to_fixed(sample->lon, 6), 6)
+               && http_buf_append(client, "}", 1);
+
+        // Reserva espaço para o Content-Length
+        if (!ok || client->buf_len > HTTP_CLIENT_BUF_SIZE - TELEMETRY_CL_RESERVE) {
+            client->buf_len = entry_start;
+            break;
+        }
+
+        previous_ms = sample->timestamp_ms;
+        sent++;
+    }
+    telemetry_inflight_count = sent;
+    if (sent == 0) return -1;
+
+    u16_t body_len = client->buf_len;
+    uint32_t content_length = (sizeof(TELEMETRY_JSON_PREFIX) - 1) + body_len + (sizeof(TELEMETRY_JSON_SUFFIX) - 1);
+    http_buf_append_uint(client, content_length);
+    http_buf_append(client, "\r\n\r\n", 4);
+
+    http_add_segment(client, TELEMETRY_POST_HEADER, sizeof(TELEMETRY_POST_HEADER) - 1);
+    http_add_segment(client, client->buf + body_len, client->buf_len - body_len);
+    http_add_segment(client, TELEMETRY_JSON_PREFIX, sizeof(TELEMETRY_JSON_PREFIX) - 1);
+    http_add_segment(client, client->buf, body_len);
+    http_add_segment(client, TELEMETRY_JSON_SUFFIX, sizeof(TELEMETRY_JSON_SUFFIX) - 1);
+
+    LOG_INFO("Enviando lote com %u amostras (%lu bytes de corpo)", sent, content_length);
+    http_client_send();
+    return sent;
+}
+
+
+// --------------------------- Função para Enviar o Lote do Buffer Circular ---------------------------
+
+/**
+ * @brief Envia até `TELEMETRY_BATCH_SIZE` amostras do buffer circular.
+ *
+ * @return int O número de amostras enviadas no lote, ou -1 em caso de falha.
+ *
+ * @note Só as amostras que couberam na requisição são retiradas do buffer; as demais
+ *       (e todas, em caso de falha) continuam nele para o próximo lote.
+ */
+int telemetry_flush(void) {
+    TELEMETRY_RING_T *ring = &telemetry_ring;
+    if (ring->count == 0) return 0;
+
+    uint16_t n = ring->count < TELEMETRY_BATCH_SIZE ? ring->count : TELEMETRY_BATCH_SIZE;
+    for (uint16_t i = 0; i < n; i++) {
+        telemetry_inflight[i] = ring->samples[(ring->head + i) % TELEMETRY_RING_SIZE];
+    }
+
+    telemetry_inflight_count = n;
+    telemetry_inflight_source = TELEMETRY_SOURCE_RING;
+    int sent = telemetry_send_inflight();
+    if (sent > 0) {
+        ring->head = (ring->head + sent) % TELEMETRY_RING_SIZE;
+        ring->count -= sent;
+    }
+    return sent;
+}
+
+
+// --------------------------- Função para Enviar o Lote da Flash ---------------------------
+
+/**
+ * @brief Lê até `TELEMETRY_BATCH_SIZE` amostras pendentes da fila na flash e as envia.
+ *
+ * @return int O número de amostras enviadas no lote, ou -1 em caso de falha.
+ *
+ * @note As amostras só são marcadas como entregues em `telemetry_complete`, depois da
+ *       confirmação do servidor.
+ */
+int telemetry_flush_flash(void) {
+    const FLASH_QUEUE_RECORD_T *records[TELEMETRY_BATCH_SIZE];
+    uint16_t n = flash_queue_peek(records, TELEMETRY_BATCH_SIZE);
+    if (n == 0) return 0;
+
+    for (uint16_t i = 0; i < n; i++) {
+        telemetry_inflight[i].temperature = records[i]->temperature;
+        telemetry_inflight[i].lat = records[i]->lat;
+        telemetry_inflight[i].lon = records[i]->lon;
+        telemetry_inflight[i].timestamp_ms = records[i]->timestamp_ms;
+    }
+
+    telemetry_inflight_count = n;
+    telemetry_inflight_source = TELEMETRY_SOURCE_FLASH;
+    return telemetry_send_inflight();
+}
+
+
+// --------------------------- Função para Gravar Amostras na Flash ---------------------------
+
+/**
+ * @brief Transfere amostras para a fila persistente na flash.
+ *
+ * @param samples Vetor de amostras.
+ * @param n Quantidade de amostras.
+ */
+void telemetry_spill(const TELEMETRY_SAMPLE_T *samples, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+        flash_queue_push(samples[i].timestamp_ms, samples[i].temperature, samples[i].lat, samples[i].lon);
+    }
+}
+
+
+/**
+ * @brief Transfere todas as amostras do buffer circular para a fila persistente na flash.
+ */
+void telemetry_spill_ring(void) {
+    TELEMETRY_RING_T *ring = &telemetry_ring;
+    while (ring->count) {
+        telemetry_spill(&ring->samples[ring->head], 1);
+        ring->head = (ring->head + 1) % TELEMETRY_RING_SIZE;
+        ring->count--;
+    }
+}
+
+
+// --------------------------- Função de Conclusão do Envio ---------------------------
+
+/**
+ * @brief Trata o resultado do lote em envio.
+ *
+ * @param ok true se o servidor confirmou o recebimento do lote.
+ *
+ * ### Comportamento:
+ * - Sucesso com lote da flash: marca os registros como entregues.
+ * - Falha com lote do buffer circular: grava as amostras na flash para reenvio.
+ * - Falha com lote da flash: mantém os registros pendentes para a próxima tentativa.
+ */
+void telemetry_complete(bool ok) {
+    if (ok) {
+        if (telemetry_inflight_source == TELEMETRY_SOURCE_FLASH) {
+            flash_queue_consume(telemetry_inflight_count);
+        }
+    } else if (telemetry_inflight_source == TELEMETRY_SOURCE_RING) {
+        telemetry_spill(telemetry_inflight, telemetry_inflight_count);
+    }
+    telemetry_inflight_count = 0;
+}
+
+
+// --------------------------- Função de Verificação do Enlace ---------------------------
+
+/**
+ * @brief Verifica se a interface Wi-Fi (modo STA) está conectada e com endereço IP.
+ */
+bool telemetry_link_up(void) {
+    return start_wifi && wifi_link_ok && cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA) == CYW43_LINK_UP;
+}
+
+
+// --------------------------- Função de Processamento da Telemetria ---------------------------
+
+/**
+ * @brief Verifica periodicamente se o lote deve ser enviado e o envia.
+ *
+ * Esta função deve ser chamada no laço da tela "Cloud".
+ *
+ * ### Comportamento:
+ * - Aguarda a requisição HTTP em andamento terminar e trata o seu resultado.
+ * - Sem conexão, grava na flash o lote que estiver pronto para envio.
+ * - Com conexão, esvazia primeiro a fila da flash (amostras mais antigas) e depois
+ *   envia o buffer circular.
+ * - Após uma falha (inclusive limite de taxa), adia o envio até `http_client_ready`
+ *   permitir; se o buffer circular encher nesse meio tempo, as amostras seguem para a flash.
+ * - Também grava o buffer cheio na flash com um lote da flash em envio (a fila pode levar
+ *   dezenas de requisições para esvaziar), exceto com um lote do próprio buffer em envio:
+ *   se ele falhar, precisa voltar para a flash antes das amostras mais novas.
+ */
+void telemetry_poll(void) {
+    // Buffer cheio enquanto a fila da flash é esvaziada ou durante a espera após uma falha:
+    // as amostras seguem para a flash, depois das que já estão lá
+    bool ring_inflight = telemetry_inflight_count && telemetry_inflight_source == TELEMETRY_SOURCE_RING;
+    if (telemetry_ring.count == TELEMETRY_RING_SIZE && !ring_inflight) telemetry_spill_ring();
+
+    if (http_request_pending) return;
+
+    if (telemetry_inflight_count) {
+        telemetry_complete(http_request_ok);
+    }
+
+    if (!telemetry_link_up()) {
+        if (telemetry_flush_due()) telemetry_spill_ring();
+        return;
+    }
+
+    // Aguarda a espera após uma falha (ou imposta pelo servidor) sem descartar amostras
+    if (!http_client_ready()) {
+        if (telemetry_ring.count == TELEMETRY_RING_SIZE) telemetry_spill_ring();
+        return;
+    }
+
+    if (flash_queue.count > 0) {
+        telemetry_flush_flash();
+    } else if (telemetry_flush_due()) {
+        telemetry_flush();
+    }
+}
+
+#endif /*TELEMETRY_H*/
@@ -0,0 +1,3 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#define _BEGIN_STD_C
+#define _END_STD_C
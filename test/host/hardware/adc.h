@@ -0,0 +1,8 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#include "pico_host.h"
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+void adc_set_temp_sensor_enabled(bool enable);
+uint16_t adc_read(void);
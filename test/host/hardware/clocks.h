@@ -0,0 +1,15 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#ifndef HARDWARE_CLOCKS_H
+#define HARDWARE_CLOCKS_H
+
+#include "pico_host.h"
+
+enum clock_index { clk_sys = 5 };
+
+extern uint32_t host_sys_khz;           // Relógio do sistema (`set_sys_clock_khz`; 125 MHz no boot).
+extern uint32_t host_sys_clock_sets;    // Chamadas de `set_sys_clock_khz`.
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#endif /*HARDWARE_CLOCKS_H*/
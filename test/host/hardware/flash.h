@@ -0,0 +1,5 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#include "pico_host.h"
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
@@ -0,0 +1,19 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#ifndef HARDWARE_I2C_H
+#define HARDWARE_I2C_H
+
+#include "pico_host.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *const i2c1;
+
+// Recebe cada escrita de `i2c_write_blocking` (NULL = descartada), na thread do núcleo que escreveu.
+extern void (*host_i2c_write_hook)(uint8_t addr, const uint8_t *src, size_t len);
+
+extern uint32_t host_i2c_sys_khz;       // Relógio do sistema no último cálculo do divisor (`i2c_init`, `i2c_set_baudrate`).
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif /*HARDWARE_I2C_H*/
@@ -0,0 +1,17 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#ifndef HARDWARE_PWM_H
+#define HARDWARE_PWM_H
+
+#include "pico_host.h"
+
+typedef struct { uint32_t csr, div, top; } pwm_config;
+
+uint pwm_gpio_to_slice_num(uint gpio);
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_clkdiv(pwm_config *c, float div);
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+void pwm_set_clkdiv(uint slice_num, float divider);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+
+#endif /*HARDWARE_PWM_H*/
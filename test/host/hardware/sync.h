@@ -0,0 +1,15 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#ifndef HARDWARE_SYNC_H
+#define HARDWARE_SYNC_H
+
+#include "pico_host.h"
+
+typedef volatile uint32_t spin_lock_t;  // Atômico: o núcleo 1 roda em outra thread (pico/multicore.h).
+
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_init(uint lock_num);
+bool spin_try_lock_unsafe(spin_lock_t *lock);
+void spin_lock_unsafe_blocking(spin_lock_t *lock);
+void spin_unlock_unsafe(spin_lock_t *lock);
+
+#endif /*HARDWARE_SYNC_H*/
@@ -0,0 +1,85 @@
+/******************************************************************************
+ * @file    host_flash.h
+ * @brief   Flash emulada em RAM para os testes dos registros gravados na flash
+ *          (storage/flash_queue.h e storage/credential_store.h).
+ *
+ * @note    A região emulada cobre o setor das credenciais e os setores da fila
+ *          logo acima dele, no fim da flash, como no firmware. A semântica é a
+ *          da flash NOR: apagar deixa os bytes em 0xFF e gravar só zera bits.
+ *          A queda de energia é simulada com um orçamento de bytes: quando ele
+ *          acaba, a operação em andamento é cortada com `longjmp` para
+ *          `host_flash_power_lost`, antes de escrever o próximo byte.
+ *
+ * @note    Deve ser incluído antes dos módulos: define os ganchos
+ *          `FLASH_QUEUE_*` e `CRED_STORE_*` que eles usam para acessar a flash.
+ ******************************************************************************/
+
+#ifndef HOST_FLASH_H
+#define HOST_FLASH_H
+
+#include <assert.h>
+#include <setjmp.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#define HOST_FLASH_SIZE (9 * FLASH_SECTOR_SIZE)  // Setor das credenciais + FLASH_QUEUE_SECTORS setores da fila.
+#define HOST_FLASH_BASE (PICO_FLASH_SIZE_BYTES - HOST_FLASH_SIZE)
+
+static uint8_t host_flash[HOST_FLASH_SIZE];     // Conteúdo da região emulada.
+static long host_flash_budget = -1;             // Bytes que ainda podem ser escritos antes da queda (-1 = sem queda).
+static long host_flash_written = 0;             // Bytes escritos (apagados ou gravados) desde a última contagem.
+static uint32_t host_flash_erases = 0;          // Setores apagados desde a última contagem.
+static uint32_t host_flash_programs = 0;        // Páginas gravadas desde a última contagem.
+static jmp_buf host_flash_power_lost;           // Retorno ao teste quando a energia cai.
+
+/**
+ * @brief Apaga toda a região emulada e zera o orçamento e as contagens.
+ */
+static inline void host_flash_reset(void) {
+    memset(host_flash, 0xFF, sizeof(host_flash));
+    host_flash_budget = -1;
+    host_flash_written = 0;
+    host_flash_erases = 0;
+    host_flash_programs = 0;
+}
+
+// Consome um byte do orçamento; sem orçamento, a energia cai antes de escrever o byte
+static inline void host_flash_tick(void) {
+    if (host_flash_budget == 0) longjmp(host_flash_power_lost, 1);
+    if (host_flash_budget > 0) host_flash_budget--;
+    host_flash_written++;
+}
+
+static inline const uint8_t *host_flash_read(uint32_t offset) {
+    assert(offset >= HOST_FLASH_BASE && offset < HOST_FLASH_BASE + HOST_FLASH_SIZE);
+    return &host_flash[offset - HOST_FLASH_BASE];
+}
+
+static inline bool host_flash_erase(uint32_t offset) {
+    assert(offset >= HOST_FLASH_BASE && (offset - HOST_FLASH_BASE) % FLASH_SECTOR_SIZE == 0);
+    host_flash_erases++;
+    for (uint32_t i = 0; i < FLASH_SECTOR_SIZE; i++) {
+        host_flash_tick();
+        host_flash[offset - HOST_FLASH_BASE + i] = 0xFF;
+    }
+    return true;
+}
+
+static inline bool host_flash_program(uint32_t offset, const uint8_t *data) {
+    assert(offset >= HOST_FLASH_BASE && (offset - HOST_FLASH_BASE) % FLASH_PAGE_SIZE == 0);
+    host_flash_programs++;
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+        host_flash_tick();
+        host_flash[offset - HOST_FLASH_BASE + i] &= data[i];
+    }
+    return true;
+}
+
+#define FLASH_QUEUE_READ_PTR(offset) host_flash_read(offset)
+#define FLASH_QUEUE_ERASE(offset) host_flash_erase(offset)
+#define FLASH_QUEUE_PROGRAM(offset, data) host_flash_program(offset, data)
+#define CRED_STORE_READ_PTR(offset) host_flash_read(offset)
+#define CRED_STORE_ERASE(offset) host_flash_erase(offset)
+#define CRED_STORE_PROGRAM(offset, data) host_flash_program(offset, data)
+
+#endif // HOST_FLASH_H
@@ -0,0 +1,636 @@
+/******************************************************************************
+ * @file    host_net.c
+ * @brief   Implementação da pilha TCP simulada, do DNS, do cliente MQTT e do
+ *          CYW43 usados pelos testes no computador (declarados em host_net.h).
+ *
+ * @note    Segue o contrato do lwIP nos pontos em que os módulos dependem dele:
+ *          `tcp_abort` chama o callback de erro com ERR_ABRT, um `recv` que
+ *          retorna ERR_OK fica com o pbuf, e o `sent` recebe os bytes confirmados.
+ ******************************************************************************/
+
+#include "host_net.h"
+
+unsigned long host_net_misuse = 0;
+int host_tcp_new_failures = 0;
+err_t host_tcp_connect_result = ERR_OK;
+u16_t host_tcp_snd_buf = TCP_SND_BUF;
+
+HOST_DNS_MODE_T host_dns_mode = HOST_DNS_CACHED;
+unsigned long host_dns_queries = 0;
+
+mqtt_client_t *host_mqtt_client = NULL;
+err_t host_mqtt_publish_result = ERR_OK;
+
+int host_link_status = CYW43_LINK_UP;
+int host_lwip_depth = 0;
+
+// Ponto de acesso padrão: a rede do vetor de teste da PMK do IEEE 802.11i (anexo H.4)
+static const HOST_WIFI_T host_wifi_default = {
+    .ap_up = true,
+    .ssid = "IEEE",
+    .password = "password",
+    .pmk_hex = "f42c6fc52df0ebef9ebb4b90b38a5f902e83fe1b135a70e23aed762e9710a12e",
+    .bssid = { 0x02, 0x00, 0x5E, 0x10, 0x20, 0x30 },
+    .channel = 6,
+    .rssi = -58,
+    .scan_ms = 2500,
+    .direct_ms = 300,
+};
+
+HOST_WIFI_T host_wifi = host_wifi_default;
+
+cyw43_t cyw43_state;
+const ip_addr_t ip_addr_any = { 0 };
+
+static struct tcp_pcb *pcb_list = NULL;        // Todos os PCBs criados desde o último `host_net_reset`.
+static struct tcp_pcb *pcb_last = NULL;        // PCB criado mais recentemente.
+
+static struct {
+    bool pending;                              // Consulta aguardando `host_dns_answer`.
+    char name[64];                             // Nome consultado.
+    dns_found_callback found;                  // Callback do módulo.
+    void *arg;                                 // Argumento do callback.
+} dns_queries[HOST_DNS_MAX_QUERIES];
+
+static const ip_addr_t dns_address = { 0x04030201 }; // 1.2.3.4, resposta de todas as consultas.
+
+static void host_net_report(const char *what, const struct tcp_pcb *pcb) {
+    host_net_misuse++;
+    fprintf(stderr, "host_net: %s (pcb %p)\n", what, (const void *)pcb);
+}
+
+// Um PCB fechado ou abortado não pode mais ser usado pelo módulo (na pilha real, já foi liberado)
+static bool host_tcp_usable(const struct tcp_pcb *pcb, const char *call) {
+    if (!pcb) {
+        host_net_report(call, pcb);
+        return false;
+    }
+    if (pcb->state == CLOSED && pcb->aborted) {
+        host_net_report(call, pcb);
+        return false;
+    }
+    return true;
+}
+
+// ------------------------------ PCBs ------------------------------
+
+static struct tcp_pcb *host_tcp_alloc(void) {
+    struct tcp_pcb *pcb = calloc(1, sizeof(*pcb));
+    assert(pcb);
+    pcb->prio = TCP_PRIO_NORMAL;
+    pcb->snd_buf = host_tcp_snd_buf;
+    pcb->next = pcb_list;
+    pcb_list = pcb;
+    pcb_last = pcb;
+    return pcb;
+}
+
+void host_net_reset(void) {
+    while (pcb_list) {
+        struct tcp_pcb *next = pcb_list->next;
+        free(pcb_list->out);
+        free(pcb_list);
+        pcb_list = next;
+    }
+    pcb_last = NULL;
+    host_tcp_new_failures = 0;
+    host_tcp_connect_result = ERR_OK;
+    host_tcp_snd_buf = TCP_SND_BUF;
+    memset(dns_queries, 0, sizeof(dns_queries));
+    host_dns_mode = HOST_DNS_CACHED;
+    host_mqtt_publish_result = ERR_OK;
+    host_link_status = CYW43_LINK_UP;
+    host_wifi = host_wifi_default;
+}
+
+struct tcp_pcb *host_tcp_last(void) {
+    return pcb_last;
+}
+
+struct tcp_pcb *host_tcp_listener(u16_t port) {
+    for (struct tcp_pcb *pcb = pcb_list; pcb; pcb = pcb->next) {
+        if (pcb->state == LISTEN && pcb->local_port == port) return pcb;
+    }
+    return NULL;
+}
+
+bool host_tcp_open(const struct tcp_pcb *pcb) {
+    return pcb && pcb->state != CLOSED;
+}
+
+// ------------------------------ API do lwIP ------------------------------
+
+struct tcp_pcb *tcp_new(void) {
+    if (host_tcp_new_failures > 0) {
+        host_tcp_new_failures--;
+        return NULL;
+    }
+    return host_tcp_alloc();
+}
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type) {
+    return tcp_new();
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg) {
+    if (host_tcp_usable(pcb, "tcp_arg em PCB liberado")) pcb->callback_arg = arg;
+}
+
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv) {
+    if (host_tcp_usable(pcb, "tcp_recv em PCB liberado")) pcb->recv = recv;
+}
+
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent) {
+    if (host_tcp_usable(pcb, "tcp_sent em PCB liberado")) pcb->sent = sent;
+}
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval) {
+    if (!host_tcp_usable(pcb, "tcp_poll em PCB liberado")) return;
+    pcb->poll = poll;
+    pcb->poll_interval = interval;
+}
+
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err) {
+    if (host_tcp_usable(pcb, "tcp_err em PCB liberado")) pcb->errf = err;
+}
+
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept) {
+    if (host_tcp_usable(pcb, "tcp_accept em PCB liberado")) pcb->accept = accept;
+}
+
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port) {
+    if (!host_tcp_usable(pcb, "tcp_bind em PCB liberado")) return ERR_VAL;
+    if (host_tcp_listener(port)) return ERR_USE;
+    pcb->local_port = port;
+    return ERR_OK;
+}
+
+struct tcp_pcb *tcp_listen_with_backlog(struct tcp_pcb *pcb, u8_t backlog) {
+    if (!host_tcp_usable(pcb, "tcp_listen em PCB liberado")) return NULL;
+    pcb->state = LISTEN;
+    return pcb;
+}
+
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, tcp_connected_fn connected) {
+    if (!host_tcp_usable(pcb, "tcp_connect em PCB liberado")) return ERR_VAL;
+    if (host_tcp_connect_result != ERR_OK) return host_tcp_connect_result;
+    pcb->remote_ip = *ipaddr;
+    pcb->remote_port = port;
+    pcb->connected = connected;
+    pcb->state = SYN_SENT;
+    return ERR_OK;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags) {
+    if (!host_tcp_usable(pcb, "tcp_write em PCB liberado")) return ERR_CONN;
+    if (pcb->state == CLOSED) {
+        host_net_report("tcp_write depois de tcp_close", pcb);
+        return ERR_CONN;
+    }
+    if (len == 0) return ERR_OK;
+    if (len > pcb->snd_buf || pcb->segment_count == HOST_TCP_MAX_SEGMENTS) return ERR_MEM;
+
+    if (pcb->out_len + len > pcb->out_cap) {
+        pcb->out_cap = (pcb->out_len + len) * 2;
+        pcb->out = realloc(pcb->out, pcb->out_cap);
+        assert(pcb->out);
+    }
+    memcpy(pcb->out + pcb->out_len, dataptr, len);
+
+    HOST_TCP_SEGMENT_T *segment = &pcb->segments[pcb->segment_count++];
+    segment->data = (apiflags & TCP_WRITE_FLAG_COPY) ? NULL : dataptr;
+    segment->offset = pcb->out_len;
+    segment->len = len;
+
+    pcb->out_len += len;
+    pcb->unacked += len;
+    pcb->snd_buf -= len;
+    return ERR_OK;
+}
+
+err_t tcp_output(struct tcp_pcb *pcb) {
+    if (!host_tcp_usable(pcb, "tcp_output em PCB liberado")) return ERR_CONN;
+    pcb->outputs++;
+    return ERR_OK;
+}
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len) {
+    if (host_tcp_usable(pcb, "tcp_recved em PCB liberado")) pcb->recved += len;
+}
+
+err_t tcp_close(struct tcp_pcb *pcb) {
+    if (!host_tcp_usable(pcb, "tcp_close em PCB liberado")) return ERR_VAL;
+    if (pcb->state == CLOSED) {
+        host_net_report("tcp_close repetido", pcb);
+        return ERR_VAL;
+    }
+    pcb->state = CLOSED;
+    return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb) {
+    if (!host_tcp_usable(pcb, "tcp_abort em PCB liberado")) return;
+    pcb->state = CLOSED;
+    pcb->aborted = true;
+    if (pcb->errf) pcb->errf(pcb->callback_arg, ERR_ABRT);
+}
+
+u16_t tcp_sndbuf(const struct tcp_pcb *pcb) {
+    return pcb->snd_buf;
+}
+
+u16_t tcp_sndqueuelen(const struct tcp_pcb *pcb) {
+    return (u16_t)pcb->segment_count;
+}
+
+void tcp_setprio(struct tcp_pcb *pcb, u8_t prio) {
+    if (host_tcp_usable(pcb, "tcp_setprio em PCB liberado")) pcb->prio = prio;
+}
+
+// ------------------------------ Outro lado da conexão ------------------------------
+
+struct tcp_pcb *host_tcp_accept(struct tcp_pcb *listener) {
+    if (!listener || listener->state != LISTEN || !listener->accept) return NULL;
+
+    struct tcp_pcb *pcb = host_tcp_alloc();
+    pcb->state = ESTABLISHED;
+    pcb->local_port = listener->local_port;
+    IP4_ADDR(&pcb->remote_ip, 192, 168, 4, 16);
+    pcb->remote_port = 50000;
+
+    // Como o lwIP: se o accept recusar sem abortar, a conexão é abortada pela pilha
+    err_t err = listener->accept(listener->callback_arg, pcb, ERR_OK);
+    if (err != ERR_OK) {
+        if (err != ERR_ABRT && pcb->state != CLOSED) tcp_abort(pcb);
+        return NULL;
+    }
+    return pcb;
+}
+
+err_t host_tcp_connect_done(struct tcp_pcb *pcb) {
+    if (!host_tcp_usable(pcb, "conexão concluída em PCB liberado") || pcb->state != SYN_SENT) return ERR_VAL;
+    pcb->state = ESTABLISHED;
+    return pcb->connected ? pcb->connected(pcb->callback_arg, pcb, ERR_OK) : ERR_OK;
+}
+
+err_t host_tcp_deliver(struct tcp_pcb *pcb, const void *data, size_t len, size_t chunk) {
+    if (!host_tcp_open(pcb) || !pcb->recv) return ERR_CLSD;
+    assert(len > 0 && len <= 0xFFFF);
+    if (chunk == 0 || chunk > len) chunk = len;
+
+    // Cadeia de pbufs com `chunk` bytes cada (o último com o resto)
+    struct pbuf *head = NULL, **tail = &head;
+    for (size_t offset = 0; offset < len; offset += chunk) {
+        u16_t part = (u16_t)(len - offset < chunk ? len - offset : chunk);
+        struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, part, PBUF_POOL);
+        memcpy(p->payload, (const char *)data + offset, part);
+        p->tot_len = (u16_t)(len - offset);
+        *tail = p;
+        tail = &p->next;
+    }
+
+    err_t err = pcb->recv(pcb->callback_arg, pcb, head, ERR_OK);
+    if (err != ERR_OK && err != ERR_ABRT) pbuf_free(head);  // Recusado: a pilha guardaria para repetir
+    return err;
+}
+
+err_t host_tcp_deliver_str(struct tcp_pcb *pcb, const char *text) {
+    return host_tcp_deliver(pcb, text, strlen(text), 0);
+}
+
+err_t host_tcp_remote_close(struct tcp_pcb *pcb) {
+    if (!host_tcp_open(pcb) || !pcb->recv) return ERR_CLSD;
+    return pcb->recv(pcb->callback_arg, pcb, NULL, ERR_OK);
+}
+
+err_t host_tcp_ack(struct tcp_pcb *pcb, size_t len) {
+    if (!host_tcp_usable(pcb, "confirmação em PCB liberado")) return ERR_VAL;
+    if (len > pcb->unacked) len = pcb->unacked;
+    if (len == 0) return ERR_OK;
+
+    // Trechos sem cópia precisam estar intactos até a confirmação (a pilha os retransmitiria)
+    size_t acked_end = pcb->out_len - pcb->unacked + len;
+    int done = 0;
+    while (done < pcb->segment_count && pcb->segments[done].offset + pcb->segments[done].len <= acked_end) {
+        const HOST_TCP_SEGMENT_T *segment = &pcb->segments[done];
+        if (segment->data && memcmp(segment->data, pcb->out + segment->offset, segment->len) != 0) {
+            host_net_report("dados sem cópia alterados antes da confirmação", pcb);
+        }
+        done++;
+    }
+    memmove(pcb->segments, pcb->segments + done, (pcb->segment_count - done) * sizeof(pcb->segments[0]));
+    pcb->segment_count -= done;
+    pcb->unacked -= len;
+    pcb->snd_buf += (u16_t)len;
+
+    // Como no lwIP, o `sent` continua sendo chamado durante o encerramento (após `tcp_close`)
+    if (pcb->aborted || !pcb->sent) return ERR_OK;
+    err_t err = ERR_OK;
+    while (len > 0 && err == ERR_OK && !pcb->aborted) {
+        u16_t part = (u16_t)(len > 0xFFFF ? 0xFFFF : len);
+        err = pcb->sent(pcb->callback_arg, pcb, part);
+        len -= part;
+    }
+    return err;
+}
+
+err_t host_tcp_ack_all(struct tcp_pcb *pcb) {
+    return host_tcp_ack(pcb, pcb->unacked);
+}
+
+err_t host_tcp_poll_now(struct tcp_pcb *pcb) {
+    if (!host_tcp_open(pcb) || !pcb->poll) return ERR_OK;
+    return pcb->poll(pcb->callback_arg, pcb);
+}
+
+void host_tcp_reset_by_peer(struct tcp_pcb *pcb) {
+    if (!host_tcp_open(pcb)) return;
+    pcb->state = CLOSED;
+    pcb->aborted = true;
+    if (pcb->errf) pcb->errf(pcb->callback_arg, ERR_RST);
+}
+
+size_t host_tcp_read(struct tcp_pcb *pcb, char *out, size_t max) {
+    size_t len = pcb->out_len - pcb->out_read;
+    if (len > max) len = max;
+    if (len == 0) return 0;             // Nada enviado ainda: `out` pode ser NULL
+    memcpy(out, pcb->out + pcb->out_read, len);
+    pcb->out_read += len;
+    return len;
+}
+
+// ------------------------------ pbuf ------------------------------
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type) {
+    struct pbuf *p = malloc(sizeof(struct pbuf) + length);
+    assert(p);
+    p->next = NULL;
+    p->payload = (char *)(p + 1);
+    p->tot_len = length;
+    p->len = length;
+    return p;
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+    u8_t count = 0;
+    while (p) {
+        struct pbuf *next = p->next;
+        free(p);
+        p = next;
+        count++;
+    }
+    return count;
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset) {
+    u16_t copied = 0;
+    for (; p && copied < len; p = p->next) {
+        if (offset >= p->len) {
+            offset -= p->len;
+            continue;
+        }
+        u16_t part = p->len - offset;
+        if (part > len - copied) part = len - copied;
+        memcpy((char *)dataptr + copied, (const char *)p->payload + offset, part);
+        copied += part;
+        offset = 0;
+    }
+    return copied;
+}
+
+// ------------------------------ Endereços e DNS ------------------------------
+
+char *ip4addr_ntoa_r(const ip4_addr_t *addr, char *buf, int buflen) {
+    snprintf(buf, buflen, "%u.%u.%u.%u", ip4_addr1(addr), ip4_addr2(addr), ip4_addr3(addr), ip4_addr4(addr));
+    return buf;
+}
+
+char *ip4addr_ntoa(const ip4_addr_t *addr) {
+    static char buf[16];
+    return ip4addr_ntoa_r(addr, buf, sizeof(buf));
+}
+
+char *ipaddr_ntoa(const ip_addr_t *addr) {
+    return ip4addr_ntoa(addr);
+}
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg) {
+    host_dns_queries++;
+    switch (host_dns_mode) {
+    case HOST_DNS_CACHED:
+        *addr = dns_address;
+        return ERR_OK;
+    case HOST_DNS_PENDING:
+        // Como no lwIP, cada consulta pendente (mesmo a um nome já consultado) guarda o seu callback
+        for (int i = 0; i < HOST_DNS_MAX_QUERIES; i++) {
+            if (dns_queries[i].pending) continue;
+            dns_queries[i].pending = true;
+            snprintf(dns_queries[i].name, sizeof(dns_queries[i].name), "%s", hostname);
+            dns_queries[i].found = found;
+            dns_queries[i].arg = callback_arg;
+            return ERR_INPROGRESS;
+        }
+        return ERR_MEM;
+    default:
+        return ERR_ARG;
+    }
+}
+
+bool host_dns_answer(bool found) {
+    bool answered = false;
+    for (int i = 0; i < HOST_DNS_MAX_QUERIES; i++) {
+        if (!dns_queries[i].pending) continue;
+        dns_queries[i].pending = false;
+        dns_queries[i].found(dns_queries[i].name, found ? &dns_address : NULL, dns_queries[i].arg);
+        answered = true;
+    }
+    return answered;
+}
+
+// ------------------------------ MQTT ------------------------------
+
+mqtt_client_t *mqtt_client_new(void) {
+    mqtt_client_t *client = calloc(1, sizeof(*client));
+    host_mqtt_client = client;
+    return client;
+}
+
+void mqtt_client_free(mqtt_client_t *client) {
+    if (client == host_mqtt_client) host_mqtt_client = NULL;
+    free(client);
+}
+
+err_t mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *ipaddr, u16_t port, mqtt_connection_cb_t cb,
+                          void *arg, const struct mqtt_connect_client_info_t *client_info) {
+    if (client->connecting || client->connected) return ERR_ISCONN;
+    client->connects++;
+    client->connecting = true;
+    client->broker_ip = *ipaddr;
+    client->port = port;
+    client->info = *client_info;
+    client->cb = cb;
+    client->arg = arg;
+    return ERR_OK;
+}
+
+void mqtt_disconnect(mqtt_client_t *client) {
+    client->disconnects++;
+    client->connecting = false;
+    client->connected = false;
+    client->inbox_count = 0;      // O lwIP descarta as publicações pendentes sem chamar os callbacks
+}
+
+u8_t mqtt_client_is_connected(mqtt_client_t *client) {
+    return client->connected;
+}
+
+err_t mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos,
+                   u8_t retain, mqtt_request_cb_t cb, void *arg) {
+    if (!client->connected) return ERR_CONN;
+    if (host_mqtt_publish_result != ERR_OK) return host_mqtt_publish_result;
+    if (client->inbox_count == HOST_MQTT_MAX_PUBLISH) return ERR_MEM;
+
+    HOST_MQTT_PUBLISH_T *publish = &client->inbox[client->inbox_count++];
+    snprintf(publish->topic, sizeof(publish->topic), "%s", topic);
+    assert(payload_length < sizeof(publish->payload));
+    memcpy(publish->payload, payload, payload_length);
+    publish->payload[payload_length] = '\0';
+    publish->len = payload_length;
+    publish->qos = qos;
+    publish->cb = cb;
+    publish->arg = arg;
+    return ERR_OK;
+}
+
+void host_mqtt_connack(mqtt_client_t *client, mqtt_connection_status_t status) {
+    client->connecting = false;
+    client->connected = (status == MQTT_CONNECT_ACCEPTED);
+    client->cb(client, client->arg, status);
+}
+
+void host_mqtt_drop(mqtt_client_t *client) {
+    client->connecting = false;
+    client->connected = false;
+    client->inbox_count = 0;
+    client->cb(client, client->arg, MQTT_CONNECT_DISCONNECTED);
+}
+
+int host_mqtt_deliver(mqtt_client_t *client, err_t err, HOST_MQTT_PUBLISH_T *out, int max) {
+    int count = client->inbox_count;
+    client->inbox_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (i < max) out[i] = client->inbox[i];
+        if (client->inbox[i].cb) client->inbox[i].cb(client->inbox[i].arg, err);
+    }
+    return count;
+}
+
+// ------------------------------ CYW43 ------------------------------
+
+void cyw43_arch_lwip_begin(void) { host_lwip_depth++; }
+void cyw43_arch_lwip_end(void) { host_lwip_depth--; }
+void cyw43_arch_poll(void) {}
+
+int cyw43_tcpip_link_status(cyw43_t *self, int itf) {
+    if (host_wifi.joining) {
+        if (host_time_us < host_wifi.join_done_us) return CYW43_LINK_JOIN;
+        host_wifi.joining = false;
+        host_link_status = host_wifi.join_status;
+    }
+    return host_link_status;
+}
+
+int cyw43_arch_init(void) {
+    host_wifi.inits++;
+    host_wifi.initialized = true;
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+    host_wifi.initialized = false;
+    host_wifi.joining = false;
+    host_link_status = CYW43_LINK_DOWN;
+}
+
+void cyw43_arch_enable_sta_mode(void) {}
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth) {}
+void cyw43_arch_disable_ap_mode(void) {}
+
+// Inicia uma conexão que termina em `ms` com o estado `status`
+static int host_wifi_start(uint32_t ms, int status) {
+    if (!host_wifi.initialized) host_net_report("conexão Wi-Fi sem cyw43_arch_init", NULL);
+    if (host_wifi.join_result != 0) return host_wifi.join_result;
+    host_wifi.joining = true;
+    host_wifi.join_done_us = status == CYW43_LINK_JOIN ? UINT64_MAX : host_time_us + (uint64_t)ms * 1000;
+    host_wifi.join_status = status;
+    host_link_status = CYW43_LINK_JOIN;
+    return 0;
+}
+
+int cyw43_arch_wifi_connect_async(const char *ssid, const char *pw, uint32_t auth) {
+    host_wifi.scans++;
+    int status = !host_wifi.ap_up || strcmp(ssid, host_wifi.ssid) != 0 ? CYW43_LINK_NONET :
+                 strcmp(pw, host_wifi.password) != 0 ? CYW43_LINK_BADAUTH : CYW43_LINK_UP;
+    return host_wifi_start(host_wifi.scan_ms, status);
+}
+
+int cyw43_wifi_join(cyw43_t *self, size_t ssid_len, const uint8_t *ssid, size_t key_len, const uint8_t *key,
+                    uint32_t auth_type, const uint8_t *bssid, uint32_t channel) {
+    host_wifi.direct_joins++;
+    size_t n = key_len < sizeof(host_wifi.key) - 1 ? key_len : sizeof(host_wifi.key) - 1;
+    memcpy(host_wifi.key, key, n);
+    host_wifi.key[n] = '\0';
+    memcpy(host_wifi.join_bssid, bssid, 6);
+    host_wifi.join_channel = channel;
+
+    bool same_ap = memcmp(bssid, host_wifi.bssid, 6) == 0 && channel == host_wifi.channel;
+    int status = !host_wifi.ap_up || !same_ap ? CYW43_LINK_JOIN :
+                 ssid_len != strlen(host_wifi.ssid) || memcmp(ssid, host_wifi.ssid, ssid_len) != 0 ? CYW43_LINK_NONET :
+                 strcmp(host_wifi.key, host_wifi.pmk_hex) != 0 ? CYW43_LINK_BADAUTH : CYW43_LINK_UP;
+    return host_wifi_start(host_wifi.direct_ms, status);
+}
+
+int cyw43_wifi_leave(cyw43_t *self, int itf) {
+    host_wifi.leaves++;
+    host_wifi.joining = false;
+    host_link_status = CYW43_LINK_DOWN;
+    return 0;
+}
+
+int cyw43_wifi_get_bssid(cyw43_t *self, uint8_t bssid[6]) {
+    if (cyw43_tcpip_link_status(self, CYW43_ITF_STA) != CYW43_LINK_UP) return -1;
+    memcpy(bssid, host_wifi.bssid, 6);
+    return 0;
+}
+
+int cyw43_wifi_get_rssi(cyw43_t *self, int32_t *rssi) {
+    host_wifi.rssi_reads++;
+    *rssi = host_wifi.rssi;
+    return 0;
+}
+
+int cyw43_ioctl(cyw43_t *self, uint32_t cmd, size_t len, uint8_t *buf, uint32_t iface) {
+    if (cmd != CYW43_IOCTL_GET_CHANNEL || len < sizeof(uint32_t)) return -1;
+    host_wifi.channel_reads++;
+    uint32_t channel = host_wifi.channel;
+    memcpy(buf, &channel, sizeof(channel));     // Canal atual (primeiro campo de `channel_info_t`)
+    return 0;
+}
+
+int cyw43_wifi_pm(cyw43_t *self, uint32_t pm) {
+    host_wifi.pm_calls++;
+    host_wifi.pm = pm;
+    return 0;
+}
+
+static bool led_value = false;
+
+int cyw43_gpio_get(cyw43_t *self, int gpio, bool *val) {
+    *val = led_value;
+    return 0;
+}
+
+int cyw43_gpio_set(cyw43_t *self, int gpio, bool val) {
+    led_value = val;
+    return 0;
+}
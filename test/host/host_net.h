@@ -0,0 +1,189 @@
+/******************************************************************************
+ * @file    host_net.h
+ * @brief   Pilha TCP simulada (lwIP), DNS, cliente MQTT e CYW43 para os testes
+ *          no computador.
+ *
+ * @note    Os módulos do firmware chamam a API do lwIP normalmente (cabeçalhos lwip/
+ *          deste diretório); o teste faz o papel da rede e do outro lado da
+ *          conexão: aceita clientes, entrega segmentos (em cadeias de pbufs do
+ *          tamanho escolhido), confirma dados enviados, dispara o `tcp_poll`,
+ *          derruba conexões e responde ao DNS e ao broker MQTT.
+ *
+ * @note    O que a pilha real não permitiria é contado em `host_net_misuse` e
+ *          impresso: uso de um PCB já fechado e dados enviados sem
+ *          `TCP_WRITE_FLAG_COPY` alterados antes de confirmados. Os PCBs
+ *          fechados continuam legíveis pelo teste até `host_net_reset`.
+ ******************************************************************************/
+
+#ifndef HOST_NET_H
+#define HOST_NET_H
+
+#include "lwip/tcp.h"
+#include "lwip/dns.h"
+#include "lwip/apps/mqtt.h"
+#include "pico/cyw43_arch.h"
+
+// ------------------------------ TCP ------------------------------
+
+#define HOST_TCP_MAX_SEGMENTS 64        // Trechos enviados e ainda não confirmados, por PCB.
+
+/**
+ * @brief Trecho enfileirado com `tcp_write` e ainda não confirmado pelo outro lado.
+ */
+typedef struct HOST_TCP_SEGMENT_T_ {
+    const void *data;             // Dados do módulo (sem cópia) ou NULL (copiados).
+    size_t offset;                // Posição do trecho em `out`.
+    u16_t len;                    // Comprimento do trecho.
+} HOST_TCP_SEGMENT_T;
+
+/**
+ * @brief PCB simulado: callbacks registrados pelo módulo e tudo o que ele enviou.
+ */
+struct tcp_pcb {
+    struct tcp_pcb *next;         // Lista de PCBs (liberados em `host_net_reset`).
+    enum tcp_state state;         // CLOSED depois de `tcp_close` ou `tcp_abort`.
+    bool aborted;                 // Encerrado por `tcp_abort` (ou pelo outro lado).
+    ip_addr_t remote_ip;          // Endereço de `tcp_connect`.
+    u16_t remote_port;            // Porta de `tcp_connect`.
+    u16_t local_port;             // Porta de `tcp_bind`.
+    u8_t prio;                    // Prioridade de `tcp_setprio`.
+    u8_t poll_interval;           // Intervalo de `tcp_poll`.
+    void *callback_arg;           // Argumento de `tcp_arg`.
+    tcp_accept_fn accept;
+    tcp_recv_fn recv;
+    tcp_sent_fn sent;
+    tcp_poll_fn poll;
+    tcp_err_fn errf;
+    tcp_connected_fn connected;
+    u16_t snd_buf;                // Espaço livre no buffer de envio.
+    HOST_TCP_SEGMENT_T segments[HOST_TCP_MAX_SEGMENTS]; // Trechos não confirmados, em ordem.
+    int segment_count;            // Quantidade de trechos não confirmados.
+    size_t unacked;               // Bytes enviados e não confirmados.
+    size_t recved;                // Bytes liberados com `tcp_recved`.
+    uint32_t outputs;             // Chamadas de `tcp_output`.
+    char *out;                    // Tudo o que o módulo enviou (cópia).
+    size_t out_len;               // Bytes em `out`.
+    size_t out_cap;               // Capacidade de `out`.
+    size_t out_read;              // Bytes de `out` já consumidos pelo teste.
+};
+
+extern unsigned long host_net_misuse;  // Usos da API que a pilha real não aceitaria.
+extern int host_tcp_new_failures;      // Próximas chamadas de `tcp_new` que retornam NULL.
+extern err_t host_tcp_connect_result;  // Retorno de `tcp_connect`.
+extern u16_t host_tcp_snd_buf;         // Buffer de envio dos novos PCBs.
+
+void host_net_reset(void);
+struct tcp_pcb *host_tcp_last(void);
+struct tcp_pcb *host_tcp_listener(u16_t port);
+struct tcp_pcb *host_tcp_accept(struct tcp_pcb *listener);
+err_t host_tcp_connect_done(struct tcp_pcb *pcb);
+err_t host_tcp_deliver(struct tcp_pcb *pcb, const void *data, size_t len, size_t chunk);
+err_t host_tcp_deliver_str(struct tcp_pcb *pcb, const char *text);
+err_t host_tcp_remote_close(struct tcp_pcb *pcb);
+err_t host_tcp_ack(struct tcp_pcb *pcb, size_t len);
+err_t host_tcp_ack_all(struct tcp_pcb *pcb);
+err_t host_tcp_poll_now(struct tcp_pcb *pcb);
+void host_tcp_reset_by_peer(struct tcp_pcb *pcb);
+bool host_tcp_open(const struct tcp_pcb *pcb);
+size_t host_tcp_read(struct tcp_pcb *pcb, char *out, size_t max);
+
+// ------------------------------ DNS ------------------------------
+
+#define HOST_DNS_MAX_QUERIES 4          // Consultas pendentes ao mesmo tempo (DNS_MAX_REQUESTS).
+
+typedef enum {
+    HOST_DNS_CACHED,              // Responde na hora (ERR_OK).
+    HOST_DNS_PENDING,             // Responde depois, com `host_dns_answer` (ERR_INPROGRESS; ERR_MEM sem espaço).
+    HOST_DNS_FAIL                 // Recusa a consulta (ERR_ARG).
+} HOST_DNS_MODE_T;
+
+extern HOST_DNS_MODE_T host_dns_mode;  // Comportamento de `dns_gethostbyname`.
+extern unsigned long host_dns_queries; // Consultas recebidas.
+
+bool host_dns_answer(bool found);
+
+// ------------------------------ MQTT ------------------------------
+
+#define HOST_MQTT_MAX_PUBLISH 32        // Publicações guardadas até o teste consumi-las.
+
+/**
+ * @brief Publicação recebida pelo broker simulado.
+ */
+typedef struct HOST_MQTT_PUBLISH_T_ {
+    char topic[96];               // Tópico.
+    char payload[128];            // Payload (terminado em NUL).
+    u16_t len;                    // Comprimento do payload.
+    u8_t qos;                     // QoS pedido.
+    mqtt_request_cb_t cb;         // Callback de conclusão (chamado em `host_mqtt_deliver`).
+    void *arg;                    // Argumento do callback.
+} HOST_MQTT_PUBLISH_T;
+
+/**
+ * @brief Cliente MQTT simulado: a sessão é decidida pelo teste, no papel do broker.
+ */
+struct mqtt_client_s {
+    bool connecting;              // CONNECT enviado, aguardando o CONNACK.
+    bool connected;               // Sessão aberta.
+    ip_addr_t broker_ip;          // Endereço de `mqtt_client_connect`.
+    u16_t port;                   // Porta de `mqtt_client_connect`.
+    struct mqtt_connect_client_info_t info; // Identificação e keep-alive.
+    mqtt_connection_cb_t cb;      // Callback de conexão.
+    void *arg;                    // Argumento do callback.
+    uint32_t connects;            // Chamadas de `mqtt_client_connect`.
+    uint32_t disconnects;         // Chamadas de `mqtt_disconnect`.
+    HOST_MQTT_PUBLISH_T inbox[HOST_MQTT_MAX_PUBLISH]; // Publicações ainda não entregues.
+    int inbox_count;              // Quantidade de publicações em `inbox`.
+};
+
+extern mqtt_client_t *host_mqtt_client; // Último cliente criado por `mqtt_client_new`.
+extern err_t host_mqtt_publish_result;  // Retorno de `mqtt_publish` (ERR_OK aceita a mensagem).
+
+void host_mqtt_connack(mqtt_client_t *client, mqtt_connection_status_t status);
+void host_mqtt_drop(mqtt_client_t *client);
+int host_mqtt_deliver(mqtt_client_t *client, err_t err, HOST_MQTT_PUBLISH_T *out, int max);
+
+// ------------------------------ CYW43 ------------------------------
+
+/**
+ * @brief Rádio simulado: um ponto de acesso e o registro das chamadas ao driver.
+ *
+ * Uma conexão iniciada (`cyw43_arch_wifi_connect_async` ou, direta, `cyw43_wifi_join`) fica em
+ * CYW43_LINK_JOIN e termina após `scan_ms` ou `direct_ms`: CYW43_LINK_UP com a rede e a senha
+ * (ou a PMK, o BSSID e o canal) do ponto de acesso, CYW43_LINK_BADAUTH com a senha errada e
+ * CYW43_LINK_NONET com o ponto de acesso desligado. Uma conexão direta a outro BSSID ou canal
+ * não termina, como o CYW43 esperando um ponto de acesso que não responde.
+ */
+typedef struct HOST_WIFI_T_ {
+    bool ap_up;                   // Ponto de acesso ligado.
+    const char *ssid;             // Rede do ponto de acesso.
+    const char *password;         // Senha do ponto de acesso.
+    const char *pmk_hex;          // PMK da rede em 64 dígitos hexadecimais (chave da conexão direta).
+    uint8_t bssid[6];             // BSSID do ponto de acesso.
+    uint32_t channel;             // Canal do ponto de acesso.
+    int32_t rssi;                 // Retorno de `cyw43_wifi_get_rssi`.
+    uint32_t scan_ms;             // Duração da conexão com varredura.
+    uint32_t direct_ms;           // Duração da conexão direta.
+    int join_result;              // Retorno das chamadas de conexão (0 = iniciada).
+
+    bool initialized;             // Entre `cyw43_arch_init` e `cyw43_arch_deinit`.
+    bool joining;                 // Conexão em andamento.
+    uint64_t join_done_us;        // Fim da conexão em andamento.
+    int join_status;              // Estado ao fim da conexão em andamento.
+    uint32_t inits;               // Chamadas de `cyw43_arch_init`.
+    uint32_t scans;               // Conexões com varredura (`cyw43_arch_wifi_connect_async`).
+    uint32_t direct_joins;        // Conexões diretas (`cyw43_wifi_join`).
+    uint32_t leaves;              // Chamadas de `cyw43_wifi_leave`.
+    uint32_t rssi_reads;          // Chamadas de `cyw43_wifi_get_rssi`.
+    uint32_t channel_reads;       // Consultas do canal (`cyw43_ioctl`).
+    uint32_t pm_calls;            // Chamadas de `cyw43_wifi_pm`.
+    char key[65];                 // Chave recebida na última conexão direta.
+    uint8_t join_bssid[6];        // BSSID pedido na última conexão direta.
+    uint32_t join_channel;        // Canal pedido na última conexão direta.
+    uint32_t pm;                  // Último modo de economia (`cyw43_wifi_pm`).
+} HOST_WIFI_T;
+
+extern int host_link_status;           // Retorno de `cyw43_tcpip_link_status` (CYW43_LINK_UP).
+extern int host_lwip_depth;            // Aninhamento de `cyw43_arch_lwip_begin/end`.
+extern HOST_WIFI_T host_wifi;          // Rádio simulado (ponto de acesso "IEEE", senha "password").
+
+#endif /*HOST_NET_H*/
@@ -0,0 +1,176 @@
+/******************************************************************************
+ * @file    host_sdk.c
+ * @brief   Implementação dos substitutos do Pico SDK usados pelos testes no
+ *          computador (declarados em pico_host.h).
+ *
+ * @note    O relógio só avança com `host_time_advance_ms` (ou `sleep_ms`), o que
+ *          torna os prazos dos módulos determinísticos. Os testes da flash usam
+ *          os ganchos de acesso do próprio módulo (`FLASH_QUEUE_READ_PTR`, ...)
+ *          com um emulador, então as funções de flash do SDK não fazem nada.
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "pico/unique_id.h"
+#include "hardware/flash.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/i2c.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+uint64_t host_time_us = 1000000;        // Começa em 1 s: instantes 0 têm significado especial em alguns módulos.
+
+// ------------------------------ Relógio ------------------------------
+
+absolute_time_t get_absolute_time(void) { return host_time_us; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+absolute_time_t make_timeout_time_ms(uint32_t ms) { return host_time_us + (uint64_t)ms * 1000; }
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+uint32_t time_us_32(void) { return (uint32_t)host_time_us; }
+uint64_t time_us_64(void) { return host_time_us; }
+void sleep_ms(uint32_t ms) { host_time_advance_ms(ms); }
+void sleep_us(uint64_t us) { host_time_us += us; }
+void tight_loop_contents(void) {}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp) {
+    if (timeout_timestamp > host_time_us) host_time_us = timeout_timestamp;
+    return true;
+}
+
+// ------------------------------ GPIO, núcleos e interrupções ------------------------------
+
+void gpio_init(uint gpio) {}
+void gpio_set_dir(uint gpio, bool out) {}
+void gpio_pull_up(uint gpio) {}
+bool gpio_get(uint gpio) { return true; }   // Botões com pull-up: soltos
+void gpio_put(uint gpio, bool value) {}
+void gpio_set_function(uint gpio, enum gpio_function fn) {}
+gpio_irq_callback_t host_gpio_irq_callback = NULL;
+uint32_t host_gpio_irq_pins = 0;
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (enabled) host_gpio_irq_pins |= 1u << gpio;
+    else host_gpio_irq_pins &= ~(1u << gpio);
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    host_gpio_irq_callback = callback;
+}
+
+bool stdio_init_all(void) { return true; }
+bool stdio_usb_connected(void) { return true; }
+int puts_raw(const char *s) { return puts(s); }   // Como no SDK: sem tradução de "\n", com quebra de linha no fim
+
+_Thread_local uint host_core_num = 0;   // Núcleo em que a thread está "executando".
+
+uint get_core_num(void) { return host_core_num; }
+uint32_t save_and_disable_interrupts(void) { return 0; }
+void restore_interrupts(uint32_t status) {}
+void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+void __sev(void) {}
+void __wfe(void) { sched_yield(); }     // O núcleo 1 (thread) cede a vez enquanto espera um evento
+void __wfi(void) {}
+
+// ------------------------------ Núcleo 1 e spin locks ------------------------------
+
+static spin_lock_t host_spin_locks[32];
+static int host_spin_claimed = 0;
+
+int spin_lock_claim_unused(bool required) { return host_spin_claimed++ % 32; }
+
+spin_lock_t *spin_lock_init(uint lock_num) {
+    spin_unlock_unsafe(&host_spin_locks[lock_num]);
+    return &host_spin_locks[lock_num];
+}
+
+bool spin_try_lock_unsafe(spin_lock_t *lock) { return __atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) == 0; }
+
+void spin_lock_unsafe_blocking(spin_lock_t *lock) {
+    while (!spin_try_lock_unsafe(lock)) sched_yield();
+}
+
+void spin_unlock_unsafe(spin_lock_t *lock) { __atomic_store_n(lock, 0, __ATOMIC_RELEASE); }
+
+static void *host_core1_thread(void *entry) {
+    host_core_num = 1;
+    ((void (*)(void))entry)();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, host_core1_thread, (void *)entry);
+    pthread_detach(thread);
+}
+
+void multicore_lockout_victim_init(void) {}
+
+// ------------------------------ Periféricos ------------------------------
+
+i2c_inst_t *const i2c1 = NULL;
+
+uint32_t host_i2c_sys_khz = 0;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    host_i2c_sys_khz = host_sys_khz;
+    return baudrate;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+    host_i2c_sys_khz = host_sys_khz;
+    return baudrate;
+}
+void (*host_i2c_write_hook)(uint8_t addr, const uint8_t *src, size_t len) = NULL;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    if (host_i2c_write_hook) host_i2c_write_hook(addr, src, len);
+    return (int)len;
+}
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) {}
+void adc_select_input(uint input) {}
+void adc_set_temp_sensor_enabled(bool enable) {}
+uint16_t adc_read(void) { return 876; }     // Cerca de 27 °C no sensor interno
+
+uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+pwm_config pwm_get_default_config(void) { pwm_config c = { 0, 1 << 4, 0xffff }; return c; }
+void pwm_config_set_clkdiv(pwm_config *c, float div) {}
+void pwm_init(uint slice_num, pwm_config *c, bool start) {}
+void pwm_set_clkdiv(uint slice_num, float divider) {}
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {}
+void pwm_set_gpio_level(uint gpio, uint16_t level) {}
+
+uint32_t host_sys_khz = 125000;
+uint32_t host_sys_clock_sets = 0;
+
+uint32_t clock_get_hz(enum clock_index clk_index) { return host_sys_khz * 1000; }
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    host_sys_khz = freq_khz;
+    host_sys_clock_sets++;
+    return true;
+}
+
+// ------------------------------ Flash ------------------------------
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    func(param);
+    return PICO_OK;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {}
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {}
+
+// ------------------------------ Identificador da placa ------------------------------
+
+pico_unique_board_id_t host_board_id = { { 0xE6, 0x61, 0x48, 0x54, 0xD3, 0x2A, 0x7C, 0x21 } };
+
+void pico_get_unique_board_id(pico_unique_board_id_t *id_out) { *id_out = host_board_id; }
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * @file    host_text.h
+ * @brief   Leitura do texto que os testes recebem no papel do servidor:
+ *          cabeçalhos HTTP, JSON e payloads com números em ponto fixo.
+ *
+ * @note    As funções trabalham sobre intervalos [início, fim) e não dependem
+ *          de terminador NULL, então podem ser usadas direto sobre os bytes
+ *          recebidos da pilha simulada. As funções `take*` avançam `*p` apenas
+ *          quando reconhecem o trecho.
+ ******************************************************************************/
+
+#ifndef HOST_TEXT_H
+#define HOST_TEXT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+/**
+ * @brief Consome `text`, se ele estiver no início de [*p, end).
+ */
+static inline bool take(const char **p, const char *end, const char *text) {
+    size_t len = strlen(text);
+    if ((size_t)(end - *p) < len || memcmp(*p, text, len) != 0) return false;
+    *p += len;
+    return true;
+}
+
+/**
+ * @brief Consome um inteiro sem sinal como o JSON o escreve (sem zeros à esquerda, até UINT32_MAX).
+ */
+static inline bool take_uint(const char **p, const char *end, uint32_t *out) {
+    const char *s = *p;
+    uint64_t value = 0;
+    while (s < end && *s >= '0' && *s <= '9' && s - *p < 10) value = value * 10 + (uint64_t)(*s++ - '0');
+    if (s == *p || (s - *p > 1 && **p == '0') || value > UINT32_MAX) return false;
+    *out = (uint32_t)value;
+    *p = s;
+    return true;
+}
+
+/**
+ * @brief Consome um número com exatamente `decimals` casas decimais, convertido para ponto fixo.
+ *
+ * @return false se o formato for outro ou se o valor não couber em int32_t.
+ */
+static inline bool take_fixed(const char **p, const char *end, int decimals, int32_t *out) {
+    const char *s = *p;
+    bool negative = s < end && *s == '-';
+    if (negative) s++;
+    uint32_t integer;
+    if (!take_uint(&s, end, &integer) || s == end || *s++ != '.') return false;
+
+    int64_t value = integer;
+    for (int i = 0; i < decimals; i++) {
+        if (s == end || *s < '0' || *s > '9') return false;
+        value = value * 10 + (*s++ - '0');
+    }
+    if (s < end && *s >= '0' && *s <= '9') return false;
+    if (negative) value = -value;
+    if (value < INT32_MIN || value > INT32_MAX) return false;
+    *out = (int32_t)value;
+    *p = s;
+    return true;
+}
+
+/**
+ * @brief Primeira ocorrência de `text` em [s, end), ou NULL.
+ */
+static inline const char *find(const char *s, const char *end, const char *text) {
+    size_t len = strlen(text);
+    for (; (size_t)(end - s) >= len; s++) {
+        if (memcmp(s, text, len) == 0) return s;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Valor de um cabeçalho (nome sem distinção de maiúsculas) em [headers, end), ou NULL.
+ *
+ * @param len Recebe o comprimento do valor, sem os espaços iniciais.
+ */
+static inline const char *header_value(const char *headers, const char *end, const char *name, size_t *len) {
+    size_t name_len = strlen(name);
+    for (const char *line = headers; line < end;) {
+        const char *eol = find(line, end, "\r\n");
+        if (!eol) return NULL;
+        if ((size_t)(eol - line) > name_len && strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *value = line + name_len + 1;
+            while (value < eol && *value == ' ') value++;
+            *len = eol - value;
+            return value;
+        }
+        line = eol + 2;
+    }
+    return NULL;
+}
+
+#endif // HOST_TEXT_H
@@ -0,0 +1,2 @@
+// Substituto do lwIP para os testes no computador (ver test/host/host_net.h).
+#include "lwip/tcp.h"
@@ -0,0 +1,45 @@
+// Substituto do lwIP para os testes no computador (ver test/host/host_net.h).
+#ifndef LWIP_HDR_APPS_MQTT_CLIENT_H
+#define LWIP_HDR_APPS_MQTT_CLIENT_H
+
+#include "lwip/ip_addr.h"
+
+typedef struct mqtt_client_s mqtt_client_t;
+
+typedef enum {
+    MQTT_CONNECT_ACCEPTED = 0,
+    MQTT_CONNECT_REFUSED_PROTOCOL_VERSION = 1,
+    MQTT_CONNECT_REFUSED_IDENTIFIER = 2,
+    MQTT_CONNECT_REFUSED_SERVER = 3,
+    MQTT_CONNECT_REFUSED_USERNAME_PASS = 4,
+    MQTT_CONNECT_REFUSED_NOT_AUTHORIZED_ = 5,
+    MQTT_CONNECT_DISCONNECTED = 256,
+    MQTT_CONNECT_TIMEOUT = 257
+} mqtt_connection_status_t;
+
+typedef void (*mqtt_connection_cb_t)(mqtt_client_t *client, void *arg, mqtt_connection_status_t status);
+typedef void (*mqtt_request_cb_t)(void *arg, err_t err);
+
+struct mqtt_connect_client_info_t {
+    const char *client_id;
+    const char *client_user;
+    const char *client_pass;
+    u16_t keep_alive;
+    const char *will_topic;
+    const char *will_msg;
+    u8_t will_qos;
+    u8_t will_retain;
+};
+
+#define MQTT_PORT 1883
+
+mqtt_client_t *mqtt_client_new(void);
+void mqtt_client_free(mqtt_client_t *client);
+err_t mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *ipaddr, u16_t port, mqtt_connection_cb_t cb,
+                          void *arg, const struct mqtt_connect_client_info_t *client_info);
+void mqtt_disconnect(mqtt_client_t *client);
+u8_t mqtt_client_is_connected(mqtt_client_t *client);
+err_t mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos,
+                   u8_t retain, mqtt_request_cb_t cb, void *arg);
+
+#endif /*LWIP_HDR_APPS_MQTT_CLIENT_H*/
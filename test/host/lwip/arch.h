@@ -0,0 +1,16 @@
+// Substituto do lwIP para os testes no computador (ver test/host/host_net.h).
+#ifndef LWIP_HDR_ARCH_H
+#define LWIP_HDR_ARCH_H
+
+#include "pico_host.h"
+
+typedef uint8_t u8_t;
+typedef int8_t s8_t;
+typedef uint16_t u16_t;
+typedef int16_t s16_t;
+typedef uint32_t u32_t;
+typedef int32_t s32_t;
+
+#define LWIP_UNUSED_ARG(x) (void)(x)
+
+#endif /*LWIP_HDR_ARCH_H*/
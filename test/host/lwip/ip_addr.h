@@ -0,0 +1,32 @@
+// Substituto do lwIP para os testes no computador (ver test/host/host_net.h).
+#ifndef LWIP_HDR_IP_ADDR_H
+#define LWIP_HDR_IP_ADDR_H
+
+#include "lwip/err.h"
+
+typedef struct ip4_addr { u32_t addr; } ip4_addr_t;
+typedef ip4_addr_t ip_addr_t;
+
+#define IPADDR_TYPE_V4 0U
+#define IPADDR_TYPE_ANY 46U
+
+#define IP4_ADDR(ipaddr, a, b, c, d) \
+    (ipaddr)->addr = ((u32_t)(a)) | ((u32_t)(b) << 8) | ((u32_t)(c) << 16) | ((u32_t)(d) << 24)
+#define ip_2_ip4(ipaddr) (ipaddr)
+#define ip4_addr_get_u32(ipaddr) ((ipaddr)->addr)
+#define ip_addr_get_ip4_u32(ipaddr) ((ipaddr)->addr)
+#define ip4_addr1(ipaddr) ((u8_t)((ipaddr)->addr))
+#define ip4_addr2(ipaddr) ((u8_t)((ipaddr)->addr >> 8))
+#define ip4_addr3(ipaddr) ((u8_t)((ipaddr)->addr >> 16))
+#define ip4_addr4(ipaddr) ((u8_t)((ipaddr)->addr >> 24))
+#define ip4_addr_isany_val(ipaddr) ((ipaddr).addr == 0)
+
+extern const ip_addr_t ip_addr_any;
+#define IP_ADDR_ANY (&ip_addr_any)
+#define IP_ANY_TYPE (&ip_addr_any)
+
+char *ipaddr_ntoa(const ip_addr_t *addr);
+char *ip4addr_ntoa(const ip4_addr_t *addr);
+char *ip4addr_ntoa_r(const ip4_addr_t *addr, char *buf, int buflen);
+
+#endif /*LWIP_HDR_IP_ADDR_H*/
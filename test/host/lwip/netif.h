@@ -0,0 +1,18 @@
+// Substituto do lwIP para os testes no computador (ver test/host/host_net.h).
+#ifndef LWIP_HDR_NETIF_H
+#define LWIP_HDR_NETIF_H
+
+#include "lwip/ip_addr.h"
+
+struct netif {
+    ip_addr_t ip_addr;
+    ip_addr_t netmask;
+    ip_addr_t gw;
+    u8_t flags;
+};
+
+#define netif_ip4_addr(netif) (&(netif)->ip_addr)
+#define netif_ip4_netmask(netif) (&(netif)->netmask)
+#define netif_ip4_gw(netif) (&(netif)->gw)
+
+#endif /*LWIP_HDR_NETIF_H*/
@@ -0,0 +1,2 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#include "pico_host.h"
@@ -0,0 +1,53 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/host_net.h).
+#ifndef PICO_CYW43_ARCH_H
+#define PICO_CYW43_ARCH_H
+
+#include "pico_host.h"
+#include "lwip/netif.h"
+
+typedef struct {
+    struct netif netif[2];
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+#define CYW43_ITF_STA 0
+#define CYW43_ITF_AP 1
+#define CYW43_WL_GPIO_LED_PIN 0
+#define CYW43_AUTH_OPEN 0
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+
+#define CYW43_LINK_DOWN 0
+#define CYW43_LINK_JOIN 1
+#define CYW43_LINK_NOIP 2
+#define CYW43_LINK_UP 3
+#define CYW43_LINK_FAIL -1
+#define CYW43_LINK_NONET -2
+#define CYW43_LINK_BADAUTH -3
+
+#define CYW43_IOCTL_GET_CHANNEL 0x3a
+#define CYW43_DEFAULT_PM 0xA11142
+#define CYW43_AGGRESSIVE_PM 0xA11C82
+#define CYW43_PERFORMANCE_PM 0x111022
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_sta_mode(void);
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth);
+void cyw43_arch_disable_ap_mode(void);
+int cyw43_arch_wifi_connect_async(const char *ssid, const char *pw, uint32_t auth);
+int cyw43_wifi_join(cyw43_t *self, size_t ssid_len, const uint8_t *ssid, size_t key_len, const uint8_t *key,
+                    uint32_t auth_type, const uint8_t *bssid, uint32_t channel);
+int cyw43_wifi_leave(cyw43_t *self, int itf);
+int cyw43_wifi_get_bssid(cyw43_t *self, uint8_t bssid[6]);
+int cyw43_wifi_get_rssi(cyw43_t *self, int32_t *rssi);
+int cyw43_ioctl(cyw43_t *self, uint32_t cmd, size_t len, uint8_t *buf, uint32_t iface);
+int cyw43_wifi_pm(cyw43_t *self, uint32_t pm);
+void cyw43_arch_lwip_begin(void);
+void cyw43_arch_lwip_end(void);
+void cyw43_arch_poll(void);
+int cyw43_tcpip_link_status(cyw43_t *self, int itf);
+int cyw43_gpio_get(cyw43_t *self, int gpio, bool *val);
+int cyw43_gpio_set(cyw43_t *self, int gpio, bool val);
+
+#endif /*PICO_CYW43_ARCH_H*/
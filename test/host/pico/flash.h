@@ -0,0 +1,4 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#include "pico_host.h"
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
@@ -0,0 +1,10 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#ifndef PICO_MULTICORE_H
+#define PICO_MULTICORE_H
+
+#include "pico_host.h"
+
+void multicore_launch_core1(void (*entry)(void));   // Executa `entry` em uma thread (`get_core_num` = 1).
+void multicore_lockout_victim_init(void);
+
+#endif /*PICO_MULTICORE_H*/
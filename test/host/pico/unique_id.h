@@ -0,0 +1,12 @@
+// Substituto do Pico SDK para os testes no computador (ver test/host/pico_host.h).
+#include "pico_host.h"
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
+
+typedef struct {
+    uint8_t id[PICO_UNIQUE_BOARD_ID_SIZE_BYTES];
+} pico_unique_board_id_t;
+
+extern pico_unique_board_id_t host_board_id;    // Identificador devolvido por `pico_get_unique_board_id`.
+
+void pico_get_unique_board_id(pico_unique_board_id_t *id_out);
@@ -0,0 +1,93 @@
+/******************************************************************************
+ * @file    pico_host.h
+ * @brief   Substitutos mínimos do Pico SDK para compilar os módulos do projeto
+ *          no computador (testes em test/).
+ *
+ * @note    Declara apenas o que os módulos testados usam. O relógio é simulado
+ *          (`host_time_us`) e avança somente quando o teste manda; as funções de
+ *          hardware (GPIO, ADC, PWM, I2C) não fazem nada além de registrar o que os
+ *          testes observam: as escritas I2C (`host_i2c_write_hook`), o relógio do
+ *          sistema (`host_sys_khz`) e o callback das interrupções dos GPIOs (host_sdk.c).
+ ******************************************************************************/
+
+#ifndef PICO_HOST_H
+#define PICO_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+typedef unsigned int uint;
+
+#define _u(x) x##u
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+
+#define PICO_OK 0
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define XIP_BASE 0x10000000
+#define FLASH_SECTOR_SIZE 4096
+#define FLASH_PAGE_SIZE 256
+
+// ------------------------------ Relógio simulado ------------------------------
+
+extern uint64_t host_time_us;           // Instante atual do relógio simulado.
+
+static inline void host_time_advance_ms(uint32_t ms) { host_time_us += (uint64_t)ms * 1000; }
+
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint64_t to_us_since_boot(absolute_time_t t);
+absolute_time_t from_us_since_boot(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+void tight_loop_contents(void);
+
+// ------------------------------ GPIO, núcleos e interrupções ------------------------------
+
+#define GPIO_IN 0
+#define GPIO_OUT 1
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+
+enum gpio_function { GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4 };
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+extern gpio_irq_callback_t host_gpio_irq_callback; // Callback de `gpio_set_irq_enabled_with_callback` (a interrupção é o teste que chama).
+extern uint32_t host_gpio_irq_pins;     // Pinos com interrupção habilitada (bit = número do pino).
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_pull_up(uint gpio);
+bool gpio_get(uint gpio);
+void gpio_put(uint gpio, bool value);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+
+bool stdio_init_all(void);
+bool stdio_usb_connected(void);
+int puts_raw(const char *s);
+
+extern _Thread_local uint host_core_num; // Retorno de `get_core_num` (0 por padrão, 1 na thread do núcleo 1).
+
+uint get_core_num(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void __dmb(void);
+void __sev(void);
+void __wfe(void);
+void __wfi(void);
+
+#endif /*PICO_HOST_H*/
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * @file    host_test.h
+ * @brief   Verificações e gerador pseudoaleatório dos testes executados no
+ *          computador (host).
+ *
+ * @note    Cada teste é um executável: as verificações que falham são impressas
+ *          com arquivo e linha, e `host_test_report` define o código de saída
+ *          usado pelo CTest. O gerador é próprio (xorshift32) para que as
+ *          sequências de fuzzing sejam as mesmas em qualquer libc.
+ ******************************************************************************/
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static unsigned long host_test_checks = 0;     // Verificações executadas.
+static unsigned long host_test_failures = 0;   // Verificações que falharam.
+static uint32_t host_test_seed = 0x2545F491;   // Estado do gerador pseudoaleatório.
+
+#define CHECK(cond) do {                                                          \
+    host_test_checks++;                                                           \
+    if (!(cond)) {                                                                \
+        host_test_failures++;                                                     \
+        fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond);        \
+    }                                                                             \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do {                                           \
+    long long actual_ = (long long)(actual), expected_ = (long long)(expected);  \
+    host_test_checks++;                                                           \
+    if (actual_ != expected_) {                                                   \
+        host_test_failures++;                                                     \
+        fprintf(stderr, "%s:%d: falhou: %s == %s (%lld != %lld)\n", __FILE__,     \
+                __LINE__, #actual, #expected, actual_, expected_);                \
+    }                                                                             \
+} while (0)
+
+/**
+ * @brief Retorna o próximo número do gerador pseudoaleatório (xorshift32).
+ */
+static inline uint32_t host_test_rand(void) {
+    uint32_t x = host_test_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return host_test_seed = x;
+}
+
+/**
+ * @brief Quantidade de iterações de fuzzing: `FUZZ_ITERATIONS` do ambiente ou o padrão.
+ */
+static inline unsigned long host_test_iterations(unsigned long fallback) {
+    const char *env = getenv("FUZZ_ITERATIONS");
+    return env ? strtoul(env, NULL, 10) : fallback;
+}
+
+/**
+ * @brief Silencia (ou restaura) a saída padrão, para os `printf` dos módulos em laços longos.
+ */
+static inline void host_test_quiet(bool quiet) {
+    static int saved = -1;
+    fflush(stdout);
+    if (quiet && saved < 0) {
+        saved = dup(STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    } else if (!quiet && saved >= 0) {
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+        saved = -1;
+    }
+}
+
+/**
+ * @brief Imprime o resumo do teste e retorna o código de saída (0 sem falhas).
+ */
+static inline int host_test_report(const char *name) {
+    printf("%s: %lu verificações, %lu falhas\n", name, host_test_checks, host_test_failures);
+    return host_test_failures ? 1 : 0;
+}
+
+#endif /*HOST_TEST_H*/
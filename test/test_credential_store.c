@@ -0,0 +1,241 @@
+/******************************************************************************
+ * @file    test_credential_store.c
+ * @brief   Teste do registro de credenciais Wi-Fi (storage/credential_store.h):
+ *          leitura e gravação, ofuscação, desgaste do setor e quedas de energia
+ *          no meio de uma gravação.
+ *
+ * @note    A flash é emulada em RAM (host_flash.h: gravar só zera bits; a
+ *          queda de energia corta a operação após um número de bytes).
+ *          A região emulada cobre o setor das credenciais e a fila de telemetria
+ *          logo acima dele, para verificar que um não invade o outro.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "host_flash.h"
+#include "storage/credential_store.h"
+
+_Static_assert(HOST_FLASH_BASE == CRED_STORE_OFFSET, "região emulada deve começar no setor das credenciais");
+
+// ------------------------------ Auxiliares ------------------------------
+
+typedef struct CREDENTIALS_T_ {
+    char ssid[CRED_STORE_SSID_SIZE + 1];
+    char password[CRED_STORE_PASSWORD_SIZE + 1];
+    CRED_STORE_LINK_T link;
+} CREDENTIALS_T;
+
+static void format_flash(void) {
+    host_flash_reset();
+    flash_queue_init();
+}
+
+/**
+ * @brief Monta credenciais distintas para cada `n` (com cache da conexão quando `n` é par).
+ */
+static CREDENTIALS_T make_credentials(unsigned n) {
+    CREDENTIALS_T c;
+    memset(&c, 0, sizeof(c));
+    snprintf(c.ssid, sizeof(c.ssid), "Rede-%u", n);
+    snprintf(c.password, sizeof(c.password), "senha secreta %u", n * 7919);
+    c.link.valid = n % 2 == 0;
+    if (c.link.valid) {
+        for (int i = 0; i < 6; i++) c.link.bssid[i] = (uint8_t)(n + i);
+        c.link.channel = 1 + n % 13;
+        for (int i = 0; i < WPA2_PMK_SIZE; i++) c.link.pmk[i] = (uint8_t)(n * 13 + i);
+    }
+    return c;
+}
+
+static bool save(const CREDENTIALS_T *c) {
+    return cred_store_save(c->ssid, c->password, &c->link);
+}
+
+/**
+ * @brief Lê o registro atual (como no boot); retorna false se não houver.
+ */
+static bool load(CREDENTIALS_T *c) {
+    memset(c, 0, sizeof(*c));
+    return cred_store_load(c->ssid, sizeof(c->ssid), c->password, sizeof(c->password), &c->link);
+}
+
+static bool same(const CREDENTIALS_T *a, const CREDENTIALS_T *b) {
+    if (strcmp(a->ssid, b->ssid) != 0 || strcmp(a->password, b->password) != 0) return false;
+    if (a->link.valid != b->link.valid) return false;
+    return !a->link.valid || (memcmp(a->link.bssid, b->link.bssid, 6) == 0 && a->link.channel == b->link.channel &&
+                              memcmp(a->link.pmk, b->link.pmk, WPA2_PMK_SIZE) == 0);
+}
+
+static bool contains(const uint8_t *data, size_t len, const char *text) {
+    size_t n = strlen(text);
+    for (size_t i = 0; i + n <= len; i++) {
+        if (memcmp(data + i, text, n) == 0) return true;
+    }
+    return false;
+}
+
+// ------------------------------ Cenário 1: leitura, gravação e validação ------------------------------
+
+static void test_round_trip(void) {
+    CREDENTIALS_T c, out;
+    format_flash();
+    CHECK(!load(&out));
+
+    c = make_credentials(2);
+    CHECK(save(&c));
+    CHECK(load(&out) && same(&out, &c));
+    c = make_credentials(3);
+    CHECK(save(&c));
+    CHECK(load(&out) && same(&out, &c) && !out.link.valid);
+
+    // Credenciais iguais não são regravadas
+    host_flash_written = 0;
+    CHECK(save(&c));
+    CHECK_EQ(host_flash_written, 0);
+
+    // Só o cache da conexão mudou: grava um novo registro
+    c.link = make_credentials(4).link;
+    CHECK(save(&c));
+    CHECK(host_flash_written > 0);
+    CHECK(load(&out) && same(&out, &c));
+
+    // Tamanhos nos limites do registro
+    memset(c.ssid, 'S', CRED_STORE_SSID_SIZE);
+    c.ssid[CRED_STORE_SSID_SIZE] = '\0';
+    memset(c.password, 'p', CRED_STORE_PASSWORD_SIZE);
+    c.password[CRED_STORE_PASSWORD_SIZE] = '\0';
+    CHECK(save(&c));
+    CHECK(load(&out) && same(&out, &c));
+    CHECK(!cred_store_save("", "senha", NULL));
+    CHECK(!cred_store_save("123456789012345678901234567890123", "senha", NULL));
+
+    // Buffers pequenos demais para o registro atual
+    char small[8];
+    CHECK(!cred_store_load(small, sizeof(small), out.password, sizeof(out.password), NULL));
+
+    // Senha e SSID não aparecem em claro na flash
+    c = make_credentials(5);
+    CHECK(save(&c));
+    CHECK(!contains(host_flash, FLASH_SECTOR_SIZE, c.ssid));
+    CHECK(!contains(host_flash, FLASH_SECTOR_SIZE, c.password));
+
+    // Um registro copiado para outra placa não é lido corretamente
+    pico_unique_board_id_t own = host_board_id;
+    host_board_id.id[3] ^= 0x5A;
+    if (load(&out)) CHECK(!same(&out, &c));
+    host_board_id = own;
+    CHECK(load(&out) && same(&out, &c));
+
+    // Registros de versões anteriores são ignorados
+    format_flash();
+    CHECK(save(&c));
+    CRED_STORE_RECORD_T rec;
+    memcpy(&rec, host_flash, sizeof(rec));
+    rec.version = CRED_STORE_VERSION - 1;
+    rec.crc = crc32_compute(&rec, offsetof(CRED_STORE_RECORD_T, crc));
+    memcpy(host_flash, &rec, sizeof(rec));
+    CHECK(!load(&out));
+}
+
+// ------------------------------ Cenário 2: desgaste e isolamento da fila ------------------------------
+
+static void test_wear(void) {
+    CREDENTIALS_T c, out;
+    format_flash();
+    for (uint32_t id = 1; id <= 20; id++) flash_queue_push(id, 25.0f, -5.0f, -35.0f);
+
+    // Uma gravação por página; o setor só é apagado quando todas estão usadas
+    host_flash_erases = 0;
+    for (unsigned n = 1; n <= 3 * CRED_STORE_PAGES; n++) {
+        c = make_credentials(n);
+        CHECK(save(&c));
+        CHECK_EQ(cred_store_current, (int)((n - 1) % CRED_STORE_PAGES));
+        CHECK_EQ(host_flash_erases, (n - 1) / CRED_STORE_PAGES);
+        CHECK(load(&out) && same(&out, &c));
+    }
+
+    // A fila de telemetria, no setor seguinte, não foi tocada
+    flash_queue_init();
+    CHECK_EQ(flash_queue.count, 20);
+}
+
+// ------------------------------ Cenário 3: quedas de energia durante a gravação ------------------------------
+
+/**
+ * @brief Grava `next` a partir de `snapshot` cortando a energia após cada byte possível.
+ *
+ * @param may_lose Se a queda pode perder as credenciais (setor apagado antes da gravação).
+ * @return A quantidade de pontos de corte percorridos.
+ */
+static long sweep(const uint8_t *snapshot, const CREDENTIALS_T *old, const CREDENTIALS_T *next, bool may_lose) {
+    CREDENTIALS_T out, c;
+
+    // Conta os bytes escritos pela gravação sem queda
+    memcpy(host_flash, snapshot, HOST_FLASH_SIZE);
+    CHECK(load(&out));
+    host_flash_written = 0;
+    CHECK(save(next));
+    long total = host_flash_written;
+
+    long lost = 0;
+    for (long cut = 0; cut <= total; cut++) {
+        memcpy(host_flash, snapshot, HOST_FLASH_SIZE);
+        CHECK(load(&out));
+        host_flash_budget = cut;
+        if (setjmp(host_flash_power_lost) == 0) save(next);
+        host_flash_budget = -1;
+
+        // Boot seguinte: credenciais antigas ou novas, nunca uma mistura
+        if (load(&out)) {
+            CHECK(same(&out, old) || same(&out, next));
+            if (cut == total) CHECK(same(&out, next));
+        } else {
+            lost++;
+        }
+
+        // O registro continua utilizável (páginas com gravação interrompida são puladas)
+        c = make_credentials(1000 + (unsigned)cut);
+        CHECK(save(&c));
+        CHECK(load(&out) && same(&out, &c));
+    }
+    CHECK(may_lose || lost == 0);
+    return total + 1;
+}
+
+static void test_torn_save(void) {
+    static uint8_t snapshot[HOST_FLASH_SIZE];
+    CREDENTIALS_T old = make_credentials(10), next = make_credentials(11);
+
+    // Página livre após o registro atual: o registro anterior vale até o novo estar completo
+    format_flash();
+    CHECK(save(&old));
+    memcpy(snapshot, host_flash, HOST_FLASH_SIZE);
+    long cuts = sweep(snapshot, &old, &next, false);
+    fprintf(stderr, "gravação interrompida: %ld pontos de corte\n", cuts);
+
+    // Página com gravação interrompida antes de uma livre
+    memcpy(host_flash, snapshot, HOST_FLASH_SIZE);
+    host_flash[FLASH_PAGE_SIZE + 40] = 0x00;
+    memcpy(snapshot, host_flash, HOST_FLASH_SIZE);
+    cuts = sweep(snapshot, &old, &next, false);
+    fprintf(stderr, "gravação interrompida após página corrompida: %ld pontos de corte\n", cuts);
+
+    // Setor cheio: o apagamento vem antes da gravação e a queda pode perder as credenciais
+    format_flash();
+    for (unsigned n = 1; n <= CRED_STORE_PAGES; n++) {
+        old = make_credentials(n);
+        CHECK(save(&old));
+    }
+    memcpy(snapshot, host_flash, HOST_FLASH_SIZE);
+    cuts = sweep(snapshot, &old, &next, true);
+    fprintf(stderr, "apagamento e gravação interrompidos (setor cheio): %ld pontos de corte\n", cuts);
+}
+
+int main(void) {
+    host_test_quiet(true);              // `cred_store_save` imprime a página de cada gravação
+    test_round_trip();
+    test_wear();
+    test_torn_save();
+    host_test_quiet(false);
+    return host_test_report("test_credential_store");
+}
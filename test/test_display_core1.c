@@ -0,0 +1,257 @@
+/******************************************************************************
+ * @file    test_display_core1.c
+ * @brief   Teste do envio dos quadros do display pelo núcleo 1 (display_core1.h),
+ *          com o núcleo 1 rodando de fato em outra thread.
+ *
+ * @note    O painel é simulado a partir das escritas I2C (`host_i2c_write_hook`):
+ *          comandos de página, contraste e liga/desliga e os dados de cada
+ *          página. O barramento pode ser retido para segurar o núcleo 1 no meio
+ *          de um quadro, o que torna determinística a substituição de quadros.
+ ******************************************************************************/
+
+#include <sched.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "host_test.h"
+#include "display_core1.h"
+
+#define WAIT_LIMIT_S 10                 // Limite da espera pelo núcleo 1 (o teste falha em vez de travar).
+
+// ------------------------------ Painel simulado ------------------------------
+
+/**
+ * @brief Estado do painel reconstruído a partir das escritas I2C.
+ *
+ * Escrito apenas por quem escreve no I2C; lido pelo teste depois de `wait_idle`, cujo spin
+ * lock ordena as memórias entre as threads.
+ */
+typedef struct PANEL_T_ {
+    uint8_t ram[SSD1306_BUFFER_SIZE];       // Conteúdo exibido.
+    int page;                               // Página selecionada (comando 0xB0 + página).
+    bool contrast_next;                     // O próximo comando é o valor do contraste (após 0x81).
+    int contrast;                           // Último contraste recebido.
+    uint32_t contrast_cmds;                 // Comandos de contraste recebidos.
+    uint32_t data_at_contrast;              // Páginas escritas até o último comando de contraste.
+    bool on;                                // Painel ligado (0xAF) ou desligado (0xAE).
+    uint32_t page_writes[DISPLAY_CORE1_PAGES]; // Escritas de cada página.
+    uint32_t data_writes;                   // Páginas escritas no total.
+    uint32_t writes[2];                     // Escritas I2C de cada núcleo.
+    uint32_t bad;                           // Escritas com endereço ou formato inesperado.
+} PANEL_T;
+
+static PANEL_T panel;
+static volatile bool bus_hold = false;      // Retém a próxima escrita I2C até ser liberado.
+static volatile bool bus_waiting = false;   // Uma escrita está retida.
+
+static void panel_write(uint8_t addr, const uint8_t *src, size_t len) {
+    while (__atomic_load_n(&bus_hold, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&bus_waiting, true, __ATOMIC_RELEASE);
+        sched_yield();
+    }
+    __atomic_store_n(&bus_waiting, false, __ATOMIC_RELEASE);
+
+    panel.writes[get_core_num()]++;
+    if (addr != SSD1306_I2C_ADDR || len < 2) {
+        panel.bad++;
+    } else if (src[0] == 0x80 && len == 2) {
+        uint8_t cmd = src[1];
+        if (panel.contrast_next) {
+            panel.contrast = cmd;
+            panel.contrast_cmds++;
+            panel.data_at_contrast = panel.data_writes;
+            panel.contrast_next = false;
+        } else if (cmd == 0x81) {
+            panel.contrast_next = true;
+        } else if (cmd == 0xAE || cmd == 0xAF) {
+            panel.on = cmd == 0xAF;
+        } else if (cmd >= 0xB0 && cmd < 0xB0 + DISPLAY_CORE1_PAGES) {
+            panel.page = cmd - 0xB0;
+        }
+    } else if (src[0] == 0x40 && len == SSD1306_WIDTH + 1) {
+        memcpy(panel.ram + panel.page * SSD1306_WIDTH, src + 1, SSD1306_WIDTH);
+        panel.page_writes[panel.page]++;
+        panel.data_writes++;
+    } else {
+        panel.bad++;
+    }
+}
+
+// ------------------------------ Auxiliares ------------------------------
+
+static uint8_t frame[SSD1306_BUFFER_SIZE];  // Último quadro entregue pelo núcleo 0.
+
+// Entrega `frame` pelo caminho do firmware: buffer do driver e `ssd1306_UpdateScreen`
+static void post_frame(void) {
+    ssd1306_FillBuffer(frame, sizeof(frame));
+    ssd1306_UpdateScreen();
+}
+
+// Tempo real (o relógio simulado não avança enquanto o teste espera o núcleo 1)
+static time_t wall_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+// Aguarda o núcleo 1 enviar todos os quadros e comandos pendentes
+static void wait_idle(void) {
+    time_t limit = wall_s() + WAIT_LIMIT_S;
+    while ((!display_core1_idle() ||
+            display_core1.stats.flushed + display_core1.stats.replaced != display_core1.stats.posted) &&
+           wall_s() < limit) {
+        sched_yield();
+    }
+    CHECK(wall_s() < limit);
+}
+
+// Aguarda o núcleo 1 parar na escrita retida
+static void wait_bus_held(void) {
+    time_t limit = wall_s() + WAIT_LIMIT_S;
+    while (!__atomic_load_n(&bus_waiting, __ATOMIC_ACQUIRE) && wall_s() < limit) sched_yield();
+    CHECK(wall_s() < limit);
+}
+
+static void release_bus(void) {
+    __atomic_store_n(&bus_hold, false, __ATOMIC_RELEASE);
+}
+
+// ------------------------------ Cenários ------------------------------
+
+// Sem o núcleo 1: quadros e comandos vão direto ao I2C pelo núcleo 0
+static void test_before_start(void) {
+    CHECK(!display_core1.running);
+    CHECK(display_core1_idle());
+    display_core1_set_contrast(0x40);
+    display_core1_set_on(false);
+    CHECK_EQ(panel.contrast, 0x40);
+    CHECK(!panel.on);
+    memset(frame, 0x5A, sizeof(frame));
+    post_frame();
+    CHECK(memcmp(panel.ram, frame, sizeof(frame)) == 0);
+    CHECK_EQ(panel.data_writes, DISPLAY_CORE1_PAGES);
+    CHECK_EQ(panel.writes[1], 0);
+    CHECK_EQ(display_core1.stats.posted, 0);
+}
+
+// Com o núcleo 1: o primeiro quadro vai inteiro, os seguintes só nas páginas que mudaram
+static void test_pages(void) {
+    display_core1_start();
+    CHECK(display_core1.running);
+    uint32_t core0_writes = panel.writes[0];
+
+    memset(frame, 0, sizeof(frame));        // Igual à cópia inicial do núcleo 1, não ao painel
+    post_frame();
+    wait_idle();
+    CHECK_EQ(panel.data_writes, 2 * DISPLAY_CORE1_PAGES);
+    CHECK_EQ(display_core1.stats.pages_written, DISPLAY_CORE1_PAGES);
+    CHECK_EQ(display_core1.stats.flushed, 1);
+    CHECK(memcmp(panel.ram, frame, sizeof(frame)) == 0);
+
+    frame[5 * SSD1306_WIDTH + 17] ^= 0x01;  // Um pixel na página 5
+    uint32_t page5 = panel.page_writes[5];
+    post_frame();
+    wait_idle();
+    CHECK_EQ(panel.page_writes[5], page5 + 1);
+    CHECK_EQ(panel.data_writes, 2 * DISPLAY_CORE1_PAGES + 1);
+    CHECK_EQ(display_core1.stats.pages_skipped, DISPLAY_CORE1_PAGES - 1);
+    CHECK(memcmp(panel.ram, frame, sizeof(frame)) == 0);
+
+    post_frame();                           // Quadro igual: nenhuma página escrita
+    wait_idle();
+    CHECK_EQ(panel.data_writes, 2 * DISPLAY_CORE1_PAGES + 1);
+    CHECK_EQ(display_core1.stats.flushed, 3);
+    CHECK_EQ(panel.writes[0], core0_writes);    // O núcleo 0 não toca mais no I2C
+}
+
+// Núcleo 1 preso no meio de um quadro: o núcleo 0 não espera e o quadro pendente é substituído
+static void test_replace(void) {
+    uint32_t replaced = display_core1.stats.replaced, flushed = display_core1.stats.flushed;
+    uint32_t page1 = panel.page_writes[1], page2 = panel.page_writes[2], data = panel.data_writes;
+
+    __atomic_store_n(&bus_hold, true, __ATOMIC_RELEASE);
+    memset(frame + 1 * SSD1306_WIDTH, 0x11, SSD1306_WIDTH);    // Quadro A: página 1
+    post_frame();
+    wait_bus_held();
+
+    memset(frame + 2 * SSD1306_WIDTH, 0x22, SSD1306_WIDTH);    // Quadro B: página 2 (nunca enviado)
+    post_frame();
+    memset(frame + 2 * SSD1306_WIDTH, 0x33, SSD1306_WIDTH);    // Quadro C: substitui B
+    post_frame();
+    CHECK_EQ(display_core1.stats.replaced, replaced + 1);
+
+    display_core1_set_contrast(0x10);       // O pedido não aplicado é substituído
+    display_core1_set_contrast(0x20);
+    uint32_t contrast_cmds = panel.contrast_cmds;
+    CHECK(!display_core1_idle());
+
+    release_bus();
+    wait_idle();
+    CHECK(memcmp(panel.ram, frame, sizeof(frame)) == 0);
+    CHECK_EQ(display_core1.stats.flushed, flushed + 2);
+    CHECK_EQ(panel.page_writes[1], page1 + 1);
+    CHECK_EQ(panel.page_writes[2], page2 + 1);              // Só o quadro C chegou à página 2
+    CHECK_EQ(panel.contrast, 0x20);
+    CHECK_EQ(panel.contrast_cmds, contrast_cmds + 1);
+    CHECK_EQ(panel.data_at_contrast, data + 1);             // Depois do quadro A, antes do quadro C
+}
+
+// Liga e desliga o painel pelo núcleo 1
+static void test_panel_on(void) {
+    uint32_t core0_writes = panel.writes[0];
+    display_core1_set_on(true);
+    wait_idle();
+    CHECK(panel.on);
+    display_core1_set_on(false);
+    wait_idle();
+    CHECK(!panel.on);
+    display_core1_set_on(true);
+    wait_idle();
+    CHECK(panel.on);
+    CHECK_EQ(panel.writes[0], core0_writes);
+}
+
+// Quadros sorteados entregues sem pausa, disputando o spin lock com o núcleo 1
+static void test_random(void) {
+    unsigned long rounds = host_test_iterations(20000);
+    DISPLAY_CORE1_STATS_T start = display_core1.stats;
+    uint32_t core0_writes = panel.writes[0];
+    int contrast = panel.contrast;
+    for (unsigned long round = 0; round < rounds; round++) {
+        uint32_t pages = host_test_rand() % (1u << DISPLAY_CORE1_PAGES);
+        for (int page = 0; page < DISPLAY_CORE1_PAGES; page++) {
+            if (pages & (1u << page)) frame[page * SSD1306_WIDTH + host_test_rand() % SSD1306_WIDTH] ^= 1 << (host_test_rand() % 8);
+        }
+        post_frame();
+        if (host_test_rand() % 64 == 0) {
+            contrast = host_test_rand() % 256;
+            display_core1_set_contrast((uint8_t)contrast);
+        }
+        if (host_test_rand() % 4 == 0) sched_yield();
+    }
+    wait_idle();
+
+    DISPLAY_CORE1_STATS_T end = display_core1.stats;
+    uint32_t flushed = end.flushed - start.flushed;
+    CHECK(memcmp(panel.ram, frame, sizeof(frame)) == 0);
+    CHECK_EQ(panel.contrast, contrast);
+    CHECK_EQ(end.posted - start.posted, rounds);
+    CHECK_EQ(flushed + end.replaced - start.replaced, rounds);
+    CHECK_EQ(end.pages_written - start.pages_written + end.pages_skipped - start.pages_skipped,
+             flushed * DISPLAY_CORE1_PAGES);
+    CHECK_EQ(panel.writes[0], core0_writes);
+    CHECK_EQ(panel.bad, 0);
+}
+
+int main(void) {
+    host_test_quiet(true);
+    ssd1306_Init();
+    host_test_quiet(false);
+    host_i2c_write_hook = panel_write;
+    test_before_start();
+    test_pages();
+    test_replace();
+    test_panel_on();
+    test_random();
+    return host_test_report("test_display_core1");
+}
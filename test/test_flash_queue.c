@@ -0,0 +1,236 @@
+/******************************************************************************
+ * @file    test_flash_queue.c
+ * @brief   Teste de recuperação da fila persistente (storage/flash_queue.h)
+ *          após quedas de energia no meio de gravações e apagamentos.
+ *
+ * @note    A flash é emulada em RAM (host_flash.h), com a semântica da flash
+ *          NOR (gravar só zera bits). A queda de energia é simulada cortando a
+ *          operação em andamento depois de um número de bytes (`longjmp`): o
+ *          estado em RAM é perdido e a fila é reconstruída por `flash_queue_init`,
+ *          como no boot seguinte. Cada cenário percorre todos os pontos de corte.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "host_flash.h"
+#include "storage/flash_queue.h"
+
+_Static_assert(HOST_FLASH_BASE + FLASH_SECTOR_SIZE == FLASH_QUEUE_OFFSET, "a fila deve vir logo após o setor das credenciais na região emulada");
+
+// ------------------------------ Auxiliares ------------------------------
+
+static const FLASH_QUEUE_RECORD_T *records[FLASH_QUEUE_CAPACITY];
+
+/**
+ * @brief Reconstrói a fila (boot) e lê os identificadores pendentes (`timestamp_ms`), em ordem.
+ */
+static uint16_t recover(uint32_t *ids) {
+    flash_queue_init();
+    uint16_t n = flash_queue_peek(records, FLASH_QUEUE_CAPACITY);
+    for (uint16_t i = 0; i < n; i++) ids[i] = records[i]->timestamp_ms;
+    return n;
+}
+
+static void push_id(uint32_t id) {
+    flash_queue_push(id, 25.0f, -5.0f, -35.0f);
+}
+
+static void format_flash(void) {
+    host_flash_reset();
+    flash_queue_init();
+}
+
+/**
+ * @brief Verifica o estado reconstruído: `count`, `head` e ordem dos pendentes.
+ */
+static void check_consistent(const uint32_t *ids, uint16_t n) {
+    CHECK_EQ(flash_queue.count, n);
+    if (n > 0) CHECK_EQ(flash_queue_record(flash_queue.head)->timestamp_ms, ids[0]);
+    for (uint16_t i = 1; i < n; i++) CHECK(ids[i] > ids[i - 1]);
+    CHECK(flash_queue.tail < FLASH_QUEUE_CAPACITY);
+}
+
+/**
+ * @brief Executa `op` a partir de `snapshot` cortando a energia após cada byte possível.
+ *
+ * @param check Chamada após a recuperação com o ponto de corte e os pendentes reconstruídos.
+ * @return A quantidade de pontos de corte percorridos.
+ */
+static long sweep(const uint8_t *snapshot, void (*op)(void), void (*check)(long cut, const uint32_t *ids, uint16_t n)) {
+    static uint32_t ids[FLASH_QUEUE_CAPACITY];
+
+    // Conta os bytes escritos pela operação sem queda
+    memcpy(host_flash, snapshot, HOST_FLASH_SIZE);
+    flash_queue_init();
+    host_flash_written = 0;
+    op();
+    long total = host_flash_written;
+
+    for (long cut = 0; cut <= total; cut++) {
+        memcpy(host_flash, snapshot, HOST_FLASH_SIZE);
+        flash_queue_init();
+        host_flash_budget = cut;
+        if (setjmp(host_flash_power_lost) == 0) op();
+        host_flash_budget = -1;
+
+        uint16_t n = recover(ids);
+        check_consistent(ids, n);
+        check(cut, ids, n);
+
+        // A recuperação é estável e a fila continua utilizável
+        uint16_t again = recover(ids);
+        CHECK_EQ(again, n);
+        push_id(100000);
+        n = recover(ids);
+        check_consistent(ids, n);
+        CHECK(n > 0 && ids[n - 1] == 100000);
+    }
+    return total + 1;
+}
+
+// ------------------------------ Cenário 1: gravação de registro interrompida ------------------------------
+
+static void op_push_21(void) { push_id(21); }
+
+static void check_push(long cut, const uint32_t *ids, uint16_t n) {
+    CHECK(n == 20 || n == 21);
+    for (uint16_t i = 0; i < n; i++) CHECK_EQ(ids[i], i + 1);
+    CHECK(flash_queue.corrupted <= 1);
+}
+
+static void test_torn_push(void) {
+    static uint8_t snapshot[HOST_FLASH_SIZE];
+    format_flash();
+    for (uint32_t id = 1; id <= 20; id++) push_id(id);
+    memcpy(snapshot, host_flash, HOST_FLASH_SIZE);
+
+    long cuts = sweep(snapshot, op_push_21, check_push);
+    fprintf(stderr, "gravação interrompida: %ld pontos de corte\n", cuts);
+}
+
+// ------------------------------ Cenário 2: marcação de entrega interrompida ------------------------------
+
+static void op_consume_10(void) { flash_queue_consume(10); }
+
+static void check_consume(long cut, const uint32_t *ids, uint16_t n) {
+    // A marcação é gravada em ordem: some um prefixo dos 10 mais antigos, nunca outro registro
+    CHECK(n >= 10 && n <= 20);
+    for (uint16_t i = 0; i < n; i++) CHECK_EQ(ids[i], 20 - n + 1 + i);
+}
+
+static void test_torn_consume(void) {
+    static uint8_t snapshot[HOST_FLASH_SIZE];
+    format_flash();
+    for (uint32_t id = 1; id <= 20; id++) push_id(id);     // Registros 1-8 na página 0, 9-16 na página 1
+    memcpy(snapshot, host_flash, HOST_FLASH_SIZE);
+
+    long cuts = sweep(snapshot, op_consume_10, check_consume);
+    fprintf(stderr, "marcação de entrega interrompida: %ld pontos de corte\n", cuts);
+}
+
+// ------------------------------ Cenário 3: apagamento de setor interrompido (fila cheia) ------------------------------
+
+static void op_push_overflow(void) { push_id(FLASH_QUEUE_CAPACITY + 1); }
+
+static void check_overflow(long cut, const uint32_t *ids, uint16_t n) {
+    // Só o setor mais antigo (1 a RECORDS_PER_SECTOR) pode perder registros
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        CHECK(ids[i] >= 1 && ids[i] <= FLASH_QUEUE_CAPACITY + 1);
+        if (ids[i] > FLASH_QUEUE_RECORDS_PER_SECTOR && ids[i] <= FLASH_QUEUE_CAPACITY) kept++;
+    }
+    CHECK_EQ(kept, FLASH_QUEUE_CAPACITY - FLASH_QUEUE_RECORDS_PER_SECTOR);
+}
+
+static void test_torn_erase(void) {
+    static uint8_t snapshot[HOST_FLASH_SIZE];
+    format_flash();
+    for (uint32_t id = 1; id <= FLASH_QUEUE_CAPACITY; id++) push_id(id);
+    CHECK_EQ(flash_queue.count, FLASH_QUEUE_CAPACITY);
+    memcpy(snapshot, host_flash, HOST_FLASH_SIZE);
+
+    long cuts = sweep(snapshot, op_push_overflow, check_overflow);
+    fprintf(stderr, "apagamento interrompido (fila cheia): %ld pontos de corte\n", cuts);
+}
+
+// ------------------------------ Cenário 4: sequência aleatória com quedas ------------------------------
+
+/**
+ * @brief Empurra e entrega amostras dando várias voltas na região, com quedas em pontos aleatórios.
+ *
+ * Mantém a fila abaixo da capacidade (sem descarte), de modo que o conteúdo esperado é
+ * exato: os pendentes do modelo, menos um prefixo da entrega interrompida, mais
+ * (talvez) a amostra da gravação interrompida.
+ */
+static void test_random_power_loss(void) {
+    static uint32_t model[FLASH_QUEUE_CAPACITY];    // Pendentes esperados, em ordem
+    static uint32_t ids[FLASH_QUEUE_CAPACITY];
+    uint16_t model_n = 0;
+    uint32_t next_id = 1;
+    unsigned long losses = 0;
+    unsigned long rounds = host_test_iterations(6000);
+
+    format_flash();
+    for (unsigned long round = 0; round < rounds; round++) {
+        bool push = model_n == 0 || (model_n < FLASH_QUEUE_CAPACITY - 2 * FLASH_QUEUE_RECORDS_PER_SECTOR && host_test_rand() % 3 != 0);
+        uint16_t consume_n = push ? 0 : 1 + host_test_rand() % (model_n < 20 ? model_n : 20);
+        bool cut = host_test_rand() % 8 == 0;
+
+        // Corte dentro da operação: uma página por gravação, mais o setor ao entrar em um novo
+        uint32_t span = !push ? 3 * FLASH_PAGE_SIZE
+                      : flash_queue.tail % FLASH_QUEUE_RECORDS_PER_SECTOR == 0 ? FLASH_SECTOR_SIZE + FLASH_PAGE_SIZE
+                      : FLASH_PAGE_SIZE;
+        host_flash_budget = cut ? (long)(host_test_rand() % span) : -1;
+        bool lost = false;
+        if (setjmp(host_flash_power_lost) == 0) {
+            if (push) push_id(next_id);
+            else flash_queue_consume(consume_n);
+        } else {
+            lost = true;
+            losses++;
+        }
+        host_flash_budget = -1;
+
+        if (!lost) {
+            if (push) model[model_n++] = next_id;
+            else {
+                memmove(model, model + consume_n, (model_n - consume_n) * sizeof(model[0]));
+                model_n -= consume_n;
+            }
+            if (push) next_id++;
+            if (!cut) continue;
+        }
+
+        uint16_t n = recover(ids);
+        check_consistent(ids, n);
+        if (push) {
+            // Pendentes do modelo, e a nova amostra se a gravação chegou ao fim
+            bool added = n == model_n + 1 && ids[n - 1] == next_id;
+            CHECK(n == model_n || added);
+            for (uint16_t i = 0; i < model_n && i < n; i++) CHECK_EQ(ids[i], model[i]);
+            if (lost) {
+                if (added) model[model_n++] = next_id;
+                next_id++;
+            }
+        } else {
+            // Um prefixo (de até `consume_n`) dos pendentes do modelo foi entregue
+            uint16_t gone = model_n - n;
+            CHECK(n <= model_n && gone <= consume_n);
+            for (uint16_t i = 0; i < n; i++) CHECK_EQ(ids[i], model[gone + i]);
+            memmove(model, model + gone, n * sizeof(model[0]));
+            model_n = n;
+        }
+        if (host_test_failures) break;
+    }
+    fprintf(stderr, "sequência aleatória: %lu rodadas, %lu quedas de energia, %lu amostras\n", rounds, losses, (unsigned long)next_id - 1);
+}
+
+int main(void) {
+    host_test_quiet(true);              // `flash_queue_init` imprime um resumo a cada recuperação
+    test_torn_push();
+    test_torn_consume();
+    test_torn_erase();
+    test_random_power_loss();
+    host_test_quiet(false);
+    return host_test_report("test_flash_queue");
+}
@@ -0,0 +1,265 @@
+/******************************************************************************
+ * @file    test_form_decode.c
+ * @brief   Casos e fuzzing diferencial de `form_decode_field` e
+ *          `process_post_payload` (corpo do formulário do portal, ap_mode_utility.h).
+ *
+ * @note    O fuzzing compara o resultado com um decodificador de referência
+ *          escrito de outra forma (separa os campos antes e decodifica em outro
+ *          buffer). Cada corpo é alocado com o tamanho exato, para que o
+ *          AddressSanitizer acuse qualquer leitura além do NULL final.
+ ******************************************************************************/
+
+#include "host_test.h"
+#include "host_net.h"
+#include "ap_mode_utility.h"
+
+// ------------------------------ Referência ------------------------------
+
+/**
+ * @brief Resultado esperado de um corpo: credenciais aceitas ou recusa.
+ */
+typedef struct FORM_RESULT_T_ {
+    int ret;                                    // 0 se aceitas, -1 se recusadas.
+    char ssid[WIFI_SSID_MAX_LEN + 1];           // SSID decodificado (se aceito).
+    char password[WIFI_PASSWORD_MAX_LEN + 1];   // Senha decodificada (se aceita).
+} FORM_RESULT_T;
+
+static int ref_hex(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+// Decodifica `len` bytes de `in` em `out` e retorna o comprimento decodificado
+static int ref_decode(const char *in, int len, char *out) {
+    int n = 0;
+    for (int i = 0; i < len; i++) {
+        if (in[i] == '%' && i + 2 < len && ref_hex(in[i + 1]) >= 0 && ref_hex(in[i + 2]) >= 0) {
+            out[n++] = (char)(ref_hex(in[i + 1]) * 16 + ref_hex(in[i + 2]));
+            i += 2;
+        } else {
+            out[n++] = in[i] == '+' ? ' ' : in[i];
+        }
+    }
+    return n;
+}
+
+static FORM_RESULT_T ref_parse(const char *body) {
+    FORM_RESULT_T result = { .ret = -1 };
+    char id[1024], pw[1024], key[1024], value[1024];
+    int id_len = -1, pw_len = -1;
+
+    const char *field = body;
+    while (true) {
+        const char *end = strchr(field, '&');
+        int field_len = end ? (int)(end - field) : (int)strlen(field);
+        const char *eq = memchr(field, '=', field_len);
+        if (eq) {
+            int key_len = ref_decode(field, (int)(eq - field), key);
+            int value_len = ref_decode(eq + 1, field_len - (int)(eq - field) - 1, value);
+            if (key_len == 4 && memcmp(key, "ssid", 4) == 0) {
+                memcpy(id, value, value_len);
+                id_len = value_len;
+            } else if (key_len == 8 && memcmp(key, "password", 8) == 0) {
+                memcpy(pw, value, value_len);
+                pw_len = value_len;
+            }
+        }
+        if (!end) break;
+        field = end + 1;
+    }
+
+    if (id_len < 1 || id_len > WIFI_SSID_MAX_LEN || memchr(id, '\0', id_len)) return result;
+    if (pw_len < WIFI_PASSWORD_MIN_LEN || pw_len > WIFI_PASSWORD_MAX_LEN || memchr(pw, '\0', pw_len)) return result;
+    result.ret = 0;
+    memcpy(result.ssid, id, id_len);
+    result.ssid[id_len] = '\0';
+    memcpy(result.password, pw, pw_len);
+    result.password[pw_len] = '\0';
+    return result;
+}
+
+// ------------------------------ Execução ------------------------------
+
+// Executa `process_post_payload` numa cópia de tamanho exato e compara com a referência
+static int check_body(const char *body, size_t len) {
+    char *copy = malloc(len + 1);
+    memcpy(copy, body, len);
+    copy[len] = '\0';
+    FORM_RESULT_T expected = ref_parse(copy);
+
+    static const char previous_ssid[] = "anterior";
+    static const char previous_password[] = "senha-anterior";
+    strcpy(ssid, previous_ssid);
+    strcpy(password, previous_password);
+
+    int ret = process_post_payload(NULL, copy);
+    CHECK_EQ(ret, expected.ret);
+    if (ret == 0 && expected.ret == 0) {
+        CHECK(strcmp(ssid, expected.ssid) == 0);
+        CHECK(strcmp(password, expected.password) == 0);
+    } else {
+        // Recusado: as credenciais anteriores continuam valendo
+        CHECK(strcmp(ssid, previous_ssid) == 0);
+        CHECK(strcmp(password, previous_password) == 0);
+    }
+    if (ret != expected.ret) fprintf(stderr, "  corpo: \"%s\"\n", body);
+    free(copy);
+    return ret;
+}
+
+static void expect(const char *body, int ret, const char *want_ssid, const char *want_password) {
+    char *copy = strdup(body);
+    ssid[0] = password[0] = '\0';
+    CHECK_EQ(process_post_payload(NULL, copy), ret);
+    if (ret == 0) {
+        CHECK(strcmp(ssid, want_ssid) == 0);
+        CHECK(strcmp(password, want_password) == 0);
+    }
+    free(copy);
+    check_body(body, strlen(body));
+}
+
+// ------------------------------ Casos ------------------------------
+
+static void test_decode_field(void) {
+    char field[] = "a%41+b%2x%&c=d";
+    char *next;
+    int len;
+
+    CHECK_EQ(form_decode_field(field, '=', &len, &next), '&');
+    CHECK_EQ(len, 8);
+    CHECK(memcmp(field, "aA b%2x%", 8) == 0 && field[8] == '\0');
+    CHECK(next == field + 11);
+
+    char *key = next;
+    CHECK_EQ(form_decode_field(key, '=', &len, &next), '=');
+    CHECK_EQ(len, 1);
+    CHECK(strcmp(key, "c") == 0);
+
+    char *value = next;
+    CHECK_EQ(form_decode_field(value, '&', &len, &next), '\0');
+    CHECK_EQ(len, 1);
+    CHECK(strcmp(value, "d") == 0);
+
+    // Valores aceitam '=' literal; "%26" e "%3D" decodificados não separam campos
+    char tricky[] = "x=y%26z%3d";
+    CHECK_EQ(form_decode_field(tricky, '=', &len, &next), '=');
+    value = next;
+    CHECK_EQ(form_decode_field(value, '&', &len, &next), '\0');
+    CHECK(strcmp(value, "y&z=") == 0);
+
+    char empty[] = "";
+    CHECK_EQ(form_decode_field(empty, '=', &len, &next), '\0');
+    CHECK_EQ(len, 0);
+}
+
+static void test_payloads(void) {
+    static char sixty_four[] = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+    char body[256];
+
+    expect("ssid=Casa&password=12345678", 0, "Casa", "12345678");
+    expect("password=p%26ss%3Dword&ssid=My+Net%21", 0, "My Net!", "p&ss=word");
+    expect("ssid=a&password=short", -1, NULL, NULL);
+    expect("ssid=&password=12345678", -1, NULL, NULL);
+    expect("ssid=12345678901234567890123456789012&password=12345678", 0, "12345678901234567890123456789012", "12345678");
+    expect("ssid=123456789012345678901234567890123&password=12345678", -1, NULL, NULL);
+    snprintf(body, sizeof(body), "ssid=x&password=%s", sixty_four);
+    expect(body, 0, "x", sixty_four);
+    snprintf(body, sizeof(body), "ssid=x&password=%s0", sixty_four);
+    expect(body, -1, NULL, NULL);
+    expect("ssid=x%00y&password=12345678", -1, NULL, NULL);
+    expect("ssid=xy&password=1234%005678", -1, NULL, NULL);
+    expect("junk&ssid&password=&ssid=ok&password=abcdefgh&x=1", 0, "ok", "abcdefgh");
+    expect("ssid=first&ssid=second&password=abcdefgh", 0, "second", "abcdefgh");
+    expect("ssid=%zz%4&password=abcdefgh%", 0, "%zz%4", "abcdefgh%");
+    expect("ssid=a=b&password=abc=defg", 0, "a=b", "abc=defg");
+    expect("SSID=a&password=abcdefgh", -1, NULL, NULL);
+    expect("%73sid=enc&pass%77ord=abcdefgh", 0, "enc", "abcdefgh");
+    expect("ssid=a&password=abcdefgh&", 0, "a", "abcdefgh");
+    expect("&&ssid=a&&password=abcdefgh&&", 0, "a", "abcdefgh");
+    expect("", -1, NULL, NULL);
+    expect("&", -1, NULL, NULL);
+    expect("=", -1, NULL, NULL);
+    expect("ssid=%", -1, NULL, NULL);
+
+    CHECK_EQ(process_post_payload(NULL, NULL), -1);
+}
+
+// ------------------------------ Fuzzing ------------------------------
+
+// Valor com caracteres ou bytes codificados de várias formas (nem sempre válidas)
+static int fuzz_value(char *out, int max) {
+    static const char plain[] = "abcXYZ019 !*-._~";
+    int len = 0, count = host_test_rand() % 80;
+    for (int i = 0; i < count && len + 3 < max; i++) {
+        uint32_t r = host_test_rand();
+        switch (r % 8) {
+        case 0:
+            len += sprintf(out + len, "%%%02X", (r >> 8) & 0xFF);
+            break;
+        case 1:
+            len += sprintf(out + len, "%%%02x", (r >> 8) & 0xFF);
+            break;
+        case 2:
+            out[len++] = "+%&="[(r >> 8) % 4];
+            break;
+        case 3:
+            out[len++] = '%';
+            out[len++] = "0aG%"[(r >> 8) % 4];
+            break;
+        default:
+            out[len++] = plain[(r >> 8) % (sizeof(plain) - 1)];
+            break;
+        }
+    }
+    return len;
+}
+
+// Corpo estruturado: campos conhecidos e desconhecidos com valores de comprimentos variados
+static size_t fuzz_structured(char *body, size_t max) {
+    static const char *const keys[] = { "ssid", "password", "x", "", "ssid2", "pass%77ord", "%73sid", "SSID" };
+    size_t len = 0;
+    int fields = 1 + host_test_rand() % 5;
+    for (int i = 0; i < fields && len + 120 < max; i++) {
+        if (i) body[len++] = '&';
+        const char *key = keys[host_test_rand() % (sizeof(keys) / sizeof(keys[0]))];
+        len += sprintf(body + len, "%s", key);
+        if (host_test_rand() % 8) body[len++] = '=';
+        len += fuzz_value(body + len, (int)(max - len - 1));
+    }
+    return len;
+}
+
+// Corpo com bytes arbitrários, concentrados nos delimitadores
+static size_t fuzz_bytes(char *body, size_t max) {
+    static const char alphabet[] = "%&=+sidpaworx0123456789abcdefABCDEF\x01\x7f\x80\xff";
+    size_t len = host_test_rand() % 64 ? host_test_rand() % 160 : host_test_rand() % max;
+    for (size_t i = 0; i < len; i++) {
+        uint32_t r = host_test_rand();
+        body[i] = (r & 3) == 0 ? "ssid=password="[(r >> 2) % 14] : alphabet[(r >> 2) % (sizeof(alphabet) - 1)];
+        if (body[i] == '\0') body[i] = 'z';
+    }
+    return len;
+}
+
+static void test_fuzz(void) {
+    unsigned long rounds = host_test_iterations(200000);
+    unsigned long accepted = 0;
+    char body[TCP_REQUEST_BUF_SIZE];
+
+    for (unsigned long i = 0; i < rounds; i++) {
+        size_t len = (i & 1) ? fuzz_structured(body, sizeof(body)) : fuzz_bytes(body, sizeof(body));
+        body[len] = '\0';
+        accepted += check_body(body, len) == 0;
+    }
+    fprintf(stderr, "fuzzing: %lu corpos, %lu com credenciais aceitas\n", rounds, accepted);
+    CHECK(accepted > 0);
+}
+
+int main(void) {
+    test_decode_field();
+    test_payloads();
+    test_fuzz();
+    return host_test_report("test_form_decode");
+}
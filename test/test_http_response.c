@@ -0,0 +1,287 @@
+/******************************************************************************
+ * @file    test_http_response.c
+ * @brief   Corpus e fuzzing do analisador incremental de respostas HTTP
+ *          (`http_response_feed`, http_response.h).
+ *
+ * @note    O analisador recebe cada pbuf da cadeia como um trecho: o resultado
+ *          não pode depender de onde a resposta foi dividida. Cada resposta do
+ *          corpus é verificada inteira, em todos os pontos de divisão, byte a
+ *          byte e em divisões aleatórias; o fuzzing faz o mesmo com mutações do
+ *          corpus e bytes arbitrários, sob AddressSanitizer e UBSan.
+ ******************************************************************************/
+
+#include "host_test.h"
+#include <assert.h>
+#include "http_response.h"
+
+// ------------------------------ Resultado ------------------------------
+
+/**
+ * @brief O que o cliente HTTP usa de uma resposta analisada.
+ */
+typedef struct OUTCOME_T_ {
+    HTTP_RESPONSE_STATE_T state;  // Estado final (após `http_response_finish`, se pedido).
+    uint16_t status;              // Código de status.
+    uint32_t consumed;            // Bytes consumidos por `http_response_feed`.
+    uint32_t body_len;            // Bytes de corpo recebidos.
+    uint32_t retry_after_s;       // `Retry-After`.
+    bool ok;                      // `http_response_ok`.
+    bool rate_limited;            // `http_response_rate_limited`.
+    bool has_entry;               // `http_response_entry_id` retornou true.
+    uint32_t entry_id;            // Número da entrada, se houver.
+} OUTCOME_T;
+
+// Alimenta o analisador em trechos com os comprimentos de `splits` (0 encerra; o resto vai inteiro)
+static OUTCOME_T feed(const char *data, size_t len, const uint16_t *splits, bool finish) {
+    HTTP_RESPONSE_T response;
+    OUTCOME_T outcome = { 0 };
+    http_response_init(&response);
+
+    size_t offset = 0;
+    while (offset < len) {
+        size_t part = (splits && *splits) ? *splits++ : len - offset;
+        if (part > len - offset) part = len - offset;
+
+        // Cada trecho num buffer próprio de tamanho exato, como o payload de um pbuf
+        char *chunk = malloc(part);
+        memcpy(chunk, data + offset, part);
+        uint16_t used = http_response_feed(&response, chunk, (uint16_t)part);
+        free(chunk);
+
+        CHECK(used <= part);
+        CHECK(response.line_len <= HTTP_RESPONSE_LINE_SIZE);
+        CHECK(response.body_stored <= HTTP_RESPONSE_BODY_SIZE);
+        CHECK(response.body_stored <= response.body_len);
+        outcome.consumed += used;
+        offset += part;
+        if (used < part) {
+            // Terminou (ou é inválida): o restante não é mais aceito
+            CHECK(response.state == HTTP_RESPONSE_DONE || response.state == HTTP_RESPONSE_ERROR);
+            CHECK_EQ(http_response_feed(&response, data + offset - part + used, 1), 0);
+            break;
+        }
+    }
+
+    if (finish) http_response_finish(&response);
+    outcome.state = response.state;
+    outcome.status = response.status;
+    outcome.body_len = response.body_len;
+    outcome.retry_after_s = response.retry_after_s;
+    outcome.ok = http_response_ok(&response);
+    outcome.rate_limited = http_response_rate_limited(&response);
+    outcome.has_entry = http_response_entry_id(&response, &outcome.entry_id);
+    if (!outcome.has_entry) outcome.entry_id = 0;
+
+    // Uma resposta aceita é sempre completa e 2xx
+    if (outcome.ok) CHECK(outcome.state == HTTP_RESPONSE_DONE && outcome.status >= 200 && outcome.status <= 299);
+    return outcome;
+}
+
+static bool same_outcome(const OUTCOME_T *a, const OUTCOME_T *b) {
+    return a->state == b->state && a->status == b->status && a->consumed == b->consumed &&
+           a->body_len == b->body_len && a->retry_after_s == b->retry_after_s && a->ok == b->ok &&
+           a->rate_limited == b->rate_limited && a->has_entry == b->has_entry && a->entry_id == b->entry_id;
+}
+
+#define SPLITS_MAX 512                  // Maior resposta verificada (bytes).
+
+// Verifica que todas as formas de dividir a resposta dão o mesmo resultado da resposta inteira
+static OUTCOME_T check_splits(const char *data, size_t len, bool finish, bool exhaustive) {
+    OUTCOME_T whole = feed(data, len, NULL, finish);
+    uint16_t splits[SPLITS_MAX + 1];
+    assert(len <= SPLITS_MAX);
+
+    // Byte a byte
+    for (size_t i = 0; i < len; i++) splits[i] = 1;
+    splits[len] = 0;
+    OUTCOME_T bytes = feed(data, len, splits, finish);
+    CHECK(same_outcome(&whole, &bytes));
+
+    // Em dois trechos, em todos os pontos
+    if (exhaustive) {
+        for (size_t cut = 1; cut < len; cut++) {
+            splits[0] = (uint16_t)cut;
+            splits[1] = 0;
+            OUTCOME_T two = feed(data, len, splits, finish);
+            CHECK(same_outcome(&whole, &two));
+        }
+    }
+
+    // Em trechos aleatórios, curtos ou longos
+    for (int round = 0; round < (exhaustive ? 32 : 2); round++) {
+        uint32_t max = (host_test_rand() & 1) ? 8 : 64;
+        int count = 0;
+        for (size_t covered = 0; covered < len; count++) {
+            splits[count] = (uint16_t)(1 + host_test_rand() % max);
+            covered += splits[count];
+        }
+        splits[count] = 0;
+        OUTCOME_T random = feed(data, len, splits, finish);
+        if (!same_outcome(&whole, &random)) fprintf(stderr, "  divisão aleatória diverge: \"%.*s\"\n", (int)len, data);
+        CHECK(same_outcome(&whole, &random));
+    }
+    return whole;
+}
+
+// ------------------------------ Corpus ------------------------------
+
+/**
+ * @brief Resposta do corpus e o resultado esperado.
+ */
+typedef struct CORPUS_T_ {
+    const char *text;             // Resposta (como recebida do servidor).
+    bool finish;                  // O servidor fecha a conexão ao fim do texto.
+    HTTP_RESPONSE_STATE_T state;  // Estado final esperado.
+    uint16_t status;              // Status esperado.
+    bool ok;                      // `http_response_ok` esperado.
+    bool rate_limited;            // `http_response_rate_limited` esperado.
+    int64_t entry_id;             // Número da entrada esperado, ou -1.
+    uint32_t retry_after_s;       // `Retry-After` esperado.
+} CORPUS_T;
+
+#define LONG_HEADER "X-Long: " \
+    "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789"
+
+static const CORPUS_T corpus[] = {
+    // ThingSpeak: update simples (número da entrada) e bulk update (JSON)
+    { "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 3\r\nConnection: close\r\n\r\n123",
+      false, HTTP_RESPONSE_DONE, 200, true, false, 123, 0 },
+    { "HTTP/1.1 202 Accepted\r\ncontent-length: 16\r\n\r\n{\"success\":true}",
+      false, HTTP_RESPONSE_DONE, 202, true, false, -1, 0 },
+    { "HTTP/1.1 200 OK\r\nContent-Length: 17\r\n\r\n{\"success\":false}",
+      false, HTTP_RESPONSE_DONE, 200, false, false, -1, 0 },
+    // Limite de taxa: "0" no update simples, 429 no bulk
+    { "HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\n0",
+      false, HTTP_RESPONSE_DONE, 200, false, true, 0, 0 },
+    { "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 15\r\nContent-Length: 0\r\n\r\n",
+      false, HTTP_RESPONSE_DONE, 429, false, true, -1, 15 },
+    { "HTTP/1.1 503 Service Unavailable\r\nretry-after:  120 \r\nContent-Length: 5\r\n\r\nbusy\n",
+      false, HTTP_RESPONSE_DONE, 503, false, false, -1, 120 },
+    // Chunked, com extensões, trailers e resposta 1xx antes
+    { "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n45\r\n1;ext=1\r\n6\r\n0\r\n\r\n",
+      false, HTTP_RESPONSE_DONE, 200, true, false, 456, 0 },
+    { "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\n\r\n3\r\n789\r\n0\r\nX-Trailer: y\r\n\r\n",
+      false, HTTP_RESPONSE_DONE, 200, true, false, 789, 0 },
+    { "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1A\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\n\r\n",
+      false, HTTP_RESPONSE_DONE, 200, true, false, -1, 0 },
+    // Corpo até o fechamento (HTTP/1.0) e respostas sem corpo
+    { "HTTP/1.0 200 OK\r\n\r\n99\r\n", true, HTTP_RESPONSE_DONE, 200, true, false, 99, 0 },
+    { "HTTP/1.1 204 No Content\r\n\r\n", false, HTTP_RESPONSE_DONE, 204, true, false, -1, 0 },
+    { "HTTP/1.1 304 Not Modified\r\nContent-Length: 10\r\n\r\n", false, HTTP_RESPONSE_DONE, 304, false, false, -1, 0 },
+    // Linhas longas são truncadas sem afetar os cabeçalhos seguintes; LF sem CR é aceito
+    { "HTTP/1.1 200 OK\r\n" LONG_HEADER "\r\nContent-Length: 2\r\n\r\n42",
+      false, HTTP_RESPONSE_DONE, 200, true, false, 42, 0 },
+    { "HTTP/1.1 200 OK\nContent-Length: 2\n\n42", false, HTTP_RESPONSE_DONE, 200, true, false, 42, 0 },
+    // Dados além do fim da resposta não são consumidos
+    { "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n42HTTP/1.1 500 X\r\n\r\n",
+      false, HTTP_RESPONSE_DONE, 200, true, false, 42, 0 },
+    // Truncadas e malformadas
+    { "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n12345", true, HTTP_RESPONSE_ERROR, 200, false, false, -1, 0 },
+    { "HTTP/1.1 200 OK\r\nContent-Le", true, HTTP_RESPONSE_ERROR, 200, false, false, -1, 0 },
+    { "HTTP/2 200 OK\r\n\r\n", false, HTTP_RESPONSE_ERROR, 0, false, false, -1, 0 },
+    { "HTTP/1.1 x00 OK\r\n\r\n", false, HTTP_RESPONSE_ERROR, 0, false, false, -1, 0 },
+    { "<html>oops</html>\n", false, HTTP_RESPONSE_ERROR, 0, false, false, -1, 0 },
+    { "HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n", false, HTTP_RESPONSE_ERROR, 200, false, false, -1, 0 },
+    { "HTTP/1.1 200 OK\r\nContent-Length: 1234567890\r\n\r\n", false, HTTP_RESPONSE_ERROR, 200, false, false, -1, 0 },
+    { "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n10000000\r\n", false, HTTP_RESPONSE_ERROR, 200, false, false, -1, 0 },
+    { "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n45XX\r\n", false, HTTP_RESPONSE_ERROR, 200, false, false, -1, 0 },
+    { "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", false, HTTP_RESPONSE_ERROR, 200, false, false, -1, 0 },
+};
+
+#define CORPUS_COUNT (sizeof(corpus) / sizeof(corpus[0]))
+
+static void test_corpus(void) {
+    for (size_t i = 0; i < CORPUS_COUNT; i++) {
+        const CORPUS_T *c = &corpus[i];
+        OUTCOME_T outcome = check_splits(c->text, strlen(c->text), c->finish, true);
+
+        size_t failures = host_test_failures;
+        CHECK_EQ(outcome.state, c->state);
+        CHECK_EQ(outcome.status, c->status);
+        CHECK_EQ(outcome.ok, c->ok);
+        CHECK_EQ(outcome.rate_limited, c->rate_limited);
+        if (c->state == HTTP_RESPONSE_DONE) CHECK_EQ(outcome.has_entry ? (int64_t)outcome.entry_id : -1, c->entry_id);
+        CHECK_EQ(outcome.retry_after_s, c->retry_after_s);
+        if (host_test_failures != failures) fprintf(stderr, "  corpus[%zu]\n", i);
+    }
+
+    // Resposta que termina exatamente no fim de um trecho: o próximo `feed` não consome nada
+    const char *text = corpus[0].text;
+    HTTP_RESPONSE_T response;
+    http_response_init(&response);
+    CHECK_EQ(http_response_feed(&response, text, (uint16_t)strlen(text)), strlen(text));
+    CHECK_EQ(response.state, HTTP_RESPONSE_DONE);
+    CHECK_EQ(http_response_feed(&response, "x", 1), 0);
+}
+
+// ------------------------------ Fuzzing ------------------------------
+
+// Aplica de 1 a 4 mutações (troca, inserção, remoção ou cópia de um trecho) a uma resposta do corpus
+static size_t mutate(char *out, size_t max) {
+    static const char tokens[] = "\r\n:; 0123456789abcdefABCDEF-HTTP/1.chunked";
+    const char *base = corpus[host_test_rand() % CORPUS_COUNT].text;
+    size_t len = strlen(base);
+    memcpy(out, base, len);
+
+    int mutations = 1 + host_test_rand() % 4;
+    for (int m = 0; m < mutations && len > 0; m++) {
+        size_t at = host_test_rand() % len;
+        uint32_t r = host_test_rand();
+        char c = (r & 0x100) ? (char)(r >> 16) : tokens[(r >> 16) % (sizeof(tokens) - 1)];
+        switch (r % 4) {
+        case 0:
+            out[at] = c;
+            break;
+        case 1:
+            if (len + 1 < max) {
+                memmove(out + at + 1, out + at, len - at);
+                out[at] = c;
+                len++;
+            }
+            break;
+        case 2:
+            memmove(out + at, out + at + 1, len - at - 1);
+            len--;
+            break;
+        default: {
+            size_t span = 1 + (r >> 8) % 16;
+            if (at + span > len) span = len - at;
+            if (len + span < max) {
+                memmove(out + at + span, out + at, len - at);
+                len += span;
+            }
+            break;
+        }
+        }
+    }
+    return len;
+}
+
+static void test_fuzz(void) {
+    unsigned long rounds = host_test_iterations(100000);
+    unsigned long done = 0;
+    char buf[512];
+
+    for (unsigned long i = 0; i < rounds; i++) {
+        size_t len;
+        if (i % 4 == 3) {
+            // Bytes arbitrários atrás de uma linha de status válida (ou não)
+            len = host_test_rand() % sizeof(buf);
+            for (size_t j = 0; j < len; j++) buf[j] = (char)host_test_rand();
+            if (host_test_rand() & 1) memcpy(buf, "HTTP/1.1 200 OK\r\n", len < 17 ? len : 17);
+        } else {
+            len = mutate(buf, sizeof(buf));
+        }
+        if (len == 0) continue;
+        OUTCOME_T outcome = check_splits(buf, len, host_test_rand() & 1, false);
+        done += outcome.state == HTTP_RESPONSE_DONE;
+    }
+    fprintf(stderr, "fuzzing: %lu respostas, %lu completas\n", rounds, done);
+    CHECK(done > 0);
+}
+
+int main(void) {
+    test_corpus();
+    test_fuzz();
+    return host_test_report("test_http_response");
+}
@@ -0,0 +1,1833 @@
+/******************************************************************************
+ * @file    test_http_server.c
+ * @brief   Teste do servidor HTTP do portal (ap_mode_utility.h) com requisições
+ *          divididas em segmentos TCP como as de navegadores de Android, iOS e
+ *          computadores.
+ *
+ * @note    O teste faz o papel dos clientes sobre a pilha simulada (host_net):
+ *          cada requisição do corpus é entregue com a divisão típica do seu
+ *          cliente, com as demais divisões conhecidas, com um corte em cada
+ *          posição e com cortes aleatórios, e cada segmento ainda chega em uma
+ *          cadeia de pbufs. Nenhuma resposta pode sair antes do último byte
+ *          (nas sondagens de portal cativo, antes do fim da linha de requisição), e a
+ *          resposta é conferida byte a byte (cabeçalhos, linha `Connection` e
+ *          corpo), assim como as credenciais extraídas do formulário. As
+ *          páginas estáticas saem em vários trechos que apontam para os dados da
+ *          própria página, sem cópia. O gzip de cada página é conferido pelo
+ *          CRC-32 e pelo comprimento do conteúdo sem compressão, assim como a
+ *          escolha entre gzip, sem compressão e 304. A busca binária na
+ *          tabela de rotas é conferida contra uma varredura linear nos modos AP
+ *          e STA, assim como cada sondagem de portal cativo da tabela.
+ *
+ * @note    Os cenários em paralelo abrem mais conexões que os slots do servidor:
+ *          rajadas de sondagens do Android, páginas do portal em envio lento e
+ *          um teste de carga com clientes que conectam, enviam, confirmam e
+ *          desistem em ordem aleatória, conferindo quem cede o slot, quem recebe
+ *          503 e quando cada conexão fecha por inatividade.
+ *
+ * @note    As conexões persistentes são conferidas com pipeline (inclusive com
+ *          o buffer cheio), limite de requisições e versões do HTTP, e um
+ *          carregamento do portal conta as idas e voltas pela rede com e sem
+ *          keep-alive e com pipeline.
+ *
+ * @note    As amostras ao vivo são conferidas em `/api/telemetry` e nos
+ *          assinantes de `/events`: limite de assinantes, amostras perdidas por
+ *          quem ainda não confirmou a anterior e eventos vazios na inatividade.
+ *
+ * @note    O WebSocket é conferido de ponta a ponta: o aceite do handshake, os
+ *          comandos do cliente (inclusive cortados byte a byte), quadros não
+ *          suportados, ping e fechamento. Os clientes do espelho reconstroem o
+ *          display a partir dos quadros completos e dos trechos recebidos, e a
+ *          cópia deve ser igual ao display após cada quadro confirmado.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "host_text.h"
+#include "host_net.h"
+#include "ap_mode_utility.h"
+
+// ------------------------------ Servidor ------------------------------
+
+static TCP_SERVER_T server;             // Estado do servidor em teste.
+static struct tcp_pcb *listener;        // PCB de escuta criado por `tcp_server_open`.
+
+static void server_open(void) {
+    host_net_reset();
+    memset(&server, 0, sizeof(server));
+    CHECK(tcp_server_open(&server));
+    listener = host_tcp_listener(TCP_PORT);
+    CHECK(listener != NULL);
+}
+
+// Fecha o servidor e libera os PCBs simulados (todas as conexões já devem ter terminado)
+static void server_close(void) {
+    CHECK_EQ(tcp_connect_pool.in_use, 0);
+    tcp_server_close(&server);
+    CHECK_EQ(tcp_connect_pool.in_use, 0);
+    host_net_reset();
+}
+
+// ------------------------------ Cliente ------------------------------
+
+/**
+ * @brief Conexão do lado do cliente: o PCB aceito pelo servidor e os bytes recebidos.
+ */
+typedef struct CLIENT_T_ {
+    struct tcp_pcb *pcb;          // Conexão aceita pelo servidor.
+    char in[16384];               // Bytes recebidos e ainda não interpretados.
+    size_t in_len;                // Bytes em `in`.
+} CLIENT_T;
+
+/**
+ * @brief Resposta lida pelo cliente.
+ */
+typedef struct RESPONSE_T_ {
+    int status;                   // Código de status.
+    char headers[512];            // Linha de status e cabeçalhos, até a linha vazia (terminados em NUL).
+    size_t headers_len;           // Comprimento de `headers`.
+    uint8_t body[4096];           // Corpo (`Content-Length` bytes).
+    size_t body_len;              // Comprimento do corpo.
+} RESPONSE_T;
+
+static bool client_connect(CLIENT_T *client) {
+    client->pcb = host_tcp_accept(listener);
+    client->in_len = 0;
+    return client->pcb != NULL;
+}
+
+// Confirma tudo o que o servidor enviou (o que libera o restante da resposta) e guarda os bytes
+static void client_pump(CLIENT_T *client) {
+    struct tcp_pcb *pcb = client->pcb;
+    while (pcb->unacked && !pcb->aborted) host_tcp_ack_all(pcb);
+    client->in_len += host_tcp_read(pcb, client->in + client->in_len, sizeof(client->in) - client->in_len);
+}
+
+/**
+ * @brief Retira de `client->in` a primeira resposta, se ela já chegou inteira.
+ *
+ * @return true se havia uma resposta completa, false caso contrário.
+ */
+static bool client_parse(CLIENT_T *client, RESPONSE_T *response) {
+    const char *end = find(client->in, client->in + client->in_len, "\r\n\r\n");
+    if (!end) return false;
+
+    size_t headers_len = end + 4 - client->in, value_len;
+    const char *value = header_value(client->in, end + 2, "Content-Length", &value_len);
+    size_t body_len = value ? strtoul(value, NULL, 10) : 0;
+    if (headers_len + body_len > client->in_len) return false;
+    assert(headers_len < sizeof(response->headers) && body_len <= sizeof(response->body));
+
+    memcpy(response->headers, client->in, headers_len);
+    response->headers[headers_len] = '\0';
+    response->headers_len = headers_len;
+    response->status = strncmp(client->in, "HTTP/1.1 ", 9) == 0 ? atoi(client->in + 9) : -1;
+    memcpy(response->body, client->in + headers_len, body_len);
+    response->body_len = body_len;
+
+    client->in_len -= headers_len + body_len;
+    memmove(client->in, client->in + headers_len + body_len, client->in_len);
+    return true;
+}
+
+/**
+ * @brief Confirma tudo o que o servidor enviou e lê a próxima resposta completa.
+ */
+static bool client_response(CLIENT_T *client, RESPONSE_T *response) {
+    client_pump(client);
+    return client_parse(client, response);
+}
+
+/**
+ * @brief Confere uma resposta contra a página estática esperada, byte a byte.
+ *
+ * @param keep_alive Se a resposta deve manter a conexão aberta (linha `Connection`).
+ */
+static void check_response(const RESPONSE_T *response, const STATIC_PAGE_T *page, bool keep_alive) {
+    const char *connection = keep_alive ? HTTP_CONNECTION_KEEP_ALIVE : HTTP_CONNECTION_CLOSE;
+    CHECK_EQ(response->headers_len, page->header_len + strlen(connection));
+    CHECK(memcmp(response->headers, page->header, page->header_len) == 0);
+    CHECK(strcmp(response->headers + page->header_len, connection) == 0);
+    CHECK_EQ(response->body_len, page->body_len);
+    CHECK(page->body_len == 0 || memcmp(response->body, page->body, page->body_len) == 0);
+}
+
+// ------------------------------ Corpus ------------------------------
+
+/**
+ * @brief Forma como um cliente divide a requisição em segmentos TCP.
+ */
+typedef enum {
+    SPLIT_WHOLE,                  // Um segmento: Chrome (Android e computador) junta cabeçalhos e corpo pequeno.
+    SPLIT_HEADERS,                // Cabeçalhos e corpo em segmentos separados: Safari (iOS e macOS) e Firefox.
+    SPLIT_MSS,                    // Segmentos de 536 bytes: MSS padrão, sem opção de MSS ou com MTU reduzida.
+    SPLIT_MARKER,                 // Corte no meio do "\r\n\r\n" e no meio do corpo.
+    SPLIT_BYTES,                  // Um byte por segmento.
+    SPLIT_COUNT
+} SPLIT_T;
+
+/**
+ * @brief Requisição do corpus e o resultado esperado.
+ */
+typedef struct CAPTURE_T_ {
+    const char *client;           // Cliente que envia a requisição.
+    const char *head;             // Linha de requisição e cabeçalhos ("%u" recebe o Content-Length do corpo).
+    const char *body;             // Corpo do formulário, ou NULL.
+    SPLIT_T split;                // Divisão usada pelo cliente.
+    const STATIC_PAGE_T *response; // Resposta esperada.
+    bool keep_alive;              // A conexão continua aberta após a resposta.
+    const char *ssid;             // SSID extraído (POST aceito), ou NULL.
+    const char *password;         // Senha extraída (POST aceito), ou NULL.
+} CAPTURE_T;
+
+#define ACCEPT_HTML "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+#define FORM_TYPE "Content-Type: application/x-www-form-urlencoded\r\n"
+
+static const CAPTURE_T captures[] = {
+    { "Chrome no Android",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: keep-alive\r\nContent-Length: %u\r\n"
+      "Cache-Control: max-age=0\r\nUpgrade-Insecure-Requests: 1\r\nOrigin: http://192.168.4.1\r\n" FORM_TYPE
+      "User-Agent: Mozilla/5.0 (Linux; Android 14; Pixel 7) AppleWebKit/537.36 (KHTML, like Gecko) "
+      "Chrome/126.0.0.0 Mobile Safari/537.36\r\n"
+      "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8\r\n"
+      "Referer: http://192.168.4.1/config\r\nAccept-Encoding: gzip, deflate\r\n"
+      "Accept-Language: pt-BR,pt;q=0.9,en-US;q=0.8,en;q=0.7\r\n\r\n",
+      "ssid=Casa+da+Praia&password=senha%40forte%21", SPLIT_WHOLE,
+      &success_page.gzip, false, "Casa da Praia", "senha@forte!" },
+    { "Portal cativo do Android (WebView)",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: keep-alive\r\nContent-Length: %u\r\n"
+      "Cache-Control: max-age=0\r\nOrigin: http://192.168.4.1\r\n" FORM_TYPE
+      "User-Agent: Mozilla/5.0 (Linux; Android 13; SM-A536B Build/TP1A.220624.014; wv) AppleWebKit/537.36 "
+      "(KHTML, like Gecko) Version/4.0 Chrome/125.0.6422.165 Mobile Safari/537.36\r\n" ACCEPT_HTML
+      "Referer: http://192.168.4.1/config\r\nAccept-Encoding: gzip, deflate\r\n"
+      "Accept-Language: pt-BR,pt;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+      "X-Requested-With: com.google.android.captiveportallogin\r\n\r\n",
+      "ssid=Rede_2.4G&password=0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef", SPLIT_MSS,
+      &success_page.gzip, false, "Rede_2.4G", "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef" },
+    { "Safari no iOS",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\n" FORM_TYPE "Origin: http://192.168.4.1\r\n"
+      "Accept-Encoding: gzip, deflate\r\nConnection: keep-alive\r\n" ACCEPT_HTML
+      "User-Agent: Mozilla/5.0 (iPhone; CPU iPhone OS 17_5 like Mac OS X) AppleWebKit/605.1.15 "
+      "(KHTML, like Gecko) Version/17.5 Mobile/15E148 Safari/604.1\r\n"
+      "Referer: http://192.168.4.1/config\r\nContent-Length: %u\r\nAccept-Language: pt-BR,pt;q=0.9\r\n\r\n",
+      "ssid=iPhone+de+Ana&password=ma%C3%A7%C3%A3+verde", SPLIT_HEADERS,
+      &success_page.gzip, false, "iPhone de Ana", "ma\xC3\xA7\xC3\xA3 verde" },
+    { "Safari no iOS (senha curta)",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\n" FORM_TYPE "Origin: http://192.168.4.1\r\n"
+      "Accept-Encoding: gzip, deflate\r\nConnection: keep-alive\r\n" ACCEPT_HTML
+      "User-Agent: Mozilla/5.0 (iPhone; CPU iPhone OS 16_7 like Mac OS X) AppleWebKit/605.1.15 "
+      "(KHTML, like Gecko) Version/16.6 Mobile/15E148 Safari/604.1\r\n"
+      "Referer: http://192.168.4.1/config\r\nContent-Length: %u\r\nAccept-Language: pt-BR,pt;q=0.9\r\n\r\n",
+      "ssid=Casa&password=curta", SPLIT_HEADERS,
+      &failure_page.gzip, true, NULL, NULL },
+    { "Safari no macOS",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\n" FORM_TYPE "Origin: http://192.168.4.1\r\n"
+      "Accept-Encoding: gzip, deflate\r\nConnection: keep-alive\r\n" ACCEPT_HTML
+      "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/605.1.15 "
+      "(KHTML, like Gecko) Version/17.5 Safari/605.1.15\r\n"
+      "Referer: http://192.168.4.1/config\r\nContent-Length: %u\r\nAccept-Language: pt-BR,pt;q=0.9\r\n\r\n",
+      "ssid=Escrit%C3%B3rio&password=p%26ss%3Dword", SPLIT_HEADERS,
+      &success_page.gzip, false, "Escrit\xC3\xB3rio", "p&ss=word" },
+    { "Firefox no Windows",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\n"
+      "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:127.0) Gecko/20100101 Firefox/127.0\r\n"
+      ACCEPT_HTML "Accept-Language: pt-BR,pt;q=0.8,en-US;q=0.5,en;q=0.3\r\nAccept-Encoding: gzip, deflate\r\n"
+      FORM_TYPE "Content-Length: %u\r\nOrigin: http://192.168.4.1\r\nConnection: keep-alive\r\n"
+      "Referer: http://192.168.4.1/config\r\nUpgrade-Insecure-Requests: 1\r\nPriority: u=0, i\r\n\r\n",
+      "ssid=Lab+IoT&password=12345678", SPLIT_HEADERS,
+      &success_page.gzip, false, "Lab IoT", "12345678" },
+    { "Edge no Windows",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: keep-alive\r\nContent-Length: %u\r\n"
+      "Cache-Control: max-age=0\r\nUpgrade-Insecure-Requests: 1\r\nOrigin: http://192.168.4.1\r\n" FORM_TYPE
+      "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) "
+      "Chrome/126.0.0.0 Safari/537.36 Edg/126.0.0.0\r\n" ACCEPT_HTML
+      "Referer: http://192.168.4.1/config\r\nAccept-Encoding: gzip, deflate\r\n"
+      "Accept-Language: pt-BR,pt;q=0.9,en;q=0.8,en-GB;q=0.7,en-US;q=0.6\r\n\r\n",
+      "password=senha+com+espa%C3%A7os&ssid=Sala", SPLIT_WHOLE,
+      &success_page.gzip, false, "Sala", "senha com espa\xC3\xA7os" },
+    { "curl",
+      "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\nUser-Agent: curl/8.5.0\r\nAccept: */*\r\n"
+      "content-length: %u\r\ncontent-type: application/x-www-form-urlencoded\r\n\r\n",
+      "ssid=teste&password=abcdefgh", SPLIT_WHOLE,
+      &success_page.plain, false, "teste", "abcdefgh" },
+    { "Sondagem do iOS",
+      "GET /hotspot-detect.html HTTP/1.0\r\nHost: captive.apple.com\r\nConnection: close\r\n"
+      "User-Agent: CaptiveNetworkSupport-481.100.2 wispr\r\n\r\n",
+      NULL, SPLIT_WHOLE, &apple_probe_page, false, NULL, NULL },
+    { "Sondagem do Android",
+      "GET /generate_204 HTTP/1.1\r\n"
+      "User-Agent: Dalvik/2.1.0 (Linux; U; Android 14; Pixel 7 Build/UQ1A.240205.004)\r\n"
+      "Host: connectivitycheck.gstatic.com\r\nConnection: Keep-Alive\r\nAccept-Encoding: gzip\r\n\r\n",
+      NULL, SPLIT_WHOLE, &redirect_page, false, NULL, NULL },
+    { "Safari no iOS (página de configuração)",
+      "GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\nUpgrade-Insecure-Requests: 1\r\n" ACCEPT_HTML
+      "User-Agent: Mozilla/5.0 (iPhone; CPU iPhone OS 17_5 like Mac OS X) AppleWebKit/605.1.15 "
+      "(KHTML, like Gecko) Version/17.5 Mobile/15E148 Safari/604.1\r\n"
+      "Accept-Language: pt-BR,pt;q=0.9\r\nAccept-Encoding: gzip, deflate\r\nConnection: keep-alive\r\n\r\n",
+      NULL, SPLIT_WHOLE, &config_page.gzip, true, NULL, NULL },
+    { "Chrome no Android (favicon)",
+      "GET /favicon.ico HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: keep-alive\r\n"
+      "User-Agent: Mozilla/5.0 (Linux; Android 14; Pixel 7) AppleWebKit/537.36 (KHTML, like Gecko) "
+      "Chrome/126.0.0.0 Mobile Safari/537.36\r\n"
+      "Accept: image/avif,image/webp,image/apng,image/svg+xml,image/*,*/*;q=0.8\r\n"
+      "Referer: http://192.168.4.1/config\r\nAccept-Encoding: gzip, deflate\r\n"
+      "Accept-Language: pt-BR,pt;q=0.9,en-US;q=0.8,en;q=0.7\r\n\r\n",
+      NULL, SPLIT_WHOLE, &redirect_page, true, NULL, NULL },
+};
+
+#define CAPTURE_COUNT (sizeof(captures) / sizeof(captures[0]))
+
+// Monta a requisição completa; retorna o comprimento e, em `body_offset`, o início do corpo
+static size_t build_request(const CAPTURE_T *capture, char *out, size_t max, size_t *body_offset) {
+    const char *body = capture->body ? capture->body : "";
+    int head_len = snprintf(out, max, capture->head, (unsigned)strlen(body));
+    assert(head_len > 0 && (size_t)head_len + strlen(body) < max);
+    strcpy(out + head_len, body);
+    if (body_offset) *body_offset = head_len;
+    return head_len + strlen(body);
+}
+
+// Posições de corte de uma divisão (em ordem crescente, sem 0 nem `len`)
+static int split_cuts(SPLIT_T split, const char *request, size_t len, size_t body_offset, size_t *cuts) {
+    int count = 0;
+    switch (split) {
+    case SPLIT_WHOLE:
+        break;
+    case SPLIT_HEADERS:
+        if (body_offset < len) cuts[count++] = body_offset;
+        break;
+    case SPLIT_MSS:
+        for (size_t offset = 536; offset < len; offset += 536) cuts[count++] = offset;
+        break;
+    case SPLIT_MARKER:
+        cuts[count++] = body_offset - 2;
+        if (len - body_offset > 1) cuts[count++] = body_offset + (len - body_offset) / 2;
+        break;
+    default:
+        for (size_t offset = 1; offset < len; offset++) cuts[count++] = offset;
+        break;
+    }
+    return count;
+}
+
+// Bytes que o servidor precisa receber para responder: a linha de requisição nas sondagens, senão a requisição inteira
+static size_t answer_at(const char *request, size_t len) {
+    const char *eol = memchr(request, '\n', len);
+    return eol && tcp_server_match_probe(request, eol - request) ? (size_t)(eol + 1 - request) : len;
+}
+
+/**
+ * @brief Entrega uma requisição do corpus cortada em `cuts` e confere a resposta.
+ *
+ * @param chunk Tamanho dos pbufs de cada segmento (0 para um pbuf por segmento).
+ */
+static void replay(const CAPTURE_T *capture, const size_t *cuts, int cut_count, size_t chunk) {
+    static CLIENT_T client;
+    char request[TCP_REQUEST_BUF_SIZE];
+    size_t len = build_request(capture, request, sizeof(request), NULL);
+    size_t answered_at = answer_at(request, len);
+    unsigned long failures = host_test_failures;
+
+    id_pw_collected = 0;
+    strcpy(ssid, "anterior");
+    strcpy(password, "senha-anterior");
+    if (!client_connect(&client)) {
+        CHECK(false);
+        return;
+    }
+
+    size_t start = 0;
+    for (int i = 0; i <= cut_count; i++) {
+        size_t end = i < cut_count ? cuts[i] : len;
+        if (end <= start) continue;
+        CHECK_EQ(host_tcp_deliver(client.pcb, request + start, end - start, chunk), ERR_OK);
+        start = end;
+
+        // Nada é respondido antes do último byte da requisição (ou da linha de requisição, nas sondagens)
+        if (end < len) {
+            CHECK_EQ(client.pcb->out_len > 0, end >= answered_at);
+            CHECK(host_tcp_open(client.pcb));
+        }
+    }
+    CHECK_EQ(client.pcb->recved, len);
+
+    RESPONSE_T response;
+    bool answered = client_response(&client, &response);
+    CHECK(answered);
+    if (answered) check_response(&response, capture->response, capture->keep_alive);
+    CHECK_EQ(client.in_len, 0);
+
+    CHECK_EQ(id_pw_collected, capture->ssid != NULL);
+    CHECK(strcmp(ssid, capture->ssid ? capture->ssid : "anterior") == 0);
+    CHECK(strcmp(password, capture->password ? capture->password : "senha-anterior") == 0);
+
+    // Conexões persistentes são fechadas pelo cliente; as demais, pelo servidor
+    CHECK_EQ(host_tcp_open(client.pcb), capture->keep_alive);
+    if (host_tcp_open(client.pcb)) host_tcp_remote_close(client.pcb);
+    CHECK(!host_tcp_open(client.pcb));
+    CHECK_EQ(tcp_connect_pool.in_use, 0);
+
+    if (host_test_failures != failures) fprintf(stderr, "  requisição: %s (%d cortes, pbufs de %zu)\n", capture->client, cut_count, chunk);
+}
+
+// ------------------------------ Cenários ------------------------------
+
+// Cada requisição com a divisão do seu cliente e com as demais divisões conhecidas
+static void test_splits(void) {
+    server_open();
+    for (size_t i = 0; i < CAPTURE_COUNT; i++) {
+        char request[TCP_REQUEST_BUF_SIZE];
+        size_t body_offset, cuts[TCP_REQUEST_BUF_SIZE];
+        size_t len = build_request(&captures[i], request, sizeof(request), &body_offset);
+
+        int count = split_cuts(captures[i].split, request, len, body_offset, cuts);
+        replay(&captures[i], cuts, count, 0);
+        for (SPLIT_T split = SPLIT_WHOLE; split < SPLIT_COUNT; split++) {
+            count = split_cuts(split, request, len, body_offset, cuts);
+            replay(&captures[i], cuts, count, 0);
+            replay(&captures[i], cuts, count, 7);
+        }
+    }
+    server_close();
+}
+
+// Um corte em cada posição de cada requisição, com pbufs de tamanhos variados
+static void test_every_cut(void) {
+    for (size_t i = 0; i < CAPTURE_COUNT; i++) {
+        char request[TCP_REQUEST_BUF_SIZE];
+        size_t len = build_request(&captures[i], request, sizeof(request), NULL);
+
+        server_open();
+        for (size_t cut = 1; cut < len; cut++) {
+            replay(&captures[i], &cut, 1, cut % 5 == 0 ? 0 : cut % 5);
+        }
+        server_close();
+    }
+}
+
+// Limites do buffer de requisição e espera pelo restante da requisição
+static void test_limits(void) {
+    static CLIENT_T client;
+    char request[TCP_REQUEST_BUF_SIZE + 1];
+    RESPONSE_T response;
+    server_open();
+
+    // Requisição que ocupa o buffer inteiro (menos o NULL final) é atendida
+    static const char head[] = "GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\nX-Pad: ";
+    size_t len = TCP_REQUEST_BUF_SIZE - 1;
+    memset(request, 'a', sizeof(request));
+    memcpy(request, head, sizeof(head) - 1);
+    memcpy(request + len - 4, "\r\n\r\n", 4);
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request, len - 100, 0), ERR_OK);
+    CHECK_EQ(host_tcp_deliver(client.pcb, request + len - 100, 100, 0), ERR_OK);
+    CHECK(client_response(&client, &response));
+    check_response(&response, &config_page.plain, true);
+    host_tcp_remote_close(client.pcb);
+
+    // Um byte a mais fecha a conexão sem resposta
+    memcpy(request + len - 4, "a\r\n\r\n", 5);
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request, len - 100, 0), ERR_OK);
+    CHECK_EQ(host_tcp_deliver(client.pcb, request + len - 100, 101, 0), ERR_OK);
+    CHECK(!host_tcp_open(client.pcb));
+    CHECK_EQ(client.pcb->out_len, 0);
+
+    // Cabeçalhos sem fim que enchem o buffer também fecham a conexão
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request, len - 4, 0), ERR_OK);
+    CHECK(host_tcp_open(client.pcb));
+    CHECK_EQ(host_tcp_deliver(client.pcb, "bbbb", 4, 0), ERR_OK);
+    CHECK(!host_tcp_open(client.pcb));
+    CHECK_EQ(client.pcb->out_len, 0);
+
+    // Content-Length maior que o buffer: fechada ao fim dos cabeçalhos, sem esperar o corpo
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver_str(client.pcb, "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\nContent-Length: 5000\r\n\r"), ERR_OK);
+    CHECK(host_tcp_open(client.pcb));
+    CHECK_EQ(host_tcp_deliver_str(client.pcb, "\nssid=x"), ERR_OK);
+    CHECK(!host_tcp_open(client.pcb));
+    CHECK_EQ(client.pcb->out_len, 0);
+
+    // O corpo que chega depois de uma pausa menor que o tempo de inatividade é aceito
+    const CAPTURE_T *ios = &captures[2];
+    size_t body_offset;
+    len = build_request(ios, request, sizeof(request), &body_offset);
+    id_pw_collected = 0;
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request, body_offset, 0), ERR_OK);
+    for (int i = 0; i < TCP_IDLE_TIMEOUT_S - 1; i++) {
+        host_time_advance_ms(1000);
+        host_tcp_poll_now(client.pcb);
+    }
+    CHECK(host_tcp_open(client.pcb));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request + body_offset, len - body_offset, 0), ERR_OK);
+    CHECK(client_response(&client, &response));
+    check_response(&response, ios->response, false);
+    CHECK_EQ(id_pw_collected, 1);
+    CHECK(!host_tcp_open(client.pcb));
+
+    // Sem o corpo até o tempo de inatividade, a conexão é fechada sem resposta
+    id_pw_collected = 0;
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request, body_offset + 3, 0), ERR_OK);
+    host_time_advance_ms(TCP_IDLE_TIMEOUT_S * 1000);
+    host_tcp_poll_now(client.pcb);
+    CHECK(!host_tcp_open(client.pcb));
+    CHECK_EQ(client.pcb->out_len, 0);
+    CHECK_EQ(id_pw_collected, 0);
+
+    server_close();
+}
+
+// ------------------------------ Páginas estáticas ------------------------------
+
+static bool points_into(const void *data, size_t len, const void *base, size_t base_len) {
+    const char *p = data, *start = base;
+    return base && p >= start && p + len <= start + base_len;
+}
+
+/**
+ * @brief Requisita uma página e confere, a cada confirmação, que todos os trechos entregues
+ *        ao lwIP apontam para a própria página (cabeçalhos, linha `Connection` ou corpo).
+ *
+ * @return Quantidade de trechos enviados.
+ */
+static int check_zero_copy(const char *request, const STATIC_PAGE_T *page, bool keep_alive) {
+    static CLIENT_T client;
+    const char *connection = keep_alive ? http_connection_keep_alive : http_connection_close;
+    size_t connection_len = strlen(connection);
+    int segments = 0;
+
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver_str(client.pcb, request), ERR_OK);
+    while (client.pcb->unacked && !client.pcb->aborted) {
+        CHECK(client.pcb->segment_count > 0);
+        for (int i = 0; i < client.pcb->segment_count; i++) {
+            const HOST_TCP_SEGMENT_T *segment = &client.pcb->segments[i];
+            CHECK(points_into(segment->data, segment->len, page->header, page->header_len) ||
+                  points_into(segment->data, segment->len, connection, connection_len) ||
+                  points_into(segment->data, segment->len, page->body, page->body_len));
+        }
+        segments += client.pcb->segment_count;
+        host_tcp_ack(client.pcb, client.pcb->segments[0].len);    // Um trecho por vez: o restante sai aos poucos
+    }
+
+    RESPONSE_T response;
+    client.in_len = host_tcp_read(client.pcb, client.in, sizeof(client.in));
+    CHECK(client_parse(&client, &response));
+    check_response(&response, page, keep_alive);
+    if (host_tcp_open(client.pcb)) host_tcp_remote_close(client.pcb);
+    return segments;
+}
+
+// Páginas do portal, redirecionamento e sondagens são enviados da flash, sem cópia, mesmo em vários trechos
+static void test_zero_copy(void) {
+    server_open();
+    host_tcp_snd_buf = 256;
+    CHECK(!config_page.plain.copy && !config_page.gzip.copy && !redirect_page.copy && !apple_probe_page.copy);
+
+    int segments = check_zero_copy("GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n", &config_page.plain, true);
+    CHECK(segments > config_page.plain.body_len / 256);
+    check_zero_copy("GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept-Encoding: gzip\r\nConnection: close\r\n\r\n",
+                    &config_page.gzip, false);
+    check_zero_copy("GET " REMOTE_PATH " HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept-Encoding: gzip\r\n\r\n",
+                    &remote_page.gzip, true);
+    check_zero_copy("GET /favicon.ico HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n", &redirect_page, true);
+    check_zero_copy("GET /hotspot-detect.html HTTP/1.0\r\nHost: captive.apple.com\r\n\r\n", &apple_probe_page, false);
+
+    host_tcp_snd_buf = TCP_SND_BUF;
+    server_close();
+}
+
+// CRC-32 do gzip e da ETag (polinômio 0xEDB88320, como o zlib)
+static uint32_t crc32_of(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint32_t le32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Requisita uma página e confere a resposta
+static void check_page(const char *request, const STATIC_PAGE_T *page, bool keep_alive) {
+    static CLIENT_T client;
+    RESPONSE_T response;
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver_str(client.pcb, request), ERR_OK);
+    CHECK(client_response(&client, &response));
+    check_response(&response, page, keep_alive);
+    if (host_tcp_open(client.pcb)) host_tcp_remote_close(client.pcb);
+}
+
+// Variantes das páginas do portal: gzip do mesmo conteúdo, ETag do conteúdo e escolha pelos cabeçalhos
+static void test_page_variants(void) {
+    server_open();
+    const WEB_PAGE_T *pages[] = { &config_page, &success_page, &failure_page, &remote_page };
+    for (size_t i = 0; i < sizeof(pages) / sizeof(pages[0]); i++) {
+        const WEB_PAGE_T *page = pages[i];
+        const uint8_t *gz = page->gzip.body;
+        char etag[16];
+        snprintf(etag, sizeof(etag), "\"%08x\"", (unsigned)crc32_of(page->plain.body, page->plain.body_len));
+        CHECK(strcmp(page->asset->etag, etag) == 0);
+
+        // O trailer do gzip guarda o CRC-32 e o comprimento do conteúdo descomprimido
+        CHECK(page->gzip.body_len > 18 && page->gzip.body_len < page->plain.body_len);
+        CHECK(gz[0] == 0x1F && gz[1] == 0x8B && gz[2] == 8);
+        CHECK_EQ(le32(gz + page->gzip.body_len - 8), crc32_of(page->plain.body, page->plain.body_len));
+        CHECK_EQ(le32(gz + page->gzip.body_len - 4), page->plain.body_len);
+
+        CHECK(strstr(page->gzip.header, "Content-Encoding: gzip\r\n") != NULL);
+        CHECK(strstr(page->plain.header, "Content-Encoding") == NULL);
+        CHECK(strstr(page->plain.header, etag) && strstr(page->gzip.header, etag) && strstr(page->not_modified.header, etag));
+        CHECK(strncmp(page->not_modified.header, "HTTP/1.1 304 ", 13) == 0 && page->not_modified.body_len == 0);
+    }
+
+    // Sem gzip em Accept-Encoding, a página vai sem compressão
+    check_page("GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n", &config_page.plain, true);
+    check_page("GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept-Encoding: identity\r\n\r\n", &config_page.plain, true);
+    check_page("GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept-Encoding: br, gzip\r\n\r\n", &config_page.gzip, true);
+
+    // ETag atual em If-None-Match: 304 nas rotas que revalidam; outra ETag recebe a página
+    char request[256];
+    snprintf(request, sizeof(request), "GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\nIf-None-Match: \"0\", %s\r\n"
+             "Accept-Encoding: gzip\r\n\r\n", config_page.asset->etag);
+    check_page(request, &config_page.not_modified, true);
+    snprintf(request, sizeof(request), "GET " REMOTE_PATH " HTTP/1.0\r\nIf-None-Match: %s\r\n\r\n", remote_page.asset->etag);
+    check_page(request, &remote_page.not_modified, false);
+    snprintf(request, sizeof(request), "GET " REMOTE_PATH " HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", config_page.asset->etag);
+    check_page(request, &remote_page.plain, true);
+
+    // A resposta do formulário não é revalidada
+    snprintf(request, sizeof(request), "POST /post HTTP/1.1\r\nIf-None-Match: %s\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+             "Content-Length: 24\r\n\r\nssid=Casa&password=curta", failure_page.asset->etag);
+    check_page(request, &failure_page.plain, true);
+    server_close();
+}
+
+// ------------------------------ Rotas ------------------------------
+
+// Modelo da busca: varredura linear da tabela
+static const HTTP_ROUTE_T *linear_route(const char *method, const char *path) {
+    for (size_t i = 0; i < HTTP_ROUTE_COUNT; i++) {
+        if (strcmp(http_routes[i].path, path) == 0 && strcmp(http_routes[i].method, method) == 0) {
+            return (http_routes[i].modes & http_server_mode) ? &http_routes[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+// Caminho sorteado a partir dos caminhos da tabela: inteiro, cortado, com sufixo ou com um byte trocado
+static void random_path(char *out, size_t max) {
+    const char *base = http_routes[host_test_rand() % HTTP_ROUTE_COUNT].path;
+    size_t len = strlen(base);
+    switch (host_test_rand() % 4) {
+    case 0:
+        snprintf(out, max, "%s", base);
+        break;
+    case 1:
+        snprintf(out, max, "%.*s", (int)(host_test_rand() % (len + 1)), base);
+        break;
+    case 2:
+        snprintf(out, max, "%s%c", base, "/?xa"[host_test_rand() % 4]);
+        break;
+    default:
+        snprintf(out, max, "%s", base);
+        out[host_test_rand() % len] = "/acegz_AC"[host_test_rand() % 9];
+        break;
+    }
+}
+
+// Busca binária na tabela ordenada, nos dois modos, conferida contra a varredura linear
+static void test_routes(void) {
+    static const char *methods[] = { HTTP_GET, HTTP_POST, "HEAD", "PUT", "get", "" };
+    static const u8_t modes[] = { HTTP_MODE_AP, HTTP_MODE_STA };
+
+    tcp_server_routes_check();
+    for (size_t i = 1; i < HTTP_ROUTE_COUNT; i++) {
+        CHECK(tcp_server_route_compare(http_routes[i].method, http_routes[i].path, &http_routes[i - 1]) > 0);
+    }
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        http_server_mode = modes[m];
+        for (size_t i = 0; i < HTTP_ROUTE_COUNT; i++) {
+            const HTTP_ROUTE_T *route = &http_routes[i];
+            CHECK(tcp_server_find_route(route->method, route->path) == ((route->modes & modes[m]) ? route : NULL));
+            for (size_t j = 0; j < sizeof(methods) / sizeof(methods[0]); j++) {
+                CHECK(tcp_server_find_route(methods[j], route->path) == linear_route(methods[j], route->path));
+            }
+        }
+        CHECK(tcp_server_find_route(HTTP_GET, "/") == NULL);
+        CHECK(tcp_server_find_route(HTTP_GET, "") == NULL);
+        CHECK(tcp_server_find_route(HTTP_GET, "/CONFIG") == NULL);
+        CHECK(tcp_server_find_route(HTTP_GET, "/config/") == NULL);
+        CHECK(tcp_server_find_route(HTTP_GET, "~") == NULL);
+
+        unsigned long rounds = host_test_iterations(20000);
+        for (unsigned long round = 0; round < rounds; round++) {
+            char path[32];
+            const char *method = methods[host_test_rand() % (sizeof(methods) / sizeof(methods[0]))];
+            random_path(path, sizeof(path));
+            CHECK(tcp_server_find_route(method, path) == linear_route(method, path));
+        }
+    }
+
+    // Pelo servidor no modo STA: rotas só do portal e caminhos desconhecidos recebem 404
+    http_server_mode = HTTP_MODE_STA;
+    server_open();
+    check_page("GET /config HTTP/1.1\r\nHost: pico.local\r\n\r\n", &not_found_page, true);
+    check_page("POST /post HTTP/1.1\r\nHost: pico.local\r\nContent-Length: 0\r\n\r\n", &not_found_page, true);
+    check_page("GET /favicon.ico HTTP/1.1\r\nHost: pico.local\r\n\r\n", &not_found_page, true);
+    check_page("GET " REMOTE_PATH " HTTP/1.1\r\nHost: pico.local\r\nAccept-Encoding: gzip\r\n\r\n", &remote_page.gzip, true);
+    check_page("GET " API_TELEMETRY " HTTP/1.1\r\nHost: pico.local\r\n\r\n", &no_content_page, true);
+    server_close();
+    http_server_mode = HTTP_MODE_AP;
+}
+
+// Sondagens de portal cativo: resposta constante e conexão fechada, só com a linha de requisição exata e no modo AP
+static void test_probes(void) {
+    static CLIENT_T client;
+    RESPONSE_T response;
+    char request[256];
+    server_open();
+    for (size_t i = 0; i < sizeof(captive_probes) / sizeof(captive_probes[0]); i++) {
+        const CAPTIVE_PROBE_T *probe = &captive_probes[i];
+        CHECK(tcp_server_match_probe(probe->request_line, probe->len) == probe->response);
+        CHECK(tcp_server_match_probe(probe->request_line, probe->len - 1) == NULL);
+
+        // Mesmo numa conexão persistente, a sondagem é respondida e fechada, na prioridade mínima
+        CHECK(client_connect(&client));
+        CHECK_EQ(host_tcp_deliver_str(client.pcb, "GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n"), ERR_OK);
+        CHECK(client_response(&client, &response));
+        check_response(&response, &config_page.plain, true);
+        snprintf(request, sizeof(request), "%sHTTP/1.1\r\nHost: probe.example\r\nConnection: keep-alive\r\n\r\n", probe->request_line);
+        CHECK_EQ(host_tcp_deliver_str(client.pcb, request), ERR_OK);
+        CHECK_EQ(client.pcb->prio, TCP_PRIO_MIN);
+        CHECK(client_response(&client, &response));
+        check_response(&response, probe->response, false);
+        CHECK(!host_tcp_open(client.pcb));
+
+        // Só a linha de requisição basta: a resposta sai antes dos cabeçalhos, que são descartados
+        CHECK(client_connect(&client));
+        snprintf(request, sizeof(request), "%sHTTP/1.1\r\n", probe->request_line);
+        CHECK_EQ(host_tcp_deliver_str(client.pcb, request), ERR_OK);
+        CHECK(client.pcb->out_len > 0);
+        CHECK_EQ(host_tcp_deliver_str(client.pcb, "Host: probe.example\r\nConnection: keep-alive\r\n\r\nGET /config HTTP/1.1\r\n\r\n"), ERR_OK);
+        CHECK(client_response(&client, &response));
+        check_response(&response, probe->response, false);
+        CHECK_EQ(client.in_len, 0);
+        CHECK(!host_tcp_open(client.pcb));
+
+        // Caminho mais longo, com parâmetros ou outro método: caminho normal (redirecionamento, conexão mantida)
+        int path_len = probe->len - 5;      // Sem "GET " e o espaço final
+        snprintf(request, sizeof(request), "GET %.*s0 HTTP/1.1\r\nHost: probe.example\r\n\r\n", path_len, probe->request_line + 4);
+        check_page(request, &redirect_page, true);
+        snprintf(request, sizeof(request), "GET %.*s?x=1 HTTP/1.1\r\nHost: probe.example\r\n\r\n", path_len, probe->request_line + 4);
+        check_page(request, &redirect_page, true);
+        snprintf(request, sizeof(request), "HEAD %.*s HTTP/1.1\r\nHost: probe.example\r\n\r\n", path_len, probe->request_line + 4);
+        check_page(request, &redirect_page, true);
+    }
+    server_close();
+
+    // No modo STA as sondagens são caminhos desconhecidos
+    http_server_mode = HTTP_MODE_STA;
+    server_open();
+    for (size_t i = 0; i < sizeof(captive_probes) / sizeof(captive_probes[0]); i++) {
+        snprintf(request, sizeof(request), "%sHTTP/1.1\r\nHost: probe.example\r\n\r\n", captive_probes[i].request_line);
+        check_page(request, &not_found_page, true);
+    }
+    server_close();
+    http_server_mode = HTTP_MODE_AP;
+}
+
+// Cortes em posições aleatórias, com pbufs de tamanhos aleatórios
+static void test_random(void) {
+    unsigned long rounds = host_test_iterations(20000);
+    server_open();
+    for (unsigned long i = 0; i < rounds; i++) {
+        const CAPTURE_T *capture = &captures[host_test_rand() % CAPTURE_COUNT];
+        char request[TCP_REQUEST_BUF_SIZE];
+        size_t len = build_request(capture, request, sizeof(request), NULL);
+
+        size_t cuts[8];
+        int count = 1 + host_test_rand() % 8;
+        for (int j = 0; j < count; j++) cuts[j] = 1 + host_test_rand() % (len - 1);
+        for (int j = 1; j < count; j++) {
+            for (int k = j; k > 0 && cuts[k] < cuts[k - 1]; k--) {
+                size_t swap = cuts[k];
+                cuts[k] = cuts[k - 1];
+                cuts[k - 1] = swap;
+            }
+        }
+        replay(capture, cuts, count, host_test_rand() % 33);
+
+        // Os PCBs simulados só são liberados no reset
+        if (i % 1000 == 999) {
+            server_close();
+            server_open();
+        }
+    }
+    server_close();
+    fprintf(stderr, "aleatório: %lu requisições\n", rounds);
+}
+
+// ------------------------------ Clientes em paralelo ------------------------------
+
+#define LOAD_CLIENTS 12                 // Clientes simulados no teste de carga.
+
+static CLIENT_T clients[TCP_MAX_CONNECTIONS + 2]; // Conexões dos cenários em paralelo.
+
+static const CAPTURE_T *find_capture(const char *client) {
+    for (size_t i = 0; i < CAPTURE_COUNT; i++) {
+        if (strcmp(captures[i].client, client) == 0) return &captures[i];
+    }
+    assert(false);
+    return NULL;
+}
+
+// Sondagens e caminhos desconhecidos recebem respostas constantes e podem perder o slot
+static bool probe_like(const CAPTURE_T *capture) {
+    return capture->response == &redirect_page || capture->response == &apple_probe_page;
+}
+
+// Entrega a requisição inteira de uma captura
+static void client_send(CLIENT_T *client, const CAPTURE_T *capture) {
+    char request[TCP_REQUEST_BUF_SIZE];
+    size_t len = build_request(capture, request, sizeof(request), NULL);
+    CHECK_EQ(host_tcp_deliver(client->pcb, request, len, 0), ERR_OK);
+}
+
+// A conexão recebeu o 503 enviado quando não há slot e foi fechada
+static bool client_rejected(CLIENT_T *client) {
+    client_pump(client);
+    return !host_tcp_open(client->pcb) && client->in_len == sizeof(HTTP_RESPONSE_BUSY) - 1 &&
+           memcmp(client->in, HTTP_RESPONSE_BUSY, client->in_len) == 0;
+}
+
+// Rajada de sondagens do Android, portal com prioridade e conexões sem slot
+static void test_parallel(void) {
+    const CAPTURE_T *probes[TCP_MAX_CONNECTIONS] = {
+        find_capture("Sondagem do Android"), find_capture("Sondagem do iOS"),
+        find_capture("Sondagem do Android"), find_capture("Chrome no Android (favicon)"),
+    };
+    const CAPTURE_T *config = find_capture("Safari no iOS (página de configuração)");
+    const CAPTURE_T *post = find_capture("Chrome no Android");
+    CLIENT_T *portal = &clients[TCP_MAX_CONNECTIONS], *late = &clients[TCP_MAX_CONNECTIONS + 1];
+    RESPONSE_T response;
+    server_open();
+
+    // Sondagens respondidas e ainda não confirmadas (cliente lento) ocupam todos os slots
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        CHECK(client_connect(&clients[i]));
+        client_send(&clients[i], probes[i]);
+        CHECK_EQ(clients[i].pcb->prio, TCP_PRIO_MIN);
+        CHECK(clients[i].pcb->unacked > 0);
+        host_time_advance_ms(100);
+    }
+    CHECK_EQ(tcp_connect_pool.in_use, TCP_MAX_CONNECTIONS);
+
+    // A página de configuração fica com o slot da sondagem mais antiga, com prioridade máxima
+    CHECK(client_connect(portal));
+    CHECK(!host_tcp_open(clients[0].pcb));
+    client_send(portal, config);
+    CHECK_EQ(portal->pcb->prio, TCP_PRIO_MAX);
+    CHECK(client_response(portal, &response));
+    check_response(&response, config->response, true);
+    CHECK_EQ(portal->pcb->prio, TCP_PRIO_MIN);  // Persistente e ociosa
+
+    // O formulário fica com o slot da próxima sondagem (mais antiga que o portal ocioso)
+    host_time_advance_ms(100);
+    CHECK(client_connect(late));
+    CHECK(!host_tcp_open(clients[1].pcb));
+    CHECK(host_tcp_open(portal->pcb));
+    client_send(late, post);
+    CHECK_EQ(late->pcb->prio, TCP_PRIO_MAX);
+    CHECK(client_response(late, &response));
+    check_response(&response, post->response, false);
+    CHECK(!host_tcp_open(late->pcb));
+    CHECK_EQ(tcp_connect_pool.rejected, 0);
+
+    // As sondagens restantes terminam quando confirmadas
+    for (int i = 2; i < TCP_MAX_CONNECTIONS; i++) {
+        CHECK(client_response(&clients[i], &response));
+        check_response(&response, probes[i]->response, probes[i]->keep_alive);
+        if (host_tcp_open(clients[i].pcb)) host_tcp_remote_close(clients[i].pcb);
+    }
+    host_tcp_remote_close(portal->pcb);
+    CHECK_EQ(tcp_connect_pool.in_use, 0);
+    server_close();
+
+    // Páginas do portal em envio nunca perdem o slot: a conexão seguinte recebe 503
+    server_open();
+    host_tcp_snd_buf = 256;
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        CHECK(client_connect(&clients[i]));
+        client_send(&clients[i], config);
+        CHECK_EQ(clients[i].pcb->prio, TCP_PRIO_MAX);
+        host_time_advance_ms(100);
+    }
+    CHECK(client_connect(late));
+    CHECK(client_rejected(late));
+    CHECK_EQ(tcp_connect_pool.rejected, 1);
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        CHECK(client_response(&clients[i], &response));
+        check_response(&response, config->response, true);
+        CHECK(host_tcp_open(clients[i].pcb));
+        host_time_advance_ms(100);
+    }
+
+    // Terminadas, elas ficam ociosas e a mais antiga cede o slot
+    CHECK(client_connect(late));
+    CHECK(!host_tcp_open(clients[0].pcb));
+    client_send(late, config);
+    CHECK(client_response(late, &response));
+    check_response(&response, config->response, true);
+    CHECK_EQ(tcp_connect_pool.rejected, 1);
+    for (int i = 1; i < TCP_MAX_CONNECTIONS; i++) host_tcp_remote_close(clients[i].pcb);
+    host_tcp_remote_close(late->pcb);
+    server_close();
+
+    // Conexões que ainda não enviaram a requisição são preservadas até o tempo de inatividade
+    server_open();
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) CHECK(client_connect(&clients[i]));
+    CHECK(client_connect(late));
+    CHECK(client_rejected(late));
+    host_time_advance_ms(TCP_IDLE_TIMEOUT_S * 1000 - 1);
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        host_tcp_poll_now(clients[i].pcb);
+        CHECK(host_tcp_open(clients[i].pcb));
+    }
+    host_time_advance_ms(1);
+    for (int i = 0; i < TCP_MAX_CONNECTIONS; i++) {
+        host_tcp_poll_now(clients[i].pcb);
+        CHECK(!host_tcp_open(clients[i].pcb));
+    }
+    CHECK_EQ(tcp_connect_pool.in_use, 0);
+    server_close();
+
+    // O tempo de inatividade é de cada conexão: uma página lenta continua enquanto há confirmações
+    server_open();
+    host_tcp_snd_buf = 128;
+    CLIENT_T *slow = &clients[0], *idle = &clients[1];
+    CHECK(client_connect(slow));
+    CHECK(client_connect(idle));
+    client_send(slow, config);
+    int seconds = 0;
+    while (slow->pcb->unacked) {
+        host_time_advance_ms(1000);
+        seconds++;
+        host_tcp_ack(slow->pcb, 48);
+        host_tcp_poll_now(slow->pcb);
+        host_tcp_poll_now(idle->pcb);
+        CHECK(host_tcp_open(slow->pcb));
+        CHECK_EQ(host_tcp_open(idle->pcb), seconds < TCP_IDLE_TIMEOUT_S);
+    }
+    CHECK(seconds > 2 * TCP_IDLE_TIMEOUT_S);
+    CHECK(client_response(slow, &response));
+    check_response(&response, config->response, true);
+
+    // Uma confirmação parada pelo tempo de inatividade fecha a conexão, mesmo com a resposta em envio
+    client_send(slow, config);
+    host_tcp_ack(slow->pcb, 48);
+    host_time_advance_ms(TCP_IDLE_TIMEOUT_S * 1000);
+    host_tcp_poll_now(slow->pcb);
+    CHECK(!host_tcp_open(slow->pcb));
+    server_close();
+}
+
+/**
+ * @brief Cliente do teste de carga: conecta, envia requisições em partes, confirma
+ *        as respostas aos poucos, reutiliza ou fecha a conexão.
+ */
+typedef struct LOAD_CLIENT_T_ {
+    CLIENT_T conn;                // Conexão e bytes recebidos.
+    const CAPTURE_T *capture;     // Requisição atual.
+    char request[TCP_REQUEST_BUF_SIZE]; // Requisição atual, montada.
+    size_t len;                   // Comprimento da requisição.
+    size_t answer_at;             // Bytes entregues a partir dos quais o servidor responde.
+    size_t sent;                  // Bytes da requisição já entregues.
+    int served;                   // Respostas completas na conexão atual.
+    uint32_t last_activity_ms;    // Último dado entregue ou confirmado (como o servidor conta).
+    bool connected;               // Conexão aberta do lado do cliente.
+} LOAD_CLIENT_T;
+
+/**
+ * @brief Contadores do teste de carga.
+ */
+typedef struct LOAD_STATS_T_ {
+    unsigned long connects;       // Conexões aceitas com slot.
+    unsigned long rejected;       // Conexões recusadas com 503.
+    unsigned long evicted;        // Conexões que cederam o slot.
+    unsigned long timeouts;       // Conexões fechadas por inatividade.
+    unsigned long responses;      // Respostas completas conferidas.
+    unsigned long portal;         // Respostas completas de `/config` e `/post`.
+} LOAD_STATS_T;
+
+static LOAD_CLIENT_T load[LOAD_CLIENTS];
+static LOAD_STATS_T load_stats;
+
+static void load_next_request(LOAD_CLIENT_T *client) {
+    client->capture = &captures[host_test_rand() % CAPTURE_COUNT];
+    client->len = build_request(client->capture, client->request, sizeof(client->request), NULL);
+    client->answer_at = answer_at(client->request, client->len);
+    client->sent = 0;
+}
+
+// Conexões que o servidor pode liberar para um novo cliente (como o cliente as vê)
+static bool load_evictable(const LOAD_CLIENT_T *client) {
+    if (!client->connected) return false;
+    if (client->sent >= client->answer_at) return probe_like(client->capture); // Resposta em andamento
+    return client->served > 0;          // Persistente e ociosa (ou enviando a próxima requisição)
+}
+
+static int load_open_count(void) {
+    int count = 0;
+    for (int i = 0; i < LOAD_CLIENTS; i++) count += load[i].connected;
+    return count;
+}
+
+// Conecta um cliente e confere a escolha do servidor: slot livre, slot cedido ou 503
+static void load_connect(LOAD_CLIENT_T *client, uint32_t now) {
+    bool evictable[LOAD_CLIENTS], any_evictable = false;
+    for (int i = 0; i < LOAD_CLIENTS; i++) {
+        evictable[i] = load_evictable(&load[i]);
+        any_evictable |= evictable[i];
+    }
+    bool full = load_open_count() == TCP_MAX_CONNECTIONS;
+
+    CHECK(client_connect(&client->conn));
+    int evicted = 0;
+    for (int i = 0; i < LOAD_CLIENTS; i++) {
+        if (&load[i] == client || !load[i].connected || host_tcp_open(load[i].conn.pcb)) continue;
+        CHECK(evictable[i]);
+        load[i].connected = false;
+        evicted++;
+    }
+    load_stats.evicted += evicted;
+
+    if (full && !any_evictable) {
+        CHECK(client_rejected(&client->conn));
+        load_stats.rejected++;
+        return;
+    }
+    CHECK_EQ(evicted, full ? 1 : 0);
+    CHECK(host_tcp_open(client->conn.pcb));
+    client->connected = true;
+    client->served = 0;
+    client->last_activity_ms = now;
+    load_next_request(client);
+    load_stats.connects++;
+}
+
+// Lê o que chegou (sem confirmar) e avança quando a resposta terminou do lado do servidor
+static void load_receive(LOAD_CLIENT_T *client) {
+    CLIENT_T *conn = &client->conn;
+    conn->in_len += host_tcp_read(conn->pcb, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len);
+    if (client->sent < client->len || conn->pcb->unacked) return;
+
+    // Todo o enviado foi confirmado: a resposta está inteira
+    RESPONSE_T response;
+    bool answered = client_parse(conn, &response);
+    CHECK(answered);
+    CHECK_EQ(conn->in_len, 0);
+    if (!answered) return;
+    check_response(&response, client->capture->response, client->capture->keep_alive);
+    load_stats.responses++;
+    load_stats.portal += !probe_like(client->capture);
+
+    CHECK_EQ(host_tcp_open(conn->pcb), client->capture->keep_alive);
+    if (!host_tcp_open(conn->pcb)) {
+        client->connected = false;
+        return;
+    }
+    client->served++;
+    load_next_request(client);
+}
+
+/**
+ * @brief Clientes em paralelo que conectam, enviam, confirmam e fecham em ordem aleatória.
+ *
+ * Confere em cada passo que o servidor só libera slots de sondagens e de conexões
+ * persistentes ociosas, que só recusa uma conexão quando não há nenhuma delas, que cada
+ * conexão fecha por inatividade exatamente após `TCP_IDLE_TIMEOUT_S` e que todas as
+ * respostas completas estão corretas.
+ */
+static void test_load(void) {
+    unsigned long steps = host_test_iterations(200000);
+    unsigned long failures = host_test_failures;
+    memset(load, 0, sizeof(load));
+    memset(&load_stats, 0, sizeof(load_stats));
+    server_open();
+
+    for (unsigned long step = 0; step < steps; step++) {
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        LOAD_CLIENT_T *client = &load[host_test_rand() % LOAD_CLIENTS];
+        struct tcp_pcb *pcb = client->conn.pcb;
+        uint32_t r = host_test_rand() % 100;
+
+        if (r >= 96) {
+            // O tempo passa: o servidor fecha exatamente as conexões ociosas
+            host_time_advance_ms(host_test_rand() % 1500);
+            now = to_ms_since_boot(get_absolute_time());
+            for (int i = 0; i < LOAD_CLIENTS; i++) {
+                if (!load[i].connected) continue;
+                host_tcp_poll_now(load[i].conn.pcb);
+                bool idle = now - load[i].last_activity_ms >= TCP_IDLE_TIMEOUT_S * 1000;
+                CHECK_EQ(host_tcp_open(load[i].conn.pcb), !idle);
+                if (idle) {
+                    load[i].connected = false;
+                    load_stats.timeouts++;
+                }
+            }
+        } else if (!client->connected) {
+            if (r < 20) load_connect(client, now);
+        } else if (r < 2) {
+            // O cliente desiste (fecha ou reseta a conexão)
+            if (r == 0) host_tcp_remote_close(pcb);
+            else host_tcp_reset_by_peer(pcb);
+            CHECK(!host_tcp_open(pcb));
+            client->connected = false;
+        } else if (client->sent < client->len) {
+            size_t part = 1 + host_test_rand() % (client->len - client->sent);
+            if (r < 50) part = client->len - client->sent;
+            CHECK_EQ(host_tcp_deliver(pcb, client->request + client->sent, part, host_test_rand() % 64), ERR_OK);
+            client->sent += part;
+            client->last_activity_ms = now;
+            load_receive(client);
+        } else if (pcb->unacked) {
+            size_t part = r < 50 ? pcb->unacked : 1 + host_test_rand() % pcb->unacked;
+            host_tcp_ack(pcb, part);
+            client->last_activity_ms = now;
+            load_receive(client);
+        }
+        CHECK_EQ(tcp_connect_pool.in_use, load_open_count());
+        if (host_test_failures != failures) break;
+
+        // Os PCBs simulados só são liberados no reset
+        if (step % 20000 == 19999) {
+            for (int i = 0; i < LOAD_CLIENTS; i++) {
+                if (load[i].connected) host_tcp_remote_close(load[i].conn.pcb);
+                load[i].connected = false;
+            }
+            server_close();
+            server_open();
+        }
+    }
+
+    for (int i = 0; i < LOAD_CLIENTS; i++) {
+        if (load[i].connected) host_tcp_remote_close(load[i].conn.pcb);
+    }
+    CHECK(load_stats.evicted > 0 && load_stats.rejected > 0 && load_stats.timeouts > 0);
+    CHECK(tcp_connect_pool.high_water == TCP_MAX_CONNECTIONS);
+    server_close();
+    fprintf(stderr, "carga: %lu conexões, %lu respostas (%lu do portal), %lu cederam o slot, "
+            "%lu recusadas, %lu por inatividade\n", load_stats.connects, load_stats.responses,
+            load_stats.portal, load_stats.evicted, load_stats.rejected, load_stats.timeouts);
+}
+
+// ------------------------------ Conexões persistentes ------------------------------
+
+#define LOAD_PAGE_COUNT 5               // Requisições de um carregamento do portal.
+
+/**
+ * @brief Requisições de um carregamento do portal: página, favicon, amostra, formulário
+ *        recusado e formulário aceito ("%s" recebe a linha `Connection`, "%u" o Content-Length).
+ */
+static const struct {
+    const char *head;             // Linha de requisição e cabeçalhos.
+    const char *body;             // Corpo, ou "".
+    const STATIC_PAGE_T *response; // Resposta esperada.
+} page_load[LOAD_PAGE_COUNT] = {
+    { "GET /config HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept-Encoding: gzip, deflate\r\nConnection: %s\r\n\r\n",
+      "", &config_page.gzip },
+    { "GET /favicon.ico HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: %s\r\n\r\n", "", &redirect_page },
+    { "GET /api/telemetry HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: %s\r\n\r\n", "", &no_content_page },
+    { "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept-Encoding: gzip\r\nConnection: %s\r\n" FORM_TYPE
+      "Content-Length: %u\r\n\r\n", "ssid=Casa&password=curta", &failure_page.gzip },
+    { "POST /post HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept-Encoding: gzip\r\nConnection: %s\r\n" FORM_TYPE
+      "Content-Length: %u\r\n\r\n", "ssid=Casa&password=12345678", &success_page.gzip },
+};
+
+// Monta uma requisição do carregamento do portal e retorna o comprimento
+static size_t page_request(int index, const char *connection, char *out, size_t max) {
+    int len = snprintf(out, max, page_load[index].head, connection, (unsigned)strlen(page_load[index].body));
+    assert(len > 0 && (size_t)len + strlen(page_load[index].body) < max);
+    strcpy(out + len, page_load[index].body);
+    return len + strlen(page_load[index].body);
+}
+
+// Pipeline, limite de requisições, versões do HTTP e inatividade entre requisições
+static void test_keep_alive(void) {
+    static CLIENT_T client;
+    char request[TCP_REQUEST_BUF_SIZE];
+    RESPONSE_T response;
+    server_open();
+
+    // Três requisições no mesmo segmento: respostas na ordem, a conexão continua aberta
+    size_t len = 0;
+    for (int i = 0; i < 3; i++) len += page_request(i, "keep-alive", request + len, sizeof(request) - len);
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request, len, 0), ERR_OK);
+    for (int i = 0; i < 3; i++) {
+        CHECK(client_response(&client, &response));
+        check_response(&response, page_load[i].response, true);
+    }
+    CHECK_EQ(client.in_len, 0);
+    CHECK(host_tcp_open(client.pcb));
+
+    // Inatividade entre requisições fecha a conexão persistente
+    host_time_advance_ms(TCP_IDLE_TIMEOUT_S * 1000 - 1);
+    host_tcp_poll_now(client.pcb);
+    CHECK(host_tcp_open(client.pcb));
+    host_time_advance_ms(1);
+    host_tcp_poll_now(client.pcb);
+    CHECK(!host_tcp_open(client.pcb));
+
+    // A requisição de número `TCP_MAX_REQUESTS` recebe `Connection: close`
+    CHECK(client_connect(&client));
+    for (int i = 1; i <= TCP_MAX_REQUESTS; i++) {
+        len = page_request(i % 3, "keep-alive", request, sizeof(request));
+        CHECK_EQ(host_tcp_deliver(client.pcb, request, len, 0), ERR_OK);
+        CHECK(client_response(&client, &response));
+        check_response(&response, page_load[i % 3].response, i < TCP_MAX_REQUESTS);
+        CHECK_EQ(host_tcp_open(client.pcb), i < TCP_MAX_REQUESTS);
+    }
+
+    // `Connection: close` no HTTP/1.1; HTTP/1.0 só mantém a conexão com `keep-alive`
+    static const struct {
+        const char *request;      // Requisição.
+        bool keep_alive;          // A conexão continua aberta.
+    } versions[] = {
+        { "GET /favicon.ico HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: close\r\n\r\n", false },
+        { "GET /favicon.ico HTTP/1.1\r\nHost: 192.168.4.1\r\nconnection: Keep-Alive, Close\r\n\r\n", false },
+        { "GET /favicon.ico HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n", true },
+        { "GET /favicon.ico HTTP/1.0\r\nHost: 192.168.4.1\r\n\r\n", false },
+        { "GET /favicon.ico HTTP/1.0\r\nHost: 192.168.4.1\r\nConnection: keep-alive\r\n\r\n", true },
+    };
+    for (size_t i = 0; i < sizeof(versions) / sizeof(versions[0]); i++) {
+        CHECK(client_connect(&client));
+        CHECK_EQ(host_tcp_deliver_str(client.pcb, versions[i].request), ERR_OK);
+        CHECK(client_response(&client, &response));
+        check_response(&response, &redirect_page, versions[i].keep_alive);
+        CHECK_EQ(host_tcp_open(client.pcb), versions[i].keep_alive);
+        if (host_tcp_open(client.pcb)) host_tcp_remote_close(client.pcb);
+    }
+
+    // Pipeline maior que o buffer durante uma resposta: o servidor recusa o segmento (ERR_MEM)
+    // e o aceita de novo depois que a resposta anda
+    server_close();
+    server_open();
+    host_tcp_snd_buf = 256;
+    CHECK(client_connect(&client));
+    len = page_request(0, "keep-alive", request, sizeof(request));
+    CHECK_EQ(host_tcp_deliver(client.pcb, request, len, 0), ERR_OK);
+    char pipeline[2 * TCP_REQUEST_BUF_SIZE];
+    size_t pipeline_len = 0;
+    int queued = 0;
+    while (pipeline_len < TCP_REQUEST_BUF_SIZE) {
+        pipeline_len += page_request(queued++ % 3, "keep-alive", pipeline + pipeline_len, sizeof(pipeline) - pipeline_len);
+    }
+    size_t half = pipeline_len / 2;
+    CHECK_EQ(host_tcp_deliver(client.pcb, pipeline, half, 0), ERR_OK);
+    CHECK_EQ(host_tcp_deliver(client.pcb, pipeline + half, pipeline_len - half, 0), ERR_MEM);
+    CHECK(host_tcp_open(client.pcb));
+    CHECK(client_response(&client, &response));
+    check_response(&response, page_load[0].response, true);
+    for (int i = 0; i < queued; i++) {
+        if (half < pipeline_len && host_tcp_deliver(client.pcb, pipeline + half, pipeline_len - half, 0) == ERR_OK) {
+            half = pipeline_len;
+        }
+        CHECK(client_response(&client, &response));
+        check_response(&response, page_load[i % 3].response, true);
+    }
+    CHECK_EQ(half, pipeline_len);
+    CHECK_EQ(client.in_len, 0);
+    host_tcp_remote_close(client.pcb);
+    server_close();
+}
+
+// Requisições em pipeline cortadas em posições aleatórias, com confirmações parciais
+static void test_pipeline_random(void) {
+    static CLIENT_T client;
+    unsigned long rounds = host_test_iterations(20000) / 4;
+    server_open();
+    for (unsigned long round = 0; round < rounds; round++) {
+        char pipeline[TCP_REQUEST_BUF_SIZE];
+        int expected[8], count = 1 + host_test_rand() % 8;
+        size_t len = 0;
+        for (int i = 0; i < count; i++) {
+            expected[i] = host_test_rand() % 4;  // Sem o formulário aceito, que fecha a conexão
+            char one[TCP_REQUEST_BUF_SIZE];
+            size_t one_len = page_request(expected[i], "keep-alive", one, sizeof(one));
+            if (len + one_len >= sizeof(pipeline)) {
+                count = i;
+                break;
+            }
+            memcpy(pipeline + len, one, one_len);
+            len += one_len;
+        }
+
+        if (round % 64 == 0) {
+            server_close();
+            server_open();
+            host_tcp_snd_buf = 128 + host_test_rand() % 2048;
+        }
+        CHECK(client_connect(&client));
+
+        // Entrega em partes; entre elas o cliente confirma parte do que recebeu
+        size_t sent = 0;
+        int answered = 0;
+        RESPONSE_T response;
+        for (int guard = 0; answered < count && guard < 10000; guard++) {
+            if (sent < len) {
+                size_t part = 1 + host_test_rand() % (len - sent);
+                err_t err = host_tcp_deliver(client.pcb, pipeline + sent, part, host_test_rand() % 16);
+                CHECK(err == ERR_OK || err == ERR_MEM);
+                if (err == ERR_OK) sent += part;
+            }
+            if (client.pcb->unacked) host_tcp_ack(client.pcb, 1 + host_test_rand() % client.pcb->unacked);
+            client.in_len += host_tcp_read(client.pcb, client.in + client.in_len, sizeof(client.in) - client.in_len);
+            while (answered < count && client_parse(&client, &response)) {
+                check_response(&response, page_load[expected[answered]].response, true);
+                answered++;
+            }
+        }
+        CHECK_EQ(answered, count);
+        CHECK_EQ(client.in_len, 0);
+        CHECK(host_tcp_open(client.pcb));
+        host_tcp_remote_close(client.pcb);
+        CHECK_EQ(tcp_connect_pool.in_use, 0);
+    }
+    server_close();
+    fprintf(stderr, "pipeline: %lu conexões\n", rounds);
+}
+
+/**
+ * @brief Resultado de um carregamento do portal.
+ */
+typedef struct PAGE_LOAD_RESULT_T_ {
+    int connections;              // Conexões abertas (um handshake cada).
+    int round_trips;              // Idas e voltas: handshakes e janelas de resposta.
+} PAGE_LOAD_RESULT_T;
+
+/**
+ * @brief Carrega o portal como um navegador e conta as idas e voltas pela rede.
+ *
+ * @param keep_alive Pede conexões persistentes (senão, `Connection: close` em cada requisição).
+ * @param pipeline Envia todas as requisições de uma vez na conexão persistente.
+ *
+ * Cada conexão custa uma ida e volta (handshake); cada requisição, uma ida e volta até a
+ * primeira janela da resposta, mais uma para cada janela seguinte (que só sai depois da
+ * confirmação da anterior).
+ */
+static PAGE_LOAD_RESULT_T page_load_run(bool keep_alive, bool pipeline) {
+    static CLIENT_T client;
+    PAGE_LOAD_RESULT_T result = { 0, 0 };
+    const char *connection = keep_alive ? "keep-alive" : "close";
+    RESPONSE_T response;
+    server_open();
+
+    int next = 0, answered = 0;
+    bool open = false;
+    while (answered < LOAD_PAGE_COUNT) {
+        if (!open) {
+            CHECK(client_connect(&client));
+            result.connections++;
+            result.round_trips++;
+            open = true;
+        }
+
+        // Envia a próxima requisição (ou todas, em pipeline) e recebe as janelas das respostas
+        char request[TCP_REQUEST_BUF_SIZE];
+        size_t len = 0;
+        int last = pipeline ? LOAD_PAGE_COUNT : next + 1;
+        for (; next < last; next++) len += page_request(next, connection, request + len, sizeof(request) - len);
+        CHECK_EQ(host_tcp_deliver(client.pcb, request, len, 0), ERR_OK);
+
+        int pending = pipeline ? LOAD_PAGE_COUNT - answered : 1;
+        result.round_trips++;
+        for (int guard = 0; guard < 100; guard++) {
+            client.in_len += host_tcp_read(client.pcb, client.in + client.in_len, sizeof(client.in) - client.in_len);
+            while (pending > 0 && client_parse(&client, &response)) {
+                bool last_one = answered == LOAD_PAGE_COUNT - 1;
+                check_response(&response, page_load[answered].response, keep_alive && !last_one);
+                answered++;
+                pending--;
+            }
+            if (pending == 0) break;
+            host_tcp_ack_all(client.pcb);   // A próxima janela chega uma ida e volta depois
+            result.round_trips++;
+        }
+
+        // A última confirmação segue com a próxima requisição (ou com o fim da conexão)
+        if (client.pcb->unacked) host_tcp_ack_all(client.pcb);
+        open = host_tcp_open(client.pcb);
+    }
+    CHECK(!open);                       // O formulário aceito encerra a conexão
+    CHECK_EQ(id_pw_collected, 1);
+    server_close();
+    id_pw_collected = 0;
+    return result;
+}
+
+// Idas e voltas de um carregamento do portal com e sem conexões persistentes
+static void test_round_trips(void) {
+    PAGE_LOAD_RESULT_T close = page_load_run(false, false);
+    PAGE_LOAD_RESULT_T keep = page_load_run(true, false);
+    PAGE_LOAD_RESULT_T piped = page_load_run(true, true);
+
+    CHECK_EQ(close.connections, LOAD_PAGE_COUNT);
+    CHECK_EQ(keep.connections, 1);
+    CHECK_EQ(piped.connections, 1);
+    CHECK_EQ(close.round_trips, 2 * LOAD_PAGE_COUNT);   // Handshake e resposta de cada requisição
+    CHECK_EQ(keep.round_trips, 1 + LOAD_PAGE_COUNT);    // Um handshake
+    CHECK_EQ(piped.round_trips, 2);                     // Todas as respostas na mesma janela
+    fprintf(stderr, "carregamento do portal (%d requisições): %d conexões e %d idas e voltas sem keep-alive, "
+            "%d e %d com keep-alive, %d e %d com pipeline\n", LOAD_PAGE_COUNT, close.connections,
+            close.round_trips, keep.connections, keep.round_trips, piped.connections, piped.round_trips);
+}
+
+// ------------------------------ Amostras ao vivo (/api/telemetry e /events) ------------------------------
+
+#define EVENTS_REQUEST "GET /events HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept: text/event-stream\r\n\r\n"
+#define TELEMETRY_REQUEST "GET /api/telemetry HTTP/1.1\r\nHost: 192.168.4.1\r\nConnection: close\r\n\r\n"
+
+// Confirma e confere tudo o que chegou a um assinante de `/events` (um fluxo, sem respostas a interpretar)
+static void check_stream(CLIENT_T *client, const char *expected) {
+    client_pump(client);
+    CHECK_EQ(client->in_len, strlen(expected));
+    CHECK(client->in_len == strlen(expected) && memcmp(client->in, expected, client->in_len) == 0);
+    client->in_len = 0;
+}
+
+// Evento SSE esperado para a amostra `seq`
+static const char *stream_event(uint32_t seq, const char *json) {
+    static char event[LIVE_EVENT_SIZE];
+    snprintf(event, sizeof(event), "id: %lu\ndata: %s\n\n", (unsigned long)seq, json);
+    return event;
+}
+
+// Confere `GET /api/telemetry`: cabeçalhos JSON com o `Content-Length` da amostra e a própria amostra
+static void check_telemetry(const char *json) {
+    static CLIENT_T client;
+    RESPONSE_T response;
+    char expected[STATIC_PAGE_HEADER_SIZE];
+    int len = snprintf(expected, sizeof(expected), HTTP_RESPONSE_JSON_HEADERS HTTP_CONNECTION_CLOSE, (int)strlen(json));
+
+    CHECK(client_connect(&client));
+    CHECK_EQ(host_tcp_deliver_str(client.pcb, TELEMETRY_REQUEST), ERR_OK);
+    CHECK(client_response(&client, &response));
+    CHECK_EQ(response.status, 200);
+    CHECK_EQ(response.headers_len, len);
+    CHECK(strcmp(response.headers, expected) == 0);
+    CHECK_EQ(response.body_len, strlen(json));
+    CHECK(memcmp(response.body, json, strlen(json)) == 0);
+    CHECK(!host_tcp_open(client.pcb));
+}
+
+// Assinantes de `/events`, limite de assinantes, amostras perdidas por assinantes ocupados e eventos vazios
+static void test_live_feed(void) {
+    static CLIENT_T subscribers[TCP_MAX_SUBSCRIBERS], extra, slow;
+    static const char *samples[] = {
+        "{\"seq\":1,\"temperature\":25.50,\"unit\":\"C\"}",
+        "{\"seq\":2,\"temperature\":25.75,\"unit\":\"C\"}",
+        "{\"seq\":3,\"temperature\":26.00,\"unit\":\"C\"}",
+        "{\"seq\":4,\"temperature\":26.25,\"unit\":\"C\"}",
+        "{\"seq\":5,\"temperature\":26.50,\"unit\":\"C\"}",
+    };
+    RESPONSE_T response;
+    memset(&live_feed, 0, sizeof(live_feed));
+    server_open();
+
+    // Antes da primeira amostra: 204
+    CHECK(client_connect(&extra));
+    CHECK_EQ(host_tcp_deliver_str(extra.pcb, TELEMETRY_REQUEST), ERR_OK);
+    CHECK(client_response(&extra, &response));
+    check_response(&response, &no_content_page, false);
+
+    // Cabeçalhos do fluxo e intervalo de reconexão; o assinante seguinte ao limite recebe 503
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS; i++) {
+        CHECK(client_connect(&subscribers[i]));
+        CHECK_EQ(host_tcp_deliver_str(subscribers[i].pcb, EVENTS_REQUEST), ERR_OK);
+        check_stream(&subscribers[i], HTTP_RESPONSE_EVENT_STREAM HTTP_CONNECTION_CLOSE HTTP_EVENT_STREAM_START);
+        CHECK(host_tcp_open(subscribers[i].pcb));
+    }
+    CHECK(client_connect(&extra));
+    CHECK_EQ(host_tcp_deliver_str(extra.pcb, EVENTS_REQUEST), ERR_OK);
+    CHECK(client_response(&extra, &response));
+    check_response(&response, &unavailable_page, false);
+    CHECK(!host_tcp_open(extra.pcb));
+
+    // Cada amostra chega a todos os assinantes e a `/api/telemetry`
+    tcp_server_publish(samples[0], strlen(samples[0]));
+    CHECK_EQ(host_lwip_depth, 0);
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS; i++) check_stream(&subscribers[i], stream_event(1, samples[0]));
+    check_telemetry(samples[0]);
+    CHECK_EQ(live_feed.delivered, TCP_MAX_SUBSCRIBERS);
+
+    // Um assinante que ainda não confirmou a amostra anterior perde a seguinte
+    CLIENT_T *busy = &subscribers[TCP_MAX_SUBSCRIBERS - 1];
+    tcp_server_publish(samples[1], strlen(samples[1]));
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS - 1; i++) check_stream(&subscribers[i], stream_event(2, samples[1]));
+    tcp_server_publish(samples[2], strlen(samples[2]));
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS - 1; i++) check_stream(&subscribers[i], stream_event(3, samples[2]));
+    CHECK_EQ(live_feed.skipped, 1);
+    check_stream(busy, stream_event(2, samples[1]));
+    tcp_server_publish(samples[3], strlen(samples[3]));
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS; i++) check_stream(&subscribers[i], stream_event(4, samples[3]));
+    check_telemetry(samples[3]);
+
+    // Amostras vazias ou maiores que o buffer são ignoradas
+    char long_json[LIVE_JSON_SIZE + 1];
+    memset(long_json, '1', LIVE_JSON_SIZE);
+    tcp_server_publish(long_json, LIVE_JSON_SIZE);
+    tcp_server_publish("", 0);
+    CHECK_EQ(live_feed.seq, 4);
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS; i++) check_stream(&subscribers[i], "");
+
+    // Dados enviados por um assinante são descartados
+    CHECK_EQ(host_tcp_deliver_str(subscribers[0].pcb, "GET /config HTTP/1.1\r\n\r\n"), ERR_OK);
+    check_stream(&subscribers[0], "");
+    CHECK(host_tcp_open(subscribers[0].pcb));
+
+    // Resposta de `/api/telemetry` ainda não entregue ao lwIP quando a amostra muda: a conexão é fechada
+    host_tcp_snd_buf = 64;
+    CHECK(client_connect(&slow));
+    host_tcp_snd_buf = TCP_SND_BUF;
+    CHECK_EQ(host_tcp_deliver_str(slow.pcb, TELEMETRY_REQUEST), ERR_OK);
+    CHECK(host_tcp_open(slow.pcb));
+    tcp_server_publish(samples[4], strlen(samples[4]));
+    CHECK(!host_tcp_open(slow.pcb));
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS; i++) check_stream(&subscribers[i], stream_event(5, samples[4]));
+
+    // Assinante ocioso recebe um evento vazio; se nem ele for confirmado, a conexão é fechada
+    host_time_advance_ms(TCP_IDLE_TIMEOUT_S * 1000);
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS; i++) {
+        host_tcp_poll_now(subscribers[i].pcb);
+        CHECK(host_tcp_open(subscribers[i].pcb));
+    }
+    check_stream(&subscribers[0], HTTP_EVENT_HEARTBEAT);
+    host_time_advance_ms(TCP_IDLE_TIMEOUT_S * 1000);
+    for (int i = 0; i < TCP_MAX_SUBSCRIBERS; i++) host_tcp_poll_now(subscribers[i].pcb);
+    CHECK(host_tcp_open(subscribers[0].pcb));
+    CHECK(!host_tcp_open(busy->pcb));
+
+    // O slot liberado aceita um novo assinante
+    CHECK(client_connect(&extra));
+    CHECK_EQ(host_tcp_deliver_str(extra.pcb, EVENTS_REQUEST), ERR_OK);
+    check_stream(&extra, HTTP_RESPONSE_EVENT_STREAM HTTP_CONNECTION_CLOSE HTTP_EVENT_STREAM_START);
+    host_tcp_remote_close(extra.pcb);
+    host_tcp_remote_close(subscribers[0].pcb);
+    server_close();
+    memset(&live_feed, 0, sizeof(live_feed));
+}
+
+// ------------------------------ WebSocket (/ws) ------------------------------
+
+#define WS_REQUEST "GET /ws HTTP/1.1\r\nHost: 192.168.4.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n" \
+                   "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n"
+#define WS_ACCEPT "s3pPLMBiTxaQ9kYGzzhZRbK+xOo="   // Aceite da chave acima (exemplo da RFC 6455).
+
+/**
+ * @brief Cliente de `/ws`: a conexão e a cópia do display montada a partir das mensagens do espelho.
+ */
+typedef struct WS_CLIENT_T_ {
+    CLIENT_T client;              // Conexão.
+    uint8_t display[WS_FRAME_SIZE]; // Display reconstruído.
+    bool has_display;             // Já recebeu um quadro completo.
+    int keyframes;                // Quadros completos recebidos.
+    int deltas;                   // Mensagens de trechos alterados recebidas.
+} WS_CLIENT_T;
+
+// Monta um quadro do cliente (sempre mascarado, como exige a RFC 6455) e retorna o comprimento
+static size_t ws_frame(uint8_t first, const char *payload, size_t len, uint8_t *out) {
+    static const uint8_t mask[4] = { 0x37, 0xFA, 0x21, 0x3D };
+    assert(len < 126);
+    out[0] = first;
+    out[1] = 0x80 | len;
+    memcpy(out + 2, mask, 4);
+    for (size_t i = 0; i < len; i++) out[6 + i] = payload[i] ^ mask[i & 3];
+    return 6 + len;
+}
+
+static err_t ws_send(WS_CLIENT_T *ws, int opcode, const char *payload) {
+    uint8_t frame[6 + 125];
+    size_t len = ws_frame(0x80 | opcode, payload, strlen(payload), frame);
+    return host_tcp_deliver(ws->client.pcb, frame, len, 0);
+}
+
+/**
+ * @brief Retira de `client->in` o próximo quadro do servidor, se ele já chegou inteiro.
+ *
+ * @return O comprimento do payload, ou -1 se não há quadro completo.
+ */
+static int ws_read(CLIENT_T *client, int *opcode, uint8_t *payload, size_t max) {
+    const uint8_t *in = (const uint8_t *)client->in;
+    if (client->in_len < 2) return -1;
+    CHECK(in[0] & 0x80);                // Sempre um quadro só (FIN)
+    CHECK(!(in[1] & 0x80));             // O servidor não mascara
+    size_t header = 2, len = in[1] & 0x7F;
+    CHECK(len != 127);                  // Mensagens do espelho têm menos de 64 KiB
+    if (len == 126) {
+        if (client->in_len < 4) return -1;
+        header = 4;
+        len = (size_t)in[2] << 8 | in[3];
+        CHECK(len >= 126);              // Comprimento na menor forma
+    }
+    CHECK(len <= max);
+    if (client->in_len < header + len) return -1;
+    *opcode = in[0] & 0x0F;
+    memcpy(payload, in + header, len);
+    client->in_len -= header + len;
+    memmove(client->in, client->in + header + len, client->in_len);
+    return (int)len;
+}
+
+// Aplica as mensagens do espelho recebidas ao display do cliente
+static void ws_receive_mirror(WS_CLIENT_T *ws) {
+    static uint8_t msg[1 + WS_FRAME_SIZE];
+    int opcode, len;
+    client_pump(&ws->client);
+    while ((len = ws_read(&ws->client, &opcode, msg, sizeof(msg))) >= 0) {
+        CHECK_EQ(opcode, WS_OPCODE_BINARY);
+        if (len >= 1 && msg[0] == WS_MSG_KEYFRAME) {
+            CHECK_EQ(len, 1 + WS_FRAME_SIZE);
+            memcpy(ws->display, msg + 1, WS_FRAME_SIZE);
+            ws->has_display = true;
+            ws->keyframes++;
+        } else if (len >= 1 && msg[0] == WS_MSG_DELTA) {
+            // Trechos só depois de um quadro completo, e menores que ele
+            CHECK(ws->has_display);
+            CHECK(len < 1 + WS_FRAME_SIZE);
+            for (int i = 1; i + 3 <= len;) {
+                int offset = msg[i] << 8 | msg[i + 1], run = msg[i + 2];
+                CHECK(run > 0 && offset + run <= WS_FRAME_SIZE && i + 3 + run <= len);
+                if (run == 0 || offset + run > WS_FRAME_SIZE || i + 3 + run > len) break;
+                memcpy(ws->display + offset, msg + i + 3, run);
+                i += 3 + run;
+            }
+            ws->deltas++;
+        } else {
+            CHECK(false);
+        }
+    }
+}
+
+static bool ws_connect(WS_CLIENT_T *ws) {
+    RESPONSE_T response;
+    memset(ws, 0, sizeof(*ws));
+    if (!client_connect(&ws->client)) return false;
+    CHECK_EQ(host_tcp_deliver_str(ws->client.pcb, WS_REQUEST), ERR_OK);
+    if (!client_response(&ws->client, &response)) return false;
+    CHECK_EQ(response.status, 101);
+    CHECK(strcmp(response.headers, HTTP_RESPONSE_WS_UPGRADE WS_ACCEPT HTTP_WS_UPGRADE_END) == 0);
+    return response.status == 101 && host_tcp_open(ws->client.pcb);
+}
+
+// Handshake, comandos do cliente, quadros não suportados, ping e fechamento
+static void test_websocket(void) {
+    static WS_CLIENT_T ws, other;
+    static CLIENT_T extra;
+    RESPONSE_T response;
+    uint8_t payload[8], event;
+    int opcode;
+    memset(&ws_mirror, 0, sizeof(ws_mirror));
+    memset(&ws_input, 0, sizeof(ws_input));
+    server_open();
+
+    // Pedidos de upgrade incompletos: 400
+    static const char *bad[] = {
+        "GET /ws HTTP/1.1\r\nHost: 192.168.4.1\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n",
+        "GET /ws HTTP/1.1\r\nHost: 192.168.4.1\r\nUpgrade: websocket\r\n\r\n",
+        "GET /ws HTTP/1.1\r\nHost: 192.168.4.1\r\nUpgrade: websocket\r\nSec-WebSocket-Key: curta\r\n\r\n",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        CHECK(client_connect(&extra));
+        CHECK_EQ(host_tcp_deliver_str(extra.pcb, bad[i]), ERR_OK);
+        CHECK(client_response(&extra, &response));
+        check_response(&response, &bad_request_page, false);
+        CHECK(!host_tcp_open(extra.pcb));
+    }
+    CHECK_EQ(ws_mirror.clients, 0);
+
+    // Upgrade com o aceite da RFC 6455; os clientes dividem o limite com os assinantes de `/events`
+    CHECK(ws_connect(&ws));
+    CHECK(ws_connect(&other));
+    CHECK_EQ(ws_mirror.clients, 2);
+    CHECK(client_connect(&extra));
+    CHECK_EQ(host_tcp_deliver_str(extra.pcb, WS_REQUEST), ERR_OK);
+    CHECK(client_response(&extra, &response));
+    check_response(&response, &unavailable_page, false);
+    CHECK_EQ(ws_mirror.clients, 2);
+
+    // Comandos na ordem, inclusive com o quadro cortado byte a byte; os demais quadros são ignorados
+    CHECK_EQ(ws_send(&ws, WS_OPCODE_TEXT, "up"), ERR_OK);
+    CHECK_EQ(ws_send(&ws, WS_OPCODE_TEXT, "left"), ERR_OK);
+    CHECK_EQ(ws_send(&ws, 0xA, ""), ERR_OK);                   // Pong
+    uint8_t frame[16];
+    size_t len = ws_frame(0x80 | WS_OPCODE_TEXT, "enter", 5, frame);
+    for (size_t i = 0; i < len; i++) CHECK_EQ(host_tcp_deliver(ws.client.pcb, frame + i, 1, 0), ERR_OK);
+    CHECK_EQ(ws_send(&other, WS_OPCODE_TEXT, "down"), ERR_OK);
+    CHECK(ws_input_pop(&event) && event == WS_INPUT_UP);
+    CHECK(ws_input_pop(&event) && event == WS_INPUT_ENTER);
+    CHECK(ws_input_pop(&event) && event == WS_INPUT_DOWN);
+    CHECK(!ws_input_pop(&event));
+    CHECK_EQ(ws.client.pcb->out_len - ws.client.pcb->out_read, 0);
+
+    // Fila cheia: os comandos seguintes são descartados até o laço principal esvaziá-la
+    for (int i = 0; i < WS_INPUT_QUEUE_SIZE + 2; i++) CHECK_EQ(ws_send(&ws, WS_OPCODE_TEXT, "down"), ERR_OK);
+    CHECK_EQ(ws_input.dropped, 2);
+    for (int i = 0; i < WS_INPUT_QUEUE_SIZE; i++) CHECK(ws_input_pop(&event) && event == WS_INPUT_DOWN);
+    CHECK(!ws_input_pop(&event));
+
+    // Cliente ocioso recebe um ping
+    host_time_advance_ms(TCP_IDLE_TIMEOUT_S * 1000);
+    host_tcp_poll_now(ws.client.pcb);
+    client_pump(&ws.client);
+    CHECK_EQ(ws_read(&ws.client, &opcode, payload, sizeof(payload)), 0);
+    CHECK_EQ(opcode, WS_OPCODE_PING);
+    CHECK(host_tcp_open(ws.client.pcb));
+
+    // Fechamento pelo cliente: o servidor responde com outro quadro de fechamento e encerra
+    CHECK_EQ(ws_send(&ws, WS_OPCODE_CLOSE, ""), ERR_OK);
+    CHECK_EQ(ws_mirror.clients, 1);
+    client_pump(&ws.client);
+    CHECK_EQ(ws_read(&ws.client, &opcode, payload, sizeof(payload)), 0);
+    CHECK_EQ(opcode, WS_OPCODE_CLOSE);
+    CHECK(!host_tcp_open(ws.client.pcb));
+
+    // Quadro sem máscara ou fragmentado fecha a conexão
+    uint8_t unmasked[] = { 0x80 | WS_OPCODE_TEXT, 2, 'u', 'p' };
+    CHECK_EQ(host_tcp_deliver(other.client.pcb, unmasked, sizeof(unmasked), 0), ERR_OK);
+    CHECK(!host_tcp_open(other.client.pcb));
+    CHECK(ws_connect(&other));
+    CHECK_EQ(host_tcp_deliver(other.client.pcb, frame, len, 0), ERR_OK);
+    CHECK(ws_input_pop(&event) && event == WS_INPUT_ENTER);
+    frame[0] &= 0x7F;                   // Sem FIN
+    CHECK_EQ(host_tcp_deliver(other.client.pcb, frame, len, 0), ERR_OK);
+    CHECK(!host_tcp_open(other.client.pcb));
+    CHECK(!ws_input_pop(&event));
+    CHECK_EQ(ws_mirror.clients, 0);
+    server_close();
+}
+
+// Espelho do display: quadro completo para clientes novos ou atrasados, trechos para os demais
+static void test_mirror(void) {
+    static WS_CLIENT_T clients[TCP_MAX_SUBSCRIBERS];
+    static uint8_t frame[WS_FRAME_SIZE];
+    unsigned long rounds = host_test_iterations(20000) / 10;
+    memset(&ws_mirror, 0, sizeof(ws_mirror));
+    memset(frame, 0, sizeof(frame));
+    server_open();
+
+    // Sem clientes não há trabalho (nem a trava do lwIP)
+    tcp_server_mirror_display(frame);
+    CHECK(!ws_mirror.valid);
+    CHECK_EQ(host_lwip_depth, 0);
+
+    CHECK(ws_connect(&clients[0]));
+    tcp_server_mirror_display(frame);
+    ws_receive_mirror(&clients[0]);
+    CHECK_EQ(clients[0].keyframes, 1);
+    CHECK(memcmp(clients[0].display, frame, WS_FRAME_SIZE) == 0);
+
+    // Antes do intervalo mínimo, ou sem mudança no display, nada é enviado
+    frame[10] = 0xFF;
+    tcp_server_mirror_display(frame);
+    CHECK_EQ(clients[0].client.pcb->out_len - clients[0].client.pcb->out_read, 0);
+    host_time_advance_ms(WS_FRAME_INTERVAL_MS);
+    tcp_server_mirror_display(frame);
+    ws_receive_mirror(&clients[0]);
+    CHECK_EQ(clients[0].deltas, 1);
+    host_time_advance_ms(WS_FRAME_INTERVAL_MS);
+    tcp_server_mirror_display(frame);
+    CHECK_EQ(clients[0].client.pcb->out_len - clients[0].client.pcb->out_read, 0);
+
+    // Um segundo cliente recebe o quadro completo mesmo sem mudança no display
+    CHECK(ws_connect(&clients[1]));
+    host_time_advance_ms(WS_FRAME_INTERVAL_MS);
+    tcp_server_mirror_display(frame);
+    ws_receive_mirror(&clients[1]);
+    CHECK_EQ(clients[1].keyframes, 1);
+    CHECK_EQ(clients[0].client.pcb->out_len - clients[0].client.pcb->out_read, 0);
+
+    // Mudanças aleatórias; cada cliente confirma (ou não) os quadros em ritmos diferentes
+    bool idle[TCP_MAX_SUBSCRIBERS];
+    for (int c = 0; c < TCP_MAX_SUBSCRIBERS; c++) idle[c] = true;
+    for (unsigned long round = 0; round < rounds; round++) {
+        switch (host_test_rand() % 4) {
+        case 0:                         // Tela nova
+            for (int i = 0; i < WS_FRAME_SIZE; i++) frame[i] = host_test_rand();
+            break;
+        case 1:                         // Cursor: uma linha de 128 bytes
+            memset(frame + 128 * (host_test_rand() % 8), host_test_rand(), 128);
+            break;
+        case 2:                         // Alguns bytes espalhados
+            for (int n = 1 + host_test_rand() % 40; n > 0; n--) frame[host_test_rand() % WS_FRAME_SIZE] ^= 1 << host_test_rand() % 8;
+            break;
+        default:                        // Sem mudança
+            break;
+        }
+        host_time_advance_ms(WS_FRAME_INTERVAL_MS);
+        tcp_server_mirror_display(frame);
+        CHECK_EQ(host_lwip_depth, 0);
+
+        for (int c = 0; c < TCP_MAX_SUBSCRIBERS; c++) {
+            if (host_test_rand() % (c + 2) == 0) {
+                idle[c] = false;        // Ainda não confirmou
+                continue;
+            }
+            ws_receive_mirror(&clients[c]);
+            // Cliente que já tinha confirmado tudo recebe o quadro atual (completo ou em trechos)
+            if (idle[c]) CHECK(memcmp(clients[c].display, frame, WS_FRAME_SIZE) == 0);
+            idle[c] = true;
+        }
+    }
+
+    // Com todos os quadros confirmados, os clientes convergem para o display atual
+    for (int step = 0; step < 2; step++) {
+        host_time_advance_ms(WS_FRAME_INTERVAL_MS);
+        tcp_server_mirror_display(frame);
+        for (int c = 0; c < TCP_MAX_SUBSCRIBERS; c++) ws_receive_mirror(&clients[c]);
+    }
+    for (int c = 0; c < TCP_MAX_SUBSCRIBERS; c++) {
+        CHECK(memcmp(clients[c].display, frame, WS_FRAME_SIZE) == 0);
+        CHECK(host_tcp_open(clients[c].client.pcb));
+        CHECK(clients[c].deltas > 0);
+        host_tcp_remote_close(clients[c].client.pcb);
+    }
+    CHECK(ws_mirror.skipped > 0);
+    CHECK_EQ(ws_mirror.clients, 0);
+    fprintf(stderr, "espelho: %lu quadros, %lu completos, %lu de trechos, %lu perdidos por clientes ocupados\n", rounds,
+            (unsigned long)ws_mirror.keyframes, (unsigned long)ws_mirror.deltas, (unsigned long)ws_mirror.skipped);
+    server_close();
+    memset(&ws_mirror, 0, sizeof(ws_mirror));
+}
+
+int main(void) {
+    host_test_quiet(true);
+    test_splits();
+    test_every_cut();
+    test_limits();
+    test_zero_copy();
+    test_page_variants();
+    test_routes();
+    test_probes();
+    test_random();
+    test_parallel();
+    test_load();
+    test_keep_alive();
+    test_pipeline_random();
+    test_round_trips();
+    test_live_feed();
+    test_websocket();
+    test_mirror();
+    host_test_quiet(false);
+    CHECK_EQ(host_net_misuse, 0);
+    return host_test_report("test_http_server");
+}
@@ -0,0 +1,289 @@
+/******************************************************************************
+ * @file    test_log_ring.c
+ * @brief   Teste do registro binário (log_ring.h) e do decodificador
+ *          tools/log_decode.py.
+ *
+ * @note    Os registros são gravados pelas macros `LOG_<NIVEL>` e enviados por
+ *          `log_drain` para um arquivo, como se fosse o console USB. Cada linha
+ *          `#L` é conferida campo a campo e, no fim, o arquivo passa pelo
+ *          decodificador. As strings de formato ficam em uma única estrutura,
+ *          gravada como a seção de um ELF32 mínimo no endereço (de 32 bits) em
+ *          que o registro as vê, para que o decodificador as encontre como
+ *          encontraria na flash do firmware.
+ ******************************************************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "log_ring.h"
+
+#define CAPTURE_PATH "test_log_ring.capture"    // Saída de `log_drain` (diretório do teste).
+#define ELF_PATH "test_log_ring.elf"            // ELF com as strings de formato.
+
+// Strings de formato e uma string "na flash" usada como argumento `%s` inteiro
+static const struct {
+    char integers[40];
+    char text[40];
+    char flash_arg[24];
+    char pointer[40];
+    char many[48];
+    char sequence[24];
+    char debug[24];
+} formats = {
+    "inteiros %d %u %x %c %%",
+    "texto [%s] [%s] [%s]",
+    "config.html",
+    "página %s de %d bytes; outro %s",
+    "%u %u %u %u %u %u %u %u",
+    "registro %u",
+    "depuração %u",
+};
+
+// ------------------------------ Captura do console ------------------------------
+
+/**
+ * @brief Executa `log_drain` `runs` vezes com a saída padrão acrescentada a `CAPTURE_PATH`.
+ */
+static void drain(int runs) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int fd = open(CAPTURE_PATH, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+    for (int i = 0; i < runs; i++) log_drain(NULL);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+static char lines[256][160];            // Linhas capturadas desde a última leitura.
+static int line_count;
+static long capture_offset;             // Bytes do arquivo já lidos.
+
+// Lê as linhas acrescentadas ao arquivo de captura desde a última leitura
+static int read_lines(void) {
+    FILE *f = fopen(CAPTURE_PATH, "r");
+    line_count = 0;
+    if (!f) return 0;
+    fseek(f, capture_offset, SEEK_SET);
+    while (line_count < 256 && fgets(lines[line_count], sizeof(lines[0]), f)) {
+        lines[line_count][strcspn(lines[line_count], "\n")] = '\0';
+        line_count++;
+    }
+    capture_offset = ftell(f);
+    fclose(f);
+    return line_count;
+}
+
+/**
+ * @brief Converte uma linha `#L<hex>` de volta no registro.
+ *
+ * @return O comprimento do registro enviado, ou -1 se a linha não é um registro.
+ */
+static int parse_record(const char *line, LOG_RECORD_T *record) {
+    if (strncmp(line, "#L", 2) != 0) return -1;
+    size_t hex_len = strlen(line + 2);
+    if (hex_len % 2 || hex_len / 2 > sizeof(*record)) return -1;
+    memset(record, 0xEE, sizeof(*record));
+    for (size_t i = 0; i < hex_len / 2; i++) {
+        unsigned byte;
+        if (sscanf(line + 2 + 2 * i, "%2x", &byte) != 1) return -1;
+        ((uint8_t *)record)[i] = byte;
+    }
+    return (int)(hex_len / 2);
+}
+
+static uint32_t addr(const void *p) {
+    return (uint32_t)(uintptr_t)p;
+}
+
+// ------------------------------ Cenários ------------------------------
+
+// Campos de cada tipo de registro
+static void test_records(void) {
+    LOG_RECORD_T record;
+    host_time_us = 1234567;
+
+    LOG_INFO(formats.integers, -5, 7u, 0xBEEFu, 'z');
+    LOG_WARN_S(formats.text, "abc", "", NULL);
+    LOG_ERROR_S(formats.text, "0123456789", "abcdefghij", "ABCDEFGHIJ");    // 33 bytes: truncado
+    LOG_DEBUG(formats.debug, 1u);       // Nível não compilado (LOG_LEVEL padrão é INFO)
+    log_write(LOG_LEVEL_INFO, formats.many, 8, 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u);
+    drain(1);
+    CHECK_EQ(read_lines(), 4);
+
+    CHECK_EQ(parse_record(lines[0], &record), offsetof(LOG_RECORD_T, args) + 4 * 4);
+    CHECK_EQ(record.timestamp_us, 1234567);
+    CHECK_EQ(record.fmt, addr(formats.integers));
+    CHECK_EQ(record.level, LOG_LEVEL_INFO);
+    CHECK_EQ(record.core, 0);
+    CHECK_EQ(record.size, 4);
+    CHECK_EQ(record.flags, 0);
+    CHECK_EQ((int32_t)record.args[0], -5);
+    CHECK_EQ(record.args[1], 7);
+    CHECK_EQ(record.args[2], 0xBEEF);
+    CHECK_EQ(record.args[3], 'z');
+
+    // Strings copiadas, cada uma terminada em NUL (NULL vira uma string vazia)
+    CHECK_EQ(parse_record(lines[1], &record), offsetof(LOG_RECORD_T, args) + 6);
+    CHECK_EQ(record.level, LOG_LEVEL_WARN);
+    CHECK_EQ(record.flags, LOG_FLAG_TEXT);
+    CHECK_EQ(record.size, 6);
+    CHECK(memcmp(record.text, "abc\0\0\0", 6) == 0);
+
+    // A última string que não cabe é truncada e o texto ocupa o registro inteiro
+    CHECK_EQ(parse_record(lines[2], &record), offsetof(LOG_RECORD_T, args) + LOG_MAX_ARGS * 4);
+    CHECK_EQ(record.size, LOG_MAX_ARGS * 4);
+    CHECK(memcmp(record.text, "0123456789\0abcdefghij\0A\0", LOG_MAX_ARGS * 4) == 0);
+
+    // Argumentos além de LOG_MAX_ARGS são ignorados
+    CHECK_EQ(parse_record(lines[3], &record), offsetof(LOG_RECORD_T, args) + LOG_MAX_ARGS * 4);
+    CHECK_EQ(record.size, LOG_MAX_ARGS);
+    for (int i = 0; i < LOG_MAX_ARGS; i++) CHECK_EQ(record.args[i], i + 1);
+}
+
+// Buffer cheio, envio em lotes e os dois núcleos
+static void test_overflow(void) {
+    LOG_RECORD_T record;
+    const int extra = 5;
+
+    // Núcleo 0 transborda; núcleo 1 registra alguns
+    for (uint32_t i = 0; i < LOG_RING_SIZE + extra; i++) LOG_INFO(formats.sequence, i);
+    host_core_num = 1;
+    for (uint32_t i = 0; i < 3; i++) LOG_WARN(formats.sequence, 1000 + i);
+    host_core_num = 0;
+    CHECK_EQ(log_rings[0].dropped, extra);
+    CHECK_EQ(log_rings[0].head - log_rings[0].tail, LOG_RING_SIZE);
+
+    // Uma execução: o aviso de descarte e `LOG_DRAIN_BATCH` registros, na ordem
+    drain(1);
+    CHECK_EQ(read_lines(), 1 + LOG_DRAIN_BATCH);
+    char expected[64];
+    snprintf(expected, sizeof(expected), "Log: %d registros descartados (núcleo 0)", extra);
+    CHECK(strcmp(lines[0], expected) == 0);
+    for (int i = 0; i < LOG_DRAIN_BATCH; i++) {
+        CHECK(parse_record(lines[1 + i], &record) > 0);
+        CHECK_EQ(record.args[0], i);
+    }
+
+    // Espaço liberado aceita novos registros; o restante sai nas execuções seguintes,
+    // os do núcleo 0 antes dos do núcleo 1
+    LOG_INFO(formats.sequence, (uint32_t)(LOG_RING_SIZE + extra));
+    CHECK_EQ(log_rings[0].dropped, extra);
+    drain(LOG_RING_SIZE / LOG_DRAIN_BATCH + 1);
+    read_lines();
+    uint32_t next = LOG_DRAIN_BATCH, core1 = 1000;
+    int records = 0;
+    for (int i = 0; i < line_count; i++) {
+        CHECK(parse_record(lines[i], &record) > 0);
+        records++;
+        if (record.core == 0) {
+            CHECK_EQ(core1, 1000);      // Núcleo 1 só depois de esvaziar o núcleo 0 no mesmo lote
+            if (record.args[0] == LOG_RING_SIZE + extra) continue;
+            CHECK_EQ(record.args[0], next);
+            next++;
+        } else {
+            CHECK_EQ(record.core, 1);
+            CHECK_EQ(record.level, LOG_LEVEL_WARN);
+            CHECK_EQ(record.args[0], core1);
+            core1++;
+        }
+    }
+    CHECK_EQ(next, LOG_RING_SIZE);
+    CHECK_EQ(core1, 1003);
+    CHECK_EQ(records, LOG_RING_SIZE - LOG_DRAIN_BATCH + 1 + 3);
+    for (int core = 0; core < 2; core++) CHECK_EQ(log_rings[core].head, log_rings[core].tail);
+
+    // O mesmo descarte não é informado de novo
+    drain(1);
+    CHECK_EQ(read_lines(), 0);
+}
+
+// ------------------------------ Decodificador ------------------------------
+
+/**
+ * @brief Grava um ELF32 little-endian com uma única seção (`formats`) no endereço de 32 bits dela.
+ */
+static void write_elf(void) {
+    uint8_t header[52] = { 0x7F, 'E', 'L', 'F', 1, 1, 1 };     // ELFCLASS32, ELFDATA2LSB
+    uint8_t sections[2][40] = { { 0 } };                       // SHT_NULL e a seção das strings
+    uint32_t data_offset = sizeof(header);
+    uint32_t shoff = data_offset + sizeof(formats);
+    uint32_t section[6] = { 0, 1, 0x2, addr(&formats), data_offset, sizeof(formats) }; // PROGBITS, ALLOC
+    uint16_t sizes[2] = { sizeof(sections[0]), 2 };
+
+    memcpy(header + 0x20, &shoff, 4);
+    memcpy(header + 0x2E, sizes, 4);
+    memcpy(sections[1], section, sizeof(section));
+
+    FILE *f = fopen(ELF_PATH, "wb");
+    assert(f);
+    fwrite(header, sizeof(header), 1, f);
+    fwrite(&formats, sizeof(formats), 1, f);
+    fwrite(sections, sizeof(sections), 1, f);
+    fclose(f);
+}
+
+// Registros decodificados no computador, com linhas de texto comuns no meio
+static void test_decode(void) {
+    static const char *expected[] = {
+        "[     2.000001] c0 I inteiros -5 7 beef z %",
+        "inicializando...",
+        "[     2.000001] c0 W texto [abc] [] []",
+        "[     2.000001] c0 I página config.html de 4096 bytes; outro <0x00000010>",
+        "[     2.000001] c1 E texto [0123456789] [abcdefghij] [A]",     // Núcleo 1 sai depois do núcleo 0
+        "linha com #L no meio",
+        "#Lzz  (registro inválido: ",   // Seguido da mensagem do Python (só o início é conferido)
+    };
+    host_time_us = 2000001;
+    LOG_INFO(formats.integers, -5, 7u, 0xBEEFu, 'z');
+    drain(1);
+    FILE *f = fopen(CAPTURE_PATH, "a");
+    fputs("inicializando...\n", f);
+    fclose(f);
+    LOG_WARN_S(formats.text, "abc", "", NULL);
+    host_core_num = 1;
+    LOG_ERROR_S(formats.text, "0123456789", "abcdefghij", "ABCDEFGHIJ");
+    host_core_num = 0;
+    LOG_INFO(formats.pointer, addr(formats.flash_arg), 4096, 0x10u);
+    drain(1);
+    f = fopen(CAPTURE_PATH, "a");
+    fputs("linha com #L no meio\n#Lzz\n", f);
+    fclose(f);
+    write_elf();
+
+    char command[1024], line[256];
+    snprintf(command, sizeof(command), "\"%s\" \"%s\" %s %s", PYTHON_EXECUTABLE, LOG_DECODE_SCRIPT, ELF_PATH, CAPTURE_PATH);
+    FILE *decoder = popen(command, "r");
+    CHECK(decoder != NULL);
+    if (!decoder) return;
+
+    // As linhas dos cenários anteriores vêm antes: só as últimas são conferidas
+    static char decoded[512][256];
+    int count = 0;
+    while (count < 512 && fgets(line, sizeof(line), decoder)) {
+        line[strcspn(line, "\n")] = '\0';
+        strcpy(decoded[count++], line);
+    }
+    CHECK_EQ(pclose(decoder), 0);
+
+    int n = sizeof(expected) / sizeof(expected[0]);
+    CHECK(count >= n);
+    for (int i = 0; i < n && count >= n; i++) {
+        const char *got = decoded[count - n + i];
+        size_t len = i == n - 1 ? strlen(expected[i]) : sizeof(decoded[0]);
+        if (strncmp(got, expected[i], len) != 0) {
+            CHECK(strncmp(got, expected[i], len) == 0);
+            fprintf(stderr, "  obtido:   %s\n  esperado: %s\n", got, expected[i]);
+        }
+    }
+}
+
+int main(void) {
+    unlink(CAPTURE_PATH);
+    test_records();
+    test_overflow();
+    test_decode();
+    return host_test_report("test_log_ring");
+}
@@ -0,0 +1,505 @@
+/******************************************************************************
+ * @file    test_mqtt_uplink.c
+ * @brief   Teste da sessão MQTT (mqtt_uplink.h) e da publicação das amostras
+ *          pelo serviço de rede (net_service.h) contra um broker simulado.
+ *
+ * @note    O teste faz o papel do broker sobre o cliente MQTT simulado
+ *          (host_net): aceita ou recusa o CONNECT, confirma ou falha as
+ *          publicações e derruba a sessão. Cada amostra leva um número de
+ *          série na temperatura; no fim, todas as amostras postadas devem ter
+ *          saído exatamente uma vez, pelo broker ou pelo lote HTTP (atendido
+ *          por um servidor mínimo), sem quebrar a ordem de cada caminho.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "host_flash.h"
+#include "host_text.h"
+#include "host_net.h"
+#include "ap_mode_utility.h"
+#include "hardware/adc.h"
+#include "menu/icons.h"
+#include "net_service.h"
+
+// ------------------------------ Amostras ------------------------------
+
+#define MAX_SAMPLES 20000               // Amostras postadas por cenário.
+
+static uint8_t seen[MAX_SAMPLES];       // Vezes em que cada amostra saiu (broker ou lote HTTP).
+static uint32_t posted_count = 0;       // Amostras postadas.
+static uint32_t mqtt_count = 0;         // Amostras publicadas no broker.
+static uint32_t http_count = 0;         // Amostras enviadas em lotes HTTP.
+static long last_mqtt_id = -1;          // Última amostra vista pelo broker.
+static long last_http_id = -1;          // Última amostra vista pelo servidor HTTP.
+static uint32_t mqtt_confirmed = 0;     // Publicações confirmadas pelo broker.
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Número de série da amostra: a temperatura, em centésimos
+static float sample_temperature(uint32_t id) { return id / 100.0f; }
+static float sample_lat(uint32_t id) { return -23.5f + (id % 997) * 0.0001f; }
+static float sample_lon(uint32_t id) { return -46.6f - (id % 991) * 0.0001f; }
+
+static bool post_sample(void) {
+    assert(posted_count < MAX_SAMPLES);
+    uint32_t id = posted_count;
+    if (!net_post_sample(sample_temperature(id), sample_lat(id), sample_lon(id), time_us_64())) return false;
+    posted_count++;
+    return true;
+}
+
+// Registra a saída de uma amostra por um caminho e confere a ordem dentro dele
+static void sample_out(int32_t id, long *last, uint32_t *count) {
+    CHECK(id >= 0 && (uint32_t)id < posted_count);
+    if (id < 0 || (uint32_t)id >= posted_count) return;
+    CHECK(id > *last);
+    *last = id;
+    seen[id]++;
+    (*count)++;
+}
+
+static void reset_all(void) {
+    host_net_reset();
+    host_flash_reset();
+    flash_queue_init();
+    memset(&telemetry_ring, 0, sizeof(telemetry_ring));
+    telemetry_inflight_count = 0;
+    memset(&http_client, 0, sizeof(http_client));
+    http_request_pending = false;
+    http_request_ok = false;
+    if (mqtt_uplink.client) mqtt_client_free(mqtt_uplink.client);
+    memset(&mqtt_uplink, 0, sizeof(mqtt_uplink));
+    memset(&net_service, 0, sizeof(net_service));
+    uplink_mode = UPLINK_MQTT;
+    start_wifi = 1;
+    wifi_link_ok = true;
+    memset(seen, 0, sizeof(seen));
+    posted_count = mqtt_count = http_count = mqtt_confirmed = 0;
+    last_mqtt_id = last_http_id = -1;
+}
+
+// ------------------------------ Broker simulado ------------------------------
+
+// Confere tópico e payload de uma publicação e retorna a amostra, ou -1
+static int32_t broker_parse(const HOST_MQTT_PUBLISH_T *publish) {
+    CHECK(strcmp(publish->topic, "channels/2838403/publish") == 0);
+    CHECK_EQ(publish->qos, MQTT_QOS);
+    CHECK_EQ(publish->len, strlen(publish->payload));
+
+    int32_t values[3];
+    const char *p = publish->payload, *end = publish->payload + publish->len;
+    bool valid = take(&p, end, "field1=") && take_fixed(&p, end, 2, &values[0])
+              && take(&p, end, "&field2=") && take_fixed(&p, end, 6, &values[1])
+              && take(&p, end, "&field3=") && take_fixed(&p, end, 6, &values[2])
+              && p == end;
+    CHECK(valid);
+    if (!valid) {
+        fprintf(stderr, "  payload: \"%s\"\n", publish->payload);
+        return -1;
+    }
+
+    int32_t id = values[0];
+    if (id >= 0 && (uint32_t)id < posted_count) {
+        CHECK_EQ(values[1], float_to_fixed(sample_lat(id), 6));
+        CHECK_EQ(values[2], float_to_fixed(sample_lon(id), 6));
+    }
+    return id;
+}
+
+/**
+ * @brief Entrega as publicações pendentes no broker.
+ *
+ * @param err Resultado informado ao cliente (ERR_OK ou uma falha).
+ * @return int Quantidade de publicações entregues.
+ */
+static int broker_deliver(err_t err) {
+    HOST_MQTT_PUBLISH_T publishes[HOST_MQTT_MAX_PUBLISH];
+    if (!mqtt_uplink.client) return 0;
+    int count = host_mqtt_deliver(mqtt_uplink.client, err, publishes, HOST_MQTT_MAX_PUBLISH);
+    for (int i = 0; i < count; i++) {
+        sample_out(broker_parse(&publishes[i]), &last_mqtt_id, &mqtt_count);
+    }
+    if (err == ERR_OK) mqtt_confirmed += count;
+    return count;
+}
+
+// ------------------------------ Servidor HTTP mínimo ------------------------------
+
+static struct tcp_pcb *http_served = NULL;      // Última conexão atendida.
+
+// Atende o lote HTTP pendente (amostras que não foram pelo broker) e retorna as entradas
+static int http_serve(void) {
+    struct tcp_pcb *pcb = host_tcp_last();
+    if (!pcb || pcb == http_served || pcb->state != SYN_SENT) return 0;
+    http_served = pcb;
+    CHECK_EQ(host_tcp_connect_done(pcb), ERR_OK);
+
+    static char request[4096];
+    size_t len = host_tcp_read(pcb, request, sizeof(request));
+    const char *end = request + len;
+    int entries = 0;
+    for (const char *p = request; (p = find(p, end, "\"field1\":")) != NULL; entries++) {
+        p += 9;
+        int32_t id;
+        CHECK(take_fixed(&p, end, 2, &id));
+        sample_out(id, &last_http_id, &http_count);
+    }
+    host_tcp_ack_all(pcb);
+    host_tcp_deliver_str(pcb, "HTTP/1.1 202 Accepted\r\nContent-Length: 16\r\n\r\n{\"success\":true}");
+    CHECK(!host_tcp_open(pcb));
+    CHECK(http_request_ok);
+    return entries;
+}
+
+// Uma rodada do serviço de rede (com o lwIP travado, como no firmware)
+static void service_poll(void) {
+    net_service_poll();
+    CHECK_EQ(host_lwip_depth, 0);
+}
+
+// Sessão aberta: cliente criado, CONNECT enviado e aceito
+static void open_session(void) {
+    service_poll();
+    CHECK(mqtt_uplink.client != NULL && mqtt_uplink.client->connecting);
+    host_mqtt_connack(mqtt_uplink.client, MQTT_CONNECT_ACCEPTED);
+    CHECK(mqtt_client_is_connected(mqtt_uplink.client));
+    CHECK(!mqtt_uplink.connecting);
+}
+
+// ------------------------------ Cenários ------------------------------
+
+static void test_connect(void) {
+    reset_all();
+
+    // Modo HTTP: nenhuma sessão
+    uplink_mode = UPLINK_HTTP;
+    service_poll();
+    CHECK(mqtt_uplink.client == NULL);
+    CHECK_EQ(host_dns_queries, 0);
+
+    // Sem conexão Wi-Fi: nenhuma tentativa
+    uplink_mode = UPLINK_MQTT;
+    wifi_link_ok = false;
+    service_poll();
+    CHECK(mqtt_uplink.client == NULL);
+    wifi_link_ok = true;
+
+    // CONNECT com o endereço resolvido, a porta 1883 e o keep-alive configurado
+    service_poll();
+    mqtt_client_t *client = mqtt_uplink.client;
+    CHECK(client != NULL);
+    if (!client) return;
+    CHECK_EQ(host_dns_queries, 1);
+    CHECK_EQ(client->connects, 1);
+    CHECK_EQ(client->port, 1883);
+    CHECK_EQ(client->broker_ip.addr, 0x04030201);
+    CHECK_EQ(client->info.keep_alive, MQTT_KEEP_ALIVE_S);
+    CHECK(strcmp(client->info.client_id, MQTT_CLIENT_ID) == 0);
+    CHECK(strcmp(client->info.client_user, MQTT_USERNAME) == 0);
+    CHECK(strcmp(client->info.client_pass, MQTT_PASSWORD) == 0);
+    CHECK(mqtt_uplink.connecting);
+
+    // Enquanto o CONNACK não chega, nada de novas tentativas
+    host_time_advance_ms(2 * MQTT_RETRY_MS);
+    service_poll();
+    CHECK_EQ(client->connects, 1);
+    CHECK_EQ(host_dns_queries, 1);
+
+    host_mqtt_connack(client, MQTT_CONNECT_ACCEPTED);
+    service_poll();
+    CHECK_EQ(client->connects, 1);
+    CHECK(mqtt_client_is_connected(client));
+}
+
+static void test_retry(void) {
+    reset_all();
+
+    // CONNECT recusado: a próxima tentativa espera MQTT_RETRY_MS desde a anterior
+    service_poll();
+    mqtt_client_t *client = mqtt_uplink.client;
+    CHECK(client != NULL);
+    if (!client) return;
+    host_time_advance_ms(1000);
+    host_mqtt_connack(client, MQTT_CONNECT_REFUSED_NOT_AUTHORIZED_);
+    CHECK(!mqtt_uplink.connecting);
+    host_time_advance_ms(MQTT_RETRY_MS - 1000 - 1);
+    service_poll();
+    CHECK_EQ(client->connects, 1);
+    host_time_advance_ms(1);
+    service_poll();
+    CHECK_EQ(client->connects, 2);
+    host_mqtt_connack(client, MQTT_CONNECT_ACCEPTED);
+
+    // Queda da sessão depois de muito tempo conectado: reconecta na hora
+    host_time_advance_ms(60000);
+    host_mqtt_drop(client);
+    service_poll();
+    CHECK_EQ(client->connects, 3);
+
+    // Broker sem resposta ao CONNECT (timeout do lwIP) e DNS com falhas
+    host_mqtt_connack(client, MQTT_CONNECT_TIMEOUT);
+    host_dns_mode = HOST_DNS_PENDING;
+    host_time_advance_ms(MQTT_RETRY_MS);
+    service_poll();
+    CHECK(mqtt_uplink.connecting);
+    unsigned long queries = host_dns_queries;
+    host_time_advance_ms(MQTT_RETRY_MS);
+    service_poll();
+    CHECK_EQ(host_dns_queries, queries);
+    CHECK(host_dns_answer(false));
+    CHECK(!mqtt_uplink.connecting);
+    CHECK_EQ(client->connects, 3);
+
+    host_dns_mode = HOST_DNS_FAIL;
+    host_time_advance_ms(MQTT_RETRY_MS);
+    service_poll();
+    CHECK(!mqtt_uplink.connecting);
+    CHECK_EQ(host_dns_queries, queries + 1);
+
+    // DNS de volta (resposta assíncrona): a sessão abre com o endereço resolvido
+    host_dns_mode = HOST_DNS_PENDING;
+    host_time_advance_ms(MQTT_RETRY_MS);
+    service_poll();
+    CHECK(host_dns_answer(true));
+    CHECK_EQ(client->connects, 4);
+    CHECK_EQ(client->broker_ip.addr, 0x04030201);
+    host_mqtt_connack(client, MQTT_CONNECT_ACCEPTED);
+    CHECK(mqtt_client_is_connected(client));
+
+    // Um `mqtt_client_connect` recusado na hora também libera a próxima tentativa
+    host_dns_mode = HOST_DNS_CACHED;
+    host_mqtt_drop(client);
+    client->connecting = true;            // O lwIP ainda fechando a conexão anterior
+    host_time_advance_ms(MQTT_RETRY_MS);
+    service_poll();
+    CHECK(!mqtt_uplink.connecting);
+    CHECK_EQ(client->connects, 4);
+    client->connecting = false;
+    host_time_advance_ms(MQTT_RETRY_MS);
+    service_poll();
+    CHECK_EQ(client->connects, 5);
+}
+
+static void test_publish(void) {
+    reset_all();
+    open_session();
+
+    // Cada amostra vira uma publicação no tópico do canal, com os três campos
+    for (int i = 0; i < 5; i++) CHECK(post_sample());
+    service_poll();
+    CHECK_EQ(broker_deliver(ERR_OK), 5);
+    CHECK_EQ(mqtt_uplink.published, 5);
+    CHECK_EQ(mqtt_uplink.failed, 0);
+    CHECK_EQ(telemetry_ring.count, 0);
+    CHECK_EQ(net_service.latency[NET_PATH_MQTT].count, 5);
+
+    // Publicação que falha depois de aceita (sem PUBACK, conexão perdida): só é contada
+    CHECK(post_sample());
+    service_poll();
+    CHECK_EQ(broker_deliver(ERR_TIMEOUT), 1);
+    CHECK_EQ(mqtt_uplink.failed, 1);
+
+    // Cliente sem memória para a mensagem: a amostra segue pelo lote HTTP
+    host_mqtt_publish_result = ERR_MEM;
+    CHECK(post_sample());
+    service_poll();
+    CHECK_EQ(mqtt_uplink.failed, 2);
+    CHECK_EQ(telemetry_ring.count, 1);
+    host_mqtt_publish_result = ERR_OK;
+
+    // Sessão derrubada: as amostras vão para o lote até a reconexão
+    host_mqtt_drop(mqtt_uplink.client);
+    for (int i = 0; i < 3; i++) CHECK(post_sample());
+    host_time_advance_ms(MQTT_RETRY_MS);
+    service_poll();
+    CHECK_EQ(telemetry_ring.count, 4);
+    CHECK(mqtt_uplink.connecting);
+    host_mqtt_connack(mqtt_uplink.client, MQTT_CONNECT_ACCEPTED);
+    CHECK(post_sample());
+    service_poll();
+    CHECK_EQ(broker_deliver(ERR_OK), 1);
+    CHECK_EQ(telemetry_ring.count, 4);
+
+    // O lote com as amostras que ficaram de fora sai pelo HTTP
+    host_time_advance_ms(TELEMETRY_BATCH_MAX_AGE_MS);
+    service_poll();
+    CHECK_EQ(http_serve(), 4);
+    service_poll();
+    CHECK_EQ(telemetry_ring.count, 0);
+    CHECK_EQ(mqtt_count + http_count, posted_count);
+}
+
+static void test_switch_to_http(void) {
+    reset_all();
+    open_session();
+    mqtt_client_t *client = mqtt_uplink.client;
+
+    // Ao voltar para HTTP, a sessão é encerrada e as amostras vão para o lote
+    uplink_mode = UPLINK_HTTP;
+    CHECK(post_sample());
+    service_poll();
+    CHECK_EQ(client->disconnects, 1);
+    CHECK(!mqtt_client_is_connected(client));
+    CHECK_EQ(client->inbox_count, 0);
+    CHECK_EQ(telemetry_ring.count, 1);
+
+    // Em modo HTTP, nenhuma reconexão
+    host_time_advance_ms(10 * MQTT_RETRY_MS);
+    service_poll();
+    CHECK_EQ(client->connects, 1);
+    CHECK_EQ(client->disconnects, 1);
+
+    // Um CONNACK atrasado depois da troca abre a sessão, que é encerrada na rodada seguinte
+    uplink_mode = UPLINK_MQTT;
+    service_poll();
+    CHECK_EQ(client->connects, 2);
+    uplink_mode = UPLINK_HTTP;
+    host_mqtt_connack(client, MQTT_CONNECT_ACCEPTED);
+    service_poll();
+    CHECK_EQ(client->disconnects, 2);
+    CHECK(!mqtt_client_is_connected(client));
+}
+
+// Caixa de mensagens entre a aplicação e o serviço de rede: limite, ordem na volta dos
+// contadores de 32 bits, ocupação máxima e latência da leitura do ADC até o segmento TCP
+static void test_mailbox(void) {
+    reset_all();
+    open_session();
+    net_service.head = net_service.tail = UINT32_MAX - 2;
+
+    for (int i = 0; i < NET_MAILBOX_SIZE; i++) CHECK(post_sample());
+    CHECK(!net_post_sample(-1.0f, 0.0f, 0.0f, time_us_64()));  // Caixa cheia: descartada
+    CHECK_EQ(net_service.posted, NET_MAILBOX_SIZE);
+    CHECK_EQ(net_service.dropped, 1);
+
+    host_time_advance_ms(7);
+    service_poll();
+    CHECK_EQ(net_service.tail, net_service.head);
+    CHECK_EQ(net_service.depth_max, NET_MAILBOX_SIZE);
+    CHECK_EQ(broker_deliver(ERR_OK), NET_MAILBOX_SIZE);     // Em ordem, sem a descartada
+    NET_LATENCY_T *latency = &net_service.latency[NET_PATH_MQTT];
+    CHECK_EQ(latency->count, NET_MAILBOX_SIZE);
+    CHECK_EQ(latency->min_us, 7000);
+    CHECK_EQ(latency->max_us, 7000);
+    CHECK_EQ(latency->sum_us, NET_MAILBOX_SIZE * 7000);
+
+    // Espaço liberado aceita novas amostras; o relatório zera a janela
+    CHECK(post_sample());
+    host_time_advance_ms(2);
+    service_poll();
+    CHECK_EQ(broker_deliver(ERR_OK), 1);
+    CHECK_EQ(latency->min_us, 2000);
+    CHECK_EQ(latency->max_us, 7000);
+    host_test_quiet(true);
+    net_service_report(NULL);
+    host_test_quiet(false);
+    CHECK_EQ(latency->count, 0);
+    CHECK_EQ(net_service.depth_max, 0);
+    CHECK_EQ(net_service.dropped, 1);
+}
+
+// ------------------------------ Execução aleatória ------------------------------
+
+static void test_random(void) {
+    unsigned long steps = host_test_iterations(50000);
+    reset_all();
+    host_test_quiet(true);
+
+    uint32_t next_sample_ms = now_ms();
+    uint32_t last_attempt_ms = 0;
+    uint32_t attempts = 0;
+    for (unsigned long step = 0; step < steps && posted_count + NET_MAILBOX_SIZE < MAX_SAMPLES; step++) {
+        // Uma amostra a cada 2 s, postada pela tarefa de amostragem
+        host_time_advance_ms(50 + host_test_rand() % 1000);
+        if ((int32_t)(now_ms() - next_sample_ms) >= 0) {
+            post_sample();
+            next_sample_ms += 2000;
+        }
+
+        // Troca de modo (as publicações já enviadas chegam ao broker antes do fim da sessão),
+        // falta de memória no cliente MQTT, DNS instável e quedas curtas da conexão Wi-Fi
+        uint32_t r = host_test_rand() % 1000;
+        if (r < 5) {
+            broker_deliver(ERR_OK);
+            uplink_mode = !uplink_mode;
+        } else if (r < 15) {
+            host_mqtt_publish_result = host_mqtt_publish_result == ERR_OK ? ERR_MEM : ERR_OK;
+        } else if (r < 25) {
+            uint32_t d = host_test_rand() % 8;
+            host_dns_mode = d == 0 ? HOST_DNS_FAIL : d < 3 ? HOST_DNS_PENDING : HOST_DNS_CACHED;
+        }
+        if (host_link_status == CYW43_LINK_UP ? r == 999 : r >= 970) {
+            host_link_status = host_link_status == CYW43_LINK_UP ? CYW43_LINK_DOWN : CYW43_LINK_UP;
+        }
+
+        service_poll();
+
+        // Tentativas de conexão (consulta ao DNS) espaçadas de pelo menos MQTT_RETRY_MS
+        if (mqtt_uplink.last_attempt_ms != last_attempt_ms) {
+            CHECK(attempts == 0 || mqtt_uplink.last_attempt_ms - last_attempt_ms >= MQTT_RETRY_MS);
+            last_attempt_ms = mqtt_uplink.last_attempt_ms;
+            attempts++;
+        }
+
+        // Papel do broker: responde ao CONNECT, confirma publicações e às vezes derruba a sessão
+        mqtt_client_t *client = mqtt_uplink.client;
+        if (client) {
+            uint32_t b = host_test_rand() % 100;
+            if (client->connecting && b < 60) {
+                host_mqtt_connack(client, b < 50 ? MQTT_CONNECT_ACCEPTED : MQTT_CONNECT_REFUSED_SERVER);
+            } else if (client->connected && b < 2) {
+                broker_deliver(ERR_OK);
+                host_mqtt_drop(client);
+            }
+            if (client->inbox_count && host_test_rand() % 3 == 0) {
+                broker_deliver(host_test_rand() % 10 ? ERR_OK : ERR_TIMEOUT);
+            }
+        }
+        host_dns_answer(host_test_rand() % 4 != 0);
+        http_serve();
+    }
+
+    // Publicações restantes confirmadas; depois, só HTTP até esvaziar o lote e a flash
+    broker_deliver(ERR_OK);
+    uplink_mode = UPLINK_HTTP;
+    host_link_status = CYW43_LINK_UP;
+    host_dns_mode = HOST_DNS_CACHED;
+    host_mqtt_publish_result = ERR_OK;
+    for (int i = 0; i < 5000 && (telemetry_ring.count || flash_queue.count || http_request_pending); i++) {
+        host_time_advance_ms(1000);
+        service_poll();
+        host_dns_answer(true);
+        http_serve();
+    }
+    host_test_quiet(false);
+
+    fprintf(stderr, "aleatório: %lu amostras, %lu pelo broker, %lu por HTTP, %lu tentativas de conexão\n",
+            (unsigned long)posted_count, (unsigned long)mqtt_count, (unsigned long)http_count,
+            (unsigned long)attempts);
+    CHECK(mqtt_count > 0 && http_count > 0);
+    CHECK_EQ(mqtt_count + http_count, posted_count);
+    unsigned long missing = 0, repeated = 0;
+    for (uint32_t id = 0; id < posted_count; id++) {
+        missing += seen[id] == 0;
+        repeated += seen[id] > 1;
+    }
+    CHECK_EQ(missing, 0);
+    CHECK_EQ(repeated, 0);
+    CHECK_EQ(mqtt_uplink.published, mqtt_confirmed);
+    CHECK(mqtt_uplink.failed >= mqtt_count - mqtt_confirmed);
+    CHECK_EQ(telemetry_ring.dropped, 0);
+    CHECK_EQ(flash_queue.dropped, 0);
+}
+
+int main(void) {
+    test_connect();
+    test_retry();
+    test_publish();
+    test_mailbox();
+    test_switch_to_http();
+    test_random();
+    CHECK_EQ(host_net_misuse, 0);
+    return host_test_report("test_mqtt_uplink");
+}
@@ -0,0 +1,195 @@
+/******************************************************************************
+ * @file    test_net_status.c
+ * @brief   Teste da amostragem do estado da rede (net_status.h) e da tela
+ *          Network Info (menu/menu.h), que usa apenas a amostra.
+ *
+ * @note    O rádio é o CYW43 simulado de host_net, que conta as leituras do
+ *          RSSI e do canal. As telas são renderizadas a cada 50 ms e a
+ *          amostragem roda a cada NET_STATUS_PERIOD_MS, como em main.c; o
+ *          histórico é conferido contra um modelo com amostras sorteadas.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "host_test.h"
+
+// Flash sem uso: a amostragem e a tela não leem nem gravam registros; qualquer gravação falha o teste
+static const uint8_t unused_sector[FLASH_SECTOR_SIZE];
+
+static bool no_flash_write(uint32_t offset) {
+    CHECK(false);
+    return false;
+}
+
+#define FLASH_QUEUE_READ_PTR(offset) unused_sector
+#define FLASH_QUEUE_ERASE(offset) no_flash_write(offset)
+#define FLASH_QUEUE_PROGRAM(offset, data) no_flash_write(offset)
+#define CRED_STORE_READ_PTR(offset) unused_sector
+#define CRED_STORE_ERASE(offset) no_flash_write(offset)
+#define CRED_STORE_PROGRAM(offset, data) no_flash_write(offset)
+
+#include "host_net.h"
+#include "ap_mode_utility.h"
+#include "menu/menu.h"
+
+#define FRAME_PERIOD_MS 50              // Período da renderização do menu (tarefa "display" de main.c).
+
+// ------------------------------ Auxiliares ------------------------------
+
+static uint8_t frame[SSD1306_BUFFER_SIZE];     // Último quadro entregue por `ssd1306_UpdateScreen`.
+static uint32_t frames = 0;                    // Quadros entregues.
+
+static void capture_frame(const uint8_t *buffer) {
+    memcpy(frame, buffer, sizeof(frame));
+    frames++;
+}
+
+static struct netif *sta_netif(void) {
+    return &cyw43_state.netif[CYW43_ITF_STA];
+}
+
+static void reset_all(void) {
+    host_net_reset();
+    memset(&net_status, 0, sizeof(net_status));
+    memset(&wifi_supervisor, 0, sizeof(wifi_supervisor));
+    wifi_connected_ms = 0;
+    IP4_ADDR(&sta_netif()->ip_addr, 192, 168, 1, 50);
+    IP4_ADDR(&sta_netif()->gw, 192, 168, 1, 1);
+}
+
+// Renderiza um quadro da tela Network Info (endereços ou gráfico do RSSI)
+static void render_network_info(int graph) {
+    inicialized = 1;
+    current_screen = 1;
+    item_selected = 3;
+    net_info_graph = graph;
+    uint32_t before = frames;
+    menu();
+    CHECK_EQ(frames, before + 1);
+    CHECK_EQ(host_lwip_depth, 0);
+}
+
+// ------------------------------ Cenários ------------------------------
+
+// Antes da primeira conexão: nenhuma amostra e nenhum acesso ao rádio
+static void test_before_connect(void) {
+    reset_all();
+    for (int i = 0; i < 10; i++) net_status_poll();
+    CHECK_EQ(net_status.sampled_ms, 0);
+    CHECK_EQ(host_wifi.rssi_reads, 0);
+    CHECK_EQ(host_wifi.channel_reads, 0);
+    CHECK_EQ(net_status.history_count, 0);
+}
+
+// Uma amostra: endereços formatados, RSSI e canal lidos uma vez cada
+static void test_sample(void) {
+    reset_all();
+    wifi_connected_ms = 1;
+    net_status_poll();
+    CHECK(net_status.sampled_ms != 0);
+    CHECK_EQ(net_status.link, CYW43_LINK_UP);
+    CHECK(strcmp(net_status.ip_str, "192.168.1.50") == 0);
+    CHECK(strcmp(net_status.gateway_str, "192.168.1.1") == 0);
+    CHECK_EQ(net_status.rssi, host_wifi.rssi);
+    CHECK_EQ(net_status.channel, host_wifi.channel);
+    CHECK_EQ(net_status.history_count, 1);
+    CHECK_EQ(net_status.rssi_min, host_wifi.rssi);
+    CHECK_EQ(net_status.rssi_avg, host_wifi.rssi);
+    CHECK_EQ(host_wifi.rssi_reads, 1);
+    CHECK_EQ(host_wifi.channel_reads, 1);
+    CHECK_EQ(host_lwip_depth, 0);
+
+    // Endereços só são refeitos quando mudam
+    strcpy(net_status.ip_str, "marcado");
+    net_status_poll();
+    CHECK(strcmp(net_status.ip_str, "marcado") == 0);
+    IP4_ADDR(&sta_netif()->ip_addr, 10, 0, 0, 7);
+    IP4_ADDR(&sta_netif()->gw, 10, 0, 0, 1);
+    net_status_poll();
+    CHECK(strcmp(net_status.ip_str, "10.0.0.7") == 0);
+    CHECK(strcmp(net_status.gateway_str, "10.0.0.1") == 0);
+
+    // Conexão perdida: estado e endereços atualizados, sem ler o RSSI nem o canal
+    host_link_status = CYW43_LINK_DOWN;
+    uint32_t reads = host_wifi.rssi_reads, count = net_status.history_count;
+    net_status_poll();
+    CHECK_EQ(net_status.link, CYW43_LINK_DOWN);
+    CHECK_EQ(host_wifi.rssi_reads, reads);
+    CHECK_EQ(host_wifi.channel_reads, reads);
+    CHECK_EQ(net_status.history_count, count);
+}
+
+// Histórico circular do RSSI, limitado a int8_t, com mínimo e média conferidos contra o modelo
+static void test_history(void) {
+    reset_all();
+    wifi_connected_ms = 1;
+    int8_t model[NET_STATUS_HISTORY * 4];
+    unsigned long rounds = host_test_iterations(2000);
+    int samples = 0;
+    for (unsigned long round = 0; round < rounds; round++) {
+        int32_t rssi = -100 + (int32_t)(host_test_rand() % 101);
+        if (host_test_rand() % 16 == 0) rssi = host_test_rand() % 2 ? -200 : 5;    // Fora da faixa de int8_t/dBm
+        host_wifi.rssi = rssi;
+        host_wifi.channel = 1 + host_test_rand() % 13;
+        net_status_poll();
+        CHECK_EQ(net_status.rssi, rssi);
+        CHECK_EQ(net_status.channel, host_wifi.channel);
+
+        model[samples++ % (NET_STATUS_HISTORY * 4)] = (int8_t)(rssi < -128 ? -128 : rssi > 0 ? 0 : rssi);
+        int count = samples < NET_STATUS_HISTORY ? samples : NET_STATUS_HISTORY;
+        CHECK_EQ(net_status.history_count, count);
+        int32_t sum = 0;
+        int8_t min = 0;
+        for (int i = 0; i < count; i++) {
+            int8_t expected = model[(samples - count + i) % (NET_STATUS_HISTORY * 4)];
+            CHECK_EQ(net_status_history_at(i), expected);
+            sum += expected;
+            if (i == 0 || expected < min) min = expected;
+        }
+        CHECK_EQ(net_status.rssi_min, min);
+        CHECK_EQ(net_status.rssi_avg, (int8_t)(sum / count));
+    }
+    CHECK_EQ(host_wifi.rssi_reads, rounds);
+}
+
+// A tela Network Info usa a amostra: um minuto de quadros lê o rádio só nas amostras
+static void test_screen_uses_sample(void) {
+    reset_all();
+    wifi_connected_ms = 1;
+    wifi_supervisor.state = WIFI_SUPERVISOR_UP;
+    wifi_supervisor.up_since_ms = to_ms_since_boot(get_absolute_time());
+    uint32_t samples = 0;
+    for (uint32_t t = 0; t < 60000; t += FRAME_PERIOD_MS) {
+        if (t % NET_STATUS_PERIOD_MS == 0) {
+            net_status_poll();
+            samples++;
+        }
+        render_network_info((t / 5000) % 2);
+        host_time_advance_ms(FRAME_PERIOD_MS);
+    }
+    CHECK_EQ(samples, 60000 / NET_STATUS_PERIOD_MS);
+    CHECK_EQ(host_wifi.rssi_reads, samples);
+    CHECK_EQ(host_wifi.channel_reads, samples);
+
+    // Quadros sem amostra nova são iguais; uma amostra com outro RSSI muda a tela
+    for (int graph = 0; graph < 2; graph++) {
+        uint8_t previous[sizeof(frame)];
+        render_network_info(graph);
+        memcpy(previous, frame, sizeof(frame));
+        render_network_info(graph);
+        CHECK(memcmp(previous, frame, sizeof(frame)) == 0);
+        host_wifi.rssi -= 20;
+        net_status_poll();
+        render_network_info(graph);
+        CHECK(memcmp(previous, frame, sizeof(frame)) != 0);
+    }
+}
+
+int main(void) {
+    ssd1306_SetFrameSink(capture_frame);
+    test_before_connect();
+    test_sample();
+    test_history();
+    test_screen_uses_sample();
+    CHECK_EQ(host_net_misuse, 0);
+    return host_test_report("test_net_status");
+}
@@ -0,0 +1,328 @@
+/******************************************************************************
+ * @file    test_power_idle.c
+ * @brief   Teste da política de energia por inatividade (power_idle.h): modos,
+ *          painel, relógio do sistema, modo de economia do rádio, despertar
+ *          pelos botões e contabilização do tempo em cada modo.
+ *
+ * @note    A política roda como a tarefa "energia" de main.c (a cada 100 ms) no
+ *          escalonador real, com o relógio simulado avançando em passos de até
+ *          1 ms. O painel é reconstruído das escritas I2C, o relógio do sistema e
+ *          o I2C vêm de host_sdk e o rádio é o CYW43 simulado de host_net.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "host_test.h"
+#include "host_net.h"
+#include "ap_mode_utility.h"
+#include "hardware/adc.h"
+#include "menu/icons.h"
+#include "power_idle.h"
+
+#define POWER_PERIOD_MS 100             // Período da tarefa "energia" (main.c).
+#define BOOT_KHZ 125000                 // Relógio do sistema no boot (host_sdk).
+
+// ------------------------------ Painel simulado ------------------------------
+
+static int panel_contrast = -1;         // Último contraste recebido (-1 = nenhum).
+static bool panel_contrast_next = false;// O próximo comando é o valor do contraste.
+static uint32_t panel_contrast_cmds = 0;// Comandos de contraste recebidos.
+static bool panel_on = true;            // Painel ligado (0xAF) ou desligado (0xAE).
+
+static void panel_write(uint8_t addr, const uint8_t *src, size_t len) {
+    if (len != 2 || src[0] != 0x80) return;    // Só comandos interessam aqui
+    if (panel_contrast_next) {
+        panel_contrast = src[1];
+        panel_contrast_cmds++;
+        panel_contrast_next = false;
+    } else if (src[1] == 0x81) {
+        panel_contrast_next = true;
+    } else if (src[1] == 0xAE || src[1] == 0xAF) {
+        panel_on = src[1] == 0xAF;
+    }
+}
+
+// ------------------------------ Auxiliares ------------------------------
+
+static uint64_t model_us[POWER_MODE_COUNT];     // Tempo simulado em cada modo, pelo teste.
+static uint32_t transitions = 0;                // Trocas de modo desde `reset_all`.
+static uint32_t poll_idle_ms = 0;               // Inatividade vista pela última passagem da política.
+static bool poll_http_pending = false;          // Lote HTTP em andamento na última passagem da política.
+
+static void task_power(void *arg) {
+    poll_idle_ms = to_ms_since_boot(get_absolute_time()) - power.activity_ms;
+    poll_http_pending = http_request_pending;
+    power_poll();
+}
+
+static void reset_all(void) {
+    host_net_reset();
+    memset(&power, 0, sizeof(power));
+    memset(model_us, 0, sizeof(model_us));
+    transitions = 0;
+    poll_idle_ms = 0;
+    poll_http_pending = false;
+    host_sys_khz = BOOT_KHZ;
+    host_i2c_sys_khz = BOOT_KHZ;
+    start_wifi = 1;
+    wifi_link_ok = true;
+    http_request_pending = false;
+    panel_contrast = -1;
+    panel_contrast_cmds = 0;
+    panel_on = true;
+    power_init();
+}
+
+// Executa o que estiver pronto no escalonador (tarefas vencidas e trabalho adiado)
+static void run_ready(void) {
+    POWER_MODE_T before = power.mode;
+    while (sched_run()) {}
+    if (power.mode != before) transitions++;
+}
+
+// Avança o relógio em passos de até `step_us`, executando o escalonador a cada passo
+static void run_for_us(uint64_t us, uint32_t step_us) {
+    uint64_t end = host_time_us + us;
+    while (host_time_us < end) {
+        uint64_t step = end - host_time_us < step_us ? end - host_time_us : step_us;
+        model_us[power.mode] += step;
+        host_time_us += step;
+        run_ready();
+    }
+}
+
+static void run_for_ms(uint32_t ms) {
+    run_for_us((uint64_t)ms * 1000, 1000);
+}
+
+// Aperta um botão: a interrupção registrada por `power_init`
+static void press_button(uint gpio) {
+    CHECK(host_gpio_irq_pins & (1u << gpio));
+    host_gpio_irq_callback(gpio, GPIO_IRQ_EDGE_FALL);
+}
+
+// Modo esperado pela inatividade vista na última passagem da política
+static POWER_MODE_T expected_mode(void) {
+    return poll_idle_ms >= POWER_SLEEP_AFTER_MS ? POWER_MODE_SLEEP :
+           poll_idle_ms >= POWER_DIM_AFTER_MS ? POWER_MODE_DIM : POWER_MODE_ACTIVE;
+}
+
+// Contabiliza até agora (pelo relatório, em silêncio) e confere contra o modelo
+static void check_accounting(void) {
+    host_test_quiet(true);
+    power_report(NULL);
+    host_test_quiet(false);
+    uint64_t total_ms = 0, model_total_us = 0;
+    for (int mode = 0; mode < POWER_MODE_COUNT; mode++) {
+        total_ms += power.mode_ms[mode];
+        model_total_us += model_us[mode];
+        uint64_t expected = model_us[mode] / 1000;
+        CHECK(power.mode_ms[mode] + transitions >= expected && power.mode_ms[mode] <= expected + transitions);
+    }
+    CHECK_EQ(total_ms, model_total_us / 1000);      // O resto abaixo de 1 ms não se perde
+}
+
+// ------------------------------ Cenários ------------------------------
+
+// Ativo até 30 s sem entrada, escurecido até 2 min, depois dormindo; nada se repete dormindo
+static void test_timeline(void) {
+    reset_all();
+    CHECK(host_gpio_irq_callback != NULL);
+    CHECK(host_gpio_irq_pins & (1u << BUTTON_A));
+    CHECK(host_gpio_irq_pins & (1u << BUTTON_B));
+    CHECK_EQ(power.active_khz, BOOT_KHZ);
+
+    host_test_quiet(true);
+    run_for_ms(POWER_DIM_AFTER_MS - 1);
+    CHECK_EQ(power.mode, POWER_MODE_ACTIVE);
+    CHECK_EQ(panel_contrast_cmds, 0);
+    CHECK_EQ(host_wifi.pm, CYW43_DEFAULT_PM);
+    CHECK_EQ(host_wifi.pm_calls, 1);
+    run_for_ms(POWER_PERIOD_MS);
+    CHECK_EQ(power.mode, POWER_MODE_DIM);
+    CHECK_EQ(panel_contrast, POWER_CONTRAST_DIM);
+    CHECK(panel_on);
+    CHECK_EQ(host_sys_khz, BOOT_KHZ);
+    CHECK_EQ(host_wifi.pm_calls, 1);
+
+    run_for_ms(POWER_SLEEP_AFTER_MS - POWER_DIM_AFTER_MS - POWER_PERIOD_MS);
+    CHECK_EQ(power.mode, POWER_MODE_DIM);
+    run_for_ms(1);
+    CHECK_EQ(power.mode, POWER_MODE_SLEEP);
+    CHECK(!panel_on);
+    CHECK_EQ(host_sys_khz, POWER_SLEEP_SYS_KHZ);
+    CHECK_EQ(host_i2c_sys_khz, POWER_SLEEP_SYS_KHZ);   // Divisor do I2C recalculado no relógio novo
+    CHECK_EQ(host_wifi.pm, CYW43_AGGRESSIVE_PM);
+    CHECK_EQ(host_wifi.pm_calls, 2);
+
+    uint32_t clock_sets = host_sys_clock_sets, contrast_cmds = panel_contrast_cmds;
+    run_for_ms(60000);
+    host_test_quiet(false);
+    CHECK_EQ(host_sys_clock_sets, clock_sets);
+    CHECK_EQ(host_wifi.pm_calls, 2);
+    CHECK_EQ(panel_contrast_cmds, contrast_cmds);
+    CHECK_EQ(power.wakes, 0);
+
+    check_accounting();
+    CHECK_EQ(power.mode_ms[POWER_MODE_ACTIVE], POWER_DIM_AFTER_MS);
+    CHECK_EQ(power.mode_ms[POWER_MODE_DIM], POWER_SLEEP_AFTER_MS - POWER_DIM_AFTER_MS);
+    CHECK_EQ(power.mode_ms[POWER_MODE_SLEEP], 60000);
+}
+
+// Um botão acorda na mesma passagem do laço, pelo trabalho adiado, sem esperar a tarefa
+static void test_wake(void) {
+    reset_all();
+    host_test_quiet(true);
+    press_button(BUTTON_A);                         // Ativo: nada a agendar
+    CHECK_EQ(scheduler.work_count, 0);
+    run_for_ms(POWER_SLEEP_AFTER_MS + POWER_PERIOD_MS);
+    CHECK_EQ(power.mode, POWER_MODE_SLEEP);
+
+    press_button(BUTTON_B);
+    press_button(BUTTON_A);
+    power_activity();                               // Joystick pela tarefa de entrada
+    CHECK_EQ(scheduler.work_count, 1);              // Um único despertar agendado
+    uint64_t t = host_time_us;
+    run_ready();
+    CHECK_EQ(host_time_us, t);
+    CHECK_EQ(power.mode, POWER_MODE_ACTIVE);
+    CHECK(panel_on);
+    CHECK_EQ(panel_contrast, POWER_CONTRAST_FULL);
+    CHECK_EQ(host_sys_khz, BOOT_KHZ);
+    CHECK_EQ(host_i2c_sys_khz, BOOT_KHZ);
+    CHECK_EQ(host_wifi.pm, CYW43_DEFAULT_PM);
+    CHECK_EQ(power.wakes, 1);
+    CHECK(!power.wake_pending);
+
+    // Escurecido: a entrada também volta ao ativo na hora
+    run_for_ms(POWER_DIM_AFTER_MS + POWER_PERIOD_MS);
+    CHECK_EQ(power.mode, POWER_MODE_DIM);
+    press_button(BUTTON_A);
+    run_ready();
+    host_test_quiet(false);
+    CHECK_EQ(power.mode, POWER_MODE_ACTIVE);
+    CHECK_EQ(panel_contrast, POWER_CONTRAST_FULL);
+    CHECK_EQ(power.wakes, 1);                       // Só conta despertares do modo dormindo
+    check_accounting();
+}
+
+// Dormindo: lote HTTP em andamento sem economia agressiva; sem conexão, o modo é refeito depois
+static void test_radio_pm(void) {
+    reset_all();
+    host_test_quiet(true);
+    run_for_ms(POWER_SLEEP_AFTER_MS + POWER_PERIOD_MS);
+    CHECK_EQ(host_wifi.pm, CYW43_AGGRESSIVE_PM);
+
+    http_request_pending = true;
+    run_for_ms(POWER_PERIOD_MS);
+    CHECK_EQ(host_wifi.pm, CYW43_DEFAULT_PM);
+    http_request_pending = false;
+    run_for_ms(POWER_PERIOD_MS);
+    CHECK_EQ(host_wifi.pm, CYW43_AGGRESSIVE_PM);
+
+    uint32_t calls = host_wifi.pm_calls;
+    wifi_link_ok = false;
+    run_for_ms(10 * POWER_PERIOD_MS);
+    CHECK_EQ(host_wifi.pm_calls, calls);
+    CHECK_EQ(power.radio_pm, 0);
+    wifi_link_ok = true;                            // Reconectado: o driver voltou ao padrão
+    run_for_ms(POWER_PERIOD_MS);
+    CHECK_EQ(host_wifi.pm_calls, calls + 1);
+    CHECK_EQ(host_wifi.pm, CYW43_AGGRESSIVE_PM);
+
+    start_wifi = 0;                                 // Sem Wi-Fi iniciado: o rádio não é tocado
+    run_for_ms(10 * POWER_PERIOD_MS);
+    host_test_quiet(false);
+    CHECK_EQ(host_wifi.pm_calls, calls + 1);
+    CHECK_EQ(host_lwip_depth, 0);
+}
+
+// O relógio só muda com o núcleo 1 sem quadros nem comandos pendentes (I2C livre)
+static void test_clock_waits_core1(void) {
+    reset_all();
+    host_test_quiet(true);
+    display_core1.lock = spin_lock_init(spin_lock_claim_unused(true));
+    display_core1.running = true;
+    display_core1.state[0] = DISPLAY_SLOT_FLUSHING; // Núcleo 1 escrevendo um quadro
+    display_core1.contrast_cmd = display_core1.on_cmd = -1;
+
+    run_for_ms(POWER_SLEEP_AFTER_MS + 5 * POWER_PERIOD_MS);
+    CHECK_EQ(power.mode, POWER_MODE_SLEEP);
+    CHECK_EQ(display_core1.contrast_cmd, POWER_CONTRAST_DIM);   // Pedidos ao núcleo 1, não ao I2C
+    CHECK_EQ(display_core1.on_cmd, 0);
+    CHECK(panel_on);
+    CHECK_EQ(host_sys_khz, BOOT_KHZ);
+    CHECK(!power.clock_low);
+
+    display_core1.state[0] = DISPLAY_SLOT_FREE;     // Quadro enviado, painel ainda não desligado
+    run_for_ms(POWER_PERIOD_MS);
+    CHECK_EQ(host_sys_khz, BOOT_KHZ);
+    display_core1.contrast_cmd = display_core1.on_cmd = -1;    // Núcleo 1 aplicou os comandos
+    run_for_ms(POWER_PERIOD_MS);
+    CHECK_EQ(host_sys_khz, POWER_SLEEP_SYS_KHZ);
+    CHECK(power.clock_low);
+
+    // Despertar com o núcleo 1 ocupado: o relógio volta na primeira passagem com o I2C livre
+    display_core1.state[1] = DISPLAY_SLOT_READY;
+    press_button(BUTTON_A);
+    run_ready();
+    CHECK_EQ(power.mode, POWER_MODE_ACTIVE);
+    CHECK_EQ(host_sys_khz, POWER_SLEEP_SYS_KHZ);
+    run_for_ms(3 * POWER_PERIOD_MS);
+    CHECK_EQ(host_sys_khz, POWER_SLEEP_SYS_KHZ);
+    display_core1.state[1] = DISPLAY_SLOT_FREE;     // Quadro enviado e comandos aplicados
+    display_core1.contrast_cmd = display_core1.on_cmd = -1;
+    run_for_ms(POWER_PERIOD_MS);
+    host_test_quiet(false);
+    CHECK_EQ(host_sys_khz, BOOT_KHZ);
+    CHECK_EQ(host_i2c_sys_khz, BOOT_KHZ);
+    CHECK(!power.clock_low);
+
+    display_core1.running = false;
+}
+
+// Entradas e passos de tempo sorteados: modo sempre coerente com a inatividade, tempo exato
+static void test_random(void) {
+    reset_all();
+    unsigned long rounds = host_test_iterations(1000);
+    host_test_quiet(true);
+    run_for_ms(POWER_PERIOD_MS);                    // Primeira passagem: modo do rádio aplicado
+    for (unsigned long round = 0; round < rounds; round++) {
+        uint32_t r = host_test_rand() % 100;
+        if (r < 3) {
+            press_button(host_test_rand() % 2 ? BUTTON_A : BUTTON_B);
+            run_ready();                            // Despertar adiado, se fora do modo ativo
+            CHECK_EQ(power.mode, POWER_MODE_ACTIVE);
+            poll_idle_ms = 0;
+            poll_http_pending = http_request_pending;
+        } else if (r < 5) {
+            http_request_pending = !http_request_pending;
+        }
+        // De alguns milissegundos a alguns minutos, em passos com frações de milissegundo
+        uint64_t us = host_test_rand() % 8 == 0 ? 1000ull * (host_test_rand() % 200000) : host_test_rand() % 500000;
+        run_for_us(us, 1 + host_test_rand() % 1500);
+
+        CHECK_EQ(power.mode, expected_mode());
+        CHECK_EQ(power.clock_low, power.mode == POWER_MODE_SLEEP);
+        CHECK_EQ(host_sys_khz, power.mode == POWER_MODE_SLEEP ? POWER_SLEEP_SYS_KHZ : BOOT_KHZ);
+        CHECK_EQ(panel_on, power.mode != POWER_MODE_SLEEP);
+        if (power.mode == POWER_MODE_DIM) CHECK_EQ(panel_contrast, POWER_CONTRAST_DIM);
+        if (power.mode == POWER_MODE_ACTIVE) CHECK(panel_contrast == -1 || panel_contrast == POWER_CONTRAST_FULL);
+        CHECK_EQ(host_wifi.pm, power.mode == POWER_MODE_SLEEP && !poll_http_pending ? CYW43_AGGRESSIVE_PM : CYW43_DEFAULT_PM);
+    }
+    host_test_quiet(false);
+    check_accounting();
+    CHECK(power.wakes > 0);
+}
+
+int main(void) {
+    host_i2c_write_hook = panel_write;
+    sched_task_add("energia", task_power, NULL, POWER_PERIOD_MS, SCHED_PRIORITY_NORMAL);
+    test_timeline();
+    test_wake();
+    test_radio_pm();
+    test_clock_waits_core1();
+    test_random();
+    CHECK_EQ(host_net_misuse, 0);
+    return host_test_report("test_power_idle");
+}
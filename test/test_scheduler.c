@@ -0,0 +1,343 @@
+/******************************************************************************
+ * @file    test_scheduler.c
+ * @brief   Teste do escalonador cooperativo do laço principal (scheduler.h).
+ *
+ * @note    O laço do firmware (`sched_run` e, quando ocioso, `sched_idle`) roda
+ *          sobre o relógio simulado: `sched_idle` avança o relógio até o próximo
+ *          prazo, e uma tarefa "demorada" avança o relógio dentro da própria
+ *          função. Assim os instantes de execução são exatos e podem ser
+ *          comparados com o período de cada tarefa.
+ ******************************************************************************/
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "scheduler.h"
+
+// ------------------------------ Auxiliares ------------------------------
+
+static char trace[256];                 // Letras das tarefas e itens, na ordem de execução.
+static int trace_len;
+
+// Tarefa (ou item adiado) que só anota a sua letra
+static void mark(void *arg) {
+    if (trace_len < (int)sizeof(trace) - 1) trace[trace_len++] = (char)(intptr_t)arg;
+    trace[trace_len] = '\0';
+}
+
+#define LETTER(c) ((void *)(intptr_t)(c))
+
+static void reset(void) {
+    memset(&scheduler, 0, sizeof(scheduler));
+    trace_len = 0;
+    trace[0] = '\0';
+}
+
+// Executa tudo o que está pronto no instante atual
+static void run_ready(void) {
+    while (sched_run()) {}
+}
+
+// O laço principal do firmware até o instante `end_us`
+static void run_until(uint64_t end_us) {
+    while (host_time_us < end_us) {
+        if (sched_run()) continue;
+        uint64_t before = host_time_us;
+        sched_idle();
+        if (host_time_us == before) host_time_us = end_us;     // Sem prazos: só uma interrupção acordaria
+    }
+}
+
+// ------------------------------ Cenários ------------------------------
+
+// Ordem de execução: prioridade alta, trabalho adiado, normal e baixa; prazo mais antigo primeiro
+static void test_order(void) {
+    reset();
+    sched_task_add("normal", mark, LETTER('n'), 10, SCHED_PRIORITY_NORMAL);
+    sched_task_add("baixa", mark, LETTER('l'), 10, SCHED_PRIORITY_LOW);
+    sched_task_add("alta", mark, LETTER('h'), 10, SCHED_PRIORITY_HIGH);
+    CHECK(sched_defer(mark, LETTER('d')));
+    CHECK(sched_defer(mark, LETTER('e')));
+    run_ready();
+    CHECK(strcmp(trace, "hdenl") == 0);
+
+    // Mesma prioridade: prazos de 2 ms e 5 ms passam à frente do periódico de 10 ms,
+    // independentemente da ordem de registro
+    int a = sched_task_add("a", mark, LETTER('a'), 0, SCHED_PRIORITY_NORMAL);
+    int b = sched_task_add("b", mark, LETTER('b'), 0, SCHED_PRIORITY_NORMAL);
+    sched_task_start(a, 5);
+    sched_task_start(b, 2);
+    trace_len = 0;
+    host_time_advance_ms(10);
+    run_ready();
+    CHECK(strcmp(trace, "hbanl") == 0);
+
+    // Uma tarefa alta que fica pronta passa à frente do restante da fila adiada
+    trace_len = 0;
+    host_time_advance_ms(10);
+    CHECK(sched_defer(mark, LETTER('d')));
+    CHECK(sched_run());                 // Alta
+    CHECK(sched_run());                 // Adiado
+    CHECK(sched_defer(mark, LETTER('e')));
+    run_ready();
+    CHECK(strcmp(trace, "hdenl") == 0);
+}
+
+static uint64_t run_times[16];          // Instantes de execução da tarefa `timed`.
+static int run_count;
+static uint32_t work_us;                // Duração simulada de cada execução de `timed`.
+
+static void timed(void *arg) {
+    if (run_count < 16) run_times[run_count] = host_time_us;
+    run_count++;
+    host_time_us += work_us;
+}
+
+// Tarefas periódicas: sem deriva, períodos perdidos, atraso e tempo de execução
+static void test_periodic(void) {
+    reset();
+    uint64_t t0 = host_time_us;
+    run_count = 0;
+    work_us = 0;
+    int id = sched_task_add("periodica", timed, NULL, 10, SCHED_PRIORITY_NORMAL);
+    run_until(t0 + 100000);
+    CHECK_EQ(run_count, 10);
+    for (int i = 0; i < 10 && i < run_count; i++) CHECK_EQ(run_times[i] - t0, i * 10000);
+    CHECK_EQ(scheduler.tasks[id].late, 0);
+    CHECK_EQ(scheduler.tasks[id].max_delay_us, 0);
+
+    // Uma execução de 35 ms perde os prazos de +10, +20 e +30 ms; a próxima é 10 ms após o fim
+    uint64_t t1 = host_time_us;
+    run_count = 0;
+    work_us = 35000;
+    run_until(t1 + 1);
+    CHECK_EQ(run_count, 1);
+    work_us = 0;
+    run_until(t1 + 60000);
+    CHECK_EQ(run_count, 3);
+    CHECK_EQ(run_times[1] - t1, 45000);
+    CHECK_EQ(run_times[2] - t1, 55000);
+    CHECK_EQ(scheduler.tasks[id].late, 3);
+    CHECK_EQ(scheduler.tasks[id].max_us, 35000);
+
+    // Uma tarefa alta de 4 ms atrasa a tarefa normal com o mesmo prazo
+    reset();
+    t1 = host_time_us;
+    run_count = 0;
+    work_us = 4000;
+    int slow = sched_task_add("lenta", timed, NULL, 0, SCHED_PRIORITY_HIGH);
+    int normal = sched_task_add("normal", mark, LETTER('n'), 0, SCHED_PRIORITY_NORMAL);
+    sched_task_start(slow, 0);
+    sched_task_start(normal, 0);
+    run_ready();
+    CHECK_EQ(host_time_us - t1, 4000);
+    CHECK(strcmp(trace, "n") == 0);
+    CHECK_EQ(scheduler.tasks[normal].max_delay_us, 4000);
+    CHECK_EQ(scheduler.tasks[slow].max_delay_us, 0);
+    CHECK_EQ(scheduler.tasks[slow].busy_us, 4000);
+}
+
+static int rearm_id;                    // Tarefa `rearm` (identificador para `sched_task_start`).
+static int rearm_left;                  // Rearmes que a tarefa ainda faz.
+
+static void rearm(void *arg) {
+    timed(arg);
+    if (rearm_left-- > 0) sched_task_start(rearm_id, 5);
+}
+
+// Tarefas únicas e rearme com `sched_task_start`, de fora e de dentro da tarefa
+static void test_start(void) {
+    reset();
+    int once = sched_task_add("unica", mark, LETTER('o'), 0, SCHED_PRIORITY_NORMAL);
+    run_ready();
+    host_time_advance_ms(100);
+    run_ready();
+    CHECK_EQ(trace_len, 0);             // Sem prazo até ser armada
+    sched_task_start(once, 20);
+    host_time_advance_ms(19);
+    run_ready();
+    CHECK_EQ(trace_len, 0);
+    host_time_advance_ms(1);
+    run_ready();
+    host_time_advance_ms(100);
+    run_ready();
+    CHECK(strcmp(trace, "o") == 0);
+
+    // A tarefa se rearma duas vezes: +0, +5 e +10 ms
+    reset();
+    uint64_t t0 = host_time_us;
+    run_count = 0;
+    work_us = 0;
+    rearm_left = 2;
+    rearm_id = sched_task_add("rearme", rearm, NULL, 0, SCHED_PRIORITY_NORMAL);
+    sched_task_start(rearm_id, 0);
+    run_until(t0 + 50000);
+    CHECK_EQ(run_count, 3);
+    CHECK_EQ(run_times[1] - t0, 5000);
+    CHECK_EQ(run_times[2] - t0, 10000);
+
+    // Uma periódica rearmada por dentro segue o novo prazo, e não o período
+    reset();
+    t0 = host_time_us;
+    run_count = 0;
+    rearm_left = 1;
+    rearm_id = sched_task_add("periodica", rearm, NULL, 100, SCHED_PRIORITY_NORMAL);
+    run_until(t0 + 150000);
+    CHECK_EQ(run_count, 3);
+    CHECK_EQ(run_times[1] - t0, 5000);
+    CHECK_EQ(run_times[2] - t0, 105000);
+
+    // Adiantar uma periódica que está no heap com outras tarefas
+    reset();
+    t0 = host_time_us;
+    run_count = 0;
+    sched_task_add("x", mark, LETTER('x'), 30, SCHED_PRIORITY_LOW);
+    int id = sched_task_add("periodica", timed, NULL, 100, SCHED_PRIORITY_NORMAL);
+    sched_task_add("y", mark, LETTER('y'), 40, SCHED_PRIORITY_LOW);
+    run_ready();
+    sched_task_start(id, 5);
+    CHECK_EQ(scheduler.heap_count, 3);
+    run_until(t0 + 150000);
+    CHECK_EQ(run_count, 3);
+    CHECK_EQ(run_times[1] - t0, 5000);
+    CHECK_EQ(run_times[2] - t0, 105000);
+}
+
+static void defer_again(void *arg) {
+    mark(arg);
+    sched_defer(mark, LETTER('z'));
+}
+
+// Fila de trabalho adiado: ordem, limite, descarte e volta ao início do buffer circular
+static void test_defer(void) {
+    reset();
+    char expected[2 * SCHED_DEFER_SIZE + 2] = "";
+    for (int i = 0; i < SCHED_DEFER_SIZE; i++) {
+        CHECK(sched_defer(mark, LETTER('a' + i)));
+        expected[i] = (char)('a' + i);
+    }
+    CHECK(!sched_defer(mark, LETTER('!')));
+    CHECK_EQ(scheduler.work_dropped, 1);
+
+    CHECK(sched_run());
+    CHECK(sched_run());
+    CHECK(sched_run());
+    for (int i = 0; i < 3; i++) {
+        CHECK(sched_defer(mark, LETTER('A' + i)));
+        expected[SCHED_DEFER_SIZE + i] = (char)('A' + i);
+    }
+    CHECK(!sched_defer(mark, LETTER('!')));
+    CHECK_EQ(scheduler.work_dropped, 2);
+    run_ready();
+    CHECK(strcmp(trace, expected) == 0);
+    CHECK_EQ(scheduler.work_runs, SCHED_DEFER_SIZE + 3);
+
+    // Um item que adia outro: o novo vai para o fim da fila
+    trace_len = 0;
+    sched_defer(defer_again, LETTER('p'));
+    sched_defer(mark, LETTER('q'));
+    run_ready();
+    CHECK(strcmp(trace, "pqz") == 0);
+}
+
+// Espera ociosa: não dorme com trabalho pendente e acorda exatamente no próximo prazo
+static void test_idle(void) {
+    reset();
+    uint64_t t0 = host_time_us;
+    sched_idle();
+    CHECK_EQ(host_time_us, t0);         // Sem tarefas: retorna
+
+    int id = sched_task_add("unica", mark, LETTER('o'), 0, SCHED_PRIORITY_NORMAL);
+    sched_task_start(id, 30);
+    sched_defer(mark, LETTER('d'));
+    sched_idle();
+    CHECK_EQ(host_time_us, t0);         // Trabalho adiado pendente
+    CHECK(sched_run());
+    CHECK(!sched_run());
+    sched_idle();
+    CHECK_EQ(host_time_us - t0, 30000);
+    CHECK(sched_run());
+    CHECK(strcmp(trace, "do") == 0);
+}
+
+// Relatório: estatísticas da janela e reinício da janela
+static void test_report(void) {
+    reset();
+    uint64_t t0 = host_time_us;
+    run_count = 0;
+    work_us = 2000;
+    int id = sched_task_add("periodica", timed, NULL, 10, SCHED_PRIORITY_NORMAL);
+    sched_defer(mark, LETTER('d'));
+    run_until(t0 + 100000);
+    CHECK_EQ(scheduler.tasks[id].runs, 10);
+    CHECK_EQ(scheduler.tasks[id].busy_us, 20000);
+    CHECK_EQ(scheduler.work_runs, 1);
+
+    host_test_quiet(true);
+    sched_report(NULL);
+    host_test_quiet(false);
+    CHECK_EQ(scheduler.window_start_us, host_time_us);
+    CHECK_EQ(scheduler.tasks[id].runs, 0);
+    CHECK_EQ(scheduler.tasks[id].busy_us, 0);
+    CHECK_EQ(scheduler.tasks[id].max_us, 0);
+    CHECK_EQ(scheduler.work_runs, 0);
+    work_us = 0;
+}
+
+static uint64_t expected_next[SCHED_MAX_TASKS];    // Próximo prazo esperado de cada tarefa.
+static uint32_t periods_us[SCHED_MAX_TASKS];
+static SCHED_PRIORITY_T last_priority;             // Prioridade da execução anterior no mesmo instante.
+static uint64_t last_run_us;
+static unsigned long mismatches, total_runs;
+
+static void checked(void *arg) {
+    int id = (int)(intptr_t)arg;
+    if (host_time_us != expected_next[id]) mismatches++;
+    if (host_time_us == last_run_us && scheduler.tasks[id].priority < last_priority) mismatches++;
+    last_priority = scheduler.tasks[id].priority;
+    last_run_us = host_time_us;
+    expected_next[id] = host_time_us + periods_us[id];
+    total_runs++;
+}
+
+// Heap de prazos com todas as tarefas, períodos e prioridades aleatórios e rearmes no meio do heap
+static void test_random(void) {
+    reset();
+    uint64_t t0 = host_time_us;
+    for (int id = 0; id < SCHED_MAX_TASKS; id++) {
+        uint32_t period_ms = 1 + host_test_rand() % 50;
+        periods_us[id] = period_ms * 1000;
+        expected_next[id] = t0;
+        CHECK_EQ(sched_task_add("aleatoria", checked, (void *)(intptr_t)id, period_ms, host_test_rand() % 3), id);
+    }
+    CHECK_EQ(sched_task_add("extra", mark, NULL, 10, SCHED_PRIORITY_LOW), -1);
+
+    mismatches = total_runs = 0;
+    last_run_us = 0;
+    unsigned long steps = host_test_iterations(20000);
+    for (unsigned long i = 0; i < steps; i++) {
+        if (sched_run()) continue;
+        if (host_test_rand() % 4 == 0) {
+            int id = host_test_rand() % SCHED_MAX_TASKS;
+            uint32_t delay_ms = 1 + host_test_rand() % 60;    // Sem 0: rodaria depois das de menor prioridade
+            sched_task_start(id, delay_ms);
+            expected_next[id] = host_time_us + delay_ms * 1000;
+            continue;
+        }
+        sched_idle();
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK(total_runs > steps / 4);
+    CHECK_EQ(scheduler.heap_count, SCHED_MAX_TASKS);
+}
+
+int main(void) {
+    test_order();
+    test_periodic();
+    test_start();
+    test_defer();
+    test_idle();
+    test_report();
+    test_random();
+    return host_test_report("test_scheduler");
+}
@@ -0,0 +1,187 @@
+/******************************************************************************
+ * @file    test_sha1.c
+ * @brief   Vetores de teste publicados para crypto/sha1.h: SHA-1 (FIPS 180),
+ *          HMAC-SHA1 (RFC 2202), PBKDF2-HMAC-SHA1 (RFC 6070), a chave WPA2
+ *          (IEEE 802.11i, anexo H.4) e Base64 (RFC 4648), incluindo o
+ *          `Sec-WebSocket-Accept` do exemplo da RFC 6455.
+ *
+ * @note    Um erro na PMK não aparece no portal: a reconexão rápida só falha e
+ *          cai na conexão normal, mais lenta. Por isso a derivação é conferida
+ *          com os vetores do padrão, e o cálculo incremental com divisões em
+ *          todos os pontos ao redor dos limites de bloco.
+ ******************************************************************************/
+
+#include "host_test.h"
+#include <string.h>
+#include "crypto/sha1.h"
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11" // Mesmo GUID de ap_mode_utility.h (RFC 6455).
+
+// ------------------------------ Auxiliares ------------------------------
+
+// Converte o resultado em hexadecimal para comparar com os vetores
+static const char *hex(const uint8_t *data, size_t len) {
+    static char out[2 * 64 + 1];
+    for (size_t i = 0; i < len; i++) sprintf(out + 2 * i, "%02x", data[i]);
+    out[2 * len] = '\0';
+    return out;
+}
+
+#define CHECK_HEX(data, len, expected) do {                                       \
+    const char *got_ = hex(data, len);                                            \
+    host_test_checks++;                                                           \
+    if (strcmp(got_, expected) != 0) {                                            \
+        host_test_failures++;                                                     \
+        fprintf(stderr, "%s:%d: falhou: %s\n  obtido:   %s\n  esperado: %s\n",    \
+                __FILE__, __LINE__, #data, got_, expected);                       \
+    }                                                                             \
+} while (0)
+
+static void sha1(const void *data, size_t len, uint8_t *digest) {
+    SHA1_CTX_T ctx;
+    sha1_init(&ctx);
+    sha1_update(&ctx, data, len);
+    sha1_final(&ctx, digest);
+}
+
+static void hmac_sha1(const void *key, size_t key_len, const char *message, uint8_t *digest) {
+    HMAC_SHA1_CTX_T ctx;
+    hmac_sha1_init(&ctx, key, key_len);
+    hmac_sha1_update(&ctx, message, strlen(message));
+    hmac_sha1_final(&ctx, digest);
+}
+
+// ------------------------------ SHA-1 ------------------------------
+
+static void test_sha1(void) {
+    uint8_t digest[SHA1_DIGEST_SIZE];
+
+    sha1("", 0, digest);
+    CHECK_HEX(digest, sizeof(digest), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    sha1("abc", 3, digest);
+    CHECK_HEX(digest, sizeof(digest), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    const char *two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    sha1(two_blocks, strlen(two_blocks), digest);
+    CHECK_HEX(digest, sizeof(digest), "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+
+    // Um milhão de 'a' em trechos de 1000 bytes
+    SHA1_CTX_T ctx;
+    char block[1000];
+    memset(block, 'a', sizeof(block));
+    sha1_init(&ctx);
+    for (int i = 0; i < 1000; i++) sha1_update(&ctx, block, sizeof(block));
+    sha1_final(&ctx, digest);
+    CHECK_HEX(digest, sizeof(digest), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+    // Comprimentos nos limites do preenchimento (bytes 0, 1, 2, ...)
+    static const struct { size_t len; const char *digest; } limits[] = {
+        { 55, "8ae2d46729cfe68ff927af5eec9c7d1b66d65ac2" },     // Comprimento cabe no mesmo bloco
+        { 56, "636e2ec698dac903498e648bd2f3af641d3c88cb" },     // Comprimento vai para um bloco extra
+        { 63, "6d942da0c4392b123528f2905c713a3ce28364bd" },
+        { 64, "c6138d514ffa2135bfce0ed0b8fac65669917ec7" },
+        { 119, "41c89d06001bab4ab78736b44efe7ce18ce6ae08" },
+        { 120, "d3dbd653bd8597b7475321b60a36891278e6a04a" },
+    };
+    uint8_t data[128];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)i;
+    for (size_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+        sha1(data, limits[i].len, digest);
+        CHECK_HEX(digest, sizeof(digest), limits[i].digest);
+    }
+
+    // O resultado não depende de como os dados são divididos entre as chamadas
+    for (size_t len = 0; len <= sizeof(data); len++) {
+        uint8_t whole[SHA1_DIGEST_SIZE];
+        sha1(data, len, whole);
+        for (size_t cut = 0; cut <= len; cut++) {
+            sha1_init(&ctx);
+            sha1_update(&ctx, data, cut);
+            sha1_update(&ctx, data + cut, len - cut);
+            sha1_final(&ctx, digest);
+            CHECK(memcmp(digest, whole, sizeof(digest)) == 0);
+        }
+    }
+}
+
+// ------------------------------ HMAC-SHA1 (RFC 2202) ------------------------------
+
+static void test_hmac(void) {
+    uint8_t digest[SHA1_DIGEST_SIZE], key[80];
+
+    memset(key, 0x0B, 20);
+    hmac_sha1(key, 20, "Hi There", digest);
+    CHECK_HEX(digest, sizeof(digest), "b617318655057264e28bc0b6fb378c8ef146be00");
+    hmac_sha1("Jefe", 4, "what do ya want for nothing?", digest);
+    CHECK_HEX(digest, sizeof(digest), "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79");
+
+    // Chave maior que um bloco: substituída pelo seu resumo
+    memset(key, 0xAA, 80);
+    hmac_sha1(key, 80, "Test Using Larger Than Block-Size Key - Hash Key First", digest);
+    CHECK_HEX(digest, sizeof(digest), "aa4ae5e15272d00e95705637ce8a3b55ed402112");
+}
+
+// ------------------------------ PBKDF2 (RFC 6070) e PMK (IEEE 802.11i) ------------------------------
+
+static void test_pbkdf2(void) {
+    uint8_t out[WPA2_PMK_SIZE];
+
+    pbkdf2_sha1("password", 8, "salt", 4, 1, out, 20);
+    CHECK_HEX(out, 20, "0c60c80f961f0e71f3a9b524af6012062fe037a6");
+    pbkdf2_sha1("password", 8, "salt", 4, 2, out, 20);
+    CHECK_HEX(out, 20, "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957");
+    pbkdf2_sha1("password", 8, "salt", 4, 4096, out, 20);
+    CHECK_HEX(out, 20, "4b007901b765489abead49d926f721d065a429c1");
+
+    // Chave de mais de um bloco do HMAC e bytes nulos na senha e no sal
+    pbkdf2_sha1("passwordPASSWORDpassword", 24, "saltSALTsaltSALTsaltSALTsaltSALTsalt", 36, 4096, out, 25);
+    CHECK_HEX(out, 25, "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038");
+    pbkdf2_sha1("pass\0word", 9, "sa\0lt", 5, 4096, out, 16);
+    CHECK_HEX(out, 16, "56fa6aa75548099dcc37d7f03425e0c3");
+
+    // PMK com os parâmetros usados em `wifi_connect_sta` (senha, SSID como sal)
+    static const struct { const char *password, *ssid, *pmk; } wpa2[] = {
+        { "password", "IEEE", "f42c6fc52df0ebef9ebb4b90b38a5f902e83fe1b135a70e23aed762e9710a12e" },
+        { "ThisIsAPassword", "ThisIsASSID", "0dc0d6eb90555ed6419756b9a15ec3e3209b63df707dd508d14581f8982721af" },
+        { "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ",
+          "becb93866bb8c3832cb777c2f559807c8c59afcb6eae734885001300a981cc62" },
+    };
+    for (size_t i = 0; i < sizeof(wpa2) / sizeof(wpa2[0]); i++) {
+        pbkdf2_sha1(wpa2[i].password, strlen(wpa2[i].password), wpa2[i].ssid, strlen(wpa2[i].ssid),
+                    WPA2_PMK_ITERATIONS, out, WPA2_PMK_SIZE);
+        CHECK_HEX(out, WPA2_PMK_SIZE, wpa2[i].pmk);
+    }
+}
+
+// ------------------------------ Base64 (RFC 4648) e handshake do WebSocket (RFC 6455) ------------------------------
+
+static void test_base64(void) {
+    static const struct { const char *data, *text; } vectors[] = {
+        { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" },
+    };
+    char out[64];
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        int n = base64_encode((const uint8_t *)vectors[i].data, strlen(vectors[i].data), out);
+        CHECK_EQ(n, strlen(vectors[i].text));
+        CHECK(strcmp(out, vectors[i].text) == 0);
+    }
+
+    // Sec-WebSocket-Accept = base64(SHA-1(chave + GUID)), como em `tcp_route_ws`
+    const char *key = "dGhlIHNhbXBsZSBub25jZQ==";
+    SHA1_CTX_T ctx;
+    uint8_t digest[SHA1_DIGEST_SIZE];
+    sha1_init(&ctx);
+    sha1_update(&ctx, key, strlen(key));
+    sha1_update(&ctx, WS_GUID, sizeof(WS_GUID) - 1);
+    sha1_final(&ctx, digest);
+    CHECK_EQ(base64_encode(digest, sizeof(digest), out), 28);
+    CHECK(strcmp(out, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0);
+}
+
+int main(void) {
+    test_sha1();
+    test_hmac();
+    test_pbkdf2();
+    test_base64();
+    return host_test_report("test_sha1");
+}
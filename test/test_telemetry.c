@@ -0,0 +1,519 @@
+/******************************************************************************
+ * @file    test_telemetry.c
+ * @brief   Teste do envio em lotes da telemetria (telemetry.h e o cliente de
+ *          http.h) contra um servidor ThingSpeak simulado.
+ *
+ * @note    O teste faz o papel do servidor sobre a pilha simulada (host_net):
+ *          aceita a conexão, lê a requisição inteira, confere a linha de
+ *          requisição, os cabeçalhos, o `Content-Length` e o JSON do bulk update
+ *          campo a campo, e responde com sucesso, erro, limite de taxa, reset ou
+ *          silêncio. As amostras aceitas são comparadas com a sequência gerada:
+ *          todas chegam, em ordem e uma única vez, inclusive quando passam pela
+ *          fila da flash (emulada em RAM) depois de falhas ou sem conexão.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "host_flash.h"
+#include "host_text.h"
+#include "host_net.h"
+#include "ap_mode_utility.h"
+#include "hardware/adc.h"
+#include "menu/icons.h"
+#include "telemetry.h"
+
+// ------------------------------ Amostras geradas ------------------------------
+
+#define MAX_SAMPLES 8192                // Amostras geradas por cenário.
+#define SAMPLE_PERIOD_MS 2000           // Período da tarefa de amostragem no firmware.
+
+static TELEMETRY_SAMPLE_T generated[MAX_SAMPLES]; // Amostras na ordem em que foram geradas.
+static uint32_t generated_count = 0;    // Amostras geradas.
+static uint32_t accepted_count = 0;     // Amostras aceitas pelo servidor (sempre um prefixo de `generated`).
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static void push_values(float temperature, float lat, float lon, uint32_t timestamp_ms) {
+    assert(generated_count < MAX_SAMPLES);
+    generated[generated_count++] = (TELEMETRY_SAMPLE_T){ temperature, lat, lon, timestamp_ms };
+    telemetry_push(temperature, lat, lon, timestamp_ms);
+}
+
+// Valores diferentes a cada amostra, para que uma amostra trocada, repetida ou perdida apareça
+static void push_sample(uint32_t timestamp_ms) {
+    uint32_t id = generated_count;
+    push_values((int32_t)(id * 37 % 9000 - 2000) / 100.0f, -23.5f + (id % 997) * 0.0001f,
+                -46.6f - (id % 991) * 0.0001f, timestamp_ms);
+}
+
+// Avança o relógio, gera uma amostra e roda o serviço, como a tarefa de amostragem e a de envio
+static void sample_and_poll(int count) {
+    for (int i = 0; i < count; i++) {
+        host_time_advance_ms(SAMPLE_PERIOD_MS);
+        push_sample(now_ms());
+        telemetry_poll();
+    }
+}
+
+static void reset_all(void) {
+    host_net_reset();
+    host_flash_reset();
+    flash_queue_init();
+    memset(&telemetry_ring, 0, sizeof(telemetry_ring));
+    telemetry_inflight_count = 0;
+    memset(&http_client, 0, sizeof(http_client));
+    http_request_pending = false;
+    http_request_ok = false;
+    start_wifi = 1;
+    wifi_link_ok = true;
+    generated_count = accepted_count = 0;
+}
+
+// ------------------------------ Leitura da requisição ------------------------------
+
+/**
+ * @brief Lote lido do corpo de uma requisição de bulk update.
+ */
+typedef struct BATCH_T_ {
+    int count;                                  // Entradas do lote.
+    uint32_t delta_t[TELEMETRY_BATCH_SIZE];     // `delta_t` de cada entrada.
+    int32_t fields[TELEMETRY_BATCH_SIZE][3];    // field1 (2 casas), field2 e field3 (6 casas), em ponto fixo.
+} BATCH_T;
+
+/**
+ * @brief Lê e valida uma requisição de bulk update, como o servidor faria.
+ *
+ * @return true se a requisição é válida; o lote lido fica em `batch`.
+ */
+static bool parse_request(const char *request, size_t len, BATCH_T *batch) {
+    static const char request_line[] = "POST /channels/2838403/bulk_update.json HTTP/1.1\r\n";
+    const char *end = request + len;
+    const char *p = request;
+    if (!take(&p, end, request_line)) return false;
+
+    const char *blank = find(p, end, "\r\n\r\n");
+    if (!blank) return false;
+    const char *headers_end = blank + 2;
+    size_t value_len;
+    const char *value;
+
+    value = header_value(p, headers_end, "Host", &value_len);
+    if (!value || value_len != 18 || memcmp(value, "api.thingspeak.com", 18) != 0) return false;
+    value = header_value(p, headers_end, "Content-Type", &value_len);
+    if (!value || value_len != 16 || memcmp(value, "application/json", 16) != 0) return false;
+    value = header_value(p, headers_end, "Content-Length", &value_len);
+    uint32_t content_length;
+    if (!value) return false;
+    const char *value_end = value + value_len;
+    if (!take_uint(&value, value_end, &content_length) || value != value_end) return false;
+
+    // O corpo é tudo o que vem depois da linha em branco, com o tamanho anunciado
+    p = blank + 4;
+    if ((size_t)(end - p) != content_length) return false;
+
+    if (!take(&p, end, "{\"write_api_key\":\"JWR3PN07O0NANG46\",\"updates\":[")) return false;
+    batch->count = 0;
+    do {
+        if (batch->count == TELEMETRY_BATCH_SIZE) return false;
+        int n = batch->count;
+        if (!take(&p, end, "{\"delta_t\":") || !take_uint(&p, end, &batch->delta_t[n])
+            || !take(&p, end, ",\"field1\":") || !take_fixed(&p, end, 2, &batch->fields[n][0])
+            || !take(&p, end, ",\"field2\":") || !take_fixed(&p, end, 6, &batch->fields[n][1])
+            || !take(&p, end, ",\"field3\":") || !take_fixed(&p, end, 6, &batch->fields[n][2])
+            || !take(&p, end, "}")) return false;
+        batch->count++;
+    } while (take(&p, end, ","));
+    return take(&p, end, "]}") && p == end;
+}
+
+// Confere o lote com as próximas amostras ainda não aceitas e retorna as diferenças
+static int batch_mismatches(const BATCH_T *batch) {
+    int mismatches = 0;
+    for (int i = 0; i < batch->count; i++) {
+        if (accepted_count + i >= generated_count) return mismatches + batch->count - i;
+        const TELEMETRY_SAMPLE_T *sample = &generated[accepted_count + i];
+        uint32_t delta_t = 0;
+        if (i > 0) {
+            int32_t elapsed_ms = (int32_t)(sample->timestamp_ms - sample[-1].timestamp_ms);
+            delta_t = elapsed_ms > 0 ? ((uint32_t)elapsed_ms + 500) / 1000 : 0;
+        }
+        if (batch->delta_t[i] != delta_t
+            || batch->fields[i][0] != float_to_fixed(sample->temperature, 2)
+            || batch->fields[i][1] != float_to_fixed(sample->lat, 6)
+            || batch->fields[i][2] != float_to_fixed(sample->lon, 6)) {
+            fprintf(stderr, "  entrada %d do lote difere da amostra %lu\n", i, (unsigned long)(accepted_count + i));
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// ------------------------------ Servidor simulado ------------------------------
+
+/**
+ * @brief Comportamento do servidor em uma requisição.
+ */
+typedef enum {
+    REPLY_OK,                     // 202 com {"success":true}.
+    REPLY_OK_BYTEWISE,            // Mesma resposta, um byte por pbuf.
+    REPLY_SUCCESS_FALSE,          // 202 com {"success":false}.
+    REPLY_SERVER_ERROR,           // 500.
+    REPLY_RATE_LIMIT,             // 429 com Retry-After.
+    REPLY_SILENT,                 // Lê a requisição e nunca responde.
+    REPLY_RESET,                  // Reseta a conexão depois de ler a requisição.
+    REPLY_CLOSE,                  // Fecha a conexão sem responder.
+    REPLY_COUNT
+} REPLY_T;
+
+#define RATE_LIMIT_RETRY_S 120          // Retry-After das respostas 429.
+
+static const char *const reply_text[] = {
+    [REPLY_OK] = "HTTP/1.1 202 Accepted\r\nContent-Type: application/json; charset=utf-8\r\n"
+                 "Content-Length: 16\r\nConnection: close\r\n\r\n{\"success\":true}",
+    [REPLY_OK_BYTEWISE] = "HTTP/1.1 202 Accepted\r\nContent-Length: 16\r\n\r\n{\"success\":true}",
+    [REPLY_SUCCESS_FALSE] = "HTTP/1.1 202 Accepted\r\nContent-Length: 17\r\n\r\n{\"success\":false}",
+    [REPLY_SERVER_ERROR] = "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+    [REPLY_RATE_LIMIT] = "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 120\r\nContent-Length: 0\r\n\r\n",
+};
+
+static struct tcp_pcb *last_served = NULL;      // Última conexão atendida pelo servidor.
+
+// Há uma conexão nova aguardando o servidor
+static struct tcp_pcb *server_pending(void) {
+    struct tcp_pcb *pcb = host_tcp_last();
+    return (pcb && pcb != last_served && pcb->state == SYN_SENT) ? pcb : NULL;
+}
+
+/**
+ * @brief Atende a conexão aberta pelo cliente: lê, valida e responde a requisição.
+ *
+ * @param reply Comportamento do servidor.
+ * @param chunk Tamanho dos pbufs da resposta (0 = um só).
+ * @return int Entradas do lote recebido, ou -1 se não havia conexão ou a requisição era inválida.
+ */
+static int server_serve(REPLY_T reply, size_t chunk) {
+    struct tcp_pcb *pcb = server_pending();
+    CHECK(pcb != NULL);
+    if (!pcb) return -1;
+    last_served = pcb;
+    CHECK_EQ(pcb->remote_port, 80);
+    CHECK_EQ(pcb->remote_ip.addr, 0x04030201);
+
+    CHECK_EQ(host_tcp_connect_done(pcb), ERR_OK);
+    static char request[4096];
+    size_t len = host_tcp_read(pcb, request, sizeof(request));
+    CHECK(len < sizeof(request));
+
+    BATCH_T batch;
+    bool valid = parse_request(request, len, &batch);
+    CHECK(valid);
+    if (!valid) {
+        fprintf(stderr, "  requisição: \"%.*s\"\n", (int)len, request);
+        host_tcp_reset_by_peer(pcb);
+        return -1;
+    }
+    CHECK_EQ(batch.count, telemetry_inflight_count);
+    CHECK_EQ(batch_mismatches(&batch), 0);
+    host_tcp_ack_all(pcb);
+
+    switch (reply) {
+    case REPLY_SILENT:
+        // Sem resposta, a requisição dura até o prazo do cliente (contado desde o DNS)
+        host_time_advance_ms(http_client.deadline_ms - now_ms() - 1);
+        host_tcp_poll_now(pcb);
+        CHECK(host_tcp_open(pcb) && http_request_pending);
+        host_time_advance_ms(1);
+        host_tcp_poll_now(pcb);
+        break;
+    case REPLY_RESET:
+        host_tcp_reset_by_peer(pcb);
+        break;
+    case REPLY_CLOSE:
+        host_tcp_remote_close(pcb);
+        break;
+    default:
+        host_tcp_deliver(pcb, reply_text[reply], strlen(reply_text[reply]), reply == REPLY_OK_BYTEWISE ? 1 : chunk);
+        break;
+    }
+    if (host_tcp_open(pcb)) host_tcp_remote_close(pcb);
+
+    CHECK(!host_tcp_open(pcb));
+    CHECK(!http_request_pending);
+    bool ok = reply == REPLY_OK || reply == REPLY_OK_BYTEWISE;
+    CHECK_EQ(http_request_ok, ok);
+    if (ok) accepted_count += batch.count;
+    return batch.count;
+}
+
+// ------------------------------ Cenários ------------------------------
+
+static void test_batch_ok(void) {
+    reset_all();
+
+    // 14 amostras ainda não formam um lote; a 15ª dispara o envio
+    sample_and_poll(TELEMETRY_BATCH_SIZE - 1);
+    CHECK(!http_request_pending && server_pending() == NULL);
+    sample_and_poll(1);
+    CHECK(http_request_pending);
+    CHECK_EQ(server_serve(REPLY_OK, 0), TELEMETRY_BATCH_SIZE);
+    telemetry_poll();
+    CHECK_EQ(accepted_count, TELEMETRY_BATCH_SIZE);
+    CHECK_EQ(telemetry_ring.count, 0);
+    CHECK_EQ(flash_queue.count, 0);
+    CHECK_EQ(http_client.backoff_ms, 0);
+
+    // Lote menor, enviado pela idade da amostra mais antiga; resposta em pbufs de 1 byte
+    sample_and_poll(3);
+    CHECK(!http_request_pending);
+    host_time_advance_ms(TELEMETRY_BATCH_MAX_AGE_MS - 2 * SAMPLE_PERIOD_MS - 1);
+    telemetry_poll();
+    CHECK(!http_request_pending);
+    host_time_advance_ms(1);
+    telemetry_poll();
+    CHECK_EQ(server_serve(REPLY_OK_BYTEWISE, 0), 3);
+    telemetry_poll();
+    CHECK_EQ(accepted_count, TELEMETRY_BATCH_SIZE + 3);
+
+    // DNS sem cache: a conexão só é aberta com a resposta
+    host_dns_mode = HOST_DNS_PENDING;
+    sample_and_poll(TELEMETRY_BATCH_SIZE);
+    CHECK(http_request_pending && server_pending() == NULL);
+    CHECK(host_dns_answer(true));
+    CHECK_EQ(server_serve(REPLY_OK, 7), TELEMETRY_BATCH_SIZE);
+    telemetry_poll();
+    CHECK_EQ(accepted_count, generated_count);
+    CHECK_EQ(telemetry_ring.count, 0);
+}
+
+static void test_unsent_tail(void) {
+    reset_all();
+
+    // Valores extremos (12 caracteres) e `delta_t` de 7 dígitos: só 14 entradas cabem no buffer
+    uint32_t now = now_ms();
+    for (uint32_t i = 0; i < TELEMETRY_BATCH_SIZE; i++) {
+        uint32_t timestamp_ms = now - (TELEMETRY_BATCH_SIZE - 1 - i) * 1000000000u;
+        push_values(-20000000.0f - 2.0f * i, -2000.0f - 0.001f * i, -2000.0f + 0.001f * i, timestamp_ms);
+    }
+    telemetry_poll();
+    CHECK(http_request_pending);
+    CHECK_EQ(server_serve(REPLY_OK, 0), TELEMETRY_BATCH_SIZE - 1);
+    telemetry_poll();
+
+    // A amostra que não coube continua no buffer e segue no próximo lote
+    CHECK_EQ(telemetry_ring.count, 1);
+    CHECK_EQ(flash_queue.count, 0);
+    host_time_advance_ms(TELEMETRY_BATCH_MAX_AGE_MS);
+    telemetry_poll();
+    CHECK_EQ(server_serve(REPLY_OK, 0), 1);
+    telemetry_poll();
+    CHECK_EQ(accepted_count, TELEMETRY_BATCH_SIZE);
+    CHECK_EQ(telemetry_ring.count, 0);
+}
+
+/**
+ * @brief Falhas provocadas antes ou durante uma requisição.
+ */
+typedef enum {
+    FAIL_DNS = REPLY_COUNT,       // DNS recusa a consulta.
+    FAIL_DNS_NOT_FOUND,           // DNS responde sem endereço.
+    FAIL_TCP_NEW,                 // Sem memória para o PCB.
+    FAIL_CONNECT                  // `tcp_connect` recusado.
+} FAIL_T;
+
+// Inicia a requisição que o próximo `telemetry_poll` deve fazer e a termina com `outcome`
+static void request_with(int outcome) {
+    unsigned long queries = host_dns_queries;
+    if (outcome == FAIL_DNS) host_dns_mode = HOST_DNS_FAIL;
+    if (outcome == FAIL_DNS_NOT_FOUND) host_dns_mode = HOST_DNS_PENDING;
+    if (outcome == FAIL_TCP_NEW) host_tcp_new_failures = 1;
+    if (outcome == FAIL_CONNECT) host_tcp_connect_result = ERR_RTE;
+
+    telemetry_poll();
+    CHECK_EQ(host_dns_queries, queries + 1);
+    if (outcome == FAIL_DNS_NOT_FOUND) CHECK(host_dns_answer(false));
+    if (outcome < REPLY_COUNT) server_serve((REPLY_T)outcome, 0);
+    CHECK(!http_request_pending && server_pending() == NULL);
+
+    host_dns_mode = HOST_DNS_CACHED;
+    host_tcp_new_failures = 0;
+    host_tcp_connect_result = ERR_OK;
+}
+
+static void test_failures(void) {
+    static const int outcomes[] = {
+        REPLY_SERVER_ERROR, REPLY_RESET, REPLY_SILENT, REPLY_CLOSE, REPLY_SUCCESS_FALSE,
+        FAIL_DNS, FAIL_DNS_NOT_FOUND, FAIL_TCP_NEW, FAIL_CONNECT, REPLY_RATE_LIMIT,
+    };
+    reset_all();
+
+    sample_and_poll(TELEMETRY_BATCH_SIZE - 1);
+    host_time_advance_ms(SAMPLE_PERIOD_MS);
+    push_sample(now_ms());
+
+    uint32_t expected_backoff = 0;
+    for (size_t i = 0; i < sizeof(outcomes) / sizeof(outcomes[0]); i++) {
+        request_with(outcomes[i]);
+
+        // A espera dobra a cada falha seguida, até o máximo, ou segue o Retry-After
+        expected_backoff = expected_backoff ? expected_backoff * 2 : HTTP_BACKOFF_MIN_MS;
+        if (expected_backoff > HTTP_BACKOFF_MAX_MS) expected_backoff = HTTP_BACKOFF_MAX_MS;
+        if (outcomes[i] == REPLY_RATE_LIMIT && RATE_LIMIT_RETRY_S * 1000 > expected_backoff) {
+            expected_backoff = RATE_LIMIT_RETRY_S * 1000;
+        }
+        CHECK_EQ(http_client.backoff_ms, expected_backoff);
+        CHECK_EQ(http_client.failures, i + 1);
+
+        // O lote que falhou vai para a flash e nada é enviado antes do fim da espera
+        telemetry_poll();
+        CHECK_EQ(flash_queue.count, TELEMETRY_BATCH_SIZE);
+        CHECK_EQ(telemetry_ring.count, 0);
+        unsigned long queries = host_dns_queries;
+        host_time_advance_ms(http_client.hold_until_ms - now_ms() - 1);
+        telemetry_poll();
+        CHECK_EQ(host_dns_queries, queries);
+        host_time_advance_ms(1);
+    }
+    CHECK_EQ(http_client.rate_limited, 1);
+    CHECK_EQ(http_client.timeouts, 1);
+    CHECK_EQ(accepted_count, 0);
+
+    // O mesmo lote sai da flash e é confirmado; a espera volta a zero
+    telemetry_poll();
+    CHECK_EQ(server_serve(REPLY_OK, 0), TELEMETRY_BATCH_SIZE);
+    telemetry_poll();
+    CHECK_EQ(accepted_count, TELEMETRY_BATCH_SIZE);
+    CHECK_EQ(flash_queue.count, 0);
+    CHECK_EQ(http_client.backoff_ms, 0);
+    CHECK(http_client_ready());
+}
+
+static void test_link_down(void) {
+    reset_all();
+
+    // Sem conexão, cada lote pronto vai para a flash
+    host_link_status = CYW43_LINK_DOWN;
+    sample_and_poll(2 * TELEMETRY_BATCH_SIZE + 10);
+    CHECK(host_tcp_last() == NULL);
+    CHECK_EQ(flash_queue.count, 2 * TELEMETRY_BATCH_SIZE);
+    CHECK_EQ(telemetry_ring.count, 10);
+
+    // O supervisor derruba `wifi_link_ok` antes do CYW43 perceber: nada é enviado
+    host_link_status = CYW43_LINK_UP;
+    wifi_link_ok = false;
+    telemetry_poll();
+    CHECK(host_tcp_last() == NULL);
+
+    // Com a conexão de volta, a flash (mais antiga) sai primeiro, depois o buffer
+    wifi_link_ok = true;
+    for (int i = 0; i < 2; i++) {
+        telemetry_poll();
+        CHECK_EQ(server_serve(REPLY_OK, 0), TELEMETRY_BATCH_SIZE);
+    }
+    telemetry_poll();
+    CHECK_EQ(flash_queue.count, 0);
+    CHECK(!http_request_pending);
+    host_time_advance_ms(TELEMETRY_BATCH_MAX_AGE_MS);
+    telemetry_poll();
+    CHECK_EQ(server_serve(REPLY_OK, 0), 10);
+    telemetry_poll();
+    CHECK_EQ(accepted_count, generated_count);
+}
+
+static void test_slow_drain(void) {
+    reset_all();
+
+    // Uma fila longa na flash leva muitas requisições para esvaziar
+    host_link_status = CYW43_LINK_DOWN;
+    sample_and_poll(10 * TELEMETRY_BATCH_SIZE);
+    CHECK_EQ(flash_queue.count, 10 * TELEMETRY_BATCH_SIZE);
+    host_link_status = CYW43_LINK_UP;
+    uint32_t next_seq = flash_queue.next_seq;
+
+    // Com um servidor lento, o buffer enche antes do fim e segue para a flash, sem perder amostras
+    for (int i = 0; i < 100 && (flash_queue.count > 0 || http_request_pending); i++) {
+        sample_and_poll(4);
+        if (server_pending()) server_serve(REPLY_OK, 0);
+    }
+    CHECK_EQ(flash_queue.next_seq, next_seq + TELEMETRY_RING_SIZE);
+    host_time_advance_ms(TELEMETRY_BATCH_MAX_AGE_MS);
+    for (int i = 0; i < 4; i++) {
+        telemetry_poll();
+        if (server_pending()) server_serve(REPLY_OK, 0);
+    }
+    CHECK_EQ(telemetry_ring.dropped, 0);
+    CHECK_EQ(accepted_count, generated_count);
+}
+
+// ------------------------------ Execução aleatória ------------------------------
+
+static REPLY_T random_reply(void) {
+    uint32_t r = host_test_rand() % 32;
+    return r < 24 ? REPLY_OK : (REPLY_T)(REPLY_OK_BYTEWISE + (r - 24) % (REPLY_COUNT - REPLY_OK_BYTEWISE));
+}
+
+static void test_random(void) {
+    unsigned long steps = host_test_iterations(20000);
+    reset_all();
+    host_test_quiet(true);
+
+    uint32_t next_sample_ms = now_ms() + SAMPLE_PERIOD_MS;
+    unsigned long requests = 0;
+    for (unsigned long step = 0; step < steps && generated_count + 64 < MAX_SAMPLES; step++) {
+        // Amostras atrasadas (depois de um servidor mudo) passam pelo serviço uma a uma, como no firmware
+        host_time_advance_ms(100 + host_test_rand() % 900);
+        while ((int32_t)(now_ms() - next_sample_ms) >= 0) {
+            push_sample(next_sample_ms);
+            next_sample_ms += SAMPLE_PERIOD_MS;
+            telemetry_poll();
+        }
+
+        // Quedas de conexão curtas e falhas de DNS ou de memória de vez em quando
+        if (host_test_rand() % 400 == 0) {
+            host_link_status = host_link_status == CYW43_LINK_UP ? CYW43_LINK_DOWN : CYW43_LINK_UP;
+        }
+        uint32_t r = host_test_rand() % 256;
+        host_dns_mode = r == 0 ? HOST_DNS_FAIL : r < 32 ? HOST_DNS_PENDING : HOST_DNS_CACHED;
+        host_tcp_new_failures = r == 1;
+
+        telemetry_poll();
+        host_dns_answer(host_test_rand() % 8 != 0);
+        if (server_pending()) {
+            server_serve(random_reply(), 1 + host_test_rand() % 64);
+            requests++;
+        }
+    }
+
+    // Conexão estável até entregar tudo
+    host_link_status = CYW43_LINK_UP;
+    host_dns_mode = HOST_DNS_CACHED;
+    host_tcp_new_failures = 0;
+    for (int i = 0; i < 2000 && (accepted_count < generated_count || http_request_pending); i++) {
+        host_time_advance_ms(1000);
+        telemetry_poll();
+        if (server_pending()) server_serve(REPLY_OK, 0);
+    }
+    telemetry_poll();
+    host_test_quiet(false);
+
+    fprintf(stderr, "aleatório: %lu passos, %lu amostras, %lu requisições, %lu falhas\n",
+            steps, (unsigned long)generated_count, requests, (unsigned long)http_client.failures);
+    CHECK(http_client.failures > 0);
+    CHECK_EQ(telemetry_ring.dropped, 0);
+    CHECK_EQ(flash_queue.dropped, 0);
+    CHECK_EQ(accepted_count, generated_count);
+    CHECK_EQ(telemetry_ring.count, 0);
+    CHECK_EQ(flash_queue.count, 0);
+}
+
+int main(void) {
+    test_batch_ok();
+    test_unsent_tail();
+    test_failures();
+    test_link_down();
+    test_slow_drain();
+    test_random();
+    CHECK_EQ(host_net_misuse, 0);
+    return host_test_report("test_telemetry");
+}
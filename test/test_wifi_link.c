@@ -0,0 +1,357 @@
+/******************************************************************************
+ * @file    test_wifi_link.c
+ * @brief   Teste da conexão Wi-Fi no modo STA (menu/menu.h): a conexão direta
+ *          pelo cache gravado com as credenciais e o supervisor que reconecta
+ *          com espera exponencial e aleatória.
+ *
+ * @note    O rádio é o CYW43 simulado de host_net: um ponto de acesso que pode
+ *          ser desligado, trocar de canal ou de senha, com conexões que levam
+ *          `scan_ms` (varredura) ou `direct_ms` (direta, pelo cache). O
+ *          supervisor roda a cada 100 ms, como a tarefa "rede" do firmware, e
+ *          cada tentativa é conferida pelas chamadas que chegaram ao driver.
+ ******************************************************************************/
+
+#include "pico/stdlib.h"
+#include "host_test.h"
+#include "host_flash.h"
+#include "host_net.h"
+#include "ap_mode_utility.h"
+#include "menu/menu.h"
+
+#define NETWORK_PERIOD_MS 100           // Período da tarefa "rede" (main.c).
+
+// ------------------------------ Auxiliares ------------------------------
+
+static void reset_all(void) {
+    host_net_reset();
+    host_flash_reset();
+    host_test_quiet(true);
+    flash_queue_init();
+    host_test_quiet(false);
+    cred_store_current = -1;
+    cred_store_seq = 0;
+    memset(&sta_server, 0, sizeof(sta_server));
+    memset(&wifi_supervisor, 0, sizeof(wifi_supervisor));
+    memset(&wifi_link, 0, sizeof(wifi_link));
+    wifi_connected_ms = wifi_join_ms = 0;
+    wifi_link_ok = wifi_fast_join = false;
+    wifi_radio_on = false;
+    strcpy(ssid, "IEEE");
+    strcpy(password, "password");
+}
+
+// Conexão do boot (bloqueante), como em `main` com as credenciais da flash
+static void boot_connect(void) {
+    host_test_quiet(true);
+    CHECK(wifi_connect_sta());
+    host_test_quiet(false);
+    CHECK(wifi_link_ok);
+    CHECK_EQ(wifi_supervisor.state, WIFI_SUPERVISOR_UP);
+}
+
+/**
+ * @brief Simula um reinício: a RAM volta ao estado do boot, a flash e o ponto de acesso ficam.
+ *
+ * Lê as credenciais e o cache da conexão da flash, como `main` antes de `wifi_connect_sta`.
+ */
+static void reboot(void) {
+    HOST_WIFI_T ap = host_wifi;
+    host_net_reset();
+    host_wifi.ap_up = ap.ap_up;
+    host_wifi.ssid = ap.ssid;
+    host_wifi.password = ap.password;
+    host_wifi.pmk_hex = ap.pmk_hex;
+    memcpy(host_wifi.bssid, ap.bssid, sizeof(ap.bssid));
+    host_wifi.channel = ap.channel;
+    cred_store_current = -1;
+    cred_store_seq = 0;
+    memset(&sta_server, 0, sizeof(sta_server));
+    memset(&wifi_supervisor, 0, sizeof(wifi_supervisor));
+    memset(&wifi_link, 0, sizeof(wifi_link));
+    wifi_connected_ms = wifi_join_ms = 0;
+    wifi_link_ok = wifi_fast_join = false;
+    wifi_radio_on = false;
+    memset(ssid, 0, sizeof(ssid));
+    memset(password, 0, sizeof(password));
+    CHECK(cred_store_load(ssid, sizeof(ssid), password, sizeof(password), &wifi_link));
+}
+
+// Confere a PMK do cache contra os 64 dígitos hexadecimais esperados
+static void check_pmk(const char *hex) {
+    char key[2 * WPA2_PMK_SIZE + 1];
+    for (int i = 0; i < WPA2_PMK_SIZE; i++) snprintf(key + 2 * i, 3, "%02x", wifi_link.pmk[i]);
+    CHECK(strcmp(key, hex) == 0);
+}
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static uint32_t attempts_seen;          // Conexões recebidas pelo driver até a última chamada de `supervise`.
+static uint32_t attempt_ms[64];         // Instante de cada tentativa (índice = ordem da tentativa).
+static bool attempt_direct[64];         // Tentativa pela conexão direta (cache).
+static uint32_t failed_ms[64];          // Instante em que a tentativa anterior foi dada como perdida.
+
+/**
+ * @brief Roda o supervisor a cada NETWORK_PERIOD_MS por `ms` milissegundos ou até reconectar.
+ *
+ * Registra cada tentativa que chega ao driver e o instante em que o supervisor desistiu da
+ * anterior (ou detectou a perda), e confere que nenhuma chamada avança o relógio (não bloqueia).
+ */
+static void supervise(uint32_t ms) {
+    uint32_t end = now_ms() + ms;
+    host_test_quiet(true);
+    while ((int32_t)(now_ms() - end) < 0) {
+        WIFI_SUPERVISOR_STATE_T before = wifi_supervisor.state;
+        uint64_t t = host_time_us;
+        wifi_supervisor_poll();
+        CHECK_EQ(host_time_us, t);
+
+        uint32_t attempts = host_wifi.scans + host_wifi.direct_joins;
+        bool attempted = attempts != attempts_seen;
+        if (attempted && attempts_seen < 64) {
+            attempt_ms[attempts_seen] = now_ms();
+            attempt_direct[attempts_seen] = wifi_supervisor.attempt_cached;
+        }
+        attempts_seen = attempts;
+        // Perda detectada, tentativa desistida ou recusada pelo driver: a espera começa agora
+        if (wifi_supervisor.state == WIFI_SUPERVISOR_BACKOFF && (before != WIFI_SUPERVISOR_BACKOFF || attempted) &&
+            attempts_seen < 64) {
+            failed_ms[attempts_seen] = now_ms();
+        }
+        if (before != WIFI_SUPERVISOR_UP && wifi_supervisor.state == WIFI_SUPERVISOR_UP) break;
+        host_time_advance_ms(NETWORK_PERIOD_MS);
+    }
+    host_test_quiet(false);
+}
+
+// Espera máxima antes da tentativa `n` (0 = primeira após a perda)
+static uint32_t backoff_max(uint32_t n) {
+    uint32_t delay = WIFI_BACKOFF_MAX_MS;
+    if (n < 16 && (WIFI_BACKOFF_BASE_MS << n) < WIFI_BACKOFF_MAX_MS) delay = WIFI_BACKOFF_BASE_MS << n;
+    return delay;
+}
+
+// Confere a espera antes de cada tentativa de `first` a `last`: entre a metade e o valor cheio
+static void check_backoff(uint32_t first, uint32_t last) {
+    for (uint32_t i = first; i < last && i < 64; i++) {
+        uint32_t wait = attempt_ms[i] - failed_ms[i];
+        uint32_t max = backoff_max(i - first);
+        CHECK(wait >= max / 2);
+        CHECK(wait < max + NETWORK_PERIOD_MS);
+    }
+}
+
+// ------------------------------ Cenários ------------------------------
+
+// Primeiro boot com varredura e PBKDF2; os seguintes conectam direto pelo cache gravado
+static void test_cached_boot(void) {
+    reset_all();
+    boot_connect();
+    CHECK(!wifi_fast_join);
+    CHECK_EQ(wifi_join_ms, host_wifi.scan_ms);
+    CHECK_EQ(host_wifi.scans, 1);
+    CHECK_EQ(host_wifi.direct_joins, 0);
+    CHECK(wifi_link.valid);
+    CHECK(memcmp(wifi_link.bssid, host_wifi.bssid, 6) == 0);
+    CHECK_EQ(wifi_link.channel, host_wifi.channel);
+    check_pmk(host_wifi.pmk_hex);       // Vetor do IEEE 802.11i: "password" na rede "IEEE"
+    uint32_t programs = host_flash_programs;
+    CHECK(programs > 0);
+
+    for (int boot = 0; boot < 3; boot++) {
+        reboot();
+        CHECK(wifi_link.valid);
+        boot_connect();
+        CHECK(wifi_fast_join);
+        CHECK_EQ(wifi_join_ms, host_wifi.direct_ms);
+        CHECK_EQ(host_wifi.scans, 0);
+        CHECK_EQ(host_wifi.direct_joins, 1);
+        CHECK(strcmp(host_wifi.key, host_wifi.pmk_hex) == 0);
+        CHECK(memcmp(host_wifi.join_bssid, host_wifi.bssid, 6) == 0);
+        CHECK_EQ(host_wifi.join_channel, host_wifi.channel);
+        CHECK_EQ(host_flash_programs, programs);   // Nada mudou: nenhuma gravação
+    }
+}
+
+// O ponto de acesso trocou de canal: a conexão direta expira, a varredura conecta e o cache é regravado
+static void test_channel_change(void) {
+    reset_all();
+    boot_connect();
+    uint8_t pmk[WPA2_PMK_SIZE];
+    memcpy(pmk, wifi_link.pmk, sizeof(pmk));
+    uint32_t programs = host_flash_programs;
+    uint32_t old_channel = host_wifi.channel;
+    host_wifi.channel = 11;
+
+    reboot();
+    boot_connect();
+    CHECK(!wifi_fast_join);
+    CHECK_EQ(host_wifi.direct_joins, 1);
+    CHECK_EQ(host_wifi.join_channel, old_channel);
+    CHECK_EQ(host_wifi.scans, 1);
+    CHECK(host_wifi.leaves >= 1);
+    CHECK_EQ(wifi_join_ms, WIFI_FAST_JOIN_TIMEOUT_MS + host_wifi.scan_ms);
+    CHECK_EQ(wifi_link.channel, 11);
+    CHECK(memcmp(wifi_link.pmk, pmk, sizeof(pmk)) == 0);   // Mesma senha: a PMK não é recalculada
+    CHECK(host_flash_programs > programs);
+
+    // O registro gravado já tem o canal novo: o próximo boot volta a ser direto
+    CRED_STORE_LINK_T link;
+    char stored_ssid[sizeof(ssid)], stored_password[sizeof(password)];
+    CHECK(cred_store_load(stored_ssid, sizeof(stored_ssid), stored_password, sizeof(stored_password), &link));
+    CHECK(link.valid);
+    CHECK_EQ(link.channel, 11);
+    reboot();
+    boot_connect();
+    CHECK(wifi_fast_join);
+    CHECK_EQ(host_wifi.join_channel, 11);
+    CHECK_EQ(wifi_join_ms, host_wifi.direct_ms);
+}
+
+// Senha de 64 dígitos hexadecimais: é a própria PMK, sem PBKDF2, em maiúsculas ou minúsculas
+static void test_hex_password(void) {
+    static const char hex_password[] = "0123456789ABCDEFfedcba98765432100011223344556677AaBbCcDdEeFf8899";
+    static const char hex_key[] = "0123456789abcdeffedcba98765432100011223344556677aabbccddeeff8899";
+    reset_all();
+    host_wifi.password = hex_password;
+    host_wifi.pmk_hex = hex_key;
+    strcpy(password, hex_password);
+    boot_connect();
+    CHECK(!wifi_fast_join);
+    check_pmk(hex_key);
+
+    reboot();
+    CHECK(strcmp(password, hex_password) == 0);
+    boot_connect();
+    CHECK(wifi_fast_join);
+    CHECK(strcmp(host_wifi.key, hex_key) == 0);
+}
+
+// Perda da conexão com o ponto de acesso desligado, esperas crescentes e a volta do ponto de acesso
+static void test_outage(void) {
+    reset_all();
+    boot_connect();
+    attempts_seen = host_wifi.scans + host_wifi.direct_joins;
+    uint32_t first = attempts_seen;
+    CHECK(wifi_link.valid);
+
+    // Conexão ativa: nada a fazer
+    supervise(1000);
+    CHECK_EQ(host_wifi.scans + host_wifi.direct_joins, first);
+    CHECK_EQ(wifi_supervisor.state, WIFI_SUPERVISOR_UP);
+
+    // O ponto de acesso desliga: a perda pausa a telemetria e agenda a primeira tentativa
+    host_wifi.ap_up = false;
+    host_link_status = CYW43_LINK_DOWN;
+    supervise(NETWORK_PERIOD_MS);
+    CHECK(!wifi_link_ok);
+    CHECK_EQ(wifi_supervisor.state, WIFI_SUPERVISOR_BACKOFF);
+
+    // Sete tentativas: a primeira direta (sem resposta, desiste após WIFI_FAST_JOIN_TIMEOUT_MS),
+    // as seguintes com varredura (sem rede); a espera dobra até WIFI_BACKOFF_MAX_MS
+    supervise(180000);
+    uint32_t last = attempts_seen;
+    CHECK(last - first >= 7);
+    CHECK(attempt_direct[first]);
+    CHECK(memcmp(host_wifi.join_bssid, host_wifi.bssid, 6) == 0);
+    for (uint32_t i = first + 1; i < last; i++) CHECK(!attempt_direct[i]);
+    CHECK_EQ(host_wifi.direct_joins, 1);
+    CHECK_EQ(failed_ms[first + 1] - attempt_ms[first], WIFI_FAST_JOIN_TIMEOUT_MS);
+    CHECK_EQ(failed_ms[first + 2] - attempt_ms[first + 1], host_wifi.scan_ms);
+    check_backoff(first, last);
+    CHECK(!wifi_link_ok);
+
+    // O ponto de acesso volta: a próxima varredura reconecta
+    host_wifi.ap_up = true;
+    supervise(2 * (WIFI_BACKOFF_MAX_MS + host_wifi.scan_ms));
+    CHECK_EQ(wifi_supervisor.state, WIFI_SUPERVISOR_UP);
+    CHECK(wifi_link_ok);
+    CHECK(!wifi_fast_join);
+    CHECK_EQ(wifi_join_ms, host_wifi.scan_ms);
+    CHECK_EQ(wifi_supervisor.reconnects, 1);
+    CHECK_EQ(attempts_seen, last + 1);
+
+    // Nova queda: as esperas recomeçam da menor
+    host_wifi.ap_up = false;
+    host_link_status = CYW43_LINK_DOWN;
+    first = attempts_seen;
+    supervise(10000);
+    CHECK(attempts_seen - first >= 2);
+    check_backoff(first, attempts_seen);
+}
+
+// Esperas sorteadas: nunca fora dos limites e diferentes entre as quedas
+static void test_jitter(void) {
+    reset_all();
+    boot_connect();
+    uint32_t min = UINT32_MAX, max = 0;
+    for (int drop = 0; drop < 20; drop++) {
+        attempts_seen = host_wifi.scans + host_wifi.direct_joins;
+        uint32_t first = attempts_seen;
+        host_link_status = CYW43_LINK_DOWN;
+        supervise(WIFI_BACKOFF_BASE_MS + host_wifi.direct_ms + 2 * NETWORK_PERIOD_MS);
+        CHECK_EQ(wifi_supervisor.state, WIFI_SUPERVISOR_UP);
+        CHECK_EQ(attempts_seen, first + 1);
+        check_backoff(first, attempts_seen);
+        uint32_t wait = attempt_ms[first] - failed_ms[first];
+        if (wait < min) min = wait;
+        if (wait > max) max = wait;
+    }
+    CHECK(max - min >= 2 * NETWORK_PERIOD_MS);
+    CHECK_EQ(wifi_supervisor.reconnects, 20);
+}
+
+// Senha trocada no ponto de acesso: falhas de autenticação, esperas limitadas e nenhuma gravação
+static void test_bad_auth(void) {
+    reset_all();
+    boot_connect();
+    uint32_t programs = host_flash_programs;
+    host_wifi.password = "outra senha";
+    host_wifi.pmk_hex = "00";
+    host_link_status = CYW43_LINK_BADAUTH;
+    attempts_seen = host_wifi.scans + host_wifi.direct_joins;
+    uint32_t first = attempts_seen;
+    supervise(10 * 60000);
+    CHECK(attempts_seen - first >= 12);
+    check_backoff(first, attempts_seen);
+    CHECK_EQ(wifi_supervisor.state, WIFI_SUPERVISOR_BACKOFF);
+    CHECK(!wifi_link_ok);
+    CHECK_EQ(host_flash_programs, programs);
+}
+
+// Antes da primeira conexão e com o driver recusando a tentativa
+static void test_idle_and_refused(void) {
+    reset_all();
+    host_link_status = CYW43_LINK_DOWN;
+    supervise(5000);
+    CHECK_EQ(host_wifi.scans + host_wifi.direct_joins, 0);
+    CHECK_EQ(wifi_supervisor.state, WIFI_SUPERVISOR_UP);   // Estado inicial, sem supervisão
+
+    // O driver recusa iniciar a conexão: nova espera, sem ficar em JOINING
+    boot_connect();
+    attempts_seen = host_wifi.scans + host_wifi.direct_joins;
+    uint32_t first = attempts_seen;
+    host_wifi.join_result = -1;
+    host_link_status = CYW43_LINK_DOWN;
+    supervise(8000);
+    CHECK(attempts_seen - first >= 3);
+    CHECK(wifi_supervisor.state != WIFI_SUPERVISOR_JOINING);
+    for (uint32_t i = first + 1; i < attempts_seen; i++) CHECK_EQ(failed_ms[i], attempt_ms[i - 1]);
+    check_backoff(first, attempts_seen);
+    host_wifi.join_result = 0;
+    supervise(WIFI_BACKOFF_MAX_MS + host_wifi.scan_ms + NETWORK_PERIOD_MS);
+    CHECK(wifi_link_ok);
+}
+
+int main(void) {
+    test_cached_boot();
+    test_channel_change();
+    test_hex_password();
+    test_outage();
+    test_jitter();
+    test_bad_auth();
+    test_idle_and_refused();
+    CHECK_EQ(host_net_misuse, 0);
+    return host_test_report("test_wifi_link");
+}
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+@file    embed_assets.py
+@brief   Gera o cabeçalho C com as páginas do portal de configuração.
+
+Cada arquivo de entrada (HTML, CSS ou JS) é minificado, comprimido com gzip e
+convertido em vetores constantes (armazenados na flash do Pico W), junto com
+os metadados usados pelo servidor HTTP do modo AP: tipo de conteúdo,
+comprimentos e ETag.
+
+Nos arquivos HTML, o marcador `/*@include arquivo.css*/` é substituído pelo
+conteúdo minificado do arquivo indicado (relativo ao HTML), para que cada
+página seja servida em uma única resposta.
+
+Uso:
+    embed_assets.py <saida.h> <arquivo> [<arquivo> ...]
+"""
+
+import gzip
+import os
+import re
+import sys
+import zlib
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+}
+
+INCLUDE_PATTERN = re.compile(r"/\*@include\s+([^*\s]+)\s*\*/")
+
+
+# --------------------------- Minificação ---------------------------
+
+def minify_css(text):
+    """Remove comentários e espaços desnecessários de uma folha de estilo."""
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{}:;,>])\s*", r"\1", text)
+    text = text.replace(";}", "}")
+    return text.strip()
+
+
+def minify_js(text):
+    """Minificação conservadora: remove comentários de bloco, indentação e linhas vazias."""
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    lines = (line.strip() for line in text.splitlines())
+    return "\n".join(line for line in lines if line)
+
+
+def minify_html(text, base_dir):
+    """Incorpora os estilos incluídos, remove comentários e espaços entre as tags."""
+    def include(match):
+        with open(os.path.join(base_dir, match.group(1)), encoding="utf-8") as f:
+            return minify_css(f.read())
+
+    text = INCLUDE_PATTERN.sub(include, text)
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    text = re.sub(r">\s+<", "><", text)
+    text = re.sub(r"\s+", " ", text)
+    return text.strip()
+
+
+def minify(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    ext = os.path.splitext(path)[1]
+    if ext == ".html":
+        return minify_html(text, os.path.dirname(path))
+    if ext == ".css":
+        return minify_css(text)
+    if ext == ".js":
+        return minify_js(text)
+    return text
+
+
+# --------------------------- Geração do Cabeçalho ---------------------------
+
+def c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "static const uint8_t %s[%d] = {\n%s\n};\n" % (name, len(data), "\n".join(lines))
+
+
+def symbol(path):
+    return "web_asset_" + re.sub(r"[^0-9a-zA-Z]", "_", os.path.basename(path)).lower()
+
+
+def main(argv):
+    if len(argv) < 3:
+        print(__doc__, file=sys.stderr)
+        return 1
+
+    output, inputs = argv[1], argv[2:]
+    out = [
+        "/******************************************************************************",
+        " * @file    web_assets.h",
+        " * @brief   Páginas do portal de configuração, minificadas e comprimidas com gzip.",
+        " *",
+        " * @note    Arquivo gerado por tools/embed_assets.py a partir de web/. Não editar.",
+        " ******************************************************************************/",
+        "",
+        "#ifndef WEB_ASSETS_H",
+        "#define WEB_ASSETS_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "/**",
+        " * @brief Estrutura para armazenar um arquivo embutido e os seus metadados.",
+        " */",
+        "typedef struct WEB_ASSET_T_ {",
+        "    const char *path;             // Nome do arquivo de origem.",
+        "    const char *content_type;     // Valor do cabeçalho Content-Type.",
+        "    const uint8_t *data;          // Conteúdo minificado.",
+        "    uint32_t len;                 // Comprimento do conteúdo minificado.",
+        "    const uint8_t *gzip_data;     // Conteúdo minificado e comprimido com gzip.",
+        "    uint32_t gzip_len;            // Comprimento do conteúdo comprimido.",
+        "    const char *etag;             // ETag (CRC32 do conteúdo minificado, entre aspas).",
+        "} WEB_ASSET_T;",
+        "",
+    ]
+
+    for path in inputs:
+        ext = os.path.splitext(path)[1]
+        data = minify(path).encode("utf-8")
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        name = symbol(path)
+        etag = '"%08x"' % (zlib.crc32(data) & 0xFFFFFFFF)
+
+        out.append("// %s: %d bytes minificado, %d bytes com gzip" % (os.path.basename(path), len(data), len(packed)))
+        out.append(c_array(name + "_data", data))
+        out.append(c_array(name + "_gzip", packed))
+        out.append("static const WEB_ASSET_T %s = {" % name)
+        out.append('    "%s", "%s",' % (os.path.basename(path), CONTENT_TYPES.get(ext, "application/octet-stream")))
+        out.append("    %s_data, %d," % (name, len(data)))
+        out.append("    %s_gzip, %d," % (name, len(packed)))
+        out.append('    "%s"' % etag.replace('"', '\\"'))
+        out.append("};")
+        out.append("")
+
+    out.append("#endif /*WEB_ASSETS_H*/")
+    out.append("")
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    content = "\n".join(out)
+
+    # Só reescreve o arquivo se o conteúdo mudou, evitando recompilações desnecessárias
+    if os.path.exists(output):
+        with open(output, encoding="utf-8") as f:
+            if f.read() == content:
+                return 0
+    with open(output, "w", encoding="utf-8") as f:
+        f.write(content)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+@file    log_decode.py
+@brief   Decodifica os registros binários enviados pelo firmware (log_ring.h).
+
+Lê a saída do console (arquivo ou entrada padrão). As linhas `#L<hex>` são
+registros binários: o endereço da string de formato é procurado nas seções do
+ELF do firmware e a mensagem é formatada aqui, no computador. As demais linhas
+(printf do firmware) são repetidas sem alteração.
+
+Argumentos `%s` de registros com inteiros são ponteiros: os que apontam para a
+flash são lidos do ELF; os demais aparecem como `<0x...>`.
+
+Uso:
+    log_decode.py <firmware.elf> [<captura.txt>]
+
+Exemplo:
+    cat /dev/ttyACM0 | tools/log_decode.py build/projeto_embarcatech.elf
+"""
+
+import re
+import struct
+import sys
+
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+FLAG_TEXT = 0x01
+HEADER = struct.Struct("<IIBBBB")   # timestamp_us, fmt, level, core, size, flags
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+# --------------------------- Leitura do ELF ---------------------------
+
+class Elf:
+    """Leitor mínimo de ELF32 little-endian: apenas as seções carregadas com conteúdo."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError("%s não é um ELF32 little-endian" % path)
+
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, flags, addr, offset, size = struct.unpack_from("<IIIIII", self.data, shoff + i * shentsize)
+            if flags & 0x2 and sh_type != 8 and size:   # SHF_ALLOC, exceto SHT_NOBITS (.bss)
+                self.sections.append((addr, offset, size))
+
+    def string(self, addr):
+        """Retorna a string terminada em NUL no endereço, ou None fora das seções."""
+        for start, offset, size in self.sections:
+            if start <= addr < start + size:
+                begin = offset + addr - start
+                end = self.data.index(b"\0", begin, offset + size)
+                return self.data[begin:end].decode("utf-8", "replace")
+        return None
+
+
+# --------------------------- Formatação ---------------------------
+
+def format_message(fmt, args, texts, elf):
+    """Aplica o formato C aos argumentos (palavras de 32 bits ou strings copiadas)."""
+    args = list(args)
+    texts = list(texts)
+
+    def convert(match):
+        flags, width, precision, _, kind = match.groups()
+        if kind == "%":
+            return "%"
+        spec = "%" + flags + width + ("." + precision if precision else "")
+        if kind == "s":
+            if texts:
+                value = texts.pop(0)
+            elif args:
+                addr = args.pop(0)
+                value = elf.string(addr)
+                if value is None:
+                    value = "<0x%08x>" % addr
+            else:
+                value = "?"
+            return (spec + "s") % value
+        if not args:
+            return "?"
+        value = args.pop(0)
+        if kind in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            return (spec + "d") % value
+        if kind == "c":
+            return chr(value & 0xFF)
+        if kind == "p":
+            return "0x%08x" % value
+        return (spec + kind) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(line, elf):
+    data = bytes.fromhex(line[2:].strip())
+    timestamp, fmt_addr, level, core, size, flags = HEADER.unpack_from(data)
+    payload = data[HEADER.size:]
+
+    fmt = elf.string(fmt_addr)
+    if fmt is None:
+        fmt = "<formato desconhecido 0x%08x, o ELF é deste firmware?>" % fmt_addr
+
+    if flags & FLAG_TEXT:
+        texts = payload[:size].decode("utf-8", "replace").split("\0")[:-1]
+        message = format_message(fmt, [], texts, elf)
+    else:
+        args = struct.unpack_from("<%dI" % size, payload)
+        message = format_message(fmt, args, [], elf)
+
+    return "[%6u.%06u] c%u %s %s" % (timestamp // 1000000, timestamp % 1000000, core,
+                                     LEVELS.get(level, "?"), message.rstrip("\n"))
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__, file=sys.stderr)
+        return 1
+
+    elf = Elf(argv[1])
+    stream = open(argv[2], encoding="utf-8", errors="replace") if len(argv) > 2 else sys.stdin
+    for line in stream:
+        line = line.rstrip("\r\n")
+        if line.startswith("#L"):
+            try:
+                line = decode(line, elf)
+            except (ValueError, struct.error) as err:
+                line = "%s  (registro inválido: %s)" % (line, err)
+        print(line, flush=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))